@@ -23,6 +23,9 @@
 
 namespace cereal {
 
+// Defined in mlpack/core/data/mapped_archive.hpp.
+class MappedBinaryInputArchive;
+
 template<typename Archive>
 struct is_cereal_archive
 {
@@ -33,7 +36,8 @@ struct is_cereal_archive
 // #if (BINDING_TYPE != BINDING_TYPE_R)
       std::is_same<Archive, cereal::JSONInputArchive>::value ||
 // #endif
-      std::is_same<Archive, cereal::XMLInputArchive>::value;
+      std::is_same<Archive, cereal::XMLInputArchive>::value ||
+      std::is_same<Archive, cereal::MappedBinaryInputArchive>::value;
 };
 
 template<typename Archive>
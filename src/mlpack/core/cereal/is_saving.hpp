@@ -24,6 +24,9 @@
 
 namespace cereal {
 
+// Defined in mlpack/core/data/mapped_archive.hpp.
+class MappedBinaryOutputArchive;
+
 template<typename Archive>
 struct is_cereal_archive_saving
 {
@@ -34,7 +37,8 @@ struct is_cereal_archive_saving
 // #if (BINDING_TYPE != BINDING_TYPE_R)
       std::is_same<Archive, cereal::JSONOutputArchive>::value ||
 // #endif
-      std::is_same<Archive, cereal::XMLOutputArchive>::value;
+      std::is_same<Archive, cereal::XMLOutputArchive>::value ||
+      std::is_same<Archive, cereal::MappedBinaryOutputArchive>::value;
 };
 
 template<typename Archive>
@@ -0,0 +1,258 @@
+/**
+ * @file core/data/mapped_archive.hpp
+ *
+ * Binary cereal archives for models that are loaded from a memory-mapped file.
+ * They behave like cereal's binary archives, except that the elements of every
+ * Armadillo matrix are stored at an aligned offset of the file, and when
+ * loading, the matrix uses the mapped memory directly instead of a copy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_ARCHIVE_HPP
+#define MLPACK_CORE_DATA_MAPPED_ARCHIVE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <limits>
+
+namespace cereal {
+
+/**
+ * An output archive that writes the binary representation of an object to a
+ * stream.  The elements of each Armadillo matrix are preceded by padding, so
+ * that they start at a multiple of Alignment bytes from the start of the
+ * stream.
+ */
+class MappedBinaryOutputArchive :
+    public OutputArchive<MappedBinaryOutputArchive, AllowEmptyClassElision>
+{
+ public:
+  //! The alignment of the elements of each matrix, in bytes.
+  static const size_t Alignment = 64;
+
+  /**
+   * Create the archive.  The stream must be at its beginning, since alignment
+   * is computed relative to the first byte written.
+   *
+   * @param stream Stream to write to (opened in binary mode).
+   */
+  MappedBinaryOutputArchive(std::ostream& stream) :
+      OutputArchive<MappedBinaryOutputArchive, AllowEmptyClassElision>(this),
+      stream(stream),
+      position(0)
+  { }
+
+  //! Write the given bytes to the stream.
+  void saveBinary(const void* data, std::streamsize size)
+  {
+    const std::streamsize written = stream.rdbuf()->sputn(
+        reinterpret_cast<const char*>(data), size);
+    if (written != size)
+    {
+      throw Exception("Failed to write " + std::to_string(size) + " bytes to "
+          "output stream! Wrote " + std::to_string(written));
+    }
+    position += size;
+  }
+
+  //! Write zeros until the position is aligned, then write the given bytes.
+  void SaveAligned(const void* data, std::streamsize size)
+  {
+    const char padding[Alignment] = { 0 };
+    saveBinary(padding, (Alignment - position % Alignment) % Alignment);
+    saveBinary(data, size);
+  }
+
+ private:
+  //! The stream to write to.
+  std::ostream& stream;
+  //! The number of bytes written so far.
+  size_t position;
+};
+
+/**
+ * An input archive that reads an object written by a MappedBinaryOutputArchive
+ * directly from memory (usually a data::MappedFile).  The elements of each
+ * Armadillo matrix are not copied: the matrix points into the memory, so the
+ * memory must outlive every matrix loaded from it.
+ */
+class MappedBinaryInputArchive :
+    public InputArchive<MappedBinaryInputArchive, AllowEmptyClassElision>
+{
+ public:
+  /**
+   * Create the archive.  The memory should be aligned to at least
+   * MappedBinaryOutputArchive::Alignment bytes.
+   *
+   * @param memory Memory holding the saved object.
+   * @param size Size of the memory, in bytes.
+   */
+  MappedBinaryInputArchive(char* memory, const size_t size) :
+      InputArchive<MappedBinaryInputArchive, AllowEmptyClassElision>(this),
+      memory(memory),
+      size(size),
+      position(0)
+  { }
+
+  //! Copy the next bytes of memory into the given buffer.
+  void loadBinary(void* const data, std::streamsize bytes)
+  {
+    std::memcpy(data, Map(bytes), bytes);
+  }
+
+  //! Skip the padding before the next aligned position, and return a pointer
+  //! to the given number of bytes that follow.
+  char* MapAligned(std::streamsize bytes)
+  {
+    const size_t alignment = MappedBinaryOutputArchive::Alignment;
+    Map((alignment - position % alignment) % alignment);
+    return Map(bytes);
+  }
+
+ private:
+  //! Return a pointer to the next bytes of memory, and move past them.
+  char* Map(std::streamsize bytes)
+  {
+    if ((size_t) bytes > size - position)
+    {
+      throw Exception("Failed to read " + std::to_string(bytes) + " bytes "
+          "from mapped memory! Only " + std::to_string(size - position) +
+          " bytes remain");
+    }
+
+    char* result = memory + position;
+    position += bytes;
+    return result;
+  }
+
+  //! The memory to read from.
+  char* memory;
+  //! The size of the memory.
+  size_t size;
+  //! The number of bytes read so far.
+  size_t position;
+};
+
+//! Save arithmetic types to the mapped binary archive.
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+CEREAL_SAVE_FUNCTION_NAME(MappedBinaryOutputArchive& ar, const T& t)
+{
+  ar.saveBinary(std::addressof(t), sizeof(t));
+}
+
+//! Load arithmetic types from the mapped binary archive.
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive& ar, T& t)
+{
+  ar.loadBinary(std::addressof(t), sizeof(t));
+}
+
+//! Names are not stored in the mapped binary archives.
+template<class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(MappedBinaryInputArchive,
+                               MappedBinaryOutputArchive)
+CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, NameValuePair<T>& t)
+{
+  ar(t.value);
+}
+
+//! Serialize size tags to the mapped binary archives.
+template<class Archive, class T>
+inline CEREAL_ARCHIVE_RESTRICT(MappedBinaryInputArchive,
+                               MappedBinaryOutputArchive)
+CEREAL_SERIALIZE_FUNCTION_NAME(Archive& ar, SizeTag<T>& t)
+{
+  ar(t.size);
+}
+
+//! Save binary data to the mapped binary archive.
+template<class T>
+inline void CEREAL_SAVE_FUNCTION_NAME(MappedBinaryOutputArchive& ar,
+                                      const BinaryData<T>& bd)
+{
+  ar.saveBinary(bd.data, static_cast<std::streamsize>(bd.size));
+}
+
+//! Load binary data from the mapped binary archive.
+template<class T>
+inline void CEREAL_LOAD_FUNCTION_NAME(MappedBinaryInputArchive& ar,
+                                      BinaryData<T>& bd)
+{
+  ar.loadBinary(bd.data, static_cast<std::streamsize>(bd.size));
+}
+
+/**
+ * Save a dense Armadillo matrix to the mapped binary archive; the elements are
+ * stored at an aligned offset.
+ */
+template<typename eT>
+void serialize(MappedBinaryOutputArchive& ar, arma::Mat<eT>& mat)
+{
+  arma::uword n_rows = mat.n_rows;
+  arma::uword n_cols = mat.n_cols;
+  arma::uword vec_state = mat.vec_state;
+
+  ar(CEREAL_NVP(n_rows));
+  ar(CEREAL_NVP(n_cols));
+  ar(CEREAL_NVP(vec_state));
+
+  ar.SaveAligned(mat.memptr(), mat.n_elem * sizeof(eT));
+}
+
+/**
+ * Load a dense Armadillo matrix from the mapped binary archive.  The matrix is
+ * made to use the mapped memory as its auxiliary memory, the same way as an
+ * Armadillo matrix constructed with copy_aux_mem = false and strict = false; if
+ * it is later resized, it allocates its own memory.
+ */
+template<typename eT>
+void serialize(MappedBinaryInputArchive& ar, arma::Mat<eT>& mat)
+{
+  arma::uword n_rows = 0;
+  arma::uword n_cols = 0;
+  arma::uword vec_state = 0;
+
+  ar(CEREAL_NVP(n_rows));
+  ar(CEREAL_NVP(n_cols));
+  ar(CEREAL_NVP(vec_state));
+
+  // Make sure that the size of the elements fits in the archive before it is
+  // computed; a corrupt file could otherwise wrap it around to a small size.
+  const size_t maxElements = ((size_t)
+      std::numeric_limits<std::streamsize>::max()) / sizeof(eT);
+  if (n_cols != 0 && (size_t) n_rows > maxElements / n_cols)
+  {
+    throw Exception("Matrix of size " + std::to_string(n_rows) + "x" +
+        std::to_string(n_cols) + " is too large to be mapped!");
+  }
+
+  eT* memory = reinterpret_cast<eT*>(ar.MapAligned(n_rows * n_cols *
+      sizeof(eT)));
+
+  // Release any memory owned by the matrix before pointing it to the mapping.
+  // (If the matrix already uses auxiliary memory, there is nothing to free.)
+  if (mat.mem_state == 0)
+    mat.reset();
+
+  arma::access::rw(mat.n_rows) = n_rows;
+  arma::access::rw(mat.n_cols) = n_cols;
+  arma::access::rw(mat.n_elem) = n_rows * n_cols;
+  arma::access::rw(mat.vec_state) = vec_state;
+  arma::access::rw(mat.n_alloc) = 0;
+  arma::access::rw(mat.mem_state) = 1;
+  arma::access::rw(mat.mem) = (n_rows * n_cols == 0) ? NULL : memory;
+}
+
+} // namespace cereal
+
+CEREAL_REGISTER_ARCHIVE(cereal::MappedBinaryOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::MappedBinaryInputArchive)
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::MappedBinaryInputArchive,
+                            cereal::MappedBinaryOutputArchive)
+
+#endif
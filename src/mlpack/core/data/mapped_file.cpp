@@ -0,0 +1,95 @@
+/**
+ * @file core/data/mapped_file.cpp
+ *
+ * Implementation of the MappedFile class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+  #include <fstream>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) :
+    data(NULL),
+    size(0)
+{
+  // Without mmap(), read the whole file into (suitably aligned) memory.
+  std::ifstream ifs(filename, std::ifstream::in | std::ifstream::binary |
+      std::ifstream::ate);
+  if (!ifs.is_open())
+    throw std::runtime_error("Unable to open file '" + filename + "'.");
+
+  size = (size_t) ifs.tellg();
+  ifs.seekg(0);
+  data = (char*) arma::memory::acquire<double>(size / sizeof(double) + 1);
+  if (!ifs.read(data, size))
+  {
+    arma::memory::release((double*) data);
+    throw std::runtime_error("Unable to read file '" + filename + "'.");
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  arma::memory::release((double*) data);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) :
+    data(NULL),
+    size(0)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Unable to open file '" + filename + "'.");
+
+  struct stat info;
+  if (fstat(fd, &info) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("Unable to get the size of file '" + filename +
+        "'.");
+  }
+
+  size = (size_t) info.st_size;
+  if (size == 0)
+  {
+    close(fd);
+    return;
+  }
+
+  // A private mapping is copy-on-write: the pages are shared with every other
+  // process mapping the file until they are written to.
+  void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+
+  if (memory == MAP_FAILED)
+    throw std::runtime_error("Unable to map file '" + filename + "'.");
+
+  data = static_cast<char*>(memory);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data != NULL)
+    munmap(data, size);
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file core/data/mapped_file.hpp
+ *
+ * A read-only view of a file that is mapped into memory.  This is used to load
+ * models saved with data::SaveMapped() without copying their matrices.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The MappedFile class maps the contents of a file into memory for as long as
+ * the object exists.  On POSIX systems the file is mapped with mmap() as a
+ * private, copy-on-write mapping: the pages of the file are loaded lazily and
+ * are shared by every process that maps the same file, and writing to the
+ * memory only modifies a private copy of the written page (the file itself is
+ * never modified).  On other systems, the file is simply read into memory.
+ *
+ * The memory is page-aligned, so data stored at aligned offsets in the file
+ * can be used in place.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file into memory.  If the file cannot be opened or mapped, a
+   * std::runtime_error is thrown.
+   *
+   * @param filename Name of the file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Unmap the file.  Any pointers into the mapped memory are invalidated.
+  ~MappedFile();
+
+  // A mapping can't be copied.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  //! Get the mapped memory.
+  char* Data() const { return data; }
+  //! Get the size of the mapped memory, in bytes.
+  size_t Size() const { return size; }
+
+ private:
+  //! The mapped memory.
+  char* data;
+  //! The size of the mapped memory.
+  size_t size;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
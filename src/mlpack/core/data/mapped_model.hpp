@@ -0,0 +1,86 @@
+/**
+ * @file core/data/mapped_model.hpp
+ *
+ * Functions to save models in a format that can be memory-mapped, and to load
+ * them without copying their matrices.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MODEL_HPP
+#define MLPACK_CORE_DATA_MAPPED_MODEL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/log.hpp>
+
+#include "mapped_file.hpp"
+#include "mapped_archive.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Save a model to a file in the mapped binary format.  This is a binary format
+ * like the one used by data::Save() with format::binary, except that the
+ * elements of each dense Armadillo matrix are stored at an aligned offset.
+ * Models saved this way can be loaded with LoadMapped().  The file starts with
+ * a header that holds the version of the format, the byte order, and the sizes
+ * of arma::uword and size_t; the format is not portable between systems of
+ * different endianness or word size, so LoadMapped() rejects files whose
+ * header does not match the system.
+ *
+ * @tparam T Type of the model to save (must have a serialize() function).
+ * @param filename Name of the file to save to.
+ * @param name Name of the object to save.
+ * @param t Object to save.
+ * @param fatal If true, an error will throw a std::runtime_error.
+ * @return Whether or not the saving was successful.
+ */
+template<typename T>
+bool SaveMapped(const std::string& filename,
+                const std::string& name,
+                T& t,
+                const bool fatal = false);
+
+/**
+ * Load a model that was saved with SaveMapped().  The file is mapped into
+ * memory, and every dense Armadillo matrix in the model uses the mapped memory
+ * instead of holding its own copy; so loading is fast even for very large
+ * models, and processes that load the same file share its memory.
+ *
+ * Only dense Armadillo matrices are mapped.  The rest of the model is
+ * deserialized as usual; in particular, the nodes of a tree (with their bounds
+ * and statistics) are allocated on the heap and read from the file, so loading
+ * a tree-based model still takes time and memory linear in the number of
+ * nodes.
+ *
+ * The matrices of the model point into the given mapping, so the mapping must
+ * be kept alive as long as the model (or any of its matrices) is used.  The
+ * matrices can be modified, but that only changes the private copy of the
+ * modified memory, never the file; a matrix that is resized allocates its own
+ * memory as usual.
+ *
+ * @tparam T Type of the model to load (must have a serialize() function).
+ * @param filename Name of the file to load.
+ * @param name Name of the object to load.
+ * @param t Object to load into.
+ * @param mapping Will be set to the mapping of the file.
+ * @param fatal If true, an error will throw a std::runtime_error.
+ * @return Whether or not the loading was successful.
+ */
+template<typename T>
+bool LoadMapped(const std::string& filename,
+                const std::string& name,
+                T& t,
+                std::shared_ptr<MappedFile>& mapping,
+                const bool fatal = false);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "mapped_model_impl.hpp"
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * @file core/data/mapped_model_impl.hpp
+ *
+ * Implementation of SaveMapped() and LoadMapped().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MODEL_IMPL_HPP
+#define MLPACK_CORE_DATA_MAPPED_MODEL_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "mapped_model.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace mlpack {
+namespace data {
+
+//! The bytes at the beginning of each file in the mapped binary format.
+static const char mappedModelMagic[8] = { 'm', 'l', 'p', 'a', 'c', 'k',
+    'M', 'F' };
+
+//! The version of the mapped binary format, stored after the magic bytes.
+static const uint32_t mappedModelVersion = 1;
+
+//! Stored after the version; it reads differently if the byte order differs.
+static const uint32_t mappedModelByteOrder = 0x01020304;
+
+/**
+ * The header of each file in the mapped binary format.  The elements of the
+ * matrices and every integer in the file are stored in the representation of
+ * the system that saved it, so a file can only be loaded on a system with the
+ * same byte order and the same sizes of arma::uword and size_t.
+ */
+struct MappedModelHeader
+{
+  //! Create the header of the current system.
+  MappedModelHeader() :
+      version(mappedModelVersion),
+      byteOrder(mappedModelByteOrder),
+      uwordSize(sizeof(arma::uword)),
+      sizeTSize(sizeof(size_t))
+  {
+    std::memcpy(magic, mappedModelMagic, sizeof(magic));
+  }
+
+  //! The magic bytes; always mappedModelMagic.
+  char magic[8];
+  //! The version of the format.
+  uint32_t version;
+  //! mappedModelByteOrder, as stored by the system that saved the file.
+  uint32_t byteOrder;
+  //! The size of arma::uword on the system that saved the file.
+  uint32_t uwordSize;
+  //! The size of size_t on the system that saved the file.
+  uint32_t sizeTSize;
+};
+
+/**
+ * Check that the given header was written by a compatible system, and return
+ * an empty string if so; otherwise return a description of the problem.
+ */
+inline std::string CheckMappedModelHeader(const MappedModelHeader& header)
+{
+  const MappedModelHeader expected;
+  std::ostringstream oss;
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+  {
+    oss << "it is not a mapped mlpack model";
+  }
+  else if (header.byteOrder != expected.byteOrder)
+  {
+    oss << "it was saved on a system with a different byte order";
+  }
+  else if (header.version != expected.version)
+  {
+    oss << "it uses version " << header.version << " of the mapped format, "
+        << "but only version " << expected.version << " is supported";
+  }
+  else if (header.uwordSize != expected.uwordSize ||
+           header.sizeTSize != expected.sizeTSize)
+  {
+    oss << "it was saved on a system with " << header.uwordSize * 8 << "-bit "
+        << "arma::uword and " << header.sizeTSize * 8 << "-bit size_t, but "
+        << "this system has " << expected.uwordSize * 8 << "-bit arma::uword "
+        << "and " << expected.sizeTSize * 8 << "-bit size_t";
+  }
+
+  return oss.str();
+}
+
+template<typename T>
+bool SaveMapped(const std::string& filename,
+                const std::string& name,
+                T& t,
+                const bool fatal)
+{
+  std::ofstream ofs(filename, std::ofstream::out | std::ofstream::binary);
+  if (!ofs.is_open())
+  {
+    if (fatal)
+      Log::Fatal << "Unable to open file '" << filename << "' to save object '"
+          << name << "'." << std::endl;
+    else
+      Log::Warn << "Unable to open file '" << filename << "' to save object '"
+          << name << "'." << std::endl;
+
+    return false;
+  }
+
+  try
+  {
+    cereal::MappedBinaryOutputArchive ar(ofs);
+    const MappedModelHeader header;
+    ar.saveBinary(header.magic, sizeof(header.magic));
+    ar(header.version, header.byteOrder, header.uwordSize, header.sizeTSize);
+    ar(cereal::make_nvp(name.c_str(), t));
+  }
+  catch (cereal::Exception& e)
+  {
+    if (fatal)
+      Log::Fatal << e.what() << std::endl;
+    else
+      Log::Warn << e.what() << std::endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+template<typename T>
+bool LoadMapped(const std::string& filename,
+                const std::string& name,
+                T& t,
+                std::shared_ptr<MappedFile>& mapping,
+                const bool fatal)
+{
+  std::shared_ptr<MappedFile> newMapping;
+  try
+  {
+    newMapping = std::make_shared<MappedFile>(filename);
+  }
+  catch (std::runtime_error& e)
+  {
+    if (fatal)
+      Log::Fatal << e.what() << "  Could not load object '" << name << "'."
+          << std::endl;
+    else
+      Log::Warn << e.what() << "  Could not load object '" << name << "'."
+          << std::endl;
+
+    return false;
+  }
+
+  // Check the header before anything else is read, since every integer in
+  // the file depends on it.
+  MappedModelHeader header;
+  cereal::MappedBinaryInputArchive ar(newMapping->Data(), newMapping->Size());
+  std::string problem;
+  try
+  {
+    ar.loadBinary(header.magic, sizeof(header.magic));
+    ar(header.version, header.byteOrder, header.uwordSize, header.sizeTSize);
+    problem = CheckMappedModelHeader(header);
+  }
+  catch (cereal::Exception& e)
+  {
+    problem = "it is not a mapped mlpack model";
+  }
+
+  if (!problem.empty())
+  {
+    if (fatal)
+      Log::Fatal << "Cannot load object '" << name << "' from file '"
+          << filename << "': " << problem << "." << std::endl;
+    else
+      Log::Warn << "Cannot load object '" << name << "' from file '"
+          << filename << "': " << problem << "." << std::endl;
+
+    return false;
+  }
+
+  // The matrices of the model will point into the new mapping (even if loading
+  // fails partway), so hold on to it from now on.
+  mapping = newMapping;
+
+  try
+  {
+    ar(cereal::make_nvp(name.c_str(), t));
+  }
+  catch (cereal::Exception& e)
+  {
+    if (fatal)
+      Log::Fatal << e.what() << std::endl;
+    else
+      Log::Warn << e.what() << std::endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
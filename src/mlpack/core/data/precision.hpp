@@ -0,0 +1,77 @@
+/**
+ * @file core/data/precision.hpp
+ *
+ * Utilities for models that can store their data in either single or double
+ * precision, chosen at runtime (like NSModel and RSModel).  The public
+ * interface of such models works with arma::mat; these functions convert the
+ * data to the matrix type that is actually held, and give typed access to it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PRECISION_HPP
+#define MLPACK_CORE_DATA_PRECISION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Convert the given dataset to MatType.  If MatType is arma::mat, the dataset
+ * is moved and no copy is made.
+ *
+ * @param dataset Dataset to convert; its memory is released.
+ */
+template<typename MatType>
+inline typename std::enable_if<std::is_same<MatType, arma::mat>::value,
+    MatType>::type
+ConvertPrecision(arma::mat&& dataset)
+{
+  return std::move(dataset);
+}
+
+template<typename MatType>
+inline typename std::enable_if<!std::is_same<MatType, arma::mat>::value,
+    MatType>::type
+ConvertPrecision(arma::mat&& dataset)
+{
+  MatType result = arma::conv_to<MatType>::from(dataset);
+  dataset.reset();
+  return result;
+}
+
+/**
+ * Return the given matrix as a matrix with elements of type eT.  If the matrix
+ * already holds elements of type eT, it is returned directly.  Otherwise, it is
+ * converted into the given copy (only if the copy does not already have the
+ * size of the matrix, so the conversion happens once), and the copy is
+ * returned.
+ *
+ * @param matrix Matrix to return.
+ * @param copy Matrix to hold the converted matrix, if a conversion is needed.
+ */
+template<typename eT, typename MatType>
+inline typename std::enable_if<std::is_same<typename MatType::elem_type,
+    eT>::value, const arma::Mat<eT>&>::type
+MatrixOfType(const MatType& matrix, arma::Mat<eT>& /* copy */)
+{
+  return matrix;
+}
+
+template<typename eT, typename MatType>
+inline typename std::enable_if<!std::is_same<typename MatType::elem_type,
+    eT>::value, const arma::Mat<eT>&>::type
+MatrixOfType(const MatType& matrix, arma::Mat<eT>& copy)
+{
+  if (copy.n_rows != matrix.n_rows || copy.n_cols != matrix.n_cols)
+    copy = arma::conv_to<arma::Mat<eT>>::from(matrix);
+  return copy;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file core/metrics/distance_kernels.hpp
+ *
+ * Low-level loops used to compute L1, squared L2, and L-infinity distances, as
+ * well as the distances between hyperrectangles.  Each loop keeps four
+ * independent partial results, so that the additions do not form one long
+ * dependency chain.  The loops are plain C++: no intrinsics are used and there
+ * is no runtime dispatch, so whether they are vectorized (and with which
+ * instruction set) is up to the compiler and its flags.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_DISTANCE_KERNELS_HPP
+#define MLPACK_CORE_METRICS_DISTANCE_KERNELS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <sstream>
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * Compute the sum of f(i) for i in [0, n), using four partial sums.
+ *
+ * @param n Number of terms.
+ * @param f Function returning the i'th term.
+ */
+template<typename ElemType, typename FunctionType>
+inline ElemType UnrolledSum(const size_t n, const FunctionType& f)
+{
+  ElemType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    s0 += f(i);
+    s1 += f(i + 1);
+    s2 += f(i + 2);
+    s3 += f(i + 3);
+  }
+  for (; i < n; ++i)
+    s0 += f(i);
+
+  return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * Return the larger of a and b, or NaN if either of them is NaN.  (std::max()
+ * would drop a NaN in b.)
+ */
+template<typename ElemType>
+inline ElemType MaxOrNaN(const ElemType a, const ElemType b)
+{
+  return (a >= b || a != a) ? a : b;
+}
+
+/**
+ * Compute the maximum of f(i) for i in [0, n), using four partial maxima.  All
+ * terms are assumed to be non-negative; 0 is returned if n is 0, and NaN is
+ * returned if any term is NaN.
+ *
+ * @param n Number of terms.
+ * @param f Function returning the i'th term.
+ */
+template<typename ElemType, typename FunctionType>
+inline ElemType UnrolledMax(const size_t n, const FunctionType& f)
+{
+  ElemType m0 = 0, m1 = 0, m2 = 0, m3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    m0 = MaxOrNaN(m0, f(i));
+    m1 = MaxOrNaN(m1, f(i + 1));
+    m2 = MaxOrNaN(m2, f(i + 2));
+    m3 = MaxOrNaN(m3, f(i + 3));
+  }
+  for (; i < n; ++i)
+    m0 = MaxOrNaN(m0, f(i));
+
+  return MaxOrNaN(MaxOrNaN(m0, m1), MaxOrNaN(m2, m3));
+}
+
+/**
+ * ContiguousVector provides access to the memory of dense vector types whose
+ * elements are stored contiguously.  For any other type (expressions, sparse
+ * vectors, and so on), Value is false, and the distance metrics fall back to
+ * Armadillo expressions.
+ */
+template<typename VecType>
+struct ContiguousVector
+{
+  static const bool Value = false;
+};
+
+template<typename eT>
+struct ContiguousVector<arma::Col<eT>>
+{
+  static const bool Value = true;
+  static const eT* Memory(const arma::Col<eT>& v) { return v.memptr(); }
+};
+
+template<typename eT>
+struct ContiguousVector<arma::Row<eT>>
+{
+  static const bool Value = true;
+  static const eT* Memory(const arma::Row<eT>& v) { return v.memptr(); }
+};
+
+template<typename eT>
+struct ContiguousVector<arma::Mat<eT>>
+{
+  static const bool Value = true;
+  static const eT* Memory(const arma::Mat<eT>& v) { return v.memptr(); }
+};
+
+template<typename eT>
+struct ContiguousVector<arma::subview_col<eT>>
+{
+  static const bool Value = true;
+  static const eT* Memory(const arma::subview_col<eT>& v) { return v.colmem; }
+};
+
+/**
+ * This is true if the L-metric kernels below can be used for the given pair of
+ * vector types: both must be contiguous and have the same floating-point
+ * element type.
+ */
+template<typename VecTypeA, typename VecTypeB>
+struct UseDistanceKernels
+{
+  static const bool Value = ContiguousVector<VecTypeA>::Value &&
+      ContiguousVector<VecTypeB>::Value &&
+      std::is_same<typename VecTypeA::elem_type,
+                   typename VecTypeB::elem_type>::value &&
+      std::is_floating_point<typename VecTypeA::elem_type>::value;
+};
+
+/**
+ * Throw a std::invalid_argument if the given vectors do not have the same
+ * number of elements, like the Armadillo expressions that the kernels replace.
+ * As in Armadillo, the check is skipped if ARMA_NO_DEBUG is defined.
+ */
+template<typename VecTypeA, typename VecTypeB>
+inline void CheckSameSize(const VecTypeA& a,
+                          const VecTypeB& b,
+                          const char* distanceName)
+{
+  #ifndef ARMA_NO_DEBUG
+  if (a.n_elem != b.n_elem)
+  {
+    std::ostringstream oss;
+    oss << distanceName << ": incompatible vector sizes (" << a.n_elem
+        << " and " << b.n_elem << ")";
+    throw std::invalid_argument(oss.str());
+  }
+  #else
+  (void) a;
+  (void) b;
+  (void) distanceName;
+  #endif
+}
+
+//! Compute the L1 (Manhattan) distance between two arrays of length n.
+template<typename eT>
+inline eT ManhattanKernel(const eT* a, const eT* b, const size_t n)
+{
+  return UnrolledSum<eT>(n, [a, b](const size_t i)
+      { return std::abs(a[i] - b[i]); });
+}
+
+//! Compute the squared L2 (Euclidean) distance between two arrays of length n.
+template<typename eT>
+inline eT SquaredEuclideanKernel(const eT* a, const eT* b, const size_t n)
+{
+  return UnrolledSum<eT>(n, [a, b](const size_t i)
+      {
+        const eT d = a[i] - b[i];
+        return d * d;
+      });
+}
+
+//! Compute the L-infinity (Chebyshev) distance between two arrays of length n.
+//! The result is NaN if any element of either array is NaN.
+template<typename eT>
+inline eT ChebyshevKernel(const eT* a, const eT* b, const size_t n)
+{
+  return UnrolledMax<eT>(n, [a, b](const size_t i)
+      { return std::abs(a[i] - b[i]); });
+}
+
+/**
+ * Compute the L1 distance between two vectors, with ManhattanKernel() if the
+ * vectors are contiguous, and with an Armadillo expression otherwise.
+ */
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+ManhattanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  CheckSameSize(a, b, "ManhattanDistance::Evaluate()");
+  return ManhattanKernel(ContiguousVector<VecTypeA>::Memory(a),
+      ContiguousVector<VecTypeB>::Memory(b), a.n_elem);
+}
+
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<!UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+ManhattanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  return arma::accu(abs(a - b));
+}
+
+/**
+ * Compute the squared L2 distance between two vectors, with
+ * SquaredEuclideanKernel() if the vectors are contiguous, and with an
+ * Armadillo expression otherwise.
+ */
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+SquaredEuclideanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  CheckSameSize(a, b, "EuclideanDistance::Evaluate()");
+  return SquaredEuclideanKernel(ContiguousVector<VecTypeA>::Memory(a),
+      ContiguousVector<VecTypeB>::Memory(b), a.n_elem);
+}
+
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<!UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+SquaredEuclideanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  return accu(arma::square(a - b));
+}
+
+/**
+ * Compute the L2 distance between two vectors, with SquaredEuclideanKernel()
+ * if the vectors are contiguous, and with an Armadillo expression otherwise.
+ */
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+EuclideanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  return std::sqrt(SquaredEuclideanEvaluate(a, b));
+}
+
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<!UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+EuclideanEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  return arma::norm(a - b, 2);
+}
+
+/**
+ * Compute the L-infinity distance between two vectors, with ChebyshevKernel()
+ * if the vectors are contiguous, and with an Armadillo expression otherwise.
+ */
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+ChebyshevEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  CheckSameSize(a, b, "ChebyshevDistance::Evaluate()");
+  return ChebyshevKernel(ContiguousVector<VecTypeA>::Memory(a),
+      ContiguousVector<VecTypeB>::Memory(b), a.n_elem);
+}
+
+template<typename VecTypeA, typename VecTypeB>
+inline typename std::enable_if<!UseDistanceKernels<VecTypeA, VecTypeB>::Value,
+    typename VecTypeA::elem_type>::type
+ChebyshevEvaluate(const VecTypeA& a, const VecTypeB& b)
+{
+  return arma::as_scalar(arma::max(arma::abs(a - b)));
+}
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 
 // In case it hasn't been included.
 #include "lmetric.hpp"
+#include "distance_kernels.hpp"
 
 namespace mlpack {
 namespace metric {
@@ -35,6 +36,9 @@ typename VecTypeA::elem_type LMetric<Power, TakeRoot>::Evaluate(
   return std::pow(sum, (1.0 / Power));
 }
 
+// The L1, L2, and L-infinity specializations use the unrolled kernels in
+// distance_kernels.hpp when both vectors are stored contiguously.
+
 // L1-metric specializations; the root doesn't matter.
 template<>
 template<typename VecTypeA, typename VecTypeB>
@@ -42,7 +46,7 @@ typename VecTypeA::elem_type LMetric<1, true>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  return arma::accu(abs(a - b));
+  return ManhattanEvaluate(a, b);
 }
 
 template<>
@@ -51,7 +55,7 @@ typename VecTypeA::elem_type LMetric<1, false>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  return arma::accu(abs(a - b));
+  return ManhattanEvaluate(a, b);
 }
 
 // L2-metric specializations.
@@ -61,7 +65,7 @@ typename VecTypeA::elem_type LMetric<2, true>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  return arma::norm(a - b, 2);
+  return EuclideanEvaluate(a, b);
 }
 
 template<>
@@ -70,7 +74,7 @@ typename VecTypeA::elem_type LMetric<2, false>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  return accu(arma::square(a - b));
+  return SquaredEuclideanEvaluate(a, b);
 }
 
 // L3-metric specialization (not very likely to be used, but just in case).
@@ -103,7 +107,7 @@ typename VecTypeA::elem_type LMetric<INT_MAX, false>::Evaluate(
     const VecTypeA& a,
     const VecTypeB& b)
 {
-  return arma::as_scalar(arma::max(arma::abs(a - b)));
+  return ChebyshevEvaluate(a, b);
 }
 
 } // namespace metric
@@ -15,6 +15,7 @@
 
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
+#include "parallel_build.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -25,13 +26,30 @@ namespace tree /** Trees and tree-building procedures. */ {
  * the constructor with the dataset to build the tree on, and the entire tree
  * will be built.
  *
- * This particular tree does not allow growth, so you cannot add or delete nodes
- * from it.  If you need to add or delete a node, the better procedure is to
- * rebuild the tree entirely.
+ * Points can be added to and removed from a built tree with Insert() and
+ * Delete().  To avoid moving the whole dataset on every change, the leaves of a
+ * modified tree may be followed by free columns of the dataset: Insert() writes
+ * the point into a free column of its leaf, and Delete() moves the last point
+ * of the leaf into the removed column.  When a leaf has no free column left,
+ * the free columns of the smallest enclosing node that is sparse enough are
+ * spread out among its leaves again (and the dataset grows when the whole tree
+ * is too full), so that only O(log^2 n) columns are moved per insertion,
+ * amortized.  Bounds are expanded on insertion but are not tightened on
+ * deletion; instead, any node whose size drifts too far from the size it was
+ * built with is rebuilt (along with its bound), which keeps the tree balanced.
+ * Compact() removes the free columns again.  If many points change at once, it
+ * is still better to rebuild the tree entirely.
  *
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
  *
+ * If mlpack is compiled with OpenMP and the split type supports it (see
+ * SplitTraits in parallel_build.hpp; this is the case for kd-trees and ball
+ * trees), large trees are built in parallel: the two children of large nodes
+ * are built as concurrent tasks, and the bound and split value of large nodes
+ * are computed in parallel blocks.  The resulting tree and oldFromNew mapping
+ * are the same as for a serial build.
+ *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -88,6 +106,20 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If the tree has been packed with Pack(), this holds all nodes other than
+  //! the root, followed by the packed ranges of their bounds (this is only set
+  //! in the root).
+  BinarySpaceTree* packedNodes;
+  //! The number of nodes in packedNodes.
+  size_t numPackedNodes;
+  //! The number of points this node held when it was last built; used by
+  //! Insert() and Delete() to decide when the node must be rebuilt.
+  size_t builtCount;
+  //! The number of columns of the dataset that belong to this node, starting
+  //! at begin.  In a leaf, the first count columns hold its points and the rest
+  //! are free for Insert(); this is equal to count unless the tree was
+  //! modified.
+  size_t capacity;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -433,7 +465,8 @@ class BinarySpaceTree
   /**
    * Return the index (with reference to the dataset) of a particular descendant
    * of this node.  The index should be greater than zero but less than the
-   * number of descendants.
+   * number of descendants.  If the node has free columns (see Insert()), this
+   * takes time logarithmic in the size of the node instead of constant time.
    *
    * @param index Index of the descendant.
    */
@@ -504,8 +537,142 @@ class BinarySpaceTree
   //! Modify the number of points in this subset.
   size_t& Count() { return count; }
 
+  //! Return the number of columns of the dataset that belong to this subset,
+  //! including the free columns left by Insert() and Delete().
+  size_t Capacity() const { return capacity; }
+
   //! Store the center of the bounding region in the given vector.
-  void Center(arma::vec& center) const { bound.Center(center); }
+  void Center(arma::Col<ElemType>& center) const { bound.Center(center); }
+
+  /**
+   * Move all nodes of the tree other than the root into one contiguous array,
+   * in breadth-first order.  If the bounds are HRectBounds, their ranges are
+   * moved into the same allocation, right after the nodes and in the same
+   * order.  This does not change the structure of the tree or any results
+   * computed with it, but nodes that are close to each other in the tree are
+   * then also close in memory, which reduces cache misses during traversals of
+   * large trees.  Pointers and references to nodes other than the root are
+   * invalidated.  This is meant to be called once the tree will no longer be
+   * modified (for instance, before it is used for many searches); copies of a
+   * packed tree are not packed, and Insert(), Delete() and Compact() call
+   * Unpack() first.
+   *
+   * This can only be called on the root of the tree; otherwise, a
+   * std::invalid_argument exception is thrown.
+   */
+  void Pack();
+
+  /**
+   * Move the nodes of a tree that was packed with Pack() back into separate
+   * allocations, as if the tree had never been packed.  Pointers and
+   * references to nodes other than the root are invalidated.  This does
+   * nothing if the tree is not packed.
+   */
+  void Unpack();
+
+  //! Return whether the nodes of the tree have been packed with Pack().
+  bool IsPacked() const { return packedNodes != NULL; }
+
+  /**
+   * Insert a point into the tree.  The point is written into a free column of
+   * the leaf whose bound is closest to it, and the bounds of the leaf and its
+   * ancestors are expanded to contain it.  If the leaf has no free column, the
+   * free columns of an ancestor are first spread out among its leaves, or, if
+   * the whole tree is too full, the dataset is enlarged to twice the number of
+   * points.  Then, if the leaf holds more than maxLeafSize points, or if any
+   * ancestor has grown to more than twice the size it was built with, the
+   * highest such node is rebuilt.  Points of the tree may move to other columns
+   * of the dataset.
+   *
+   * This can only be called on the root of the tree; otherwise a
+   * std::invalid_argument exception is thrown.  A packed tree is unpacked
+   * first.  It is not available for split types that set
+   * SplitTraits::SupportsIncrementalUpdates to false.
+   *
+   * @param point Point to insert.
+   * @param maxLeafSize Maximum number of points held in a leaf (this should be
+   *     the same as when the tree was built).
+   */
+  template<typename VecType>
+  void Insert(const VecType& point,
+              const size_t maxLeafSize = 20,
+              typename std::enable_if_t<IsVector<VecType>::value>* = 0);
+
+  /**
+   * Insert a point into the tree, as above, and update the given oldFromNew
+   * and newFromOld mappings (as filled by the constructor).  The new point is
+   * given the old index newFromOld.size(), as if it had been appended to the
+   * original dataset.  oldFromNew holds an entry for every column of Dataset();
+   * the entries of free columns are SIZE_MAX.
+   *
+   * @param point Point to insert.
+   * @param oldFromNew Vector holding permuted indices.
+   * @param newFromOld Vector holding the inverse of oldFromNew.
+   * @param maxLeafSize Maximum number of points held in a leaf (this should be
+   *     the same as when the tree was built).
+   */
+  template<typename VecType>
+  void Insert(const VecType& point,
+              std::vector<size_t>& oldFromNew,
+              std::vector<size_t>& newFromOld,
+              const size_t maxLeafSize = 20,
+              typename std::enable_if_t<IsVector<VecType>::value>* = 0);
+
+  /**
+   * Remove the point in the given column of the dataset of the tree.  The last
+   * point of its leaf is moved into that column, so no other point moves.  The
+   * bounds of the nodes that held the point are not tightened; but, like for
+   * Insert(), if any of these nodes has shrunk to less than half the size it
+   * was built with (or if one of its children is left empty), the highest such
+   * node is rebuilt with tight bounds.  If less than a quarter of the columns
+   * of the dataset are left holding points, the dataset is shrunk.
+   *
+   * This can only be called on the root of the tree; otherwise a
+   * std::invalid_argument exception is thrown.  A packed tree is unpacked
+   * first.  A std::invalid_argument exception is also thrown if the column
+   * does not hold a point.
+   *
+   * @param index Column of the point to remove in Dataset().
+   * @param maxLeafSize Maximum number of points held in a leaf (this should be
+   *     the same as when the tree was built).
+   */
+  void Delete(const size_t index, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point in the given column of the dataset of the tree, as above,
+   * and update the given oldFromNew and newFromOld mappings (as filled by the
+   * constructor).  The old index of the removed point is not given to any other
+   * point, and its entry in newFromOld is set to SIZE_MAX; the old indices of
+   * all other points stay the same.
+   *
+   * @param index Column of the point to remove in Dataset().
+   * @param oldFromNew Vector holding permuted indices.
+   * @param newFromOld Vector holding the inverse of oldFromNew.
+   * @param maxLeafSize Maximum number of points held in a leaf (this should be
+   *     the same as when the tree was built).
+   */
+  void Delete(const size_t index,
+              std::vector<size_t>& oldFromNew,
+              std::vector<size_t>& newFromOld,
+              const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the free columns left by Insert() and Delete() from the dataset, so
+   * that the points of every node are contiguous again.  This moves all points
+   * and takes time linear in the size of the dataset.  It can only be called on
+   * the root of the tree; a packed tree is unpacked first.
+   */
+  void Compact();
+
+  /**
+   * Remove the free columns from the dataset, as above, and update the given
+   * oldFromNew and newFromOld mappings.
+   *
+   * @param oldFromNew Vector holding permuted indices.
+   * @param newFromOld Vector holding the inverse of oldFromNew.
+   */
+  void Compact(std::vector<size_t>& oldFromNew,
+               std::vector<size_t>& newFromOld);
 
  private:
   /**
@@ -546,6 +713,101 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  //! Return whether the children of this node should be built in parallel.
+  bool BuildChildrenInParallel() const;
+
+  //! Destroy the nodes held in packedNodes, if there are any, and free the
+  //! array.
+  void ReleasePackedNodes();
+
+  //! Throw a std::invalid_argument exception if the tree can't be modified
+  //! with Insert() or Delete() (that is, if this is not the root).
+  void CheckModifiable(const char* function) const;
+
+  /**
+   * Insert the given point into a free column of the closest leaf.  If
+   * oldFromNew and newFromOld are not NULL, they are updated.
+   */
+  template<typename VecType>
+  void InsertPoint(const VecType& point,
+                   std::vector<size_t>* oldFromNew,
+                   std::vector<size_t>* newFromOld,
+                   const size_t maxLeafSize);
+
+  /**
+   * Remove the point in the given column from the tree.  If oldFromNew and
+   * newFromOld are not NULL, they are updated.
+   */
+  void DeletePoint(const size_t index,
+                   std::vector<size_t>* oldFromNew,
+                   std::vector<size_t>* newFromOld,
+                   const size_t maxLeafSize);
+
+  /**
+   * After a point was inserted into or removed from the nodes on the given
+   * path (from the root to a leaf), whose counts are already updated: rebuild
+   * the highest node that needs it, and update the parent distances and
+   * statistics along the path.
+   */
+  void UpdatePath(std::vector<BinarySpaceTree*>& path,
+                  std::vector<size_t>* oldFromNew,
+                  std::vector<size_t>* newFromOld,
+                  const size_t maxLeafSize);
+
+  //! Return whether this node should be rebuilt, given the number of points
+  //! it holds now and when it was built.
+  bool NeedsRebuild(const size_t maxLeafSize) const;
+
+  //! Delete the children of this node and split it again from scratch, keeping
+  //! its columns.  If oldFromNew and newFromOld are not NULL, they are updated.
+  void Rebuild(std::vector<size_t>* oldFromNew,
+               std::vector<size_t>* newFromOld,
+               const size_t maxLeafSize);
+
+  /**
+   * Make sure that the leaf at the end of the given path (from the root) has a
+   * free column, by spreading out the free columns of the lowest ancestor whose
+   * density is low enough, or by enlarging the dataset.  The allowed density
+   * (points per column) goes from 1 at the leaf to 1/2 at the root, so that a
+   * node only has to be spread again after a number of insertions
+   * proportional to its size.
+   */
+  void MakeRoom(const std::vector<BinarySpaceTree*>& path,
+                std::vector<size_t>* oldFromNew,
+                std::vector<size_t>* newFromOld);
+
+  //! Change the number of columns of the dataset (this must be the root), and
+  //! spread out the free columns among the leaves.
+  void Resize(const size_t newCapacity,
+              std::vector<size_t>* oldFromNew,
+              std::vector<size_t>* newFromOld);
+
+  /**
+   * Move the points of the leaves of this node so that the node takes
+   * newCapacity columns from begin, with the free columns shared among the
+   * leaves in proportion to their sizes.  The structure of the subtree is not
+   * changed.
+   */
+  void Spread(const size_t newCapacity,
+              std::vector<size_t>* oldFromNew,
+              std::vector<size_t>* newFromOld);
+
+  //! Set the begin index and capacity of this node and its descendants, giving
+  //! the leaves the capacities in the given list, in order.
+  void Layout(const size_t newBegin, const size_t*& leafCapacities);
+
+  //! Move n columns of the dataset from one position to another (the ranges
+  //! may overlap), and update oldFromNew and newFromOld if they are not NULL.
+  void MoveColumns(const size_t from,
+                   const size_t to,
+                   const size_t n,
+                   std::vector<size_t>* oldFromNew,
+                   std::vector<size_t>* newFromOld);
+
+  //! Compute the distance from the center of this node to the centers of its
+  //! children, and store it as their parent distance.
+  void UpdateChildParentDistances();
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
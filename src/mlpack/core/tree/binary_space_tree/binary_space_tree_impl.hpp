@@ -15,6 +15,7 @@
 #include "binary_space_tree.hpp"
 
 #include <mlpack/core/util/log.hpp>
+#include "../packed_bound.hpp"
 #include <queue>
 
 namespace mlpack {
@@ -39,7 +40,11 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -67,7 +72,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -101,7 +110,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -136,7 +149,11 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -164,7 +181,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -198,7 +219,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -237,7 +262,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -266,7 +295,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -300,7 +333,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -342,7 +379,11 @@ BinarySpaceTree(
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(other.builtCount),
+    capacity(other.capacity)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -397,6 +438,7 @@ operator=(const BinarySpaceTree& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
   delete dataset;
   delete left;
   delete right;
@@ -411,6 +453,8 @@ operator=(const BinarySpaceTree& other)
   parentDistance = other.ParentDistance();
   furthestDescendantDistance = other.FurthestDescendantDistance();
   minimumBoundDistance = other.MinimumBoundDistance();
+  builtCount = other.builtCount;
+  capacity = other.capacity;
   // Copy matrix, but only if we are the root.
   dataset = ((other.parent == NULL) ? new MatType(*other.dataset) : NULL);
 
@@ -469,6 +513,7 @@ operator=(BinarySpaceTree&& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
   delete dataset;
   delete left;
   delete right;
@@ -484,6 +529,10 @@ operator=(BinarySpaceTree&& other)
   furthestDescendantDistance = other.FurthestDescendantDistance();
   minimumBoundDistance = other.MinimumBoundDistance();
   dataset = other.dataset;
+  packedNodes = other.packedNodes;
+  numPackedNodes = other.numPackedNodes;
+  builtCount = other.builtCount;
+  capacity = other.capacity;
 
   other.left = NULL;
   other.right = NULL;
@@ -494,6 +543,16 @@ operator=(BinarySpaceTree&& other)
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
+  other.builtCount = 0;
+  other.capacity = 0;
+
+  // Set new parent.
+  if (left)
+    left->parent = this;
+  if (right)
+    right->parent = this;
 
   return *this;
 }
@@ -520,7 +579,11 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    packedNodes(other.packedNodes),
+    numPackedNodes(other.numPackedNodes),
+    builtCount(other.builtCount),
+    capacity(other.capacity)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -533,6 +596,10 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
+  other.builtCount = 0;
+  other.capacity = 0;
 
   // Set new parent.
   if (left)
@@ -576,6 +643,8 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
+  ReleasePackedNodes();
+
   delete left;
   delete right;
 
@@ -840,7 +909,13 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Descendant(const size_t index) const
 {
-  return (begin + index);
+  // The points are contiguous unless there are free columns between the
+  // leaves; then we have to find the leaf holding the descendant.
+  if (capacity == count || left == NULL)
+    return (begin + index);
+
+  return (index < left->count) ? left->Descendant(index) :
+      right->Descendant(index - left->count);
 }
 
 /**
@@ -868,6 +943,27 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     SplitNode(const size_t maxLeafSize,
               SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+  #ifdef HAS_OPENMP
+  // When building a large tree outside of any parallel region, open one here;
+  // the rest of the tree is then built by tasks inside of it.
+  if (parent == NULL && omp_get_level() == 0 && omp_get_max_threads() > 1 &&
+      BuildChildrenInParallel())
+  {
+    #pragma omp parallel shared(splitter)
+    {
+      #pragma omp single
+      SplitNode(maxLeafSize, splitter);
+    }
+    return;
+  }
+  #endif
+
+  // Remember the size of the node, so that Insert() and Delete() can tell
+  // when it has changed enough to be rebuilt.  A newly split node has no
+  // free columns.
+  builtCount = count;
+  capacity = count;
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -904,24 +1000,20 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
+  // For large nodes, the children are built as concurrent tasks; they work on
+  // disjoint ranges of the dataset, so no synchronization is needed.
+  const bool parallel = BuildChildrenInParallel();
+
+  #pragma omp task if (parallel) shared(splitter)
   left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
       maxLeafSize);
+  #pragma omp task if (parallel) shared(splitter)
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = bound.Metric().Evaluate(center,
-      leftCenter);
-  const ElemType rightParentDistance = bound.Metric().Evaluate(center,
-      rightCenter);
-
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  UpdateChildParentDistances();
 }
 
 template<typename MetricType,
@@ -935,6 +1027,27 @@ SplitNode(std::vector<size_t>& oldFromNew,
           const size_t maxLeafSize,
           SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+  #ifdef HAS_OPENMP
+  // When building a large tree outside of any parallel region, open one here;
+  // the rest of the tree is then built by tasks inside of it.
+  if (parent == NULL && omp_get_level() == 0 && omp_get_max_threads() > 1 &&
+      BuildChildrenInParallel())
+  {
+    #pragma omp parallel shared(oldFromNew, splitter)
+    {
+      #pragma omp single
+      SplitNode(oldFromNew, maxLeafSize, splitter);
+    }
+    return;
+  }
+  #endif
+
+  // Remember the size of the node, so that Insert() and Delete() can tell
+  // when it has changed enough to be rebuilt.  A newly split node has no
+  // free columns.
+  builtCount = count;
+  capacity = count;
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -972,24 +1085,21 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
+  // For large nodes, the children are built as concurrent tasks; they work on
+  // disjoint ranges of the dataset and of oldFromNew, so no synchronization is
+  // needed.
+  const bool parallel = BuildChildrenInParallel();
+
+  #pragma omp task if (parallel) shared(oldFromNew, splitter)
   left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
       splitter, maxLeafSize);
+  #pragma omp task if (parallel) shared(oldFromNew, splitter)
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       oldFromNew, splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = bound.Metric().Evaluate(center,
-      leftCenter);
-  const ElemType rightParentDistance = bound.Metric().Evaluate(center,
-      rightCenter);
-
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  UpdateChildParentDistances();
 }
 
 template<typename MetricType,
@@ -1003,7 +1113,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 UpdateBound(BoundType2& boundToUpdate)
 {
   if (count > 0)
-    boundToUpdate |= dataset->cols(begin, begin + count - 1);
+    split::BlockedBound(boundToUpdate, *dataset, begin, count);
 }
 
 template<typename MetricType,
@@ -1032,6 +1142,712 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BuildChildrenInParallel() const
+{
+  // The hollow ball bound of a right child depends on the bound of the left
+  // child, so those children can't be built at the same time.
+  return SplitTraits<Split>::SupportsParallelBuild &&
+      !std::is_same<BoundType<MetricType>,
+                    bound::HollowBallBound<MetricType>>::value &&
+      (count >= 2 * split::ParallelBlockSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Pack()
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::Pack(): only the root of a "
+        "tree can be packed");
+  }
+
+  if (packedNodes != NULL)
+    return; // Already packed.
+
+  // Collect all nodes other than the root in breadth-first order.
+  std::vector<BinarySpaceTree*> nodes;
+  if (left)
+    nodes.push_back(left);
+  if (right)
+    nodes.push_back(right);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (nodes[i]->left)
+      nodes.push_back(nodes[i]->left);
+    if (nodes[i]->right)
+      nodes.push_back(nodes[i]->right);
+  }
+
+  if (nodes.empty())
+    return;
+
+  // The ranges of the bounds (if they can be packed) are stored in the same
+  // allocation, after the nodes.
+  const size_t alignment = alignof(std::max_align_t);
+  const size_t boundOffset = ((nodes.size() * sizeof(BinarySpaceTree) +
+      alignment - 1) / alignment) * alignment;
+  size_t boundBytes = 0;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    boundBytes += PackedBoundBytes(nodes[i]->bound);
+
+  char* memory = static_cast<char*>(::operator new(boundOffset + boundBytes));
+  BinarySpaceTree* newNodes = reinterpret_cast<BinarySpaceTree*>(memory);
+  char* boundMemory = memory + boundOffset;
+
+  // Move each node into the array.  The parent of each node is moved before
+  // the node itself, and the move constructor has already pointed the node's
+  // parent pointer to the new location of the parent; so we only need to
+  // point the parent's child pointer to the new location of the node.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    BinarySpaceTree* oldNode = nodes[i];
+    BinarySpaceTree* newNode = new (newNodes + i)
+        BinarySpaceTree(std::move(*oldNode));
+    if (newNode->parent->left == oldNode)
+      newNode->parent->left = newNode;
+    else
+      newNode->parent->right = newNode;
+
+    PackBound(newNode->bound, boundMemory);
+
+    // The old node is now empty, so deleting it does not touch anything else.
+    delete oldNode;
+  }
+
+  packedNodes = newNodes;
+  numPackedNodes = nodes.size();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Unpack()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // The array is in breadth-first order, so, as in Pack(), the parent of each
+  // node has already been moved out when the node itself is moved.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+  {
+    BinarySpaceTree* oldNode = packedNodes + i;
+    BinarySpaceTree* newNode = new BinarySpaceTree(std::move(*oldNode));
+    if (newNode->parent->left == oldNode)
+      newNode->parent->left = newNode;
+    else
+      newNode->parent->right = newNode;
+
+    UnpackBound(newNode->bound);
+  }
+
+  // The nodes left in the array are empty now.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~BinarySpaceTree();
+
+  ::operator delete(packedNodes);
+
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ReleasePackedNodes()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // No node in the array owns its children, so clear all child pointers before
+  // destroying the nodes in place.  (The packed bounds do not free their
+  // ranges, which are part of the same allocation.)
+  for (size_t i = 0; i < numPackedNodes; ++i)
+  {
+    packedNodes[i].left = NULL;
+    packedNodes[i].right = NULL;
+  }
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~BinarySpaceTree();
+
+  ::operator delete(packedNodes);
+
+  left = NULL;
+  right = NULL;
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Insert(const VecType& point,
+       const size_t maxLeafSize,
+       typename std::enable_if_t<IsVector<VecType>::value>*)
+{
+  InsertPoint(point, NULL, NULL, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Insert(const VecType& point,
+       std::vector<size_t>& oldFromNew,
+       std::vector<size_t>& newFromOld,
+       const size_t maxLeafSize,
+       typename std::enable_if_t<IsVector<VecType>::value>*)
+{
+  InsertPoint(point, &oldFromNew, &newFromOld, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Delete(const size_t index, const size_t maxLeafSize)
+{
+  DeletePoint(index, NULL, NULL, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Delete(const size_t index,
+       std::vector<size_t>& oldFromNew,
+       std::vector<size_t>& newFromOld,
+       const size_t maxLeafSize)
+{
+  DeletePoint(index, &oldFromNew, &newFromOld, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Compact()
+{
+  CheckModifiable("Compact");
+  Unpack();
+  Resize(count, NULL, NULL);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Compact(std::vector<size_t>& oldFromNew, std::vector<size_t>& newFromOld)
+{
+  CheckModifiable("Compact");
+  Unpack();
+  Resize(count, &oldFromNew, &newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CheckModifiable(const char* function) const
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument(std::string("BinarySpaceTree::") + function +
+        "(): only the root of a tree can be modified");
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+InsertPoint(const VecType& point,
+            std::vector<size_t>* oldFromNew,
+            std::vector<size_t>* newFromOld,
+            const size_t maxLeafSize)
+{
+  static_assert(SplitTraits<Split>::SupportsIncrementalUpdates,
+      "BinarySpaceTree::Insert(): the split type does not support incremental "
+      "updates");
+
+  CheckModifiable("Insert");
+  if (point.n_elem != dataset->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "BinarySpaceTree::Insert(): dimensionality of point ("
+        << point.n_elem << ") does not match dimensionality of tree ("
+        << dataset->n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The nodes are modified in place, so they can't stay packed.
+  Unpack();
+
+  // Find the leaf whose bound is closest to the point; if the point is inside
+  // (or equally close to) both children, take the smaller one.
+  std::vector<BinarySpaceTree*> path(1, this);
+  while (!path.back()->IsLeaf())
+  {
+    BinarySpaceTree* node = path.back();
+    const ElemType leftDistance = node->left->bound.MinDistance(point);
+    const ElemType rightDistance = node->right->bound.MinDistance(point);
+    if (leftDistance < rightDistance || (leftDistance == rightDistance &&
+        node->left->count <= node->right->count))
+      path.push_back(node->left);
+    else
+      path.push_back(node->right);
+  }
+
+  // Write the point into the first free column of the leaf.  It gets the next
+  // unused old index.
+  BinarySpaceTree* leaf = path.back();
+  if (leaf->count == leaf->capacity)
+    MakeRoom(path, oldFromNew, newFromOld);
+
+  const size_t index = leaf->begin + leaf->count;
+  dataset->col(index) = point;
+  if (oldFromNew)
+  {
+    (*oldFromNew)[index] = newFromOld->size();
+    newFromOld->push_back(index);
+  }
+
+  // Expand the bounds of all nodes that now hold the point.
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    ++path[i]->count;
+    path[i]->bound |= dataset->cols(index, index);
+    path[i]->furthestDescendantDistance = 0.5 * path[i]->bound.Diameter();
+  }
+
+  UpdatePath(path, oldFromNew, newFromOld, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeletePoint(const size_t index,
+            std::vector<size_t>* oldFromNew,
+            std::vector<size_t>* newFromOld,
+            const size_t maxLeafSize)
+{
+  static_assert(SplitTraits<Split>::SupportsIncrementalUpdates,
+      "BinarySpaceTree::Delete(): the split type does not support incremental "
+      "updates");
+
+  CheckModifiable("Delete");
+  if (index >= capacity)
+  {
+    std::ostringstream oss;
+    oss << "BinarySpaceTree::Delete(): index " << index << " is out of bounds "
+        << "for a dataset with " << capacity << " columns";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The nodes are modified in place, so they can't stay packed.
+  Unpack();
+
+  // Find the leaf whose columns contain the index.
+  std::vector<BinarySpaceTree*> path(1, this);
+  while (!path.back()->IsLeaf())
+  {
+    BinarySpaceTree* node = path.back();
+    if (index < node->right->begin)
+      path.push_back(node->left);
+    else
+      path.push_back(node->right);
+  }
+
+  BinarySpaceTree* leaf = path.back();
+  if (index >= leaf->begin + leaf->count)
+  {
+    std::ostringstream oss;
+    oss << "BinarySpaceTree::Delete(): column " << index << " does not hold a "
+        << "point";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Fill the hole with the last point of the leaf, so that no other point
+  // moves.
+  const size_t last = leaf->begin + leaf->count - 1;
+  if (oldFromNew)
+    (*newFromOld)[(*oldFromNew)[index]] = SIZE_MAX;
+  MoveColumns(last, index, 1, oldFromNew, newFromOld);
+  if (oldFromNew)
+    (*oldFromNew)[last] = SIZE_MAX;
+
+  // The bounds are not tightened: they still contain all remaining points, and
+  // they are recomputed if the node is rebuilt.
+  for (size_t i = 0; i < path.size(); ++i)
+    --path[i]->count;
+
+  UpdatePath(path, oldFromNew, newFromOld, maxLeafSize);
+
+  // Give memory back once the dataset is mostly empty; halving the number of
+  // columns keeps the cost of this amortized constant, like for growing.
+  if (4 * count < capacity)
+    Resize(2 * count, oldFromNew, newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+UpdatePath(std::vector<BinarySpaceTree*>& path,
+           std::vector<size_t>* oldFromNew,
+           std::vector<size_t>* newFromOld,
+           const size_t maxLeafSize)
+{
+  // Rebuild the highest node that needs it.  Everything below it is then new,
+  // so only its ancestors are left to update.
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    if (path[i]->NeedsRebuild(maxLeafSize))
+    {
+      path[i]->Rebuild(oldFromNew, newFromOld, maxLeafSize);
+      path.resize(i);
+      break;
+    }
+  }
+
+  // The bounds along the path may have changed, so update the parent distances
+  // and the statistics from the bottom up.
+  for (size_t i = path.size(); i > 0; --i)
+  {
+    BinarySpaceTree* node = path[i - 1];
+    if (!node->IsLeaf())
+      node->UpdateChildParentDistances();
+    node->stat = StatisticType(*node);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+NeedsRebuild(const size_t maxLeafSize) const
+{
+  // A leaf is split when it becomes too large, unless it was already too large
+  // when it was built (because its points could not be split); then we wait
+  // until it has doubled in size before trying again.
+  if (IsLeaf())
+  {
+    return (count > maxLeafSize) &&
+        (builtCount <= maxLeafSize || count > 2 * builtCount);
+  }
+
+  // Any other node is rebuilt when its size has changed by more than a factor
+  // of two since it was built, or when one of its children is empty.  This
+  // keeps the tree balanced and its bounds reasonably tight, and since a node
+  // of size n is only rebuilt after O(n) changes below it, the amortized cost
+  // of the rebuilds is O(log n) per change.
+  return (count > 2 * builtCount) || (2 * count < builtCount) ||
+      (left->count == 0) || (right->count == 0);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Rebuild(std::vector<size_t>* oldFromNew,
+        std::vector<size_t>* newFromOld,
+        const size_t maxLeafSize)
+{
+  // Gather the points at the start of the columns of the node, so that it can
+  // be split like a new node, and hand the free columns back afterwards.
+  const size_t oldCapacity = capacity;
+  Spread(count, oldFromNew, newFromOld);
+
+  delete left;
+  delete right;
+  left = NULL;
+  right = NULL;
+
+  bound = BoundType<MetricType>(dataset->n_rows);
+
+  SplitType<BoundType<MetricType>, MatType> splitter;
+  if (oldFromNew)
+  {
+    SplitNode(*oldFromNew, maxLeafSize, splitter);
+    for (size_t i = begin; i < begin + count; ++i)
+      (*newFromOld)[(*oldFromNew)[i]] = i;
+  }
+  else
+  {
+    SplitNode(maxLeafSize, splitter);
+  }
+
+  Spread(oldCapacity, oldFromNew, newFromOld);
+
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+MakeRoom(const std::vector<BinarySpaceTree*>& path,
+         std::vector<size_t>* oldFromNew,
+         std::vector<size_t>* newFromOld)
+{
+  // Find the lowest ancestor of the leaf that would still be sparse enough
+  // with one more point, and spread out its free columns.  The allowed density
+  // of the node at depth i is (depth + i) / (2 * depth).
+  const BinarySpaceTree* leaf = path.back();
+  const size_t depth = path.size() - 1;
+  for (size_t i = depth; i > 0; --i)
+  {
+    BinarySpaceTree* node = path[i - 1];
+    if (2 * depth * (node->count + 1) <= (depth + i - 1) * node->capacity)
+    {
+      node->Spread(node->capacity, oldFromNew, newFromOld);
+      if (leaf->count < leaf->capacity)
+        return;
+    }
+  }
+
+  // The whole tree is too dense, so the dataset is enlarged.
+  Resize(2 * (count + 1), oldFromNew, newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Resize(const size_t newCapacity,
+       std::vector<size_t>* oldFromNew,
+       std::vector<size_t>* newFromOld)
+{
+  // When shrinking, the points must be moved out of the way first; when
+  // growing, the new columns must exist before points are moved into them.
+  const bool shrink = (newCapacity < capacity);
+  if (shrink)
+    Spread(newCapacity, oldFromNew, newFromOld);
+
+  dataset->resize(dataset->n_rows, newCapacity);
+  if (oldFromNew)
+    oldFromNew->resize(newCapacity, SIZE_MAX);
+
+  if (!shrink)
+    Spread(newCapacity, oldFromNew, newFromOld);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Spread(const size_t newCapacity,
+       std::vector<size_t>* oldFromNew,
+       std::vector<size_t>* newFromOld)
+{
+  // Collect the leaves, from left to right.
+  std::vector<BinarySpaceTree*> leaves;
+  std::stack<BinarySpaceTree*> stack;
+  stack.push(this);
+  while (!stack.empty())
+  {
+    BinarySpaceTree* node = stack.top();
+    stack.pop();
+    if (node->IsLeaf())
+    {
+      leaves.push_back(node);
+    }
+    else
+    {
+      stack.push(node->right);
+      stack.push(node->left);
+    }
+  }
+
+  // Share the free columns among the leaves in proportion to their sizes (plus
+  // one, so that empty leaves get some too), rounding the cumulative shares so
+  // that they add up exactly.
+  const size_t freeColumns = newCapacity - count;
+  const double share = (double) freeColumns / (count + leaves.size());
+  std::vector<size_t> leafCapacities(leaves.size());
+  size_t weight = 0;
+  size_t assigned = 0;
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    weight += leaves[i]->count + 1;
+    const size_t cumulative = (i + 1 == leaves.size()) ? freeColumns :
+        std::min(freeColumns, (size_t) (share * weight));
+    leafCapacities[i] = leaves[i]->count + (cumulative - assigned);
+    assigned = cumulative;
+  }
+
+  // Pack the points to the left, so that no point is overwritten when they are
+  // moved to their new positions from right to left below.
+  std::vector<size_t> packedBegins(leaves.size());
+  size_t packedEnd = begin;
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    MoveColumns(leaves[i]->begin, packedEnd, leaves[i]->count, oldFromNew,
+        newFromOld);
+    packedBegins[i] = packedEnd;
+    packedEnd += leaves[i]->count;
+  }
+
+  const size_t* leafCapacity = leafCapacities.data();
+  Layout(begin, leafCapacity);
+
+  for (size_t i = leaves.size(); i > 0; --i)
+  {
+    BinarySpaceTree* leaf = leaves[i - 1];
+    MoveColumns(packedBegins[i - 1], leaf->begin, leaf->count, oldFromNew,
+        newFromOld);
+    if (oldFromNew)
+    {
+      for (size_t j = leaf->begin + leaf->count;
+           j < leaf->begin + leaf->capacity; ++j)
+        (*oldFromNew)[j] = SIZE_MAX;
+    }
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Layout(const size_t newBegin, const size_t*& leafCapacities)
+{
+  begin = newBegin;
+  if (IsLeaf())
+  {
+    capacity = *leafCapacities++;
+    return;
+  }
+
+  left->Layout(newBegin, leafCapacities);
+  right->Layout(newBegin + left->capacity, leafCapacities);
+  capacity = left->capacity + right->capacity;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+MoveColumns(const size_t from,
+            const size_t to,
+            const size_t n,
+            std::vector<size_t>* oldFromNew,
+            std::vector<size_t>* newFromOld)
+{
+  if (from == to)
+    return;
+
+  // Copy in the direction that does not overwrite columns still to be moved.
+  for (size_t k = 0; k < n; ++k)
+  {
+    const size_t j = (to < from) ? k : n - 1 - k;
+    dataset->col(to + j) = dataset->col(from + j);
+    if (oldFromNew)
+    {
+      (*oldFromNew)[to + j] = (*oldFromNew)[from + j];
+      (*newFromOld)[(*oldFromNew)[to + j]] = to + j;
+    }
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+UpdateChildParentDistances()
+{
+  arma::Col<ElemType> center, leftCenter, rightCenter;
+  Center(center);
+  left->Center(leftCenter);
+  right->Center(rightCenter);
+
+  const ElemType leftParentDistance = bound.Metric().Evaluate(center,
+      leftCenter);
+  const ElemType rightParentDistance = bound.Metric().Evaluate(center,
+      rightCenter);
+
+  left->ParentDistance() = leftParentDistance;
+  right->ParentDistance() = rightParentDistance;
+}
+
 // Default constructor (private), for cereal.
 template<typename MetricType,
          typename StatisticType,
@@ -1049,7 +1865,11 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    packedNodes(NULL),
+    numPackedNodes(0),
+    builtCount(0),
+    capacity(0)
 {
   // Nothing to do.
 }
@@ -1070,6 +1890,8 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (cereal::is_loading<Archive>())
   {
+    ReleasePackedNodes();
+
     if (left)
       delete left;
     if (right)
@@ -1114,24 +1936,37 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
       left->parent = this;
     if (right)
       right->parent = this;
+
+    builtCount = count;
   }
-  // If we are the root, we need to restore the dataset pointer throughout
+  // If we are the root, we need to restore the dataset pointer throughout.
+  // When loading, the capacities are recovered too: the root spans the whole
+  // dataset, and the columns of each node are split between its children at
+  // the begin index of the right child.
   if (!hasParent)
   {
+    if (cereal::is_loading<Archive>())
+      capacity = dataset->n_cols;
+
     std::stack<BinarySpaceTree*> stack;
-    if (left)
-      stack.push(left);
-    if (right)
-      stack.push(right);
+    stack.push(this);
     while (!stack.empty())
     {
       BinarySpaceTree* node = stack.top();
       stack.pop();
       node->dataset = dataset;
       if (node->left)
+      {
+        if (cereal::is_loading<Archive>())
+        {
+          node->left->capacity = node->right->begin - node->begin;
+          node->right->capacity = node->begin + node->capacity -
+              node->right->begin;
+        }
+
         stack.push(node->left);
-      if (node->right)
-       stack.push(node->right);
+        stack.push(node->right);
+      }
     }
   }
 }
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_MEAN_SPLIT_IMPL_HPP
 
 #include "mean_split.hpp"
+#include "parallel_build.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -46,20 +47,10 @@ bool MeanSplit<BoundType, MatType>::SplitNode(const BoundType& bound,
   }
   else
   {
-    // We must individually calculate bounding boxes.
-    math::Range* ranges = new math::Range[data.n_rows];
-    for (size_t i = begin; i < begin + count; ++i)
-    {
-      // Expand each dimension as necessary.
-      for (size_t d = 0; d < data.n_rows; ++d)
-      {
-        const double val = data(d, i);
-        if (val < ranges[d].Lo())
-          ranges[d].Lo() = val;
-        if (val > ranges[d].Hi())
-          ranges[d].Hi() = val;
-      }
-    }
+    // We must individually calculate bounding boxes.  For large nodes, this
+    // is done in parallel blocks.
+    std::vector<math::Range> ranges;
+    split::BlockedRanges(data, begin, count, ranges);
 
     // Now, which is the widest?
     for (size_t d = 0; d < data.n_rows; d++)
@@ -71,17 +62,15 @@ bool MeanSplit<BoundType, MatType>::SplitNode(const BoundType& bound,
         splitInfo.splitDimension = d;
       }
     }
-
-    delete[] ranges;
   }
 
   if (maxWidth == 0) // All these points are the same.  We can't split.
     return false;
 
-  // Split in the mean of that dimension.
-  splitInfo.splitVal = 0.0;
-  for (size_t i = begin; i < begin + count; ++i)
-    splitInfo.splitVal += data(splitInfo.splitDimension, i);
+  // Split in the mean of that dimension.  The sum is computed in fixed-size
+  // blocks, so the split value does not depend on the number of threads.
+  splitInfo.splitVal = split::BlockedSum(data, splitInfo.splitDimension, begin,
+      count);
   splitInfo.splitVal /= count;
 
   Log::Assert(splitInfo.splitVal >= bound[splitInfo.splitDimension].Lo());
@@ -16,6 +16,7 @@
 
 #include "midpoint_split.hpp"
 #include <mlpack/core/tree/bounds.hpp>
+#include "parallel_build.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -50,20 +51,10 @@ bool MidpointSplit<BoundType, MatType>::SplitNode(const BoundType& bound,
   }
   else
   {
-    // We must individually calculate bounding boxes.
-    math::Range* ranges = new math::Range[data.n_rows];
-    for (size_t i = begin; i < begin + count; ++i)
-    {
-      // Expand each dimension as necessary.
-      for (size_t d = 0; d < data.n_rows; ++d)
-      {
-        const double val = data(d, i);
-        if (val < ranges[d].Lo())
-          ranges[d].Lo() = val;
-        if (val > ranges[d].Hi())
-          ranges[d].Hi() = val;
-      }
-    }
+    // We must individually calculate bounding boxes.  For large nodes, this
+    // is done in parallel blocks.
+    std::vector<math::Range> ranges;
+    split::BlockedRanges(data, begin, count, ranges);
 
     // Now, which is the widest?
     for (size_t d = 0; d < data.n_rows; d++)
@@ -77,8 +68,6 @@ bool MidpointSplit<BoundType, MatType>::SplitNode(const BoundType& bound,
         splitInfo.splitVal = ranges[d].Mid();
       }
     }
-
-    delete[] ranges;
   }
 
   if (maxWidth <= 0) // All these points are the same.  We can't split.
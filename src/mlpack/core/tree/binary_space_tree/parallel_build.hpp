@@ -0,0 +1,263 @@
+/**
+ * @file core/tree/binary_space_tree/parallel_build.hpp
+ *
+ * Utilities for building a BinarySpaceTree in parallel with OpenMP tasks.  The
+ * SplitTraits class marks the split types whose children may be built
+ * concurrently (and those that allow the tree to be modified after it is
+ * built), and the blocked reductions compute per-node quantities over
+ * fixed-size blocks of points, so that the result (and therefore the tree and
+ * the oldFromNew mapping) is the same no matter how many threads are used.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_BUILD_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_PARALLEL_BUILD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+#include <mlpack/core/tree/hrectbound.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+// Forward declarations of the deterministic split types.
+template<typename BoundType, typename MatType> class MidpointSplit;
+template<typename BoundType, typename MatType> class MeanSplit;
+template<typename BoundType, typename MatType> class UBTreeSplit;
+
+/**
+ * The SplitTraits class provides compile-time information about a split type
+ * of the BinarySpaceTree.  By default, a split type is assumed not to support
+ * parallel tree building.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if SplitNode() and PerformSplit() can be called concurrently
+   * on disjoint ranges of points with the same splitter object, and if they
+   * are deterministic.  In that case the two children of a node can be built
+   * as concurrent tasks, and the tree is identical to the serially built tree.
+   * Split types that use the random number generator (like the random
+   * projection and vantage point splits) or that keep state between calls
+   * (like the UB tree split) must leave this false.
+   */
+  static const bool SupportsParallelBuild = false;
+
+  /**
+   * This is true if any node of a built tree can be split again on its own,
+   * with a new splitter object.  This is needed by BinarySpaceTree::Insert()
+   * and BinarySpaceTree::Delete(), which rebuild parts of the tree.  Split
+   * types that need to see the whole dataset at the root (like the UB tree
+   * split) must set this to false.
+   */
+  static const bool SupportsIncrementalUpdates = true;
+};
+
+//! The midpoint split is deterministic and does not hold any state.
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool SupportsParallelBuild = true;
+  static const bool SupportsIncrementalUpdates = true;
+};
+
+//! The mean split is deterministic and does not hold any state.
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool SupportsParallelBuild = true;
+  static const bool SupportsIncrementalUpdates = true;
+};
+
+//! The UB tree split computes the addresses of all points at the root.
+template<typename BoundType, typename MatType>
+class SplitTraits<UBTreeSplit<BoundType, MatType>>
+{
+ public:
+  static const bool SupportsParallelBuild = false;
+  static const bool SupportsIncrementalUpdates = false;
+};
+
+namespace split {
+
+/**
+ * The number of points in each block of the blocked reductions.  Nodes with
+ * fewer points than this are processed exactly as before, in a single block.
+ * Nodes with at least twice this many points build their children as separate
+ * tasks.
+ */
+const size_t ParallelBlockSize = 16384;
+
+/**
+ * Compute the range of the given points in each dimension.  The points are
+ * split into blocks of ParallelBlockSize points, and each block is handled by
+ * a separate OpenMP task (if called inside of a parallel region).  Since
+ * minimum and maximum are exact, the result is the same as a serial pass.
+ *
+ * @param data Dataset.
+ * @param begin Index of the first point to consider.
+ * @param count Number of points to consider.
+ * @param ranges Vector to store the range of each dimension in.
+ */
+template<typename MatType>
+void BlockedRanges(const MatType& data,
+                   const size_t begin,
+                   const size_t count,
+                   std::vector<math::Range>& ranges)
+{
+  const size_t numBlocks = std::max((size_t) 1,
+      (count + ParallelBlockSize - 1) / ParallelBlockSize);
+  std::vector<std::vector<math::Range>> blockRanges(numBlocks,
+      std::vector<math::Range>(data.n_rows));
+
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    #pragma omp task if (numBlocks > 1) firstprivate(b) \
+        shared(data, blockRanges)
+    {
+      std::vector<math::Range>& r = blockRanges[b];
+      const size_t blockBegin = begin + b * ParallelBlockSize;
+      const size_t blockEnd = std::min(blockBegin + ParallelBlockSize,
+          begin + count);
+      for (size_t i = blockBegin; i < blockEnd; ++i)
+      {
+        for (size_t d = 0; d < data.n_rows; ++d)
+        {
+          const double val = data(d, i);
+          if (val < r[d].Lo())
+            r[d].Lo() = val;
+          if (val > r[d].Hi())
+            r[d].Hi() = val;
+        }
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  ranges = std::move(blockRanges[0]);
+  for (size_t b = 1; b < numBlocks; ++b)
+    for (size_t d = 0; d < data.n_rows; ++d)
+      ranges[d] |= blockRanges[b][d];
+}
+
+/**
+ * Compute the sum of the given points in one dimension.  The points are split
+ * into blocks of ParallelBlockSize points, each block is summed by a separate
+ * OpenMP task (if called inside of a parallel region), and the block sums are
+ * then added in order.  The result therefore does not depend on the number of
+ * threads; for fewer than ParallelBlockSize points it is the plain sequential
+ * sum.
+ *
+ * @param data Dataset.
+ * @param dimension Dimension to sum.
+ * @param begin Index of the first point to consider.
+ * @param count Number of points to consider.
+ */
+template<typename MatType>
+double BlockedSum(const MatType& data,
+                  const size_t dimension,
+                  const size_t begin,
+                  const size_t count)
+{
+  const size_t numBlocks = std::max((size_t) 1,
+      (count + ParallelBlockSize - 1) / ParallelBlockSize);
+  std::vector<double> blockSums(numBlocks, 0.0);
+
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    #pragma omp task if (numBlocks > 1) firstprivate(b) \
+        shared(data, blockSums)
+    {
+      const size_t blockBegin = begin + b * ParallelBlockSize;
+      const size_t blockEnd = std::min(blockBegin + ParallelBlockSize,
+          begin + count);
+      double sum = 0.0;
+      for (size_t i = blockBegin; i < blockEnd; ++i)
+        sum += data(dimension, i);
+      blockSums[b] = sum;
+    }
+  }
+  #pragma omp taskwait
+
+  double sum = 0.0;
+  for (size_t b = 0; b < numBlocks; ++b)
+    sum += blockSums[b];
+
+  return sum;
+}
+
+/**
+ * Expand the given bound to include the given points.  In general, bounds can
+ * only be expanded with all the points at once, since the result may depend on
+ * the order of the points (like for BallBound).
+ *
+ * @param bound Bound to expand.
+ * @param data Dataset.
+ * @param begin Index of the first point to include.
+ * @param count Number of points to include (must be positive).
+ */
+template<typename BoundType, typename MatType>
+void BlockedBound(BoundType& bound,
+                  const MatType& data,
+                  const size_t begin,
+                  const size_t count)
+{
+  bound |= data.cols(begin, begin + count - 1);
+}
+
+/**
+ * Expand the given HRectBound to include the given points.  The bound of each
+ * block of ParallelBlockSize points is computed by a separate OpenMP task (if
+ * called inside of a parallel region), and the block bounds are then combined.
+ * Since a hyperrectangle bound only depends on the minimum and maximum in each
+ * dimension, the result is the same as a serial pass.
+ *
+ * @param bound Bound to expand.
+ * @param data Dataset.
+ * @param begin Index of the first point to include.
+ * @param count Number of points to include (must be positive).
+ */
+template<typename MetricType, typename ElemType, typename MatType>
+void BlockedBound(bound::HRectBound<MetricType, ElemType>& bound,
+                  const MatType& data,
+                  const size_t begin,
+                  const size_t count)
+{
+  const size_t numBlocks = (count + ParallelBlockSize - 1) / ParallelBlockSize;
+  if (numBlocks <= 1)
+  {
+    bound |= data.cols(begin, begin + count - 1);
+    return;
+  }
+
+  std::vector<bound::HRectBound<MetricType, ElemType>> blockBounds(numBlocks,
+      bound::HRectBound<MetricType, ElemType>(data.n_rows));
+
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    #pragma omp task firstprivate(b) shared(data, blockBounds)
+    {
+      const size_t blockBegin = begin + b * ParallelBlockSize;
+      const size_t blockEnd = std::min(blockBegin + ParallelBlockSize,
+          begin + count);
+      blockBounds[b] |= data.cols(blockBegin, blockEnd - 1);
+    }
+  }
+  #pragma omp taskwait
+
+  for (size_t b = 0; b < numBlocks; ++b)
+    bound |= blockBounds[b];
+}
+
+} // namespace split
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -433,6 +433,30 @@ class CoverTree
   //! Get the instantiated metric.
   MetricType& Metric() const { return *metric; }
 
+  /**
+   * Move all nodes of the tree other than the root into one contiguous array,
+   * in breadth-first order.  This does not change the structure of the tree or
+   * any results computed with it, but nodes that are close to each other in
+   * the tree are then also close in memory, which reduces cache misses during
+   * traversals of large trees.  (The children of each node are still listed in
+   * a std::vector of pointers.)  Pointers and references to nodes other than
+   * the root are invalidated.  Copies of a packed tree are not packed.
+   *
+   * This can only be called on the root of the tree; otherwise, a
+   * std::invalid_argument exception is thrown.
+   */
+  void Pack();
+
+  /**
+   * Move the nodes of a tree that was packed with Pack() back into separate
+   * allocations.  Pointers and references to nodes other than the root are
+   * invalidated.  This does nothing if the tree is not packed.
+   */
+  void Unpack();
+
+  //! Return whether the nodes of the tree have been packed with Pack().
+  bool IsPacked() const { return packedNodes != NULL; }
+
  private:
   //! Reference to the matrix which this tree is built on.
   const MatType* dataset;
@@ -470,11 +494,67 @@ class CoverTree
                       size_t& farSetSize,
                       size_t& usedSetSize);
 
+  /**
+   * Create the children of a node with a large near set.  The near set is
+   * first split into groups, in order: the self child takes every point within
+   * the bound of this node's point, and then the first point that is not yet
+   * in a group becomes a new child that takes every remaining point within the
+   * bound of it.  Because every group only holds its own points, the subtrees
+   * of the children are then built concurrently as OpenMP tasks.  The far set
+   * is not absorbed by the children; it is handed back to the parent.  The
+   * grouping does not depend on the number of threads, so neither does the
+   * tree.
+   *
+   * @param indices Indices of the points in [ near | far | used ] order.
+   * @param distances Distances of the points to this node's point.
+   * @param nearSetSize Number of points in the near set.
+   * @param farSetSize Number of points in the far set.
+   * @param usedSetSize Number of points in the used set; the near set is added.
+   * @param nextScale Scale of the children.
+   * @param bound Covering radius of the children.
+   */
+  void CreateChildrenBatch(arma::Col<size_t>& indices,
+                           arma::vec& distances,
+                           const size_t nearSetSize,
+                           const size_t farSetSize,
+                           size_t& usedSetSize,
+                           const int nextScale,
+                           const ElemType bound);
+
+  /**
+   * Build one child for each of the given groups, as concurrent OpenMP tasks.
+   * The children are stored in newChildren in the order of the groups.
+   *
+   * @param centers Point of each child.
+   * @param parentDistances Distance of each center to this node's point.
+   * @param groupIndices Points (other than the center) of each child.
+   * @param groupDistances Distances of the points of each child to its center.
+   * @param nextScale Scale of the children.
+   * @param newChildren Vector to store the new children in.
+   */
+  void BuildChildren(const std::vector<size_t>& centers,
+                     const std::vector<ElemType>& parentDistances,
+                     std::vector<arma::Col<size_t>>& groupIndices,
+                     std::vector<arma::vec>& groupDistances,
+                     const int nextScale,
+                     std::vector<CoverTree*>& newChildren);
+
+  //! Point sets with at least this many points have their distances computed
+  //! in parallel blocks.
+  static const size_t ParallelDistanceSize = 2048;
+
+  //! Nodes with at least this many points in their near set build their
+  //! children with CreateChildrenBatch().
+  static const size_t BatchBuildSize = 2048;
+
   /**
    * Fill the vector of distances with the distances between the point specified
    * by pointIndex and each point in the indices array.  The distances of the
    * first pointSetSize points in indices are calculated (so, this does not
-   * necessarily need to use all of the points in the arrays).
+   * necessarily need to use all of the points in the arrays).  Large point sets
+   * are split into contiguous blocks that are computed by different OpenMP
+   * threads; since every distance is computed on its own, the result does not
+   * depend on the number of threads.
    *
    * @param pointIndex Point to build the distances for.
    * @param indices List of indices to compute distances for.
@@ -529,6 +609,22 @@ class CoverTree
                       const size_t childUsedSetSize,
                       const size_t farSetSize);
 
+  /**
+   * Assuming that the list of indices and distances is sorted as
+   * [ nearSet | farSet | usedSet ], move every point that the child just built
+   * has used (the points in its childUsedSet) from the near and far sets into
+   * the used set, keeping the near set before the far set.  The sizes of the
+   * sets are updated.
+   *
+   * @param indices List of indices to sort.
+   * @param distances List of distances to sort.
+   * @param nearSetSize Number of points in the near set.
+   * @param farSetSize Number of points in the far set.
+   * @param usedSetSize Number of points in the used set.
+   * @param childIndices Indices of the child: [ childFarSet | childUsedSet ].
+   * @param childFarSetSize Number of points in the child far set.
+   * @param childUsedSetSize Number of points in the child used set.
+   */
   void MoveToUsedSet(arma::Col<size_t>& indices,
                      arma::vec& distances,
                      size_t& nearSetSize,
@@ -573,6 +669,15 @@ class CoverTree
 
  private:
   size_t distanceComps;
+  //! If the tree has been packed with Pack(), this holds all nodes other than
+  //! the root (this is only set in the root).
+  CoverTree* packedNodes;
+  //! The number of nodes in packedNodes.
+  size_t numPackedNodes;
+
+  //! Destroy the nodes held in packedNodes, if there are any, and free the
+  //! array.
+  void ReleasePackedNodes();
 };
 
 } // namespace tree
@@ -15,6 +15,7 @@
 // In case it hasn't already been included.
 #include "cover_tree.hpp"
 
+#include <algorithm>
 #include <queue>
 #include <string>
 
@@ -55,7 +56,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(metric == NULL),
     localDataset(false),
     metric(metric),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If we need to create a metric, do that.  We'll just do it on the heap.
   if (localMetric)
@@ -154,7 +157,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(true),
     localDataset(false),
     metric(new MetricType(metric)),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If there is only one point or zero points in the dataset... uh, we're done.
   // Technically, if the dataset has zero points, our node is not correct...
@@ -247,7 +252,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     furthestDescendantDistance(0),
     localMetric(true),
     localDataset(true),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // We need to create a metric.  We'll just do it on the heap.
   this->metric = new MetricType();
@@ -345,7 +352,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(true),
     localDataset(true),
     metric(new MetricType(metric)),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If there is only one point or zero points in the dataset... uh, we're done.
   // Technically, if the dataset has zero points, our node is not correct...
@@ -449,7 +458,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(false),
     localDataset(false),
     metric(&metric),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If the size of the near set is 0, this is a leaf.
   if (nearSetSize == 0)
@@ -490,7 +501,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(metric == NULL),
     localDataset(false),
     metric(metric),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If necessary, create a local metric.
   if (localMetric)
@@ -519,7 +532,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(other.localMetric),
     localDataset(other.parent == NULL && other.localDataset),
     metric((other.localMetric ? new MetricType() : other.metric)),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // Copy each child by hand.
   for (size_t i = 0; i < other.NumChildren(); ++i)
@@ -563,6 +578,8 @@ operator=(const CoverTree& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
+
   if (localDataset)
     delete dataset;
 
@@ -639,12 +656,17 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree(
     localMetric(other.localMetric),
     localDataset(other.localDataset),
     metric(other.metric),
-    distanceComps(other.distanceComps)
+    distanceComps(other.distanceComps),
+    packedNodes(other.packedNodes),
+    numPackedNodes(other.numPackedNodes)
 {
   // Set proper parent pointer.
   for (size_t i = 0; i < children.size(); ++i)
     children[i]->Parent() = this;
 
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
+
   other.dataset = NULL;
   other.point = 0;
   other.scale = INT_MIN;
@@ -673,6 +695,8 @@ operator=(CoverTree&& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
+
   if (localDataset)
     delete dataset;
 
@@ -696,11 +720,16 @@ operator=(CoverTree&& other)
   localDataset = other.localDataset;
   metric = other.metric;
   distanceComps = other.distanceComps;
+  packedNodes = other.packedNodes;
+  numPackedNodes = other.numPackedNodes;
 
   // Set proper parent pointer.
   for (size_t i = 0; i < children.size(); ++i)
     children[i]->Parent() = this;
 
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
+
   other.dataset = NULL;
   other.point = 0;
   other.scale = INT_MIN;
@@ -742,6 +771,8 @@ template<
 >
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::~CoverTree()
 {
+  ReleasePackedNodes();
+
   // Delete each child.
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -1187,6 +1218,15 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       (int) ceil(log(maxDistance) / log(base))) - 1;
   const ElemType bound = pow(base, nextScale);
 
+  // Large near sets are split into groups up front, so that the subtrees can be
+  // built concurrently.
+  if (nearSetSize >= BatchBuildSize)
+  {
+    CreateChildrenBatch(indices, distances, nearSetSize, farSetSize,
+        usedSetSize, nextScale, bound);
+    return;
+  }
+
   // First, make the self child.  We must split the given near set into the near
   // set and far set for the self child.
   size_t childNearSetSize =
@@ -1321,6 +1361,163 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
       furthestDescendantDistance = distances[i];
 }
 
+//! Create the children of a node with a large near set in groups.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    CreateChildrenBatch(arma::Col<size_t>& indices,
+                        arma::vec& distances,
+                        const size_t nearSetSize,
+                        const size_t farSetSize,
+                        size_t& usedSetSize,
+                        const int nextScale,
+                        const ElemType bound)
+{
+  std::vector<size_t> centers;
+  std::vector<ElemType> parentDistances;
+  std::vector<arma::Col<size_t>> groupIndices;
+  std::vector<arma::vec> groupDistances;
+
+  // The self child takes every point within the bound of this point; the
+  // others remain, in their original order.
+  arma::Col<size_t> remainingIndices(nearSetSize);
+  arma::vec remainingDistances(nearSetSize);
+  arma::Col<size_t> childIndices(nearSetSize);
+  arma::vec childDistances(nearSetSize);
+  size_t remainingSize = 0;
+  size_t childSize = 0;
+  for (size_t i = 0; i < nearSetSize; ++i)
+  {
+    if (distances[i] <= bound)
+    {
+      childIndices[childSize] = indices[i];
+      childDistances[childSize++] = distances[i];
+    }
+    else
+    {
+      remainingIndices[remainingSize] = indices[i];
+      remainingDistances[remainingSize++] = distances[i];
+    }
+  }
+
+  centers.push_back(point);
+  parentDistances.push_back(0);
+  groupIndices.push_back(childIndices.head(childSize));
+  groupDistances.push_back(childDistances.head(childSize));
+
+  // Each of the other children is centered at the first remaining point, and
+  // takes every remaining point within the bound of it.  The centers are then
+  // more than the bound away from each other.
+  arma::vec centerDistances(nearSetSize);
+  while (remainingSize > 0)
+  {
+    const size_t center = remainingIndices[0];
+    const ElemType parentDistance = remainingDistances[0];
+    ComputeDistances(center, remainingIndices, centerDistances, remainingSize);
+
+    size_t newRemainingSize = 0;
+    childSize = 0;
+    for (size_t i = 1; i < remainingSize; ++i)
+    {
+      if (centerDistances[i] <= bound)
+      {
+        childIndices[childSize] = remainingIndices[i];
+        childDistances[childSize++] = centerDistances[i];
+      }
+      else
+      {
+        remainingIndices[newRemainingSize] = remainingIndices[i];
+        remainingDistances[newRemainingSize++] = remainingDistances[i];
+      }
+    }
+
+    centers.push_back(center);
+    parentDistances.push_back(parentDistance);
+    groupIndices.push_back(childIndices.head(childSize));
+    groupDistances.push_back(childDistances.head(childSize));
+
+    remainingSize = newRemainingSize;
+  }
+
+  // The groups are disjoint, so the subtrees can be built at the same time.
+  std::vector<CoverTree*> newChildren(centers.size());
+  BuildChildren(centers, parentDistances, groupIndices, groupDistances,
+      nextScale, newChildren);
+
+  // Add the children in the order of the groups, so the tree does not depend
+  // on the order in which the tasks finished.
+  for (size_t i = 0; i < newChildren.size(); ++i)
+  {
+    children.push_back(newChildren[i]);
+    numDescendants += children.back()->NumDescendants();
+
+    // Remove any implicit nodes.
+    RemoveNewImplicitNodes();
+
+    distanceComps += children.back()->DistanceComps();
+  }
+
+  // Every point of the near set is a descendant now.
+  furthestDescendantDistance = max(distances.head(nearSetSize));
+
+  // The arrays look like [ near | far | used ]; the near set is used now, and
+  // the far set goes back to the parent:  [ far | near + used ].
+  SortPointSet(indices, distances, 0, nearSetSize, farSetSize);
+  usedSetSize += nearSetSize;
+}
+
+//! Build the children of a node from the given groups.
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    BuildChildren(const std::vector<size_t>& centers,
+                  const std::vector<ElemType>& parentDistances,
+                  std::vector<arma::Col<size_t>>& groupIndices,
+                  std::vector<arma::vec>& groupDistances,
+                  const int nextScale,
+                  std::vector<CoverTree*>& newChildren)
+{
+  #ifdef HAS_OPENMP
+  // When building outside of any parallel region, open one here; the rest of
+  // the tree is then built by tasks inside of it.
+  if (omp_get_level() == 0 && omp_get_max_threads() > 1)
+  {
+    #pragma omp parallel shared(centers, parentDistances, groupIndices, \
+        groupDistances, newChildren)
+    {
+      #pragma omp single
+      BuildChildren(centers, parentDistances, groupIndices, groupDistances,
+          nextScale, newChildren);
+    }
+    return;
+  }
+  #endif
+
+  for (size_t i = 0; i < centers.size(); ++i)
+  {
+    // Leaves are not worth a task of their own.
+    #pragma omp task if (groupIndices[i].n_elem > 0) firstprivate(i) \
+        shared(centers, parentDistances, groupIndices, groupDistances, \
+        newChildren)
+    {
+      size_t farSetSize = 0;
+      size_t usedSetSize = 0;
+      newChildren[i] = new CoverTree(*dataset, base, centers[i], nextScale,
+          this, parentDistances[i], groupIndices[i], groupDistances[i],
+          groupIndices[i].n_elem, farSetSize, usedSetSize, *metric);
+    }
+  }
+  #pragma omp taskwait
+}
+
 template<
     typename MetricType,
     typename StatisticType,
@@ -1392,9 +1589,13 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
                      const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  Near the top of the tree the point sets are large, so they are
+  // split into blocks that are handled by different threads.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+
+  #pragma omp parallel for schedule(static) \
+      if (pointSetSize >= ParallelDistanceSize)
+  for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
@@ -1484,126 +1685,111 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
 {
   const size_t originalSum = nearSetSize + farSetSize + usedSetSize;
 
+  // Sort the points in the child's used set, so that we can find out with a
+  // binary search whether a point was used.  (Searching the child's used set
+  // linearly for every point in the near and far sets is quadratic in the size
+  // of the sets, which dominates the construction time of large trees.)
+  std::vector<size_t> childUsedSet(childIndices.memptr() + childFarSetSize,
+      childIndices.memptr() + childFarSetSize + childUsedSetSize);
+  std::sort(childUsedSet.begin(), childUsedSet.end());
+
   // Loop across the set.  We will swap points as we need.  It should be noted
   // that farSetSize and nearSetSize may change with each iteration of this loop
   // (depending on if we make a swap or not).
-  size_t startChildUsedSet = 0; // Where to start in the child set.
-  for (size_t i = 0; i < nearSetSize; ++i)
+  size_t numFound = 0;
+  for (size_t i = 0; (i < nearSetSize) && (numFound < childUsedSetSize); ++i)
   {
     // Discover if this point was in the child's used set.
-    for (size_t j = startChildUsedSet; j < childUsedSetSize; ++j)
+    if (!std::binary_search(childUsedSet.begin(), childUsedSet.end(),
+        indices[i]))
+      continue;
+
+    // We have found a point; a swap is necessary.
+
+    // Since this point is from the near set, to preserve the near set, we must
+    // do a swap.
+    if (farSetSize > 0)
     {
-      if (childIndices[childFarSetSize + j] == indices[i])
+      if ((nearSetSize - 1) != i)
       {
-        // We have found a point; a swap is necessary.
-
-        // Since this point is from the near set, to preserve the near set, we
-        // must do a swap.
-        if (farSetSize > 0)
-        {
-          if ((nearSetSize - 1) != i)
-          {
-            // In this case it must be a three-way swap.
-            size_t tempIndex = indices[nearSetSize + farSetSize - 1];
-            ElemType tempDist = distances[nearSetSize + farSetSize - 1];
-
-            size_t tempNearIndex = indices[nearSetSize - 1];
-            ElemType tempNearDist = distances[nearSetSize - 1];
-
-            indices[nearSetSize + farSetSize - 1] = indices[i];
-            distances[nearSetSize + farSetSize - 1] = distances[i];
-
-            indices[nearSetSize - 1] = tempIndex;
-            distances[nearSetSize - 1] = tempDist;
-
-            indices[i] = tempNearIndex;
-            distances[i] = tempNearDist;
-          }
-          else
-          {
-            // We can do a two-way swap.
-            size_t tempIndex = indices[nearSetSize + farSetSize - 1];
-            ElemType tempDist = distances[nearSetSize + farSetSize - 1];
-
-            indices[nearSetSize + farSetSize - 1] = indices[i];
-            distances[nearSetSize + farSetSize - 1] = distances[i];
-
-            indices[i] = tempIndex;
-            distances[i] = tempDist;
-          }
-        }
-        else if ((nearSetSize - 1) != i)
-        {
-          // A two-way swap is possible.
-          size_t tempIndex = indices[nearSetSize + farSetSize - 1];
-          ElemType tempDist = distances[nearSetSize + farSetSize - 1];
-
-          indices[nearSetSize + farSetSize - 1] = indices[i];
-          distances[nearSetSize + farSetSize - 1] = distances[i];
-
-          indices[i] = tempIndex;
-          distances[i] = tempDist;
-        }
-        else
-        {
-          // No swap is necessary.
-        }
-
-        // We don't need to do a complete preservation of the child index set,
-        // but we want to make sure we only loop over points we haven't seen.
-        // So increment the child counter by 1 and move a point if we need.
-        if (j != startChildUsedSet)
-        {
-          childIndices[childFarSetSize + j] = childIndices[childFarSetSize +
-              startChildUsedSet];
-        }
-
-        // Update all counters from the swaps we have done.
-        ++startChildUsedSet;
-        --nearSetSize;
-        --i; // Since we moved a point out of the near set we must step back.
-
-        break; // Break out of this for loop; back to the first one.
+        // In this case it must be a three-way swap.
+        size_t tempIndex = indices[nearSetSize + farSetSize - 1];
+        ElemType tempDist = distances[nearSetSize + farSetSize - 1];
+
+        size_t tempNearIndex = indices[nearSetSize - 1];
+        ElemType tempNearDist = distances[nearSetSize - 1];
+
+        indices[nearSetSize + farSetSize - 1] = indices[i];
+        distances[nearSetSize + farSetSize - 1] = distances[i];
+
+        indices[nearSetSize - 1] = tempIndex;
+        distances[nearSetSize - 1] = tempDist;
+
+        indices[i] = tempNearIndex;
+        distances[i] = tempNearDist;
+      }
+      else
+      {
+        // We can do a two-way swap.
+        size_t tempIndex = indices[nearSetSize + farSetSize - 1];
+        ElemType tempDist = distances[nearSetSize + farSetSize - 1];
+
+        indices[nearSetSize + farSetSize - 1] = indices[i];
+        distances[nearSetSize + farSetSize - 1] = distances[i];
+
+        indices[i] = tempIndex;
+        distances[i] = tempDist;
       }
     }
+    else if ((nearSetSize - 1) != i)
+    {
+      // A two-way swap is possible.
+      size_t tempIndex = indices[nearSetSize + farSetSize - 1];
+      ElemType tempDist = distances[nearSetSize + farSetSize - 1];
+
+      indices[nearSetSize + farSetSize - 1] = indices[i];
+      distances[nearSetSize + farSetSize - 1] = distances[i];
+
+      indices[i] = tempIndex;
+      distances[i] = tempDist;
+    }
+    else
+    {
+      // No swap is necessary.
+    }
+
+    // Update all counters from the swaps we have done.
+    ++numFound;
+    --nearSetSize;
+    --i; // Since we moved a point out of the near set we must step back.
   }
 
   // Now loop over the far set.  This loop is different because we only require
   // a normal two-way swap instead of the three-way swap to preserve the near
   // set / far set ordering.
-  for (size_t i = 0; i < farSetSize; ++i)
+  for (size_t i = 0; (i < farSetSize) && (numFound < childUsedSetSize); ++i)
   {
     // Discover if this point was in the child's used set.
-    for (size_t j = startChildUsedSet; j < childUsedSetSize; ++j)
-    {
-      if (childIndices[childFarSetSize + j] == indices[i + nearSetSize])
-      {
-        // We have found a point to swap.
+    if (!std::binary_search(childUsedSet.begin(), childUsedSet.end(),
+        indices[i + nearSetSize]))
+      continue;
 
-        // Perform the swap.
-        size_t tempIndex = indices[nearSetSize + farSetSize - 1];
-        ElemType tempDist = distances[nearSetSize + farSetSize - 1];
-
-        indices[nearSetSize + farSetSize - 1] = indices[nearSetSize + i];
-        distances[nearSetSize + farSetSize - 1] = distances[nearSetSize + i];
+    // We have found a point to swap.
 
-        indices[nearSetSize + i] = tempIndex;
-        distances[nearSetSize + i] = tempDist;
+    // Perform the swap.
+    size_t tempIndex = indices[nearSetSize + farSetSize - 1];
+    ElemType tempDist = distances[nearSetSize + farSetSize - 1];
 
-        if (j != startChildUsedSet)
-        {
-          childIndices[childFarSetSize + j] = childIndices[childFarSetSize +
-              startChildUsedSet];
-        }
+    indices[nearSetSize + farSetSize - 1] = indices[nearSetSize + i];
+    distances[nearSetSize + farSetSize - 1] = distances[nearSetSize + i];
 
-        // Update all counters from the swaps we have done.
-        ++startChildUsedSet;
-        --farSetSize;
-        --i;
+    indices[nearSetSize + i] = tempIndex;
+    distances[nearSetSize + i] = tempDist;
 
-        break; // Break out of this for loop; back to the first one.
-      }
-    }
+    // Update all counters from the swaps we have done.
+    ++numFound;
+    --farSetSize;
+    --i;
   }
 
   // Update used set size.
@@ -1690,6 +1876,111 @@ inline void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   }
 }
 
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::Pack()
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("CoverTree::Pack(): only the root of a tree "
+        "can be packed");
+  }
+
+  if (packedNodes != NULL)
+    return; // Already packed.
+
+  // Collect all nodes other than the root in breadth-first order.
+  std::vector<CoverTree*> nodes(children.begin(), children.end());
+  for (size_t i = 0; i < nodes.size(); ++i)
+    nodes.insert(nodes.end(), nodes[i]->children.begin(),
+        nodes[i]->children.end());
+
+  if (nodes.empty())
+    return;
+
+  CoverTree* newNodes = static_cast<CoverTree*>(
+      ::operator new(nodes.size() * sizeof(CoverTree)));
+
+  // Move each node into the array.  The parent of each node is moved before
+  // the node itself, and the move constructor has already pointed the node's
+  // parent pointer to the new location of the parent; so we only need to
+  // point the parent's child pointer to the new location of the node.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    CoverTree* oldNode = nodes[i];
+    CoverTree* newNode = new (newNodes + i) CoverTree(std::move(*oldNode));
+    std::vector<CoverTree*>& siblings = newNode->parent->children;
+    *std::find(siblings.begin(), siblings.end(), oldNode) = newNode;
+
+    // The old node is now empty, so deleting it does not touch anything else.
+    delete oldNode;
+  }
+
+  packedNodes = newNodes;
+  numPackedNodes = nodes.size();
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::Unpack()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // The array is in breadth-first order, so, as in Pack(), the parent of each
+  // node has already been moved out when the node itself is moved.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+  {
+    CoverTree* oldNode = packedNodes + i;
+    CoverTree* newNode = new CoverTree(std::move(*oldNode));
+    std::vector<CoverTree*>& siblings = newNode->parent->children;
+    *std::find(siblings.begin(), siblings.end(), oldNode) = newNode;
+  }
+
+  // The nodes left in the array are empty now.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~CoverTree();
+
+  ::operator delete(packedNodes);
+
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    ReleasePackedNodes()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // No node in the array owns its children, so clear all child lists before
+  // destroying the nodes in place.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].children.clear();
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~CoverTree();
+
+  ::operator delete(packedNodes);
+
+  children.clear();
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
 /**
  * Default constructor, only for use with cereal.
  */
@@ -1711,7 +2002,9 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CoverTree() :
     localMetric(false),
     localDataset(false),
     metric(NULL),
-    distanceComps(0)
+    distanceComps(0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // Nothing to do.
 }
@@ -1734,6 +2027,8 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::serialize(
   // also need to delete the local metric and dataset.
   if (cereal::is_loading<Archive>())
   {
+    ReleasePackedNodes();
+
     for (size_t i = 0; i < children.size(); ++i)
       delete children[i];
 
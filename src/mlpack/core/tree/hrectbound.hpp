@@ -17,6 +17,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/math/range.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/distance_kernels.hpp>
 #include "bound_traits.hpp"
 
 namespace mlpack {
@@ -107,6 +108,24 @@ class HRectBound
   //! Modify the minimum width of the bound.
   ElemType& MinWidth() { return minWidth; }
 
+  /**
+   * Copy the ranges of the bound into the given memory, which must have room
+   * for Dim() ranges, and use that memory from now on.  The bound does not own
+   * the memory: it is not freed by the bound, and it must outlive the bound (or
+   * a call to Unpack()).  This is used to store the bounds of all nodes of a
+   * packed tree in one array (see BinarySpaceTree::Pack()).
+   *
+   * @param memory Memory to store the ranges in.
+   */
+  void Pack(math::RangeType<ElemType>* memory);
+
+  //! Copy the ranges of a bound that was packed with Pack() back into memory
+  //! owned by the bound.
+  void Unpack();
+
+  //! Return whether the ranges are stored in memory given to Pack().
+  bool IsPacked() const { return !ownsBounds; }
+
   //! Get the instantiated metric associated with the bound.
   const MetricType& Metric() const { return metric; }
   //! Modify the instantiated metric associated with the bound.
@@ -240,6 +259,8 @@ class HRectBound
   size_t dim;
   //! The bounds for each dimension.
   math::RangeType<ElemType>* bounds;
+  //! Whether bounds is owned by the bound (it is not after Pack()).
+  bool ownsBounds;
   //! Cached minimum width of bound.
   ElemType minWidth;
   //! Instantiated metric (likely has size 0).
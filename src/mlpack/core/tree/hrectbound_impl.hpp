@@ -27,6 +27,7 @@ template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::HRectBound() :
     dim(0),
     bounds(NULL),
+    ownsBounds(true),
     minWidth(0)
 { /* Nothing to do. */ }
 
@@ -38,6 +39,7 @@ template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::HRectBound(const size_t dimension) :
     dim(dimension),
     bounds(new math::RangeType<ElemType>[dim]),
+    ownsBounds(true),
     minWidth(0)
 { /* Nothing to do. */ }
 
@@ -49,6 +51,7 @@ inline HRectBound<MetricType, ElemType>::HRectBound(
     const HRectBound<MetricType, ElemType>& other) :
     dim(other.Dim()),
     bounds(new math::RangeType<ElemType>[dim]),
+    ownsBounds(true),
     minWidth(other.MinWidth())
 {
   // Copy other bounds over.
@@ -71,11 +74,12 @@ inline HRectBound<
   if (dim != other.Dim())
   {
     // Reallocation is necessary.
-    if (bounds)
+    if (bounds && ownsBounds)
       delete[] bounds;
 
     dim = other.Dim();
     bounds = new math::RangeType<ElemType>[dim];
+    ownsBounds = true;
   }
 
   // Now copy each of the bound values.
@@ -95,11 +99,13 @@ inline HRectBound<MetricType, ElemType>::HRectBound(
     HRectBound<MetricType, ElemType>&& other) :
     dim(other.dim),
     bounds(other.bounds),
+    ownsBounds(other.ownsBounds),
     minWidth(other.minWidth)
 {
   // Fix the other bound.
   other.dim = 0;
   other.bounds = NULL;
+  other.ownsBounds = true;
   other.minWidth = 0.0;
 }
 
@@ -113,11 +119,16 @@ HRectBound<MetricType, ElemType>::operator=(
 {
   if (this != &other)
   {
+    if (bounds && ownsBounds)
+      delete[] bounds;
+
     bounds = other.bounds;
+    ownsBounds = other.ownsBounds;
     minWidth = other.minWidth;
     dim = other.dim;
     other.dim = 0;
     other.bounds = nullptr;
+    other.ownsBounds = true;
     other.minWidth = 0.0;
   }
   return *this;
@@ -129,10 +140,44 @@ HRectBound<MetricType, ElemType>::operator=(
 template<typename MetricType, typename ElemType>
 inline HRectBound<MetricType, ElemType>::~HRectBound()
 {
-  if (bounds)
+  if (bounds && ownsBounds)
     delete[] bounds;
 }
 
+/**
+ * Move the ranges into the given memory, which is not owned by the bound.
+ */
+template<typename MetricType, typename ElemType>
+inline void HRectBound<MetricType, ElemType>::Pack(
+    math::RangeType<ElemType>* memory)
+{
+  for (size_t i = 0; i < dim; ++i)
+    new (memory + i) math::RangeType<ElemType>(bounds[i]);
+
+  if (bounds && ownsBounds)
+    delete[] bounds;
+
+  bounds = memory;
+  ownsBounds = false;
+}
+
+/**
+ * Move the ranges back into memory owned by the bound.
+ */
+template<typename MetricType, typename ElemType>
+inline void HRectBound<MetricType, ElemType>::Unpack()
+{
+  if (ownsBounds)
+    return;
+
+  math::RangeType<ElemType>* newBounds = new math::RangeType<ElemType>[dim];
+  for (size_t i = 0; i < dim; ++i)
+    newBounds[i] = bounds[i];
+
+  bounds = newBounds;
+  ownsBounds = true;
+}
+
 /**
  * Resets all dimensions to the empty set.
  */
@@ -192,30 +237,28 @@ inline ElemType HRectBound<MetricType, ElemType>::MinDistance(
 {
   Log::Assert(point.n_elem == dim);
 
-  ElemType sum = 0;
-
-  ElemType lower, higher;
-  for (size_t d = 0; d < dim; d++)
-  {
-    lower = bounds[d].Lo() - point[d];
-    higher = point[d] - bounds[d].Hi();
-
-    // Since only one of 'lower' or 'higher' is negative, if we add each's
-    // absolute value to itself and then sum those two, our result is the
-    // nonnegative half of the equation times two; then we raise to power Power.
-    if (MetricType::Power == 1)
-      sum += (lower + std::fabs(lower)) + (higher + std::fabs(higher));
-    else if (MetricType::Power == 2)
-    {
-      ElemType dist = (lower + std::fabs(lower)) + (higher + std::fabs(higher));
-      sum += dist * dist;
-    }
-    else
-    {
-      sum += pow((lower + fabs(lower)) + (higher + fabs(higher)),
-          (ElemType) MetricType::Power);
-    }
-  }
+  // The sum is computed with independent partial sums, so that the loop can be
+  // vectorized.
+  const math::RangeType<ElemType>* mbound = bounds;
+  const ElemType sum = metric::UnrolledSum<ElemType>(dim,
+      [mbound, &point](const size_t d) -> ElemType
+      {
+        const ElemType lower = mbound[d].Lo() - point[d];
+        const ElemType higher = point[d] - mbound[d].Hi();
+
+        // Since only one of 'lower' or 'higher' is negative, if we add each's
+        // absolute value to itself and then sum those two, our result is the
+        // nonnegative half of the equation times two; then we raise to power
+        // Power.
+        const ElemType dist = (lower + std::fabs(lower)) +
+            (higher + std::fabs(higher));
+        if (MetricType::Power == 1)
+          return dist;
+        else if (MetricType::Power == 2)
+          return dist * dist;
+        else
+          return pow(dist, (ElemType) MetricType::Power);
+      });
 
   // Now take the Power'th root (but make sure our result is squared if it needs
   // to be); then cancel out the constant of 2 (which may have been squared now)
@@ -249,37 +292,28 @@ ElemType HRectBound<MetricType, ElemType>::MinDistance(const HRectBound& other)
 {
   Log::Assert(dim == other.dim);
 
-  ElemType sum = 0;
   const math::RangeType<ElemType>* mbound = bounds;
   const math::RangeType<ElemType>* obound = other.bounds;
 
-  ElemType lower, higher;
-  for (size_t d = 0; d < dim; d++)
-  {
-    lower = obound->Lo() - mbound->Hi();
-    higher = mbound->Lo() - obound->Hi();
-    // We invoke the following:
-    //   x + fabs(x) = max(x * 2, 0)
-    //   (x * 2)^2 / 4 = x^2
-
-    // The compiler should optimize out this if statement entirely.
-    if (MetricType::Power == 1)
-      sum += (lower + std::fabs(lower)) + (higher + std::fabs(higher));
-    else if (MetricType::Power == 2)
-    {
-      ElemType dist = (lower + std::fabs(lower)) + (higher + std::fabs(higher));
-      sum += dist * dist;
-    }
-    else
-    {
-      sum += pow((lower + fabs(lower)) + (higher + fabs(higher)),
-          (ElemType) MetricType::Power);
-    }
-
-    // Move bound pointers.
-    mbound++;
-    obound++;
-  }
+  const ElemType sum = metric::UnrolledSum<ElemType>(dim,
+      [mbound, obound](const size_t d) -> ElemType
+      {
+        const ElemType lower = obound[d].Lo() - mbound[d].Hi();
+        const ElemType higher = mbound[d].Lo() - obound[d].Hi();
+        // We invoke the following:
+        //   x + fabs(x) = max(x * 2, 0)
+        //   (x * 2)^2 / 4 = x^2
+
+        // The compiler should optimize out this if statement entirely.
+        const ElemType dist = (lower + std::fabs(lower)) +
+            (higher + std::fabs(higher));
+        if (MetricType::Power == 1)
+          return dist;
+        else if (MetricType::Power == 2)
+          return dist * dist;
+        else
+          return pow(dist, (ElemType) MetricType::Power);
+      });
 
   // The compiler should optimize out this if statement entirely.
   if (MetricType::Power == 1)
@@ -310,23 +344,23 @@ inline ElemType HRectBound<MetricType, ElemType>::MaxDistance(
     const VecType& point,
     typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
 {
-  ElemType sum = 0;
-
   Log::Assert(point.n_elem == dim);
 
-  for (size_t d = 0; d < dim; d++)
-  {
-    ElemType v = std::max(fabs(point[d] - bounds[d].Lo()),
-        fabs(bounds[d].Hi() - point[d]));
-
-    // The compiler should optimize out this if statement entirely.
-    if (MetricType::Power == 1)
-      sum += v; // v is non-negative.
-    else if (MetricType::Power == 2)
-      sum += v * v;
-    else
-      sum += std::pow(v, (ElemType) MetricType::Power);
-  }
+  const math::RangeType<ElemType>* mbound = bounds;
+  const ElemType sum = metric::UnrolledSum<ElemType>(dim,
+      [mbound, &point](const size_t d) -> ElemType
+      {
+        const ElemType v = std::max(fabs(point[d] - mbound[d].Lo()),
+            fabs(mbound[d].Hi() - point[d]));
+
+        // The compiler should optimize out this if statement entirely.
+        if (MetricType::Power == 1)
+          return v; // v is non-negative.
+        else if (MetricType::Power == 2)
+          return v * v;
+        else
+          return std::pow(v, (ElemType) MetricType::Power);
+      });
 
   // The compiler should optimize out this if statement entirely.
   if (MetricType::TakeRoot)
@@ -350,24 +384,24 @@ inline ElemType HRectBound<MetricType, ElemType>::MaxDistance(
     const HRectBound& other)
     const
 {
-  ElemType sum = 0;
-
   Log::Assert(dim == other.dim);
 
-  ElemType v;
-  for (size_t d = 0; d < dim; d++)
-  {
-    v = std::max(fabs(other.bounds[d].Hi() - bounds[d].Lo()),
-        fabs(bounds[d].Hi() - other.bounds[d].Lo()));
-
-    // The compiler should optimize out this if statement entirely.
-    if (MetricType::Power == 1)
-      sum += v; // v is non-negative.
-    else if (MetricType::Power == 2)
-      sum += v * v;
-    else
-      sum += std::pow(v, (ElemType) MetricType::Power);
-  }
+  const math::RangeType<ElemType>* mbound = bounds;
+  const math::RangeType<ElemType>* obound = other.bounds;
+  const ElemType sum = metric::UnrolledSum<ElemType>(dim,
+      [mbound, obound](const size_t d) -> ElemType
+      {
+        const ElemType v = std::max(fabs(obound[d].Hi() - mbound[d].Lo()),
+            fabs(mbound[d].Hi() - obound[d].Lo()));
+
+        // The compiler should optimize out this if statement entirely.
+        if (MetricType::Power == 1)
+          return v; // v is non-negative.
+        else if (MetricType::Power == 2)
+          return v * v;
+        else
+          return std::pow(v, (ElemType) MetricType::Power);
+      });
 
   // The compiler should optimize out this if statement entirely.
   if (MetricType::TakeRoot)
@@ -686,6 +720,13 @@ void HRectBound<MetricType, ElemType>::serialize(
     Archive& ar,
     const uint32_t /* version */)
 {
+  // Loading replaces the array, and packed memory must not be freed.
+  if (cereal::is_loading<Archive>() && !ownsBounds)
+  {
+    bounds = NULL;
+    ownsBounds = true;
+  }
+
   // We can't serialize a raw array directly, so wrap it.
   ar(CEREAL_POINTER_ARRAY(bounds, dim));
   ar(CEREAL_NVP(minWidth));
@@ -63,6 +63,12 @@ class Octree
   ElemType furthestDescendantDistance;
   //! An instantiated metric.
   MetricType metric;
+  //! If the tree has been packed with Pack(), this holds all nodes other than
+  //! the root, followed by the ranges of their bounds (this is only set in the
+  //! root).
+  Octree* packedNodes;
+  //! The number of nodes in packedNodes.
+  size_t numPackedNodes;
 
  public:
   /**
@@ -273,6 +279,30 @@ class Octree
   //! Return the metric that this tree uses.
   MetricType Metric() const { return MetricType(); }
 
+  /**
+   * Move all nodes of the tree other than the root into one contiguous array,
+   * in breadth-first order, followed by the ranges of their bounds.  This does
+   * not change the structure of the tree or any results computed with it, but
+   * nodes that are close to each other in the tree are then also close in
+   * memory, which reduces cache misses during traversals of large trees.
+   * Pointers and references to nodes other than the root are invalidated.
+   * Copies of a packed tree are not packed.
+   *
+   * This can only be called on the root of the tree; otherwise, a
+   * std::invalid_argument exception is thrown.
+   */
+  void Pack();
+
+  /**
+   * Move the nodes of a tree that was packed with Pack() back into separate
+   * allocations.  Pointers and references to nodes other than the root are
+   * invalidated.  This does nothing if the tree is not packed.
+   */
+  void Unpack();
+
+  //! Return whether the nodes of the tree have been packed with Pack().
+  bool IsPacked() const { return packedNodes != NULL; }
+
   /**
    * Return the index of the nearest child node to the given query point.  If
    * this is a leaf node, it will return NumChildren() (invalid index).
@@ -439,6 +469,10 @@ class Octree
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
 
+  //! Destroy the nodes held in packedNodes, if there are any, and free the
+  //! array.
+  void ReleasePackedNodes();
+
   /**
    * This is used for sorting points while splitting.
    */
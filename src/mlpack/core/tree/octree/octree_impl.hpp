@@ -14,6 +14,8 @@
 
 #include "octree.hpp"
 #include <mlpack/core/tree/perform_split.hpp>
+#include <mlpack/core/tree/packed_bound.hpp>
+#include <algorithm>
 #include <stack>
 
 namespace mlpack {
@@ -28,7 +30,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   if (count > 0)
   {
@@ -66,7 +70,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -109,7 +115,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(dataset)),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -154,7 +162,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   if (count > 0)
   {
@@ -192,7 +202,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -235,7 +247,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     bound(dataset.n_rows),
     dataset(new MatType(std::move(dataset))),
     parent(NULL),
-    parentDistance(0.0)
+    parentDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   oldFromNew.resize(this->dataset->n_cols);
   for (size_t i = 0; i < this->dataset->n_cols; ++i)
@@ -284,7 +298,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
-    parent(parent)
+    parent(parent),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // Calculate empirical center of data.
   bound |= dataset->cols(begin, begin + count - 1);
@@ -319,7 +335,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     count(count),
     bound(parent->dataset->n_rows),
     dataset(parent->dataset),
-    parent(parent)
+    parent(parent),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // Calculate empirical center of data.
   bound |= dataset->cols(begin, begin + count - 1);
@@ -351,7 +369,9 @@ Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
     stat(other.stat),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
-    metric(other.metric)
+    metric(other.metric),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // If we have any children, we need to create them, and then ensure that their
   // parent links are set right.
@@ -374,6 +394,7 @@ operator=(const Octree& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
   delete dataset;
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -412,12 +433,16 @@ Octree<MetricType, StatisticType, MatType>::Octree(Octree&& other) :
     stat(std::move(other.stat)),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
-    metric(std::move(other.metric))
+    metric(std::move(other.metric)),
+    packedNodes(other.packedNodes),
+    numPackedNodes(other.numPackedNodes)
 {
   // Update the parent pointers of the direct children.
   for (size_t i = 0; i < children.size(); ++i)
     children[i]->parent = this;
 
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
   other.begin = 0;
   other.count = 0;
   other.dataset = new MatType();
@@ -437,6 +462,7 @@ operator=(Octree&& other)
     return *this;
 
   // Freeing memory that will not be used anymore.
+  ReleasePackedNodes();
   delete dataset;
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -450,18 +476,21 @@ operator=(Octree&& other)
   parent = other.Parent();
   stat = std::move(other.stat);
   parentDistance = other.ParentDistance();
-  furthestDescendantDistance = other.furthestDescendantDistance();
+  furthestDescendantDistance = other.FurthestDescendantDistance();
   metric = std::move(other.metric);
+  packedNodes = other.packedNodes;
+  numPackedNodes = other.numPackedNodes;
 
   // Update the parent pointers of the direct children.
   for (size_t i = 0; i < children.size(); ++i)
     children[i]->parent = this;
 
+  other.packedNodes = NULL;
+  other.numPackedNodes = 0;
   other.begin = 0;
   other.count = 0;
   other.dataset = new MatType();
   other.parentDistance = 0.0;
-  other.numDescendants = 0;
   other.furthestDescendantDistance = 0.0;
   other.parent = NULL;
 
@@ -476,7 +505,9 @@ Octree<MetricType, StatisticType, MatType>::Octree() :
     dataset(new MatType()),
     parent(NULL),
     parentDistance(0.0),
-    furthestDescendantDistance(0.0)
+    furthestDescendantDistance(0.0),
+    packedNodes(NULL),
+    numPackedNodes(0)
 {
   // Nothing to do.
 }
@@ -495,6 +526,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::~Octree()
 {
+  ReleasePackedNodes();
+
   // Delete the dataset if we aren't the parent.
   if (!parent)
     delete dataset;
@@ -511,6 +544,110 @@ size_t Octree<MetricType, StatisticType, MatType>::NumChildren() const
   return children.size();
 }
 
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::Pack()
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("Octree::Pack(): only the root of a tree can "
+        "be packed");
+  }
+
+  if (packedNodes != NULL)
+    return; // Already packed.
+
+  // Collect all nodes other than the root in breadth-first order.
+  std::vector<Octree*> nodes(children.begin(), children.end());
+  for (size_t i = 0; i < nodes.size(); ++i)
+    nodes.insert(nodes.end(), nodes[i]->children.begin(),
+        nodes[i]->children.end());
+
+  if (nodes.empty())
+    return;
+
+  // The ranges of the bounds are stored in the same allocation, after the
+  // nodes.
+  const size_t alignment = alignof(std::max_align_t);
+  const size_t boundOffset = ((nodes.size() * sizeof(Octree) + alignment - 1) /
+      alignment) * alignment;
+  size_t boundBytes = 0;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    boundBytes += PackedBoundBytes(nodes[i]->bound);
+
+  char* memory = static_cast<char*>(::operator new(boundOffset + boundBytes));
+  Octree* newNodes = reinterpret_cast<Octree*>(memory);
+  char* boundMemory = memory + boundOffset;
+
+  // Move each node into the array.  The parent of each node is moved before
+  // the node itself, and the move constructor has already pointed the node's
+  // parent pointer to the new location of the parent; so we only need to
+  // point the parent's child pointer to the new location of the node.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    Octree* oldNode = nodes[i];
+    Octree* newNode = new (newNodes + i) Octree(std::move(*oldNode));
+    std::vector<Octree*>& siblings = newNode->parent->children;
+    *std::find(siblings.begin(), siblings.end(), oldNode) = newNode;
+
+    PackBound(newNode->bound, boundMemory);
+
+    // The old node is now empty, so deleting it does not touch anything else.
+    delete oldNode;
+  }
+
+  packedNodes = newNodes;
+  numPackedNodes = nodes.size();
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::Unpack()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // The array is in breadth-first order, so, as in Pack(), the parent of each
+  // node has already been moved out when the node itself is moved.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+  {
+    Octree* oldNode = packedNodes + i;
+    Octree* newNode = new Octree(std::move(*oldNode));
+    std::vector<Octree*>& siblings = newNode->parent->children;
+    *std::find(siblings.begin(), siblings.end(), oldNode) = newNode;
+
+    UnpackBound(newNode->bound);
+  }
+
+  // The nodes left in the array are empty now.
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~Octree();
+
+  ::operator delete(packedNodes);
+
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::ReleasePackedNodes()
+{
+  if (packedNodes == NULL)
+    return;
+
+  // No node in the array owns its children, so clear all child lists before
+  // destroying the nodes in place.  (The packed bounds do not free their
+  // ranges, which are part of the same allocation.)
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].children.clear();
+  for (size_t i = 0; i < numPackedNodes; ++i)
+    packedNodes[i].~Octree();
+
+  ::operator delete(packedNodes);
+
+  children.clear();
+  packedNodes = NULL;
+  numPackedNodes = 0;
+}
+
 template<typename MetricType, typename StatisticType, typename MatType>
 template<typename VecType>
 size_t Octree<MetricType, StatisticType, MatType>::GetNearestChild(
@@ -715,6 +852,8 @@ void Octree<MetricType, StatisticType, MatType>::serialize(
   // If we're loading and we have children, they need to be deleted.
   if (cereal::is_loading<Archive>())
   {
+    ReleasePackedNodes();
+
     for (size_t i = 0; i < children.size(); ++i)
       delete children[i];
     children.clear();
@@ -0,0 +1,65 @@
+/**
+ * @file core/tree/packed_bound.hpp
+ *
+ * Functions that move the bounds of the nodes of a packed tree into the memory
+ * of the tree.  Only the ranges of HRectBounds are moved; every other bound
+ * keeps its own storage.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PACKED_BOUND_HPP
+#define MLPACK_CORE_TREE_PACKED_BOUND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "hrectbound.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! Only the ranges of HRectBounds are packed; other bounds need no memory.
+template<typename BoundType>
+inline size_t PackedBoundBytes(const BoundType& /* bound */)
+{
+  return 0;
+}
+
+//! Return the number of bytes needed to pack the ranges of the bound.
+template<typename MetricType, typename ElemType>
+inline size_t PackedBoundBytes(
+    const bound::HRectBound<MetricType, ElemType>& bound)
+{
+  return bound.Dim() * sizeof(math::RangeType<ElemType>);
+}
+
+//! Bounds other than HRectBound keep their own storage.
+template<typename BoundType>
+inline void PackBound(BoundType& /* bound */, char*& /* memory */) { }
+
+//! Move the ranges of the bound into the given memory, and advance the memory
+//! pointer past them.
+template<typename MetricType, typename ElemType>
+inline void PackBound(bound::HRectBound<MetricType, ElemType>& bound,
+                      char*& memory)
+{
+  bound.Pack(reinterpret_cast<math::RangeType<ElemType>*>(memory));
+  memory += PackedBoundBytes(bound);
+}
+
+//! Bounds other than HRectBound were not packed.
+template<typename BoundType>
+inline void UnpackBound(BoundType& /* bound */) { }
+
+//! Move the ranges of a packed bound back into memory owned by the bound.
+template<typename MetricType, typename ElemType>
+inline void UnpackBound(bound::HRectBound<MetricType, ElemType>& bound)
+{
+  bound.Unpack();
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file core/tree/rectangle_tree/bulk_load.hpp
+ *
+ * Definition of the BulkLoader class, which computes the structure of a packed
+ * rectangle tree for a whole dataset at once.  The points are ordered either
+ * with the Sort-Tile-Recursive (STR) algorithm or by their Hilbert values, and
+ * then consecutive runs of them are packed into full leaves; the leaves are
+ * packed into nodes the same way, level by level, until a single root remains.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "discrete_hilbert_value.hpp"
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The ordering used to pack points into the leaves of a bulk-loaded
+ * RectangleTree.
+ */
+enum BulkLoadType
+{
+  //! Sort-Tile-Recursive: sort the points into slabs along each dimension in
+  //! turn, so that each leaf covers a tile of the space.
+  STR_BULK_LOAD,
+  //! Sort the points by their discrete Hilbert values.
+  HILBERT_BULK_LOAD
+};
+
+/**
+ * The nodes of one level of a bulk-loaded tree.  Node i holds the items
+ * items[offsets[i]] to items[offsets[i + 1] - 1].  At the leaf level the items
+ * are indices of points; above it, they are indices of nodes of the level
+ * below.
+ */
+struct BulkLoadLevel
+{
+  //! The items held by the nodes of the level, node by node.
+  std::vector<size_t> items;
+  //! The position in items of the first item of each node, and the total
+  //! number of items at the end.
+  std::vector<size_t> offsets;
+
+  //! Return the number of nodes in the level.
+  size_t NumNodes() const { return offsets.size() - 1; }
+};
+
+/**
+ * The BulkLoader class computes the levels of a packed rectangle tree.  All
+ * leaves hold maxLeafSize points and all other nodes hold maxNumChildren
+ * children, except that the last two nodes of a level may share their items
+ * evenly so that neither falls below the minimum fill.  The sorting of each
+ * tile in STR ordering, the computation of Hilbert values and the computation
+ * of node bounds are done in parallel when OpenMP is available; the result
+ * does not depend on the number of threads.
+ */
+class BulkLoader
+{
+ public:
+  /**
+   * Compute the levels of a packed tree on the given dataset.  levels[0] is
+   * the leaf level, and the last level holds only the root.  If the dataset
+   * is empty, levels is empty.
+   *
+   * @param data Dataset to pack.
+   * @param type Ordering of the points.
+   * @param maxLeafSize Maximum number of points in a leaf.
+   * @param minLeafSize Minimum number of points in a leaf.
+   * @param maxNumChildren Maximum number of children of a node.
+   * @param minNumChildren Minimum number of children of a node.
+   * @param levels Vector to store the levels of the tree in.
+   */
+  template<typename MatType>
+  static void Build(const MatType& data,
+                    const BulkLoadType type,
+                    const size_t maxLeafSize,
+                    const size_t minLeafSize,
+                    const size_t maxNumChildren,
+                    const size_t minNumChildren,
+                    std::vector<BulkLoadLevel>& levels);
+
+ private:
+  //! Slabs with at least this many items are ordered as separate OpenMP tasks.
+  static const size_t ParallelTaskSize = 4096;
+
+  /**
+   * Sort the given points by their discrete Hilbert values.
+   *
+   * @param data Dataset.
+   * @param items Indices of the points to sort.
+   */
+  template<typename MatType>
+  static void HilbertOrder(const MatType& data, std::vector<size_t>& items);
+
+  /**
+   * Order the items items[begin] to items[end - 1] with the Sort-Tile-Recursive
+   * algorithm: sort them along the given dimension, cut them into slabs that
+   * each fill a whole number of nodes, and order each slab along the next
+   * dimension.
+   *
+   * @param coordinates Coordinates of the items, one column per item.
+   * @param items Items to order.
+   * @param begin Position of the first item to order.
+   * @param end Position after the last item to order.
+   * @param dimension Dimension to sort along.
+   * @param capacity Number of items in a full node.
+   */
+  template<typename MatType>
+  static void STROrder(const MatType& coordinates,
+                       std::vector<size_t>& items,
+                       const size_t begin,
+                       const size_t end,
+                       const size_t dimension,
+                       const size_t capacity);
+
+  /**
+   * Cut the given number of consecutive items into nodes.
+   *
+   * @param numItems Number of items.
+   * @param maxSize Maximum number of items in a node.
+   * @param minSize Minimum number of items in a node.
+   * @param offsets Vector to store the offsets of the nodes in.
+   */
+  static void Group(const size_t numItems,
+                    const size_t maxSize,
+                    const size_t minSize,
+                    std::vector<size_t>& offsets);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "bulk_load_impl.hpp"
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * @file core/tree/rectangle_tree/bulk_load_impl.hpp
+ *
+ * Implementation of the BulkLoader class, which computes the structure of a
+ * packed rectangle tree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_BULK_LOAD_IMPL_HPP
+
+// In case it wasn't included already for some reason.
+#include "bulk_load.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void BulkLoader::Build(const MatType& data,
+                       const BulkLoadType type,
+                       const size_t maxLeafSize,
+                       const size_t minLeafSize,
+                       const size_t maxNumChildren,
+                       const size_t minNumChildren,
+                       std::vector<BulkLoadLevel>& levels)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  if (maxLeafSize == 0 || maxNumChildren < 2)
+  {
+    throw std::invalid_argument("BulkLoader::Build(): maxLeafSize must be "
+        "positive and maxNumChildren must be at least 2!");
+  }
+
+  levels.clear();
+  if (data.n_cols == 0)
+    return;
+
+  // Order the points and pack them into leaves.
+  BulkLoadLevel leaves;
+  leaves.items.resize(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    leaves.items[i] = i;
+
+  if (type == HILBERT_BULK_LOAD)
+  {
+    HilbertOrder(data, leaves.items);
+  }
+  else
+  {
+    #pragma omp parallel if (data.n_cols >= 2 * ParallelTaskSize)
+    {
+      #pragma omp single
+      STROrder(data, leaves.items, 0, data.n_cols, 0, maxLeafSize);
+    }
+  }
+
+  Group(data.n_cols, maxLeafSize, minLeafSize, leaves.offsets);
+
+  // Compute the bounds of the leaves.
+  arma::Mat<ElemType> lo(data.n_rows, leaves.NumNodes());
+  arma::Mat<ElemType> hi(data.n_rows, leaves.NumNodes());
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) leaves.NumNodes(); ++i)
+  {
+    lo.col(i) = data.col(leaves.items[leaves.offsets[i]]);
+    hi.col(i) = lo.col(i);
+    for (size_t j = leaves.offsets[i] + 1; j < leaves.offsets[i + 1]; ++j)
+    {
+      for (size_t d = 0; d < data.n_rows; ++d)
+      {
+        const ElemType val = data(d, leaves.items[j]);
+        if (val < lo(d, i))
+          lo(d, i) = val;
+        if (val > hi(d, i))
+          hi(d, i) = val;
+      }
+    }
+  }
+
+  levels.push_back(std::move(leaves));
+
+  // Pack each level into nodes until only the root is left.
+  while (levels.back().NumNodes() > 1)
+  {
+    const size_t numNodes = levels.back().NumNodes();
+
+    BulkLoadLevel level;
+    level.items.resize(numNodes);
+    for (size_t i = 0; i < numNodes; ++i)
+      level.items[i] = i;
+
+    // With Hilbert ordering, the nodes of the level below are already ordered
+    // by the Hilbert values of their points.  With STR ordering, we tile the
+    // centers of the nodes.
+    if (type == STR_BULK_LOAD)
+    {
+      const arma::Mat<ElemType> centers = (lo + hi) / 2;
+
+      #pragma omp parallel if (numNodes >= 2 * ParallelTaskSize)
+      {
+        #pragma omp single
+        STROrder(centers, level.items, 0, numNodes, 0, maxNumChildren);
+      }
+    }
+
+    Group(numNodes, maxNumChildren, minNumChildren, level.offsets);
+
+    // Compute the bounds of the new nodes.
+    arma::Mat<ElemType> newLo(data.n_rows, level.NumNodes());
+    arma::Mat<ElemType> newHi(data.n_rows, level.NumNodes());
+
+    #pragma omp parallel for
+    for (omp_size_t i = 0; i < (omp_size_t) level.NumNodes(); ++i)
+    {
+      newLo.col(i) = lo.col(level.items[level.offsets[i]]);
+      newHi.col(i) = hi.col(level.items[level.offsets[i]]);
+      for (size_t j = level.offsets[i] + 1; j < level.offsets[i + 1]; ++j)
+      {
+        for (size_t d = 0; d < data.n_rows; ++d)
+        {
+          if (lo(d, level.items[j]) < newLo(d, i))
+            newLo(d, i) = lo(d, level.items[j]);
+          if (hi(d, level.items[j]) > newHi(d, i))
+            newHi(d, i) = hi(d, level.items[j]);
+        }
+      }
+    }
+
+    lo = std::move(newLo);
+    hi = std::move(newHi);
+    levels.push_back(std::move(level));
+  }
+}
+
+template<typename MatType>
+void BulkLoader::HilbertOrder(const MatType& data, std::vector<size_t>& items)
+{
+  typedef DiscreteHilbertValue<typename MatType::elem_type> HilbertValue;
+  typedef typename HilbertValue::HilbertElemType HilbertElemType;
+
+  // Computing the Hilbert values is the expensive part, so do it only once
+  // for each point.
+  arma::Mat<HilbertElemType> values(data.n_rows, items.size());
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) items.size(); ++i)
+    values.col(i) = HilbertValue::CalculateValue(data.col(items[i]));
+
+  // The words of a Hilbert value are compared in order (see
+  // DiscreteHilbertValue::CompareValues()).  Ties are broken by position, so
+  // that the order does not depend on the sorting algorithm.
+  std::vector<size_t> order(items.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(),
+      [&values](const size_t a, const size_t b)
+      {
+        const HilbertElemType* valueA = values.colptr(a);
+        const HilbertElemType* valueB = values.colptr(b);
+        for (size_t d = 0; d < values.n_rows; ++d)
+        {
+          if (valueA[d] != valueB[d])
+            return valueA[d] < valueB[d];
+        }
+        return a < b;
+      });
+
+  std::vector<size_t> sortedItems(items.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    sortedItems[i] = items[order[i]];
+
+  items = std::move(sortedItems);
+}
+
+template<typename MatType>
+void BulkLoader::STROrder(const MatType& coordinates,
+                          std::vector<size_t>& items,
+                          const size_t begin,
+                          const size_t end,
+                          const size_t dimension,
+                          const size_t capacity)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  // A single node does not need to be ordered any further.
+  const size_t count = end - begin;
+  if (count <= capacity)
+    return;
+
+  std::sort(items.begin() + begin, items.begin() + end,
+      [&coordinates, dimension](const size_t a, const size_t b)
+      {
+        const ElemType valueA = coordinates(dimension, a);
+        const ElemType valueB = coordinates(dimension, b);
+        if (valueA != valueB)
+          return valueA < valueB;
+        return a < b;
+      });
+
+  if (dimension + 1 == coordinates.n_rows)
+    return;
+
+  // The items fill numNodes nodes.  These are divided into numSlabs slabs, so
+  // that each of the remaining dimensions is cut into the same number of
+  // slabs; every slab but the last holds a whole number of full nodes.
+  const size_t numNodes = (count + capacity - 1) / capacity;
+  const size_t numSlabs = std::max((size_t) 1, (size_t) std::ceil(std::pow(
+      (double) numNodes, 1.0 / (coordinates.n_rows - dimension))));
+  const size_t slabSize = capacity * ((numNodes + numSlabs - 1) / numSlabs);
+
+  // The slabs are disjoint, so they can be ordered as concurrent tasks.
+  for (size_t slabBegin = begin; slabBegin < end; slabBegin += slabSize)
+  {
+    const size_t slabEnd = std::min(slabBegin + slabSize, end);
+
+    #pragma omp task if (count >= ParallelTaskSize) \
+        firstprivate(slabBegin, slabEnd) shared(coordinates, items)
+    STROrder(coordinates, items, slabBegin, slabEnd, dimension + 1, capacity);
+  }
+  #pragma omp taskwait
+}
+
+inline void BulkLoader::Group(const size_t numItems,
+                              const size_t maxSize,
+                              const size_t minSize,
+                              std::vector<size_t>& offsets)
+{
+  offsets.clear();
+  for (size_t i = 0; i < numItems; i += maxSize)
+    offsets.push_back(i);
+  offsets.push_back(numItems);
+
+  // If the last node is underfull, share the items of the last two nodes
+  // evenly between them.  (A single node is the root, which may hold any
+  // number of items.)
+  const size_t numNodes = offsets.size() - 1;
+  if (numNodes > 1 && numItems - offsets[numNodes - 1] < minSize)
+  {
+    const size_t lastTwo = numItems - offsets[numNodes - 2];
+    offsets[numNodes - 1] = offsets[numNodes - 2] + (lastTwo + 1) / 2;
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
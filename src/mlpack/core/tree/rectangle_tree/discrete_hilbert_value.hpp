@@ -195,6 +195,17 @@ class DiscreteHilbertValue
    */
   void NullifyData();
 
+  /**
+   * Set up the Hilbert values of a node that was filled by bulk loading.  A
+   * leaf computes the Hilbert values of its points and sorts the points by
+   * them; an intermediate node (whose children should already be sorted) takes
+   * the largest Hilbert value of its last child.
+   *
+   * @param node The node that was filled.
+   */
+  template<typename TreeType>
+  void HandleBulkLoad(TreeType* node);
+
   /**
    * Update the largest Hilbert value and the local Hilbert values of an
    * intermediate node.  The children of the node (or the points that the node
@@ -50,10 +50,11 @@ DiscreteHilbertValue<TreeElemType>::DiscreteHilbertValue(const TreeType* tree) :
   // Calculate the Hilbert value for all points.
   if (!tree->Parent()) // This is the root node.
     ownsLocalHilbertValues = true;
-  else if (tree->Parent()->Child(0).IsLeaf())
+  else if (tree->Parent()->NumChildren() == 0 ||
+           tree->Parent()->Child(0).IsLeaf())
   {
-    // This is a leaf node.
-    assert(tree->Parent()->NumChildren() > 0);
+    // This is a leaf node (or the first child of a node being filled by bulk
+    // loading, which finds out later whether it is a leaf).
     ownsLocalHilbertValues = true;
   }
 
@@ -477,6 +478,59 @@ void DiscreteHilbertValue<TreeElemType>::NullifyData()
   ownsLocalHilbertValues = false;
 }
 
+template<typename TreeElemType>
+template<typename TreeType>
+void DiscreteHilbertValue<TreeElemType>::HandleBulkLoad(TreeType* node)
+{
+  if (node->IsLeaf())
+  {
+    if (!ownsLocalHilbertValues)
+    {
+      localHilbertValues = new arma::Mat<HilbertElemType>(
+          node->Dataset().n_rows, node->MaxLeafSize() + 1);
+      ownsLocalHilbertValues = true;
+    }
+
+    // Compute the Hilbert values of the points, and sort the points by them.
+    arma::Mat<HilbertElemType> values(node->Dataset().n_rows,
+        node->NumPoints());
+    std::vector<size_t> order(node->NumPoints());
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+    {
+      values.col(i) = CalculateValue(node->Dataset().col(node->Point(i)));
+      order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+        [&values](const size_t a, const size_t b)
+        {
+          return CompareValues(values.unsafe_col(a),
+              values.unsafe_col(b)) < 0;
+        });
+
+    std::vector<size_t> sortedPoints(node->NumPoints());
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+    {
+      sortedPoints[i] = node->Point(order[i]);
+      localHilbertValues->col(i) = values.col(order[i]);
+    }
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+      node->Point(i) = sortedPoints[i];
+
+    numValues = node->NumPoints();
+  }
+  else
+  {
+    // Only leaves own their local Hilbert values; an intermediate node points
+    // to the values of its last child.
+    if (ownsLocalHilbertValues)
+      delete localHilbertValues;
+    ownsLocalHilbertValues = false;
+
+    UpdateLargestValue(node);
+  }
+}
+
 template<typename TreeElemType>
 template<typename TreeType>
 void DiscreteHilbertValue<TreeElemType>::UpdateLargestValue(TreeType* node)
@@ -117,6 +117,15 @@ class HilbertRTreeAuxiliaryInformation
    */
   bool UpdateAuxiliaryInfo(TreeType* node);
 
+  /**
+   * Set up the Hilbert values of a node that was filled by bulk loading.  The
+   * points of a leaf and the children of an intermediate node are sorted by
+   * their Hilbert values.
+   *
+   * @param node The node that was filled.
+   */
+  void HandleBulkLoad(TreeType* node);
+
   //! Clear memory.
   void NullifyData();
 
@@ -113,6 +113,16 @@ class NoAuxiliaryInformation
     return false;
   }
 
+  /**
+   * Some tree types need to set up the auxiliary information of a node that
+   * was filled by bulk loading.  This method is called once for each node of a
+   * bulk-loaded tree, after all of its children are finished.
+   *
+   * @param * (node) The node that was filled.
+   */
+  void HandleBulkLoad(TreeType* /* node */)
+  { }
+
   /**
    * The R++ tree requires to split the maximum bounding rectangle of a node
    * that is being split. This method is intended for that. This method is only
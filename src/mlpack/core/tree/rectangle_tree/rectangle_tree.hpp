@@ -17,6 +17,8 @@
 
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
+#include "../tree_traits.hpp"
+#include "bulk_load.hpp"
 #include "r_tree_split.hpp"
 #include "r_tree_descent_heuristic.hpp"
 #include "no_auxiliary_information.hpp"
@@ -156,6 +158,57 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a packed rectangle tree, built by bulk
+   * loading the given dataset instead of inserting its points one by one.  The
+   * points are ordered either with the Sort-Tile-Recursive algorithm or by
+   * their Hilbert values, and packed into full leaves; the leaves are packed
+   * into full nodes the same way, up to the root.  This is much faster than
+   * insertion for large datasets, and the nodes are usually tighter.  Points
+   * may still be inserted and deleted afterwards.
+   *
+   * Bulk loading is not available for R+ and R++ trees, since the nodes of a
+   * packed tree may overlap.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Ordering of the points (STR_BULK_LOAD or
+   *      HILBERT_BULK_LOAD).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(const MatType& data,
+                const BulkLoadType bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a packed rectangle tree by bulk loading
+   * the given dataset, and taking ownership of the dataset.  See the
+   * constructor above for details.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param bulkLoad Ordering of the points (STR_BULK_LOAD or
+   *      HILBERT_BULK_LOAD).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(MatType&& data,
+                const BulkLoadType bulkLoad,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -557,6 +610,26 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Bulk load the dataset into this (empty) root node.
+   *
+   * @param bulkLoad Ordering of the points.
+   */
+  void BulkLoad(const BulkLoadType bulkLoad);
+
+  /**
+   * Fill this empty node with the contents of the given node of a packed tree,
+   * and build its children recursively.  Large subtrees are built as
+   * concurrent OpenMP tasks.
+   *
+   * @param levels Levels of the packed tree, computed by BulkLoader.
+   * @param level Level of this node.
+   * @param index Index of this node in its level.
+   */
+  void BulkLoadNode(const std::vector<BulkLoadLevel>& levels,
+                    const size_t level,
+                    const size_t index);
+
   /**
    * Builds statistics for a node and all its descendants in a bottom-up way.
    *
@@ -121,6 +121,176 @@ RectangleTree(MatType&& data,
   BuildStatistics(this);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const BulkLoadType bulkLoad,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad(bulkLoad);
+
+  // Initialize statistic recursively after tree construction is complete.
+  BuildStatistics(this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const BulkLoadType bulkLoad,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad(bulkLoad);
+
+  // Initialize statistic recursively after tree construction is complete.
+  BuildStatistics(this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoad(const BulkLoadType bulkLoad)
+{
+  // The nodes of a packed tree may overlap, which R+ and R++ trees forbid.
+  static_assert(TreeTraits<RectangleTree>::HasOverlappingChildren,
+      "RectangleTree: bulk loading is not supported by trees whose children "
+      "may not overlap (like the R+ and R++ trees).");
+
+  std::vector<BulkLoadLevel> levels;
+  BulkLoader::Build(*dataset, bulkLoad, maxLeafSize, minLeafSize,
+      maxNumChildren, minNumChildren, levels);
+
+  // An empty dataset gives an empty leaf.
+  if (levels.empty())
+    return;
+
+  BulkLoadNode(levels, levels.size() - 1, 0);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoadNode(const std::vector<BulkLoadLevel>& levels,
+                 const size_t level,
+                 const size_t index)
+{
+  #ifdef HAS_OPENMP
+  // When building a large tree outside of any parallel region, open one here;
+  // the subtrees are then built by tasks inside of it.
+  if (parent == NULL && omp_get_level() == 0 && omp_get_max_threads() > 1 &&
+      level >= 2)
+  {
+    #pragma omp parallel shared(levels)
+    {
+      #pragma omp single
+      BulkLoadNode(levels, level, index);
+    }
+    return;
+  }
+  #endif
+
+  const size_t first = levels[level].offsets[index];
+  const size_t last = levels[level].offsets[index + 1];
+
+  if (level == 0)
+  {
+    // This is a leaf: take its points.
+    for (size_t i = first; i < last; ++i)
+    {
+      points[count++] = levels[level].items[i];
+      bound |= dataset->col(levels[level].items[i]);
+    }
+    numDescendants = count;
+  }
+  else
+  {
+    // Create all the children first, since the constructor of the auxiliary
+    // information may look at the siblings of a node.
+    for (size_t i = first; i < last; ++i)
+      children[numChildren++] = new RectangleTree(this);
+
+    // The children hold disjoint sets of points, so they can be built as
+    // concurrent tasks.  Only subtrees with more than one level are worth a
+    // task of their own.
+    const bool parallel = (level >= 2);
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      #pragma omp task if (parallel) firstprivate(i) shared(levels)
+      children[i]->BulkLoadNode(levels, level - 1,
+          levels[level].items[first + i]);
+    }
+    #pragma omp taskwait
+
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      numDescendants += children[i]->numDescendants;
+      bound |= children[i]->bound;
+    }
+  }
+
+  // Let the auxiliary information set itself up for the finished node.
+  auxiliaryInfo.HandleBulkLoad(this);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
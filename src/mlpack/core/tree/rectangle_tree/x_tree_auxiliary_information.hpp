@@ -156,6 +156,16 @@ class XTreeAuxiliaryInformation
     return false;
   }
 
+  /**
+   * Some tree types need to set up the auxiliary information of a node that
+   * was filled by bulk loading.  This method is called once for each node of a
+   * bulk-loaded tree, after all of its children are finished.
+   *
+   * @param * (node) The node that was filled.
+   */
+  void HandleBulkLoad(TreeType* /* node */)
+  { }
+
   /**
    * Nullify the auxiliary information in order to prevent an invalid free.
    */
@@ -0,0 +1,98 @@
+/**
+ * @file core/tree/subtree_partition.hpp
+ *
+ * A utility function that splits a tree into a set of disjoint subtrees that
+ * together hold every point of the tree.  This is useful for parallel
+ * traversals: each subtree can be handed to a different thread, and since no
+ * point is held by more than one subtree, the per-point results of each task
+ * can be written without locking.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SUBTREE_PARTITION_HPP
+#define MLPACK_CORE_TREE_SUBTREE_PARTITION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <queue>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * Split the given tree into at least the given number of disjoint subtrees
+ * (or fewer, if the tree does not have that many leaves).  The largest subtree
+ * is split repeatedly, so the resulting subtrees have roughly balanced numbers
+ * of descendants.  The subtrees are returned in decreasing order of size, which
+ * is a good order in which to schedule them as tasks.
+ *
+ * This assumes that every point of the tree is held by some leaf, so that the
+ * points of a non-leaf node are also held by its descendants (as is the case
+ * for all of mlpack's trees, including the self-children of the cover tree).
+ * For spill trees, the tree must be built without overlap (tau = 0), or some
+ * points will belong to more than one subtree.
+ *
+ * @param root Root of the tree to split.
+ * @param numSubtrees Desired minimum number of subtrees.
+ * @param subtrees Vector to store pointers to the subtrees in.
+ */
+template<typename TreeType>
+void PartitionSubtrees(TreeType& root,
+                       const size_t numSubtrees,
+                       std::vector<TreeType*>& subtrees)
+{
+  typedef std::pair<size_t, TreeType*> NodeEntry;
+
+  // Store nodes ordered by their number of descendants; the largest is on top.
+  auto cmp = [](const NodeEntry& a, const NodeEntry& b)
+  {
+    return a.first < b.first;
+  };
+  std::priority_queue<NodeEntry, std::vector<NodeEntry>, decltype(cmp)>
+      nodes(cmp);
+  nodes.push(NodeEntry(root.NumDescendants(), &root));
+
+  // Leaves can't be split any further, so we set them aside.
+  std::vector<NodeEntry> leaves;
+
+  while (!nodes.empty() && nodes.size() + leaves.size() < numSubtrees)
+  {
+    NodeEntry entry = nodes.top();
+    nodes.pop();
+
+    TreeType* node = entry.second;
+    if (node->NumChildren() == 0)
+    {
+      leaves.push_back(entry);
+      continue;
+    }
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+    {
+      TreeType* child = &node->Child(i);
+      nodes.push(NodeEntry(child->NumDescendants(), child));
+    }
+  }
+
+  std::vector<NodeEntry> entries(leaves);
+  while (!nodes.empty())
+  {
+    entries.push_back(nodes.top());
+    nodes.pop();
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+      [](const NodeEntry& a, const NodeEntry& b) { return a.first > b.first; });
+
+  subtrees.clear();
+  subtrees.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i)
+    subtrees.push_back(entries[i].second);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,551 @@
+/**
+ * @file methods/ann/convolution_rules/im2col_convolution.hpp
+ *
+ * Implementation of the convolution as a matrix multiplication, by unrolling
+ * the input patches into the columns of a matrix (im2col).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by copying every patch of the input
+ * that the filter is applied to into a row of a matrix (im2col), so that the
+ * convolution becomes a single matrix multiplication.  This class allows
+ * specification of the type of the border type. The convolution can be
+ * computed with the valid border type of the full border type (default).
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * Besides the usual Convolution() functions, which convolve one input with
+ * one filter, this rule can convolve a whole batch of multi-channel inputs
+ * with all the filters of a layer at once (BatchConvolution()), and compute
+ * the gradients of that operation with respect to the input
+ * (BatchInputGradient()) and the filters (BatchFilterGradient()), each with a
+ * single matrix multiplication.  The Convolution, AtrousConvolution and
+ * TransposedConvolution layers use these functions when they are given this
+ * rule; the batched functions always use valid convolution, since the layers
+ * do their own padding.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1,
+              const size_t dilationW = 1,
+              const size_t dilationH = 1)
+  {
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+
+    arma::Mat<eT> columns;
+    Im2Col(inputCube, 1, filter.n_rows, filter.n_cols, dW, dH, dilationW,
+        dilationH, columns);
+
+    output = arma::reshape(columns * arma::vectorise(filter),
+        OutputSize(input.n_rows, filter.n_rows, dW, dilationW),
+        OutputSize(input.n_cols, filter.n_cols, dH, dilationH));
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1,
+              const size_t dilationW = 1,
+              const size_t dilationH = 1)
+  {
+    // The padded size is computed in the same way as NaiveConvolution.
+    size_t outputRows = (input.n_rows - 1) * dW + 2 * (filter.n_rows - 1)
+        * dilationW + 1;
+    size_t outputCols = (input.n_cols - 1) * dH + 2 * (filter.n_cols - 1)
+        * dilationH + 1;
+
+    for (size_t i = 0; i < dW; ++i)
+    {
+      if (((((i + outputRows - 2 * (filter.n_rows - 1) * dilationW - 1) % dW)
+          + dW) % dW) == i)
+      {
+        outputRows += i;
+        break;
+      }
+    }
+    for (size_t i = 0; i < dH; ++i)
+    {
+      if (((((i + outputCols - 2 * (filter.n_cols - 1) * dilationH - 1) % dH)
+          + dH) % dH) == i)
+      {
+        outputCols += i;
+        break;
+      }
+    }
+
+    // Pad filter and input to the working output shape.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(outputRows,
+        outputCols);
+    inputPadded.submat((filter.n_rows - 1) * dilationW, (filter.n_cols - 1)
+        * dilationH, (filter.n_rows - 1) * dilationW + input.n_rows - 1,
+        (filter.n_cols - 1) * dilationH + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, 1, 1, dilationW, dilationH);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1,
+                          const size_t dilationW = 1,
+                          const size_t dilationH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH, dilationW, dilationH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; ++i)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), output.slice(i), dW, dH, dilationW, dilationH);
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1,
+                          const size_t dilationW = 1,
+                          const size_t dilationH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH, dilationW, dilationH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; ++i)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          output.slice(i), dW, dH, dilationW, dilationH);
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the convolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1,
+                          const size_t dilationW = 1,
+                          const size_t dilationH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH, dilationW, dilationH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; ++i)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          output.slice(i), dW, dH, dilationW, dilationH);
+    }
+  }
+
+  /**
+   * Convolve a batch of multi-channel inputs with a bank of filters (valid
+   * mode), summing over the input maps: output map o of a point is the sum
+   * over the input maps i of the convolution of input map i with filter (i, o).
+   * The maps of each point are consecutive slices of the input and output
+   * cubes.  Column o of the filter matrix holds the filters from each input map
+   * to output map o, one kernelWidth x kernelHeight filter after another.
+   *
+   * @param input Input maps, with the maps of each point in consecutive slices.
+   * @param filters Filter matrix, with one column for each output map.
+   * @param output Output maps, with the maps of each point in consecutive
+   *     slices.
+   * @param kernelWidth Width of the filters.
+   * @param kernelHeight Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchConvolution(const arma::Cube<eT>& input,
+                               const arma::Mat<eT>& filters,
+                               arma::Cube<eT>& output,
+                               const size_t kernelWidth,
+                               const size_t kernelHeight,
+                               const size_t dW = 1,
+                               const size_t dH = 1,
+                               const size_t dilationW = 1,
+                               const size_t dilationH = 1)
+  {
+    const size_t inMaps = filters.n_rows / (kernelWidth * kernelHeight);
+    const size_t batchSize = input.n_slices / inMaps;
+
+    arma::Mat<eT> columns;
+    Im2Col(input, inMaps, kernelWidth, kernelHeight, dW, dH, dilationW,
+        dilationH, columns);
+    const arma::Mat<eT> products = columns * filters;
+
+    output.set_size(OutputSize(input.n_rows, kernelWidth, dW, dilationW),
+        OutputSize(input.n_cols, kernelHeight, dH, dilationH),
+        filters.n_cols * batchSize);
+    ColumnsToMaps(products, output);
+  }
+
+  /**
+   * Compute the gradient of BatchConvolution() with respect to its input,
+   * given the gradient with respect to its output.
+   *
+   * @param error Gradient with respect to the output maps.
+   * @param filters Filter matrix, with one column for each output map.
+   * @param inputGradient Gradient with respect to the input maps.  This must
+   *     already have the size of the input.
+   * @param kernelWidth Width of the filters.
+   * @param kernelHeight Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchInputGradient(const arma::Cube<eT>& error,
+                                 const arma::Mat<eT>& filters,
+                                 arma::Cube<eT>& inputGradient,
+                                 const size_t kernelWidth,
+                                 const size_t kernelHeight,
+                                 const size_t dW = 1,
+                                 const size_t dH = 1,
+                                 const size_t dilationW = 1,
+                                 const size_t dilationH = 1)
+  {
+    arma::Mat<eT> errorColumns;
+    MapsToColumns(error, filters.n_cols, errorColumns);
+    const arma::Mat<eT> columns = errorColumns * filters.t();
+
+    inputGradient.zeros();
+    Col2Im(columns, filters.n_rows / (kernelWidth * kernelHeight),
+        kernelWidth, kernelHeight, dW, dH, dilationW, dilationH,
+        inputGradient);
+  }
+
+  /**
+   * Compute the gradient of BatchConvolution() with respect to its filters,
+   * given the gradient with respect to its output.
+   *
+   * @param input Input maps, with the maps of each point in consecutive slices.
+   * @param error Gradient with respect to the output maps.
+   * @param filterGradient Gradient with respect to the filter matrix.  This
+   *     must already have the size of the filter matrix.
+   * @param kernelWidth Width of the filters.
+   * @param kernelHeight Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   */
+  template<typename eT>
+  static void BatchFilterGradient(const arma::Cube<eT>& input,
+                                  const arma::Cube<eT>& error,
+                                  arma::Mat<eT>& filterGradient,
+                                  const size_t kernelWidth,
+                                  const size_t kernelHeight,
+                                  const size_t dW = 1,
+                                  const size_t dH = 1,
+                                  const size_t dilationW = 1,
+                                  const size_t dilationH = 1)
+  {
+    arma::Mat<eT> columns, errorColumns;
+    Im2Col(input, filterGradient.n_rows / (kernelWidth * kernelHeight),
+        kernelWidth, kernelHeight, dW, dH, dilationW, dilationH, columns);
+    MapsToColumns(error, filterGradient.n_cols, errorColumns);
+
+    filterGradient = columns.t() * errorColumns;
+  }
+
+  /**
+   * Copy each patch of the input that a filter is applied to (in valid mode)
+   * into a row of the given matrix.  The patches of the first point come
+   * first, in column-major order of their position in the output; column
+   * x + kernelWidth * (y + kernelHeight * i) holds element (x, y) of each patch
+   * of input map i.
+   *
+   * @param input Input maps, with the maps of each point in consecutive slices.
+   * @param maps Number of maps of each point.
+   * @param kernelWidth Width of the filters.
+   * @param kernelHeight Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   * @param columns Matrix to store the patches in.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t maps,
+                     const size_t kernelWidth,
+                     const size_t kernelHeight,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t dilationW,
+                     const size_t dilationH,
+                     arma::Mat<eT>& columns)
+  {
+    const size_t outputWidth = OutputSize(input.n_rows, kernelWidth, dW,
+        dilationW);
+    const size_t outputHeight = OutputSize(input.n_cols, kernelHeight, dH,
+        dilationH);
+    const size_t batchSize = input.n_slices / maps;
+
+    columns.set_size(outputWidth * outputHeight * batchSize,
+        kernelWidth * kernelHeight * maps);
+    for (size_t map = 0; map < maps; ++map)
+    {
+      for (size_t kj = 0; kj < kernelHeight; ++kj)
+      {
+        for (size_t ki = 0; ki < kernelWidth; ++ki)
+        {
+          eT* columnPtr = columns.colptr(ki + kernelWidth *
+              (kj + kernelHeight * map));
+          for (size_t b = 0; b < batchSize; ++b)
+          {
+            const eT* slicePtr = input.slice_memptr(map + b * maps);
+            for (size_t j = 0; j < outputHeight; ++j)
+            {
+              const eT* inputPtr = slicePtr + (j * dH + kj * dilationH) *
+                  input.n_rows + ki * dilationW;
+              for (size_t i = 0; i < outputWidth; ++i, inputPtr += dW)
+                *(columnPtr++) = *inputPtr;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Add each row of the given matrix back to the patch of the input it was
+   * copied from by Im2Col().  Where patches overlap, the values are summed.
+   *
+   * @param columns Matrix of patches, as given by Im2Col().
+   * @param maps Number of maps of each point.
+   * @param kernelWidth Width of the filters.
+   * @param kernelHeight Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param dilationW The dilation factor in x direction.
+   * @param dilationH The dilation factor in y direction.
+   * @param input Input maps to add the patches to.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& columns,
+                     const size_t maps,
+                     const size_t kernelWidth,
+                     const size_t kernelHeight,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t dilationW,
+                     const size_t dilationH,
+                     arma::Cube<eT>& input)
+  {
+    const size_t outputWidth = OutputSize(input.n_rows, kernelWidth, dW,
+        dilationW);
+    const size_t outputHeight = OutputSize(input.n_cols, kernelHeight, dH,
+        dilationH);
+    const size_t batchSize = input.n_slices / maps;
+
+    for (size_t map = 0; map < maps; ++map)
+    {
+      for (size_t kj = 0; kj < kernelHeight; ++kj)
+      {
+        for (size_t ki = 0; ki < kernelWidth; ++ki)
+        {
+          const eT* columnPtr = columns.colptr(ki + kernelWidth *
+              (kj + kernelHeight * map));
+          for (size_t b = 0; b < batchSize; ++b)
+          {
+            eT* slicePtr = input.slice_memptr(map + b * maps);
+            for (size_t j = 0; j < outputHeight; ++j)
+            {
+              eT* inputPtr = slicePtr + (j * dH + kj * dilationH) *
+                  input.n_rows + ki * dilationW;
+              for (size_t i = 0; i < outputWidth; ++i, inputPtr += dW)
+                *inputPtr += *(columnPtr++);
+            }
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  //! Get the size of the output of a valid convolution in one direction.
+  static size_t OutputSize(const size_t size,
+                           const size_t kernelSize,
+                           const size_t stride,
+                           const size_t dilation)
+  {
+    return (size - (kernelSize - 1) * dilation - 1) / stride + 1;
+  }
+
+  /**
+   * Copy the maps of a batch of points into the columns of a matrix, so that
+   * column m holds map m of each point, one point after another.
+   */
+  template<typename eT>
+  static void MapsToColumns(const arma::Cube<eT>& maps,
+                            const size_t numMaps,
+                            arma::Mat<eT>& columns)
+  {
+    const size_t area = maps.n_rows * maps.n_cols;
+    const size_t batchSize = maps.n_slices / numMaps;
+
+    columns.set_size(area * batchSize, numMaps);
+    for (size_t b = 0; b < batchSize; ++b)
+    {
+      for (size_t m = 0; m < numMaps; ++m)
+      {
+        const eT* slicePtr = maps.slice_memptr(m + b * numMaps);
+        std::copy(slicePtr, slicePtr + area, columns.colptr(m) + b * area);
+      }
+    }
+  }
+
+  //! The inverse of MapsToColumns(); the maps must already have their size.
+  template<typename eT>
+  static void ColumnsToMaps(const arma::Mat<eT>& columns,
+                            arma::Cube<eT>& maps)
+  {
+    const size_t area = maps.n_rows * maps.n_cols;
+    const size_t batchSize = maps.n_slices / columns.n_cols;
+
+    for (size_t b = 0; b < batchSize; ++b)
+    {
+      for (size_t m = 0; m < columns.n_cols; ++m)
+      {
+        const eT* columnPtr = columns.colptr(m) + b * area;
+        std::copy(columnPtr, columnPtr + area,
+            maps.slice_memptr(m + b * columns.n_cols));
+      }
+    }
+  }
+};  // class Im2ColConvolution
+
+/**
+ * Whether the given convolution rule can convolve a whole batch of
+ * multi-channel inputs at once, with BatchConvolution(), BatchInputGradient()
+ * and BatchFilterGradient().  The convolution layers use those functions
+ * instead of convolving one pair of maps at a time if this is true.
+ */
+template<typename ConvolutionRuleType>
+struct SupportsBatchConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode>
+struct SupportsBatchConvolution<Im2ColConvolution<BorderMode> >
+{
+  static const bool value = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <map>
+
 #include "visitor/delete_visitor.hpp"
 #include "visitor/delta_visitor.hpp"
 #include "visitor/output_height_visitor.hpp"
@@ -168,13 +170,21 @@ class FFN
    * reflect the output of the given output layer as returned by the
    * output layer function.
    *
+   * The predictors are passed through the network in batches of batchSize
+   * points, so that each layer works on a matrix of points at once instead of
+   * a single point.  Larger batches are usually faster, but need more memory
+   * for the outputs of each layer.
+   *
    * If you want to pass in a parameter and discard the original parameter
    * object, be sure to use std::move to avoid unnecessary copy.
    *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to pass through the network at once.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(arma::mat predictors,
+               arma::mat& results,
+               const size_t batchSize = 128);
 
   /**
    * Evaluate the feedforward network with the given predictors and responses.
@@ -314,6 +324,36 @@ class FFN
   //! Modify the initial point for the optimization.
   arma::mat& Parameters() { return parameter; }
 
+  /**
+   * Get the number of replicas of the network that each mini-batch is split
+   * among during training.  Each replica holds its own activations and deltas
+   * (the parameters are shared) and computes its part of the mini-batch in its
+   * own OpenMP thread; the output layer is evaluated on the whole mini-batch,
+   * and the gradients of the parts are summed.  If this is 1 (the default), or
+   * if the network contains a layer that depends on the rest of the batch
+   * (such as BatchNorm, a recurrent layer like LSTM, or a layer with its own
+   * loss) or that draws random numbers during training (such as Dropout), the
+   * whole mini-batch is computed at once.
+   */
+  size_t Replicas() const { return replicas; }
+  //! Modify the number of replicas of the network that each mini-batch is
+  //! split among during training.
+  size_t& Replicas() { return replicas; }
+
+  /**
+   * Get whether the outputs and deltas of the layers are kept in a single
+   * preallocated arena during training.  The size of every buffer is recorded
+   * after the first training step with each batch size, and from then on the
+   * layers write into views of the arena, so that a training step does not
+   * allocate them again.  Since a delta is not needed anymore once the gradient
+   * of the preceding layer is computed, the deltas share two buffers.  This is
+   * true by default.
+   */
+  bool ActivationArena() const { return activationArena; }
+  //! Modify whether the outputs and deltas of the layers are kept in a single
+  //! preallocated arena during training.
+  bool& ActivationArena() { return activationArena; }
+
   //! Get the matrix of responses to the input data points.
   const arma::mat& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
@@ -426,6 +466,69 @@ class FFN
    */
   void ResetGradients(arma::mat& gradient);
 
+  /**
+   * Evaluate the network and its gradient on the given mini-batch like
+   * EvaluateWithGradient(), but split the mini-batch among the replicas of the
+   * network.
+   *
+   * @param begin Index of the first point of the mini-batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points of the mini-batch.
+   */
+  template<typename GradType>
+  double ParallelEvaluateWithGradient(const size_t begin,
+                                      GradType& gradient,
+                                      const size_t batchSize);
+
+  /**
+   * Build the replicas of the network, which share the parameters of this
+   * network.
+   */
+  void BuildReplicas();
+
+  //! Delete the replicas of the network.
+  void ResetReplicas();
+
+  /**
+   * Iterate through the layer modules from the last to the first, computing the
+   * delta and then the gradient of each one.  This is equivalent to Backward()
+   * followed by Gradient(), but each delta is only needed until the gradient of
+   * the preceding layer is computed.
+   *
+   * @param input The input of the network.
+   */
+  void BackwardGradient(const arma::mat& input);
+
+  /**
+   * Return the buffer of the activation arena with the given index: the output
+   * of each layer, then the delta of each layer, then the error.
+   *
+   * @param index Index of the buffer.
+   */
+  arma::mat& ArenaBuffer(const size_t index);
+
+  /**
+   * Make the outputs and deltas of the layers and the error views of the
+   * activation arena, if their sizes for the given batch size are known.
+   *
+   * @param batchSize Number of points of the mini-batch.
+   * @return Whether the arena is used for the given batch size.
+   */
+  bool BindArena(const size_t batchSize);
+
+  //! Give the buffers that are views of the activation arena their own (empty)
+  //! memory.
+  void ReleaseArena();
+
+  /**
+   * Record the sizes of the outputs and deltas of the layers and of the error
+   * after a training step with the given batch size, and grow the activation
+   * arena if it is too small to hold them.
+   *
+   * @param batchSize Number of points of the mini-batch.
+   */
+  void PlanArena(const size_t batchSize);
+
   /**
    * Swap the content of this network with given network.
    *
@@ -509,6 +612,23 @@ class FFN
   //! Locally-stored copy visitor
   CopyVisitor<CustomLayers...> copyVisitor;
 
+  //! The number of replicas each mini-batch is split among during training.
+  size_t replicas;
+
+  //! Locally-stored replicas of the network (other than this network itself).
+  std::vector<FFN*> replicaNetworks;
+
+  //! Whether the outputs and deltas of the layers are kept in the arena.
+  bool activationArena;
+
+  //! The memory the outputs and deltas of the layers are views of.  (Unlike
+  //! arma::mat, std::vector keeps its memory when it is moved or swapped.)
+  std::vector<double> arena;
+
+  //! For each batch size, the number of rows, number of columns and arena
+  //! offset (one column each) of the buffers returned by ArenaBuffer().
+  std::map<size_t, arma::umat> arenaPlans;
+
   // The GAN class should have access to internal members.
   template<
     typename Model,
@@ -17,6 +17,7 @@
 
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
+#include "visitor/batch_dependent_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
@@ -39,7 +40,9 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     height(0),
     reset(false),
     numFunctions(0),
-    deterministic(false)
+    deterministic(false),
+    replicas(1),
+    activationArena(true)
 {
   /* Nothing to do here. */
 }
@@ -48,6 +51,7 @@ template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::~FFN()
 {
+  ResetReplicas();
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
 }
@@ -215,9 +219,10 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
 
   gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
 
-  Backward();
+  // The layers may still be views of the activation arena, where the deltas
+  // share buffers.
   ResetGradients(gradients);
-  Gradient(inputs);
+  BackwardGradient(inputs);
 
   return res;
 }
@@ -225,11 +230,17 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
-    arma::mat predictors, arma::mat& results)
+    arma::mat predictors, arma::mat& results, const size_t batchSize)
 {
   CheckInputShape<std::vector<LayerTypes<CustomLayers...> > >(
       network, predictors.n_rows, "FFN<>::Predict()");
 
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("FFN<>::Predict(): the batch size must be "
+        "positive!");
+  }
+
   if (parameter.is_empty())
     ResetParameters();
 
@@ -239,21 +250,23 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(arma::mat(predictors.colptr(0), predictors.n_rows, 1, false, true));
-  resultsTemp = boost::apply_visitor(outputParameterVisitor,
-      network.back()).col(0);
-
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
-  results.col(0) = resultsTemp.col(0);
-
-  for (size_t i = 1; i < predictors.n_cols; ++i)
+  // Without any predictors the loop below never sets the results.
+  results.reset();
+  for (size_t begin = 0; begin < predictors.n_cols; begin += batchSize)
   {
-    Forward(arma::mat(predictors.colptr(i), predictors.n_rows, 1, false, true));
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols) - begin);
+    Forward(arma::mat(predictors.colptr(begin), predictors.n_rows,
+        effectiveBatchSize, false, true));
 
-    resultsTemp = boost::apply_visitor(outputParameterVisitor,
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
         network.back());
-    results.col(i) = resultsTemp.col(0);
+
+    // The size of the output is only known once the first batch is done.
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, begin + effectiveBatchSize - 1) = output;
   }
 }
 
@@ -317,10 +330,13 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
     ResetDeterministic();
   }
 
-  Forward(predictors.cols(begin, begin + batchSize - 1));
+  // Pass the mini-batch through the network without copying it.
+  Forward(arma::mat(predictors.colptr(begin), predictors.n_rows, batchSize,
+      false, true));
   double res = outputLayer.Forward(
       boost::apply_visitor(outputParameterVisitor, network.back()),
-      responses.cols(begin, begin + batchSize - 1));
+      arma::mat(responses.colptr(begin), responses.n_rows, batchSize, false,
+      true));
 
   for (size_t i = 0; i < network.size(); ++i)
   {
@@ -378,10 +394,30 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  Forward(predictors.cols(begin, begin + batchSize - 1));
+  // The mini-batch can only be split once the network is set up, and if none
+  // of its layers depend on the rest of the batch.
+  bool splitBatch = (replicas > 1 && batchSize > 1 && reset);
+  for (size_t i = 0; splitBatch && i < network.size(); ++i)
+    splitBatch = !boost::apply_visitor(BatchDependentVisitor(), network[i]);
+
+  if (splitBatch)
+    return ParallelEvaluateWithGradient(begin, gradient, batchSize);
+
+  // Once the sizes of the buffers are known, the layers write into the arena.
+  // Until then, they use their own memory, so that the sizes can be recorded.
+  const bool arenaBound = activationArena && reset && BindArena(batchSize);
+  if (!arenaBound)
+    ReleaseArena();
+
+  // The mini-batch is used without copying it.
+  const arma::mat input(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true);
+  const arma::mat target(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true);
+
+  Forward(input);
   double res = outputLayer.Forward(
-      boost::apply_visitor(outputParameterVisitor, network.back()),
-      responses.cols(begin, begin + batchSize - 1));
+      boost::apply_visitor(outputParameterVisitor, network.back()), target);
 
   for (size_t i = 0; i < network.size(); ++i)
   {
@@ -389,13 +425,16 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
   }
 
   outputLayer.Backward(
-      boost::apply_visitor(outputParameterVisitor, network.back()),
-      responses.cols(begin, begin + batchSize - 1),
+      boost::apply_visitor(outputParameterVisitor, network.back()), target,
       error);
 
-  Backward();
+  // The deltas may share buffers in the arena, so the gradient of each layer is
+  // computed right after its delta.
   ResetGradients(gradient);
-  Gradient(predictors.cols(begin, begin + batchSize - 1));
+  BackwardGradient(input);
+
+  if (activationArena && !arenaBound)
+    PlanArena(batchSize);
 
   return res;
 }
@@ -411,6 +450,79 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Gradient(
   this->EvaluateWithGradient(parameters, begin, gradient, batchSize);
 }
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+template<typename GradType>
+double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+ParallelEvaluateWithGradient(const size_t begin,
+                             GradType& gradient,
+                             const size_t batchSize)
+{
+  // The parts are smaller than the mini-batches the arena was planned for.
+  ReleaseArena();
+
+  if (replicaNetworks.size() != replicas - 1 ||
+      replicaNetworks[0]->network.size() != network.size() ||
+      replicaNetworks[0]->parameter.memptr() != parameter.memptr())
+  {
+    BuildReplicas();
+  }
+
+  // The first part of the mini-batch is computed by this network itself.
+  const size_t parts = std::min(replicas, batchSize);
+  std::vector<FFN*> networks(1, this);
+  networks.insert(networks.end(), replicaNetworks.begin(),
+      replicaNetworks.begin() + parts - 1);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) parts; ++i)
+  {
+    const size_t partBegin = begin + i * batchSize / parts;
+    const size_t partEnd = begin + (i + 1) * batchSize / parts;
+    networks[i]->Forward(predictors.cols(partBegin, partEnd - 1));
+  }
+
+  // Evaluate the output layer on the whole mini-batch, so that the loss and
+  // its derivative are the same as if the mini-batch was not split.
+  arma::mat output(boost::apply_visitor(outputParameterVisitor,
+      network.back()).n_rows, batchSize);
+  for (size_t i = 0; i < parts; ++i)
+  {
+    output.cols(i * batchSize / parts, (i + 1) * batchSize / parts - 1) =
+        boost::apply_visitor(outputParameterVisitor,
+        networks[i]->network.back());
+  }
+
+  const double res = outputLayer.Forward(output,
+      responses.cols(begin, begin + batchSize - 1));
+
+  arma::mat batchError;
+  outputLayer.Backward(output, responses.cols(begin, begin + batchSize - 1),
+      batchError);
+
+  // Each replica computes the gradient of its part into its own matrix.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) parts; ++i)
+  {
+    const size_t partBegin = i * batchSize / parts;
+    const size_t partEnd = (i + 1) * batchSize / parts;
+
+    FFN& part = *networks[i];
+    part.error = batchError.cols(partBegin, partEnd - 1);
+    part.Backward();
+
+    if (i != 0)
+      part.gradient.zeros(parameter.n_rows, parameter.n_cols);
+    part.ResetGradients((i == 0) ? gradient : part.gradient);
+    part.Gradient(predictors.cols(begin + partBegin, begin + partEnd - 1));
+  }
+
+  for (size_t i = 1; i < parts; ++i)
+    gradient += networks[i]->gradient;
+
+  return res;
+}
+
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
@@ -425,6 +537,12 @@ void FFN<OutputLayerType, InitializationRuleType,
 {
   ResetDeterministic();
 
+  // The replicas have to be rebuilt for the new parameters.
+  ResetReplicas();
+
+  // The layers may have changed, so the sizes of their buffers are unknown.
+  arenaPlans.clear();
+
   // Reset the network parameter with the given initialization rule.
   NetworkInitialization<InitializationRuleType,
                         CustomLayers...> networkInit(initializeRule);
@@ -454,6 +572,203 @@ void FFN<OutputLayerType, InitializationRuleType,
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::BuildReplicas()
+{
+  ResetReplicas();
+
+  for (size_t r = 1; r < replicas; ++r)
+  {
+    FFN* replica = new FFN(outputLayer, initializeRule);
+    replica->width = width;
+    replica->height = height;
+    replica->reset = reset;
+
+    // The layers of the replica use the parameters of this network.
+    replica->parameter = arma::mat(parameter.memptr(), parameter.n_rows,
+        parameter.n_cols, false, false);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      replica->network.push_back(boost::apply_visitor(copyVisitor,
+          network[i]));
+      offset += boost::apply_visitor(WeightSetVisitor(replica->parameter,
+          offset), replica->network.back());
+      boost::apply_visitor(resetVisitor, replica->network.back());
+    }
+
+    replica->ResetDeterministic();
+    replicaNetworks.push_back(replica);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::ResetReplicas()
+{
+  for (size_t i = 0; i < replicaNetworks.size(); ++i)
+    delete replicaNetworks[i];
+
+  replicaNetworks.clear();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::BackwardGradient(const arma::mat& input)
+{
+  const size_t last = network.size() - 1;
+  boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
+      outputParameterVisitor, network[last]), error,
+      boost::apply_visitor(deltaVisitor, network[last])), network[last]);
+  boost::apply_visitor(GradientVisitor(boost::apply_visitor(
+      outputParameterVisitor, network[last - 1]), error), network[last]);
+
+  for (size_t i = last - 1; i > 0; --i)
+  {
+    boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
+        outputParameterVisitor, network[i]),
+        boost::apply_visitor(deltaVisitor, network[i + 1]),
+        boost::apply_visitor(deltaVisitor, network[i])), network[i]);
+    boost::apply_visitor(GradientVisitor(boost::apply_visitor(
+        outputParameterVisitor, network[i - 1]),
+        boost::apply_visitor(deltaVisitor, network[i + 1])), network[i]);
+  }
+
+  boost::apply_visitor(GradientVisitor(input,
+      boost::apply_visitor(deltaVisitor, network[1])), network.front());
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+arma::mat& FFN<OutputLayerType, InitializationRuleType,
+               CustomLayers...>::ArenaBuffer(const size_t index)
+{
+  if (index < network.size())
+    return boost::apply_visitor(outputParameterVisitor, network[index]);
+  else if (index < 2 * network.size())
+    return boost::apply_visitor(deltaVisitor, network[index - network.size()]);
+  else
+    return error;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+bool FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::BindArena(const size_t batchSize)
+{
+  typename std::map<size_t, arma::umat>::const_iterator it =
+      arenaPlans.find(batchSize);
+  if (it == arenaPlans.end() || it->second.n_cols != 2 * network.size() + 1)
+    return false;
+
+  const arma::umat& plan = it->second;
+  for (size_t i = 0; i < plan.n_cols; ++i)
+  {
+    // Buffers that are not used are left alone.
+    if (plan(0, i) == 0)
+      continue;
+
+    // A layer that wrote an output or delta of another size has its own
+    // memory, and is rebound (without allocating) here.
+    arma::mat& buffer = ArenaBuffer(i);
+    double* memory = arena.data() + plan(2, i);
+    if (buffer.memptr() != memory || buffer.n_rows != plan(0, i) ||
+        buffer.n_cols != plan(1, i))
+    {
+      buffer = arma::mat(memory, plan(0, i), plan(1, i), false, false);
+    }
+  }
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::ReleaseArena()
+{
+  if (arena.empty())
+    return;
+
+  std::less<const double*> less;
+  for (size_t i = 0; i < 2 * network.size() + 1; ++i)
+  {
+    arma::mat& buffer = ArenaBuffer(i);
+    if (!less(buffer.memptr(), arena.data()) &&
+        less(buffer.memptr(), arena.data() + arena.size()))
+    {
+      buffer.reset();
+    }
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... CustomLayers>
+void FFN<OutputLayerType, InitializationRuleType,
+         CustomLayers...>::PlanArena(const size_t batchSize)
+{
+  // A buffer that doesn't own its memory (mem_state != 0) after a step without
+  // the arena is a view the layer made itself (for instance, of the delta of
+  // the next layer), so it is left to the layer.  In that case, the deltas
+  // can't share buffers either.
+  const size_t buffers = 2 * network.size() + 1;
+  arma::umat plan(3, buffers, arma::fill::zeros);
+  bool shareDeltas = true;
+  for (size_t i = 0; i < buffers; ++i)
+  {
+    // The delta of the first layer is never computed.
+    const arma::mat& buffer = ArenaBuffer(i);
+    if (i == network.size() || buffer.is_empty())
+      continue;
+
+    if (buffer.mem_state != 0)
+    {
+      shareDeltas = false;
+      continue;
+    }
+
+    plan(0, i) = buffer.n_rows;
+    plan(1, i) = buffer.n_cols;
+  }
+
+  // Every output is needed until the gradient of the following layer is
+  // computed, so each one gets its own buffer, as does the error.  Otherwise,
+  // the deltas of every second layer share a buffer.
+  size_t size = 0;
+  size_t deltaSize[2] = { 0, 0 };
+  for (size_t i = 0; i < buffers; ++i)
+  {
+    const size_t elements = plan(0, i) * plan(1, i);
+    if (shareDeltas && i >= network.size() && i < 2 * network.size())
+    {
+      deltaSize[i % 2] = std::max(deltaSize[i % 2], elements);
+    }
+    else
+    {
+      plan(2, i) = size;
+      size += elements;
+    }
+  }
+
+  if (shareDeltas)
+  {
+    for (size_t i = network.size(); i < 2 * network.size(); ++i)
+      plan(2, i) = size + (i % 2) * deltaSize[0];
+    size += deltaSize[0] + deltaSize[1];
+  }
+
+  // No buffer is a view of the arena during a step without it.
+  if (size > arena.size())
+    arena.resize(size);
+
+  arenaPlans[batchSize] = std::move(plan);
+}
+
 template<typename OutputLayerType, typename InitializationRuleType,
          typename... CustomLayers>
 template<typename InputType>
@@ -566,6 +881,8 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
   // Be sure to clear other layers before loading.
   if (cereal::is_loading<Archive>())
   {
+    ResetReplicas();
+    arenaPlans.clear();
     std::for_each(network.begin(), network.end(),
         boost::apply_visitor(deleteVisitor));
     network.clear();
@@ -611,6 +928,11 @@ void FFN<OutputLayerType, InitializationRuleType,
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(replicas, network.replicas);
+  std::swap(replicaNetworks, network.replicaNetworks);
+  std::swap(activationArena, network.activationArena);
+  std::swap(arena, network.arena);
+  std::swap(arenaPlans, network.arenaPlans);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
@@ -631,7 +953,9 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    replicas(network.replicas),
+    activationArena(network.activationArena)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -660,7 +984,12 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    replicas(network.replicas),
+    replicaNetworks(std::move(network.replicaNetworks)),
+    activationArena(network.activationArena),
+    arena(std::move(network.arena)),
+    arenaPlans(std::move(network.arenaPlans))
 {
   this->network = std::move(network.network);
 };
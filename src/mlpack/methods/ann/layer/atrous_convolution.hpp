@@ -19,6 +19,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 #include <mlpack/core/util/to_lower.hpp>
 
 #include "layer_types.hpp"
@@ -34,6 +35,10 @@ namespace ann /** Artificial Neural Network. */ {
  * spaces included between the kernel cells, in order to capture a larger
  * field of reception, without having to increase dicrete kernel sizes.
  *
+ * By default, the convolutions are computed with Im2ColConvolution, which
+ * handles the whole batch with a single matrix multiplication in each of the
+ * forward pass, the backward pass and the gradient computation.
+ *
  * @tparam ForwardConvolutionRule Atrous Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Atrous Convolution to perform backward process.
  * @tparam GradientConvolutionRule Atrous Convolution to calculate gradient.
@@ -43,9 +48,9 @@ namespace ann /** Artificial Neural Network. */ {
  *         arma::sp_mat or arma::cube).
  */
 template <
-    typename ForwardConvolutionRule = NaiveConvolution<ValidConvolution>,
-    typename BackwardConvolutionRule = NaiveConvolution<FullConvolution>,
-    typename GradientConvolutionRule = NaiveConvolution<ValidConvolution>,
+    typename ForwardConvolutionRule = Im2ColConvolution<ValidConvolution>,
+    typename BackwardConvolutionRule = Im2ColConvolution<FullConvolution>,
+    typename GradientConvolutionRule = Im2ColConvolution<ValidConvolution>,
     typename InputDataType = arma::mat,
     typename OutputDataType = arma::mat
 >
@@ -307,6 +312,58 @@ class AtrousConvolution
                              size_t& padHBottom,
                              size_t& padHTop) const;
 
+  /*
+   * Convolve the given (padded) input with the filters of the layer, one pair
+   * of maps at a time, and store the result in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Convolve the given (padded) input with the filters of the layer, for the
+   * whole batch at once, and store the result in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, one
+   * pair of maps at a time, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, for
+   * the whole batch at once, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the filters from the given (padded)
+   * input and error, one pair of maps at a time.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
+  /*
+   * Compute the gradient with respect to the filters from the given (padded)
+   * input and error, for the whole batch at once.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
   /*
    * Rotates a 3rd-order tensor counterclockwise by 180 degrees.
    *
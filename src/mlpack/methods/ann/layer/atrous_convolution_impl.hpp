@@ -209,6 +209,176 @@ void AtrousConvolution<
   output.set_size(wConv * hConv * outSize, batchSize);
   outputTemp = arma::Cube<eT>(output.memptr(), wConv, hConv,
       outSize * batchSize, false, false);
+
+  if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
+      padding.PadHTop() != 0 || padding.PadHBottom() != 0)
+    ForwardConvolution(inputPaddedTemp);
+  else
+    ForwardConvolution(inputTemp);
+
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
+    outputTemp.slice(outMap) += bias(outMap % outSize);
+
+  outputWidth = outputTemp.n_rows;
+  outputHeight = outputTemp.n_cols;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Backward(
+    const arma::Mat<eT>& /* input */, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
+{
+  arma::cube mappedError(((arma::Mat<eT>&) gy).memptr(), outputWidth,
+      outputHeight, outSize * batchSize, false, false);
+
+  g.set_size(inputWidth * inputHeight * inSize, batchSize);
+  gTemp = arma::Cube<eT>(g.memptr(), inputWidth, inputHeight,
+      inSize * batchSize, false, false);
+
+  BackwardConvolution(mappedError);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Gradient(
+    const arma::Mat<eT>& input,
+    const arma::Mat<eT>& error,
+    arma::Mat<eT>& gradient)
+{
+  arma::cube mappedError(((arma::Mat<eT>&) error).memptr(), outputWidth,
+      outputHeight, outSize * batchSize, false, false);
+  arma::cube inputTemp(const_cast<arma::Mat<eT>&>(input).memptr(),
+      inputWidth, inputHeight, inSize * batchSize, false, false);
+
+  gradient.set_size(weights.n_elem, 1);
+
+  if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
+      padding.PadHTop() != 0 || padding.PadHBottom() != 0)
+    GradientConvolution(inputPaddedTemp, mappedError, gradient);
+  else
+    GradientConvolution(inputTemp, mappedError, gradient);
+
+  // The gradient of the bias of each output map is the sum of its error over
+  // the whole batch.
+  gradient.rows(weight.n_elem, gradient.n_rows - 1).zeros();
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
+  {
+    gradient(weight.n_elem + (outMap % outSize)) +=
+        arma::accu(mappedError.slice(outMap));
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename Archive>
+void AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::serialize(Archive& ar, const uint32_t /* version */)
+{
+  ar(CEREAL_NVP(inSize));
+  ar(CEREAL_NVP(outSize));
+  ar(CEREAL_NVP(batchSize));
+  ar(CEREAL_NVP(kernelWidth));
+  ar(CEREAL_NVP(kernelHeight));
+  ar(CEREAL_NVP(strideWidth));
+  ar(CEREAL_NVP(strideHeight));
+  ar(CEREAL_NVP(inputWidth));
+  ar(CEREAL_NVP(inputHeight));
+  ar(CEREAL_NVP(outputWidth));
+  ar(CEREAL_NVP(outputHeight));
+  ar(CEREAL_NVP(dilationWidth));
+  ar(CEREAL_NVP(dilationHeight));
+  ar(CEREAL_NVP(padding));
+
+  if (cereal::is_loading<Archive>())
+  {
+    weights.set_size((outSize * inSize * kernelWidth * kernelHeight) + outSize,
+        1);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+void AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::InitializeSamePadding(size_t& padWLeft,
+                         size_t& padWRight,
+                         size_t& padHTop,
+                         size_t& padHBottom) const
+{
+  /*
+   * Using O = (W - F + 2P) / s + 1;
+   */
+  size_t totalVerticalPadding = (strideWidth - 1) * inputWidth + kernelWidth -
+      strideWidth + (dilationWidth - 1) * (kernelWidth - 1);
+  size_t totalHorizontalPadding = (strideHeight - 1) * inputHeight +
+      kernelHeight - strideHeight + (dilationHeight - 1) * (kernelHeight - 1);
+
+  padWLeft = totalVerticalPadding / 2;
+  padWRight = totalVerticalPadding - totalVerticalPadding / 2;
+  padHTop = totalHorizontalPadding / 2;
+  padHBottom = totalHorizontalPadding - totalHorizontalPadding / 2;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardConvolution(const arma::Cube<eT>& input)
+{
   outputTemp.zeros();
 
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
@@ -223,29 +393,13 @@ void AtrousConvolution<
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
       arma::Mat<eT> convOutput;
-
-      if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
-          padding.PadHTop() != 0 || padding.PadHBottom() != 0)
-      {
-        ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap +
-            batchCount * inSize), weight.slice(outMapIdx), convOutput,
-            strideWidth, strideHeight, dilationWidth, dilationHeight);
-      }
-      else
-      {
-        ForwardConvolutionRule::Convolution(inputTemp.slice(inMap +
-            batchCount * inSize), weight.slice(outMapIdx), convOutput,
-            strideWidth, strideHeight, dilationWidth, dilationHeight);
-      }
+      RuleType::Convolution(input.slice(inMap + batchCount * inSize),
+          weight.slice(outMapIdx), convOutput, strideWidth, strideHeight,
+          dilationWidth, dilationHeight);
 
       outputTemp.slice(outMap) += convOutput;
     }
-
-    outputTemp.slice(outMap) += bias(outMap % outSize);
   }
-
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
 }
 
 template<
@@ -255,22 +409,41 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename eT>
-void AtrousConvolution<
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::Backward(
-    const arma::Mat<eT>& /* input */, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
+>::ForwardConvolution(const arma::Cube<eT>& input)
 {
-  arma::cube mappedError(((arma::Mat<eT>&) gy).memptr(), outputWidth,
-      outputHeight, outSize * batchSize, false, false);
+  // Column o of the filter matrix holds the filters of output map o.
+  const arma::Mat<eT> filters(weight.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
 
-  g.set_size(inputWidth * inputHeight * inSize, batchSize);
-  gTemp = arma::Cube<eT>(g.memptr(), inputWidth, inputHeight,
-      inSize * batchSize, false, false);
+  RuleType::BatchConvolution(input, filters, outputTemp, kernelWidth,
+      kernelHeight, strideWidth, strideHeight, dilationWidth, dilationHeight);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardConvolution(const arma::Cube<eT>& error)
+{
   gTemp.zeros();
 
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
@@ -287,9 +460,8 @@ void AtrousConvolution<
       arma::Mat<eT> output, rotatedFilter;
       Rotate180(weight.slice(outMapIdx), rotatedFilter);
 
-      BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
-          rotatedFilter, output, strideWidth, strideHeight, dilationWidth,
-          dilationHeight);
+      RuleType::Convolution(error.slice(outMap), rotatedFilter, output,
+          strideWidth, strideHeight, dilationWidth, dilationHeight);
 
       if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
           padding.PadHTop() != 0 || padding.PadHBottom() != 0)
@@ -314,24 +486,63 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename eT>
-void AtrousConvolution<
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::Gradient(
-    const arma::Mat<eT>& input,
-    const arma::Mat<eT>& error,
-    arma::Mat<eT>& gradient)
+>::BackwardConvolution(const arma::Cube<eT>& error)
 {
-  arma::cube mappedError(((arma::Mat<eT>&) error).memptr(), outputWidth,
-      outputHeight, outSize * batchSize, false, false);
-  arma::cube inputTemp(const_cast<arma::Mat<eT>&>(input).memptr(),
-      inputWidth, inputHeight, inSize * batchSize, false, false);
+  const arma::Mat<eT> filters(weight.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
 
-  gradient.set_size(weights.n_elem, 1);
+  if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
+      padding.PadHTop() != 0 || padding.PadHBottom() != 0)
+  {
+    // Compute the gradient with respect to the padded input, and then drop
+    // the padding.
+    arma::Cube<eT> paddedGradient(
+        inputWidth + padding.PadWLeft() + padding.PadWRight(),
+        inputHeight + padding.PadHTop() + padding.PadHBottom(),
+        inSize * batchSize);
+    RuleType::BatchInputGradient(error, filters, paddedGradient, kernelWidth,
+        kernelHeight, strideWidth, strideHeight, dilationWidth,
+        dilationHeight);
+
+    gTemp = paddedGradient.tube(padding.PadWLeft(), padding.PadHTop(),
+        padding.PadWLeft() + inputWidth - 1,
+        padding.PadHTop() + inputHeight - 1);
+  }
+  else
+  {
+    RuleType::BatchInputGradient(error, filters, gTemp, kernelWidth,
+        kernelHeight, strideWidth, strideHeight, dilationWidth,
+        dilationHeight);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
+{
   gradientTemp = arma::Cube<eT>(gradient.memptr(), weight.n_rows,
       weight.n_cols, weight.n_slices, false, false);
   gradientTemp.zeros();
@@ -347,22 +558,12 @@ void AtrousConvolution<
 
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
-      arma::Mat<eT> inputSlice;
-      if (padding.PadWLeft() != 0 || padding.PadWRight() != 0 ||
-          padding.PadHTop() != 0 || padding.PadHBottom() != 0)
-      {
-        inputSlice = inputPaddedTemp.slice(inMap + batchCount * inSize);
-      }
-      else
-      {
-        inputSlice = inputTemp.slice(inMap + batchCount * inSize);
-      }
-
-      arma::Mat<eT> deltaSlice = mappedError.slice(outMap);
+      arma::Mat<eT> inputSlice = input.slice(inMap + batchCount * inSize);
+      arma::Mat<eT> deltaSlice = error.slice(outMap);
 
       arma::Mat<eT> output;
-      GradientConvolutionRule::Convolution(inputSlice, deltaSlice,
-          output, strideWidth, strideHeight, 1, 1);
+      RuleType::Convolution(inputSlice, deltaSlice, output, strideWidth,
+          strideHeight, 1, 1);
 
       if (dilationHeight > 1)
       {
@@ -394,47 +595,6 @@ void AtrousConvolution<
         gradientTemp.slice(outMapIdx) += output;
       }
     }
-
-    gradient.submat(weight.n_elem + (outMap % outSize), 0, weight.n_elem +
-        (outMap % outSize), 0) = arma::accu(mappedError.slice(outMap));
-  }
-}
-
-template<
-    typename ForwardConvolutionRule,
-    typename BackwardConvolutionRule,
-    typename GradientConvolutionRule,
-    typename InputDataType,
-    typename OutputDataType
->
-template<typename Archive>
-void AtrousConvolution<
-    ForwardConvolutionRule,
-    BackwardConvolutionRule,
-    GradientConvolutionRule,
-    InputDataType,
-    OutputDataType
->::serialize(Archive& ar, const uint32_t /* version */)
-{
-  ar(CEREAL_NVP(inSize));
-  ar(CEREAL_NVP(outSize));
-  ar(CEREAL_NVP(batchSize));
-  ar(CEREAL_NVP(kernelWidth));
-  ar(CEREAL_NVP(kernelHeight));
-  ar(CEREAL_NVP(strideWidth));
-  ar(CEREAL_NVP(strideHeight));
-  ar(CEREAL_NVP(inputWidth));
-  ar(CEREAL_NVP(inputHeight));
-  ar(CEREAL_NVP(outputWidth));
-  ar(CEREAL_NVP(outputHeight));
-  ar(CEREAL_NVP(dilationWidth));
-  ar(CEREAL_NVP(dilationHeight));
-  ar(CEREAL_NVP(padding));
-
-  if (cereal::is_loading<Archive>())
-  {
-    weights.set_size((outSize * inSize * kernelWidth * kernelHeight) + outSize,
-        1);
   }
 }
 
@@ -445,29 +605,25 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-void AtrousConvolution<
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+AtrousConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::InitializeSamePadding(size_t& padWLeft,
-                         size_t& padWRight,
-                         size_t& padHTop,
-                         size_t& padHBottom) const
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
 {
-  /*
-   * Using O = (W - F + 2P) / s + 1;
-   */
-  size_t totalVerticalPadding = (strideWidth - 1) * inputWidth + kernelWidth -
-      strideWidth + (dilationWidth - 1) * (kernelWidth - 1);
-  size_t totalHorizontalPadding = (strideHeight - 1) * inputHeight +
-      kernelHeight - strideHeight + (dilationHeight - 1) * (kernelHeight - 1);
+  // The filters come first in the gradient, in the layout of the filter
+  // matrix.
+  arma::Mat<eT> filterGradient(gradient.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
 
-  padWLeft = totalVerticalPadding / 2;
-  padWRight = totalVerticalPadding - totalVerticalPadding / 2;
-  padHTop = totalHorizontalPadding / 2;
-  padHBottom = totalHorizontalPadding - totalHorizontalPadding / 2;
+  RuleType::BatchFilterGradient(input, error, filterGradient, kernelWidth,
+      kernelHeight, strideWidth, strideHeight, dilationWidth, dilationHeight);
 }
 
 } // namespace ann
@@ -18,6 +18,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 #include <mlpack/core/util/to_lower.hpp>
 
 #include "layer_types.hpp"
@@ -59,6 +60,12 @@ namespace ann /** Artificial Neural Network. */ {
  * a 2-D image (or object) of the original 196x14 size, using this as the input
  * for the 14 filters of this example.
  *
+ * By default, the convolutions are computed with Im2ColConvolution, which
+ * handles the whole batch with a single matrix multiplication in each of the
+ * forward pass, the backward pass and the gradient computation.  Other rules
+ * (NaiveConvolution, FFTConvolution, SVDConvolution) convolve one pair of maps
+ * at a time.
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -68,9 +75,9 @@ namespace ann /** Artificial Neural Network. */ {
  *         arma::sp_mat or arma::cube).
  */
 template <
-    typename ForwardConvolutionRule = NaiveConvolution<ValidConvolution>,
-    typename BackwardConvolutionRule = NaiveConvolution<FullConvolution>,
-    typename GradientConvolutionRule = NaiveConvolution<ValidConvolution>,
+    typename ForwardConvolutionRule = Im2ColConvolution<ValidConvolution>,
+    typename BackwardConvolutionRule = Im2ColConvolution<FullConvolution>,
+    typename GradientConvolutionRule = Im2ColConvolution<ValidConvolution>,
     typename InputDataType = arma::mat,
     typename OutputDataType = arma::mat
 >
@@ -325,6 +332,58 @@ class Convolution
    */
   void InitializeSamePadding();
 
+  /*
+   * Convolve the given (padded) input with the filters of the layer, one pair
+   * of maps at a time, and store the result in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Convolve the given (padded) input with the filters of the layer, for the
+   * whole batch at once, and store the result in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, one
+   * pair of maps at a time, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, for
+   * the whole batch at once, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the filters from the given (padded)
+   * input and error, one pair of maps at a time.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
+  /*
+   * Compute the gradient with respect to the filters from the given (padded)
+   * input and error, for the whole batch at once.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
   /*
    * Rotates a 3rd-order tensor counterclockwise by 180 degrees.
    *
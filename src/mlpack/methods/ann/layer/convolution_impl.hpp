@@ -197,39 +197,14 @@ void Convolution<
   output.set_size(wConv * hConv * outSize, batchSize);
   outputTemp = arma::Cube<eT>(output.memptr(), wConv, hConv,
       outSize * batchSize, false, false);
-  outputTemp.zeros();
-
-  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
-      outSize * batchSize; outMap++)
-  {
-    if (outMap != 0 && outMap % outSize == 0)
-    {
-      batchCount++;
-      outMapIdx = 0;
-    }
-
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> convOutput;
 
-      if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
-      {
-        ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap +
-            batchCount * inSize), weight.slice(outMapIdx), convOutput,
-            strideWidth, strideHeight);
-      }
-      else
-      {
-        ForwardConvolutionRule::Convolution(inputTemp.slice(inMap +
-            batchCount * inSize), weight.slice(outMapIdx), convOutput,
-            strideWidth, strideHeight);
-      }
-
-      outputTemp.slice(outMap) += convOutput;
-    }
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+    ForwardConvolution(inputPaddedTemp);
+  else
+    ForwardConvolution(inputTemp);
 
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
     outputTemp.slice(outMap) += bias(outMap % outSize);
-  }
 
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
@@ -258,36 +233,8 @@ void Convolution<
   g.set_size(inputWidth * inputHeight * inSize, batchSize);
   gTemp = arma::Cube<eT>(g.memptr(), inputWidth, inputHeight,
       inSize * batchSize, false, false);
-  gTemp.zeros();
-
-  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
-      outSize * batchSize; outMap++)
-  {
-    if (outMap != 0 && outMap % outSize == 0)
-    {
-      batchCount++;
-      outMapIdx = 0;
-    }
 
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> output, rotatedFilter;
-      Rotate180(weight.slice(outMapIdx), rotatedFilter);
-
-      BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
-          rotatedFilter, output, strideWidth, strideHeight);
-
-      if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
-      {
-        gTemp.slice(inMap + batchCount * inSize) += output.submat(padWLeft,
-            padHTop, padWLeft + gTemp.n_rows - 1, padHTop + gTemp.n_cols - 1);
-      }
-      else
-      {
-        gTemp.slice(inMap + batchCount * inSize) += output;
-      }
-    }
-  }
+  BackwardConvolution(mappedError);
 }
 
 template<
@@ -315,57 +262,19 @@ void Convolution<
       inputHeight, inSize * batchSize, false, false);
 
   gradient.set_size(weights.n_elem, 1);
-  gradientTemp = arma::Cube<eT>(gradient.memptr(), weight.n_rows,
-      weight.n_cols, weight.n_slices, false, false);
-  gradientTemp.zeros();
 
-  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
-      outSize * batchSize; outMap++)
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+    GradientConvolution(inputPaddedTemp, mappedError, gradient);
+  else
+    GradientConvolution(inputTemp, mappedError, gradient);
+
+  // The gradient of the bias of each output map is the sum of its error over
+  // the whole batch.
+  gradient.rows(weight.n_elem, gradient.n_rows - 1).zeros();
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
   {
-    if (outMap != 0 && outMap % outSize == 0)
-    {
-      batchCount++;
-      outMapIdx = 0;
-    }
-
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> inputSlice;
-      if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
-      {
-        inputSlice = inputPaddedTemp.slice(inMap + batchCount * inSize);
-      }
-      else
-      {
-        inputSlice = inputTemp.slice(inMap + batchCount * inSize);
-      }
-
-      arma::Mat<eT> deltaSlice = mappedError.slice(outMap);
-
-      arma::Mat<eT> output;
-      GradientConvolutionRule::Convolution(inputSlice, deltaSlice,
-          output, strideWidth, strideHeight);
-
-      if (gradientTemp.n_rows < output.n_rows ||
-          gradientTemp.n_cols < output.n_cols)
-      {
-        gradientTemp.slice(outMapIdx) += output.submat(0, 0,
-            gradientTemp.n_rows - 1, gradientTemp.n_cols - 1);
-      }
-      else if (gradientTemp.n_rows > output.n_rows ||
-          gradientTemp.n_cols > output.n_cols)
-      {
-        gradientTemp.slice(outMapIdx).submat(0, 0, output.n_rows - 1,
-            output.n_cols - 1) += output;
-      }
-      else
-      {
-        gradientTemp.slice(outMapIdx) += output;
-      }
-    }
-
-    gradient.submat(weight.n_elem + (outMap % outSize), 0, weight.n_elem +
-        (outMap % outSize), 0) = arma::accu(mappedError.slice(outMap));
+    gradient(weight.n_elem + (outMap % outSize)) +=
+        arma::accu(mappedError.slice(outMap));
   }
 }
 
@@ -438,6 +347,247 @@ void Convolution<
   padHBottom = totalHorizontalPadding - totalHorizontalPadding / 2;
 }
 
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardConvolution(const arma::Cube<eT>& input)
+{
+  outputTemp.zeros();
+
+  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
+      outSize * batchSize; outMap++)
+  {
+    if (outMap != 0 && outMap % outSize == 0)
+    {
+      batchCount++;
+      outMapIdx = 0;
+    }
+
+    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
+    {
+      arma::Mat<eT> convOutput;
+      RuleType::Convolution(input.slice(inMap + batchCount * inSize),
+          weight.slice(outMapIdx), convOutput, strideWidth, strideHeight);
+
+      outputTemp.slice(outMap) += convOutput;
+    }
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardConvolution(const arma::Cube<eT>& input)
+{
+  // Column o of the filter matrix holds the filters of output map o.
+  const arma::Mat<eT> filters(weight.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
+
+  RuleType::BatchConvolution(input, filters, outputTemp, kernelWidth,
+      kernelHeight, strideWidth, strideHeight);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardConvolution(const arma::Cube<eT>& error)
+{
+  gTemp.zeros();
+
+  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
+      outSize * batchSize; outMap++)
+  {
+    if (outMap != 0 && outMap % outSize == 0)
+    {
+      batchCount++;
+      outMapIdx = 0;
+    }
+
+    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
+    {
+      arma::Mat<eT> output, rotatedFilter;
+      Rotate180(weight.slice(outMapIdx), rotatedFilter);
+
+      RuleType::Convolution(error.slice(outMap), rotatedFilter, output,
+          strideWidth, strideHeight);
+
+      if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+      {
+        gTemp.slice(inMap + batchCount * inSize) += output.submat(padWLeft,
+            padHTop, padWLeft + gTemp.n_rows - 1, padHTop + gTemp.n_cols - 1);
+      }
+      else
+      {
+        gTemp.slice(inMap + batchCount * inSize) += output;
+      }
+    }
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardConvolution(const arma::Cube<eT>& error)
+{
+  const arma::Mat<eT> filters(weight.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
+
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+  {
+    // Compute the gradient with respect to the padded input, and then drop
+    // the padding.
+    arma::Cube<eT> paddedGradient(inputWidth + padWLeft + padWRight,
+        inputHeight + padHTop + padHBottom, inSize * batchSize);
+    RuleType::BatchInputGradient(error, filters, paddedGradient, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+
+    gTemp = paddedGradient.tube(padWLeft, padHTop,
+        padWLeft + inputWidth - 1, padHTop + inputHeight - 1);
+  }
+  else
+  {
+    RuleType::BatchInputGradient(error, filters, gTemp, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
+{
+  gradientTemp = arma::Cube<eT>(gradient.memptr(), weight.n_rows,
+      weight.n_cols, weight.n_slices, false, false);
+  gradientTemp.zeros();
+
+  for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
+      outSize * batchSize; outMap++)
+  {
+    if (outMap != 0 && outMap % outSize == 0)
+    {
+      batchCount++;
+      outMapIdx = 0;
+    }
+
+    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
+    {
+      arma::Mat<eT> inputSlice = input.slice(inMap + batchCount * inSize);
+      arma::Mat<eT> deltaSlice = error.slice(outMap);
+
+      arma::Mat<eT> output;
+      RuleType::Convolution(inputSlice, deltaSlice, output, strideWidth,
+          strideHeight);
+
+      if (gradientTemp.n_rows < output.n_rows ||
+          gradientTemp.n_cols < output.n_cols)
+      {
+        gradientTemp.slice(outMapIdx) += output.submat(0, 0,
+            gradientTemp.n_rows - 1, gradientTemp.n_cols - 1);
+      }
+      else if (gradientTemp.n_rows > output.n_rows ||
+          gradientTemp.n_cols > output.n_cols)
+      {
+        gradientTemp.slice(outMapIdx).submat(0, 0, output.n_rows - 1,
+            output.n_cols - 1) += output;
+      }
+      else
+      {
+        gradientTemp.slice(outMapIdx) += output;
+      }
+    }
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
+{
+  // The filters come first in the gradient, in the layout of the filter
+  // matrix.
+  arma::Mat<eT> filterGradient(gradient.memptr(), kernelWidth * kernelHeight *
+      inSize, outSize, false, true);
+
+  RuleType::BatchFilterGradient(input, error, filterGradient, kernelWidth,
+      kernelHeight, strideWidth, strideHeight);
+}
+
 } // namespace ann
 } // namespace mlpack
 
@@ -63,6 +63,7 @@
 // Convolution modules.
 #include <mlpack/methods/ann/convolution_rules/border_modes.hpp>
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 
 // Regularizers.
@@ -255,9 +256,9 @@ using LayerTypes = boost::variant<
     Add<arma::mat, arma::mat>*,
     AddMerge<arma::mat, arma::mat>*,
     AlphaDropout<arma::mat, arma::mat>*,
-    AtrousConvolution<NaiveConvolution<ValidConvolution>,
-                      NaiveConvolution<FullConvolution>,
-                      NaiveConvolution<ValidConvolution>,
+    AtrousConvolution<Im2ColConvolution<ValidConvolution>,
+                      Im2ColConvolution<FullConvolution>,
+                      Im2ColConvolution<ValidConvolution>,
                       arma::mat, arma::mat>*,
     BaseLayer<LogisticFunction, arma::mat, arma::mat>*,
     BaseLayer<IdentityFunction, arma::mat, arma::mat>*,
@@ -272,9 +273,9 @@ using LayerTypes = boost::variant<
     ConcatPerformance<NegativeLogLikelihood<arma::mat, arma::mat>,
                       arma::mat, arma::mat>*,
     Constant<arma::mat, arma::mat>*,
-    Convolution<NaiveConvolution<ValidConvolution>,
-                NaiveConvolution<FullConvolution>,
-                NaiveConvolution<ValidConvolution>, arma::mat, arma::mat>*,
+    Convolution<Im2ColConvolution<ValidConvolution>,
+                Im2ColConvolution<FullConvolution>,
+                Im2ColConvolution<ValidConvolution>, arma::mat, arma::mat>*,
     CReLU<arma::mat, arma::mat>*,
     DropConnect<arma::mat, arma::mat>*,
     Dropout<arma::mat, arma::mat>*,
@@ -302,9 +303,9 @@ using LayerTypes = boost::variant<
     Sequential<arma::mat, arma::mat, false>*,
     Sequential<arma::mat, arma::mat, true>*,
     Softmax<arma::mat, arma::mat>*,
-    TransposedConvolution<NaiveConvolution<ValidConvolution>,
-            NaiveConvolution<ValidConvolution>,
-            NaiveConvolution<ValidConvolution>, arma::mat, arma::mat>*,
+    TransposedConvolution<Im2ColConvolution<ValidConvolution>,
+            Im2ColConvolution<ValidConvolution>,
+            Im2ColConvolution<ValidConvolution>, arma::mat, arma::mat>*,
     WeightNorm<arma::mat, arma::mat>*,
     MoreTypes,
     CustomLayers*...
@@ -19,6 +19,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 #include <mlpack/core/util/to_lower.hpp>
 
 #include "layer_types.hpp"
@@ -31,6 +32,13 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the Transposed Convolution class. The Transposed
  * Convolution class represents a single layer of a neural network.
  *
+ * By default, the convolutions are computed with Im2ColConvolution.  In that
+ * case the layer is computed as the adjoint of the associated convolution (from
+ * the output maps to the input maps), so that no zeros have to be inserted
+ * into the input, and the whole batch is handled with a single matrix
+ * multiplication in each of the forward pass, the backward pass and the
+ * gradient computation.
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -40,9 +48,9 @@ namespace ann /** Artificial Neural Network. */ {
  *         arma::sp_mat or arma::cube).
  */
 template <
-    typename ForwardConvolutionRule = NaiveConvolution<ValidConvolution>,
-    typename BackwardConvolutionRule = NaiveConvolution<ValidConvolution>,
-    typename GradientConvolutionRule = NaiveConvolution<ValidConvolution>,
+    typename ForwardConvolutionRule = Im2ColConvolution<ValidConvolution>,
+    typename BackwardConvolutionRule = Im2ColConvolution<ValidConvolution>,
+    typename GradientConvolutionRule = Im2ColConvolution<ValidConvolution>,
     typename InputDataType = arma::mat,
     typename OutputDataType = arma::mat
 >
@@ -313,6 +321,87 @@ class TransposedConvolution
    */
   void InitializeSamePadding();
 
+  /*
+   * Compute the output of the layer for the given input, one pair of maps at
+   * a time, and store it in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Compute the output of the layer for the given input, for the whole batch
+   * at once, and store it in outputTemp.
+   */
+  template<typename eT, typename RuleType = ForwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  ForwardConvolution(const arma::Cube<eT>& input);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, one
+   * pair of maps at a time, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the input from the given error, for
+   * the whole batch at once, and store it in gTemp.
+   */
+  template<typename eT, typename RuleType = BackwardConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  BackwardConvolution(const arma::Cube<eT>& error);
+
+  /*
+   * Compute the gradient with respect to the filters from the given input and
+   * error, one pair of maps at a time.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
+  /*
+   * Compute the gradient with respect to the filters from the given input and
+   * error, for the whole batch at once.
+   */
+  template<typename eT, typename RuleType = GradientConvolutionRule>
+  typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+  GradientConvolution(const arma::Cube<eT>& input,
+                      const arma::Cube<eT>& error,
+                      arma::Mat<eT>& gradient);
+
+  /*
+   * Arrange the filters of the layer as the filter matrix of the associated
+   * convolution (from the output maps to the input maps): column c holds the
+   * filters of input map c, one output map after the other.
+   *
+   * @param filters Matrix to store the filters in.
+   */
+  template<typename eT>
+  void TransposedFilters(arma::Mat<eT>& filters);
+
+  /*
+   * Insert zeros into the given input and pad it, and store the result in
+   * inputPaddedTemp (if the stride or the padding are not trivial).
+   *
+   * @param input The input to be expanded.
+   */
+  template<typename eT>
+  void ExpandInput(const arma::Cube<eT>& input);
+
+  /*
+   * Pad the given error with zeros, so that it has the size of the padded
+   * output of the layer.
+   *
+   * @param error The error to be padded.
+   * @param paddedError The padded error.
+   */
+  template<typename eT>
+  void PadError(const arma::Cube<eT>& error, arma::Cube<eT>& paddedError);
+
   /*
    * Rotates a dense matrix counterclockwise by 180 degrees.
    *
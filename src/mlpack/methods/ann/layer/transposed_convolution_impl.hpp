@@ -211,50 +211,178 @@ void TransposedConvolution<
   arma::cube inputTemp(const_cast<arma::Mat<eT>&>(input).memptr(),
       inputWidth, inputHeight, inSize * batchSize, false, false);
 
-  if (strideWidth > 1 || strideHeight > 1)
-  {
-    InsertZeros(inputTemp, strideWidth, strideHeight, inputExpandedTemp);
+  output.set_size(outputWidth * outputHeight * outSize, batchSize);
+  outputTemp = arma::Cube<eT>(output.memptr(), outputWidth, outputHeight,
+      outSize * batchSize, false, false);
 
-    if (paddingForward.PadWLeft() != 0 || paddingForward.PadWRight() != 0 ||
-        paddingForward.PadHTop() != 0 || paddingForward.PadHBottom() != 0)
-    {
-      inputPaddedTemp.set_size(inputExpandedTemp.n_rows +
-          paddingForward.PadWLeft() + paddingForward.PadWRight(),
-          inputExpandedTemp.n_cols + paddingForward.PadHTop() +
-          paddingForward.PadHBottom(), inputExpandedTemp.n_slices);
+  ForwardConvolution(inputTemp);
 
-      for (size_t i = 0; i < inputExpandedTemp.n_slices; ++i)
-      {
-        paddingForward.Forward(inputExpandedTemp.slice(i),
-            inputPaddedTemp.slice(i));
-      }
-    }
-    else
-    {
-      inputPaddedTemp = arma::Cube<eT>(inputExpandedTemp.memptr(),
-          inputExpandedTemp.n_rows, inputExpandedTemp.n_cols,
-          inputExpandedTemp.n_slices, false, false);;
-    }
-  }
-  else if (paddingForward.PadWLeft() != 0 ||
-           paddingForward.PadWRight() != 0 ||
-           paddingForward.PadHTop() != 0 ||
-           paddingForward.PadHBottom() != 0)
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
+    outputTemp.slice(outMap) += bias(outMap % outSize);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Backward(
+    const arma::Mat<eT>& /* input */, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
+{
+  arma::Cube<eT> mappedError(((arma::Mat<eT>&) gy).memptr(), outputWidth,
+      outputHeight, outSize * batchSize, false, false);
+
+  g.set_size(inputWidth * inputHeight * inSize, batchSize);
+  gTemp = arma::Cube<eT>(g.memptr(), inputWidth, inputHeight, inSize *
+      batchSize, false, false);
+
+  BackwardConvolution(mappedError);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Gradient(
+    const arma::Mat<eT>& input,
+    const arma::Mat<eT>& error,
+    arma::Mat<eT>& gradient)
+{
+  arma::Cube<eT> mappedError(((arma::Mat<eT>&) error).memptr(), outputWidth,
+      outputHeight, outSize * batchSize, false, false);
+  arma::cube inputTemp(const_cast<arma::Mat<eT>&>(input).memptr(),
+      inputWidth, inputHeight, inSize * batchSize, false, false);
+
+  gradient.set_size(weights.n_elem, 1);
+
+  GradientConvolution(inputTemp, mappedError, gradient);
+
+  // The gradient of the bias of each output map is the sum of its error over
+  // the whole batch.
+  gradient.rows(weight.n_elem, gradient.n_rows - 1).zeros();
+  for (size_t outMap = 0; outMap < outSize * batchSize; ++outMap)
   {
-    inputPaddedTemp.set_size(inputTemp.n_rows + paddingForward.PadWLeft() +
-        paddingForward.PadWRight(), inputTemp.n_cols +
-        paddingForward.PadHTop() + paddingForward.PadHBottom(),
-        inputTemp.n_slices);
+    gradient(weight.n_elem + (outMap % outSize)) +=
+        arma::accu(mappedError.slice(outMap));
+  }
+}
 
-    for (size_t i = 0; i < inputTemp.n_slices; ++i)
-    {
-      paddingForward.Forward(inputTemp.slice(i), inputPaddedTemp.slice(i));
-    }
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename Archive>
+void TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::serialize(Archive& ar, const uint32_t /* version */)
+{
+  ar(CEREAL_NVP(inSize));
+  ar(CEREAL_NVP(outSize));
+  ar(CEREAL_NVP(batchSize));
+  ar(CEREAL_NVP(kernelWidth));
+  ar(CEREAL_NVP(kernelHeight));
+  ar(CEREAL_NVP(strideWidth));
+  ar(CEREAL_NVP(strideHeight));
+  ar(CEREAL_NVP(padWLeft));
+  ar(CEREAL_NVP(padWRight));
+  ar(CEREAL_NVP(padHBottom));
+  ar(CEREAL_NVP(padHTop));
+  ar(CEREAL_NVP(inputWidth));
+  ar(CEREAL_NVP(inputHeight));
+  ar(CEREAL_NVP(outputWidth));
+  ar(CEREAL_NVP(outputHeight));
+  ar(CEREAL_NVP(paddingForward));
+  ar(CEREAL_NVP(paddingBackward));
+
+  if (cereal::is_loading<Archive>())
+  {
+    weights.set_size((outSize * inSize * kernelWidth * kernelHeight) + outSize,
+        1);
+    size_t totalPadWidth = padWLeft + padWRight;
+    size_t totalPadHeight = padHTop + padHBottom;
+    aW = (outputWidth + kernelWidth - totalPadWidth - 2) % strideWidth;
+    aH = (outputHeight + kernelHeight - totalPadHeight - 2) % strideHeight;
   }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+void TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::InitializeSamePadding(){
+  /**
+   * Using O=s*(I-1) + K -2P + A
+   * where
+   * s=stride 
+   * I=Input Shape
+   * K=Kernel Size
+   * P=Padding
+   */
+  const size_t totalHorizontalPadding  = (strideWidth - 1) * inputWidth +
+      kernelWidth - strideWidth;
+  const size_t totalVerticalPadding = (strideHeight - 1) * inputHeight +
+      kernelHeight - strideHeight;
+
+  padWLeft = totalVerticalPadding / 2;
+  padWRight = totalVerticalPadding - totalVerticalPadding / 2;
+  padHTop = totalHorizontalPadding / 2;
+  padHBottom = totalHorizontalPadding - totalHorizontalPadding / 2;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardConvolution(const arma::Cube<eT>& input)
+{
+  ExpandInput(input);
 
-  output.set_size(outputWidth * outputHeight * outSize, batchSize);
-  outputTemp = arma::Cube<eT>(output.memptr(), outputWidth, outputHeight,
-      outSize * batchSize, false, false);
   outputTemp.zeros();
 
   for (size_t outMap = 0, outMapIdx = 0, batchCount = 0; outMap <
@@ -278,19 +406,56 @@ void TransposedConvolution<
           paddingForward.PadHTop() != 0 ||
           paddingForward.PadHBottom() != 0)
       {
-        ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap +
+        RuleType::Convolution(inputPaddedTemp.slice(inMap +
             batchCount * inSize), rotatedFilter, convOutput, 1, 1);
       }
       else
       {
-        ForwardConvolutionRule::Convolution(inputTemp.slice(inMap +
-            batchCount * inSize), rotatedFilter, convOutput, 1, 1);
+        RuleType::Convolution(input.slice(inMap + batchCount * inSize),
+            rotatedFilter, convOutput, 1, 1);
       }
 
       outputTemp.slice(outMap) += convOutput;
     }
+  }
+}
 
-    outputTemp.slice(outMap) += bias(outMap % outSize);
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardConvolution(const arma::Cube<eT>& input)
+{
+  // The output of the layer is the gradient of the associated convolution
+  // with respect to its (padded) input.
+  arma::Mat<eT> filters;
+  TransposedFilters(filters);
+
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+  {
+    arma::Cube<eT> paddedOutput(outputWidth + padWLeft + padWRight,
+        outputHeight + padHTop + padHBottom, outSize * batchSize);
+    RuleType::BatchInputGradient(input, filters, paddedOutput, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+
+    outputTemp = paddedOutput.tube(padWLeft, padHTop,
+        padWLeft + outputWidth - 1, padHTop + outputHeight - 1);
+  }
+  else
+  {
+    RuleType::BatchInputGradient(input, filters, outputTemp, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
   }
 }
 
@@ -301,36 +466,30 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename eT>
-void TransposedConvolution<
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::Backward(
-    const arma::Mat<eT>& /* input */, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
+>::BackwardConvolution(const arma::Cube<eT>& error)
 {
-  arma::Cube<eT> mappedError(((arma::Mat<eT>&) gy).memptr(), outputWidth,
-      outputHeight, outSize * batchSize, false, false);
   arma::Cube<eT> mappedErrorPadded;
   if (paddingBackward.PadWLeft() != 0 || paddingBackward.PadWRight() != 0 ||
       paddingBackward.PadHTop() != 0 || paddingBackward.PadHBottom() != 0)
   {
-    mappedErrorPadded.set_size(mappedError.n_rows +
+    mappedErrorPadded.set_size(error.n_rows +
         paddingBackward.PadWLeft() + paddingBackward.PadWRight(),
-        mappedError.n_cols + paddingBackward.PadHTop() +
-        paddingBackward.PadHBottom(), mappedError.n_slices);
+        error.n_cols + paddingBackward.PadHTop() +
+        paddingBackward.PadHBottom(), error.n_slices);
 
-    for (size_t i = 0; i < mappedError.n_slices; ++i)
+    for (size_t i = 0; i < error.n_slices; ++i)
     {
-      paddingBackward.Forward(mappedError.slice(i),
-          mappedErrorPadded.slice(i));
+      paddingBackward.Forward(error.slice(i), mappedErrorPadded.slice(i));
     }
   }
-  g.set_size(inputWidth * inputHeight * inSize, batchSize);
-  gTemp = arma::Cube<eT>(g.memptr(), inputWidth, inputHeight, inSize *
-      batchSize, false, false);
 
   gTemp.zeros();
 
@@ -350,13 +509,13 @@ void TransposedConvolution<
       if (paddingBackward.PadWLeft() != 0 || paddingBackward.PadWRight() != 0 ||
           paddingBackward.PadHTop() != 0 || paddingBackward.PadHBottom() != 0)
       {
-        BackwardConvolutionRule::Convolution(mappedErrorPadded.slice(outMap),
+        RuleType::Convolution(mappedErrorPadded.slice(outMap),
             weight.slice(outMapIdx), output, strideWidth, strideHeight);
       }
       else
       {
-        BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
-            weight.slice(outMapIdx), output, strideWidth, strideHeight);
+        RuleType::Convolution(error.slice(outMap), weight.slice(outMapIdx),
+            output, strideWidth, strideHeight);
       }
 
       gTemp.slice(inMap + batchCount * inSize) += output;
@@ -371,24 +530,59 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename eT>
-void TransposedConvolution<
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::Gradient(
-    const arma::Mat<eT>& input,
-    const arma::Mat<eT>& error,
-    arma::Mat<eT>& gradient)
+>::BackwardConvolution(const arma::Cube<eT>& error)
 {
-  arma::Cube<eT> mappedError(((arma::Mat<eT>&) error).memptr(), outputWidth,
-      outputHeight, outSize * batchSize, false, false);
-  arma::cube inputTemp(const_cast<arma::Mat<eT>&>(input).memptr(),
-      inputWidth, inputHeight, inSize * batchSize, false, false);
+  // The gradient with respect to the input is the associated convolution of
+  // the (padded) error.
+  arma::Mat<eT> filters;
+  TransposedFilters(filters);
+
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+  {
+    arma::Cube<eT> paddedError;
+    PadError(error, paddedError);
+    RuleType::BatchConvolution(paddedError, filters, gTemp, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+  }
+  else
+  {
+    RuleType::BatchConvolution(error, filters, gTemp, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<!SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
+{
+  // The zero-inserted and padded input is only computed by the forward pass
+  // if it convolves one pair of maps at a time.
+  if (SupportsBatchConvolution<ForwardConvolutionRule>::value)
+    ExpandInput(input);
 
-  gradient.set_size(weights.n_elem, 1);
   gradientTemp = arma::Cube<eT>(gradient.memptr(), weight.n_rows,
       weight.n_cols, weight.n_slices, false, false);
   gradientTemp.zeros();
@@ -404,7 +598,7 @@ void TransposedConvolution<
       outMapIdx = 0;
     }
 
-    deltaSlice = mappedError.slice(outMap);
+    deltaSlice = error.slice(outMap);
 
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
@@ -419,17 +613,63 @@ void TransposedConvolution<
       }
       else
       {
-        inputSlice = inputTemp.slice(inMap + batchCount * inSize);
+        inputSlice = input.slice(inMap + batchCount * inSize);
       }
 
-      GradientConvolutionRule::Convolution(inputSlice, deltaSlice,
-          output, 1, 1);
+      RuleType::Convolution(inputSlice, deltaSlice, output, 1, 1);
       Rotate180(output, rotatedOutput);
       gradientTemp.slice(outMapIdx) += rotatedOutput;
     }
+  }
+}
 
-    gradient.submat(weight.n_elem + (outMap % outSize), 0, weight.n_elem +
-        (outMap % outSize), 0) = arma::accu(mappedError.slices(outMap, outMap));
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename RuleType>
+typename std::enable_if<SupportsBatchConvolution<RuleType>::value>::type
+TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientConvolution(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& error,
+                       arma::Mat<eT>& gradient)
+{
+  // The gradient with respect to the filters is the gradient of the
+  // associated convolution, whose input is the (padded) error and whose error
+  // is the input of the layer.
+  const size_t filterSize = kernelWidth * kernelHeight;
+  arma::Mat<eT> filterGradient(filterSize * outSize, inSize);
+
+  if (padWLeft != 0 || padWRight != 0 || padHTop != 0 || padHBottom != 0)
+  {
+    arma::Cube<eT> paddedError;
+    PadError(error, paddedError);
+    RuleType::BatchFilterGradient(paddedError, input, filterGradient,
+        kernelWidth, kernelHeight, strideWidth, strideHeight);
+  }
+  else
+  {
+    RuleType::BatchFilterGradient(error, input, filterGradient, kernelWidth,
+        kernelHeight, strideWidth, strideHeight);
+  }
+
+  // Store the filters in the order of the weights of the layer.
+  for (size_t outMap = 0; outMap < outSize; ++outMap)
+  {
+    for (size_t inMap = 0; inMap < inSize; ++inMap)
+    {
+      const eT* source = filterGradient.colptr(inMap) + outMap * filterSize;
+      std::copy(source, source + filterSize, gradient.memptr() +
+          (outMap * inSize + inMap) * filterSize);
+    }
   }
 }
 
@@ -440,41 +680,26 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename Archive>
+template<typename eT>
 void TransposedConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::serialize(Archive& ar, const uint32_t /* version */)
+>::TransposedFilters(arma::Mat<eT>& filters)
 {
-  ar(CEREAL_NVP(inSize));
-  ar(CEREAL_NVP(outSize));
-  ar(CEREAL_NVP(batchSize));
-  ar(CEREAL_NVP(kernelWidth));
-  ar(CEREAL_NVP(kernelHeight));
-  ar(CEREAL_NVP(strideWidth));
-  ar(CEREAL_NVP(strideHeight));
-  ar(CEREAL_NVP(padWLeft));
-  ar(CEREAL_NVP(padWRight));
-  ar(CEREAL_NVP(padHBottom));
-  ar(CEREAL_NVP(padHTop));
-  ar(CEREAL_NVP(inputWidth));
-  ar(CEREAL_NVP(inputHeight));
-  ar(CEREAL_NVP(outputWidth));
-  ar(CEREAL_NVP(outputHeight));
-  ar(CEREAL_NVP(paddingForward));
-  ar(CEREAL_NVP(paddingBackward));
+  const size_t filterSize = kernelWidth * kernelHeight;
+  filters.set_size(filterSize * outSize, inSize);
 
-  if (cereal::is_loading<Archive>())
+  for (size_t outMap = 0; outMap < outSize; ++outMap)
   {
-    weights.set_size((outSize * inSize * kernelWidth * kernelHeight) + outSize,
-        1);
-    size_t totalPadWidth = padWLeft + padWRight;
-    size_t totalPadHeight = padHTop + padHBottom;
-    aW = (outputWidth + kernelWidth - totalPadWidth - 2) % strideWidth;
-    aH = (outputHeight + kernelHeight - totalPadHeight - 2) % strideHeight;
+    for (size_t inMap = 0; inMap < inSize; ++inMap)
+    {
+      const eT* source = weight.slice_memptr(outMap * inSize + inMap);
+      std::copy(source, source + filterSize, filters.colptr(inMap) +
+          outMap * filterSize);
+    }
   }
 }
 
@@ -485,30 +710,77 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
+template<typename eT>
 void TransposedConvolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::InitializeSamePadding(){
-  /**
-   * Using O=s*(I-1) + K -2P + A
-   * where
-   * s=stride 
-   * I=Input Shape
-   * K=Kernel Size
-   * P=Padding
-   */
-  const size_t totalHorizontalPadding  = (strideWidth - 1) * inputWidth +
-      kernelWidth - strideWidth;
-  const size_t totalVerticalPadding = (strideHeight - 1) * inputHeight +
-      kernelHeight - strideHeight;
+>::ExpandInput(const arma::Cube<eT>& input)
+{
+  if (strideWidth > 1 || strideHeight > 1)
+  {
+    InsertZeros(input, strideWidth, strideHeight, inputExpandedTemp);
 
-  padWLeft = totalVerticalPadding / 2;
-  padWRight = totalVerticalPadding - totalVerticalPadding / 2;
-  padHTop = totalHorizontalPadding / 2;
-  padHBottom = totalHorizontalPadding - totalHorizontalPadding / 2;
+    if (paddingForward.PadWLeft() != 0 || paddingForward.PadWRight() != 0 ||
+        paddingForward.PadHTop() != 0 || paddingForward.PadHBottom() != 0)
+    {
+      inputPaddedTemp.set_size(inputExpandedTemp.n_rows +
+          paddingForward.PadWLeft() + paddingForward.PadWRight(),
+          inputExpandedTemp.n_cols + paddingForward.PadHTop() +
+          paddingForward.PadHBottom(), inputExpandedTemp.n_slices);
+
+      for (size_t i = 0; i < inputExpandedTemp.n_slices; ++i)
+      {
+        paddingForward.Forward(inputExpandedTemp.slice(i),
+            inputPaddedTemp.slice(i));
+      }
+    }
+    else
+    {
+      inputPaddedTemp = arma::Cube<eT>(inputExpandedTemp.memptr(),
+          inputExpandedTemp.n_rows, inputExpandedTemp.n_cols,
+          inputExpandedTemp.n_slices, false, false);;
+    }
+  }
+  else if (paddingForward.PadWLeft() != 0 ||
+           paddingForward.PadWRight() != 0 ||
+           paddingForward.PadHTop() != 0 ||
+           paddingForward.PadHBottom() != 0)
+  {
+    inputPaddedTemp.set_size(input.n_rows + paddingForward.PadWLeft() +
+        paddingForward.PadWRight(), input.n_cols +
+        paddingForward.PadHTop() + paddingForward.PadHBottom(),
+        input.n_slices);
+
+    for (size_t i = 0; i < input.n_slices; ++i)
+    {
+      paddingForward.Forward(input.slice(i), inputPaddedTemp.slice(i));
+    }
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void TransposedConvolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::PadError(const arma::Cube<eT>& error, arma::Cube<eT>& paddedError)
+{
+  paddedError.zeros(error.n_rows + padWLeft + padWRight,
+      error.n_cols + padHTop + padHBottom, error.n_slices);
+  paddedError.tube(padWLeft, padHTop, padWLeft + error.n_rows - 1,
+      padHTop + error.n_cols - 1) = error;
 }
 
 } // namespace ann
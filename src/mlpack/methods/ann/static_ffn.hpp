@@ -0,0 +1,450 @@
+/**
+ * @file methods/ann/static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "visitor/backward_visitor.hpp"
+#include "visitor/delta_visitor.hpp"
+#include "visitor/deterministic_set_visitor.hpp"
+#include "visitor/forward_visitor.hpp"
+#include "visitor/gradient_set_visitor.hpp"
+#include "visitor/gradient_visitor.hpp"
+#include "visitor/input_shape_visitor.hpp"
+#include "visitor/loss_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_parameter_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+#include "visitor/reset_visitor.hpp"
+#include "visitor/set_input_height_visitor.hpp"
+#include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+#include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/ann/init_rules/init_rules_traits.hpp>
+#include <mlpack/methods/ann/init_rules/random_init.hpp>
+#include <ensmallen.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of a feed forward network whose layers are fixed at compile
+ * time.  FFN holds its layers in a std::vector of the LayerTypes variant, so
+ * each call to a layer goes through boost::apply_visitor() and every layer type
+ * of the variant is instantiated.  StaticFFN holds its layers in a std::tuple
+ * instead, so that each call to a layer is resolved at compile time and can be
+ * inlined, and only the given layer types are instantiated.  This is mostly
+ * useful for small networks, where the dispatch overhead is not negligible.
+ *
+ * The layers are given (in order) as the template parameters, and the
+ * instantiated layers to the constructor.  For instance:
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+ *     SigmoidLayer<>, Linear<>, LogSoftMax<>> model(Linear<>(10, 8),
+ *     SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+ * model.Train(data, labels);
+ * @endcode
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam Layers The types of the layers of the network.
+ */
+template<
+  typename OutputLayerType,
+  typename InitializationRuleType,
+  typename... Layers
+>
+class StaticFFN
+{
+ public:
+  /**
+   * Create the StaticFFN object with the given layers.
+   *
+   * @param layers The layers of the network.
+   */
+  StaticFFN(Layers... layers);
+
+  /**
+   * Create the StaticFFN object with the given output layer, initialization
+   * rule and layers.
+   *
+   * @param outputLayer Output layer used to evaluate the network.
+   * @param initializeRule Instantiated InitializationRule object for
+   *        initializing the network parameter.
+   * @param layers The layers of the network.
+   */
+  StaticFFN(OutputLayerType outputLayer,
+            InitializationRuleType initializeRule,
+            Layers... layers);
+
+  //! Copy constructor.
+  StaticFFN(const StaticFFN& network);
+
+  //! Copy assignment operator.
+  StaticFFN& operator=(const StaticFFN& network);
+
+  /**
+   * Train the network on the given input data using the given optimizer.
+   *
+   * This will use the existing model parameters as a starting point for the
+   * optimization. If this is not what you want, then you should access the
+   * parameters vector directly with Parameters() and modify it as desired.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType, typename... CallbackTypes>
+  double Train(arma::mat predictors,
+               arma::mat responses,
+               OptimizerType& optimizer,
+               CallbackTypes&&... callbacks);
+
+  /**
+   * Train the network on the given input data. By default, the RMSProp
+   * optimization algorithm is used, but others can be specified (such as
+   * ens::SGD).
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType = ens::RMSProp, typename... CallbackTypes>
+  double Train(arma::mat predictors,
+               arma::mat responses,
+               CallbackTypes&&... callbacks);
+
+  /**
+   * Predict the responses to a given set of predictors, passing batchSize
+   * points through the network at once.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of points to pass through the network at once.
+   */
+  void Predict(arma::mat predictors,
+               arma::mat& results,
+               const size_t batchSize = 128);
+
+  /**
+   * Evaluate the network with the given parameters on all of the points,
+   * which are passed through the network as a single batch.
+   *
+   * @param parameters Matrix model parameters.
+   */
+  double Evaluate(const arma::mat& parameters);
+
+  /**
+   * Evaluate the network with the given parameters, but using only a number
+   * of data points. This is useful for optimizers such as SGD, which require a
+   * separable objective function.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the network with the given parameters, but using only a number
+   * of data points, in testing mode.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize);
+
+  /**
+   * Evaluate the network and its gradient with the given parameters on all of
+   * the points, which are passed through the network as a single batch.
+   *
+   * @param parameters Matrix model parameters.
+   * @param gradient Matrix to output gradient into.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              arma::mat& gradient);
+
+  /**
+   * Evaluate the network and its gradient with the given parameters, but using
+   * only a number of data points.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize);
+
+  /**
+   * Evaluate the gradient of the network with the given parameters, and with
+   * respect to only a number of points in the dataset.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the starting point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to be processed as a batch for objective
+   *        function gradient evaluation.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  /**
+   * Shuffle the order of function visitation. This may be called by the
+   * optimizer.
+   */
+  void Shuffle();
+
+  //! Get the layers of the network.
+  const std::tuple<Layers...>& Model() const { return layers; }
+  //! Modify the layers of the network.  Be careful!  If you change the
+  //! parameters of the layers, be sure to call ResetParameters() afterwards.
+  std::tuple<Layers...>& Model() { return layers; }
+
+  //! Return the number of separable functions (the number of predictor points).
+  size_t NumFunctions() const { return predictors.n_cols; }
+
+  //! Return the initial point for the optimization.
+  const arma::mat& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.
+  arma::mat& Parameters() { return parameter; }
+
+  //! Get the matrix of responses to the input data points.
+  const arma::mat& Responses() const { return responses; }
+  //! Modify the matrix of responses to the input data points.
+  arma::mat& Responses() { return responses; }
+
+  //! Get the matrix of data points (predictors).
+  const arma::mat& Predictors() const { return predictors; }
+  //! Modify the matrix of data points (predictors).
+  arma::mat& Predictors() { return predictors; }
+
+  /**
+   * Reset the module information (weights/parameters).
+   */
+  void ResetParameters();
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */);
+
+ private:
+  //! Pass the given input through layer I and the following layers.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  Forward(const arma::mat& input);
+
+  //! Nothing is left to pass the input through.
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  Forward(const arma::mat& /* input */) { }
+
+  //! Compute the delta of layer I and the preceding layers (but the first).
+  template<size_t I>
+  typename std::enable_if<(I > 0), void>::type
+  Backward();
+
+  //! The delta of the first layer is not needed.
+  template<size_t I>
+  typename std::enable_if<(I == 0), void>::type
+  Backward() { }
+
+  //! Compute the gradient of layer I and the following layers, given the input
+  //! of layer I.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  Gradient(const arma::mat& input);
+
+  //! There are no layers left to compute the gradient of.
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  Gradient(const arma::mat& /* input */) { }
+
+  //! Get the delta of the layer after layer I.
+  template<size_t I>
+  typename std::enable_if<(I + 1 < sizeof...(Layers)), arma::mat&>::type
+  NextDelta() { return DeltaVisitor()(&std::get<I + 1>(layers)); }
+
+  //! The delta after the last layer is the error of the output layer.
+  template<size_t I>
+  typename std::enable_if<(I + 1 == sizeof...(Layers)), arma::mat&>::type
+  NextDelta() { return error; }
+
+  //! Get the output of the last layer.
+  arma::mat& Output()
+  {
+    return OutputParameterVisitor()(&std::get<sizeof...(Layers) - 1>(layers));
+  }
+
+  //! Get the total number of weights of layer I and the following layers.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+  WeightSize();
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), size_t>::type
+  WeightSize() { return 0; }
+
+  //! Initialize the weights of layer I and the following layers one layer at a
+  //! time, starting at the given offset of the parameters.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  InitializeLayers(const size_t offset);
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  InitializeLayers(const size_t /* offset */) { }
+
+  //! Make the weights of layer I and the following layers use the parameters
+  //! of the network, starting at the given offset.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetWeights(const size_t offset);
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SetWeights(const size_t /* offset */) { }
+
+  //! Make the gradients of layer I and the following layers use the given
+  //! gradient, starting at the given offset.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetGradients(arma::mat& gradient, const size_t offset);
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  SetGradients(arma::mat& /* gradient */, const size_t /* offset */) { }
+
+  //! Set the deterministic parameter of layer I and the following layers.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  ResetDeterministic();
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), void>::type
+  ResetDeterministic() { }
+
+  //! Get the sum of the losses of layer I and the following layers.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), double>::type
+  Loss();
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), double>::type
+  Loss() { return 0; }
+
+  //! Get the input shape of the first layer (starting at layer I) that knows
+  //! its input shape, or 0 if none does.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+  InputShape();
+
+  template<size_t I>
+  typename std::enable_if<(I == sizeof...(Layers)), size_t>::type
+  InputShape() { return 0; }
+
+  /**
+   * Check that the given number of dimensions matches the input shape of the
+   * network.
+   *
+   * @param dimensions Number of dimensions of the input.
+   * @param functionName Name of the calling function, for the error message.
+   */
+  void CheckInputShape(const size_t dimensions,
+                       const std::string& functionName);
+
+  //! Set the deterministic parameter of the layers, if it is different.
+  void SetDeterministic(const bool deterministic);
+
+  /**
+   * Pass the given points through the network, and evaluate the output layer
+   * and the loss of the layers.
+   *
+   * @param begin Index of the first point.
+   * @param batchSize Number of points.
+   */
+  double ForwardBatch(const size_t begin, const size_t batchSize);
+
+  //! Instantiated output layer used to evaluate the network.
+  OutputLayerType outputLayer;
+
+  //! Instantiated InitializationRule object for initializing the network
+  //! parameter.
+  InitializationRuleType initializeRule;
+
+  //! Locally-stored layers of the network.
+  std::tuple<Layers...> layers;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Indicator if the input width and height of the layers are set.
+  bool reset;
+
+  //! The matrix of data points (predictors).
+  arma::mat predictors;
+
+  //! The matrix of responses to the input data points.
+  arma::mat responses;
+
+  //! Matrix of (trained) parameters.
+  arma::mat parameter;
+
+  //! The current error for the backward pass.
+  arma::mat error;
+
+  //! The current evaluation mode (training or testing).
+  bool deterministic;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,496 @@
+/**
+ * @file methods/ann/static_ffn_impl.hpp
+ *
+ * Implementation of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    Layers... layers) :
+    layers(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    deterministic(false)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    OutputLayerType outputLayer,
+    InitializationRuleType initializeRule,
+    Layers... layers) :
+    outputLayer(std::move(outputLayer)),
+    initializeRule(std::move(initializeRule)),
+    layers(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    deterministic(false)
+{
+  /* Nothing to do here. */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    const StaticFFN& network) :
+    outputLayer(network.outputLayer),
+    initializeRule(network.initializeRule),
+    layers(network.layers),
+    width(network.width),
+    height(network.height),
+    reset(network.reset),
+    predictors(network.predictors),
+    responses(network.responses),
+    parameter(network.parameter),
+    error(network.error),
+    deterministic(network.deterministic)
+{
+  // The copied layers still use the parameters of the given network.
+  if (!parameter.is_empty())
+    SetWeights<0>(0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::operator=(
+    const StaticFFN& network)
+{
+  if (this != &network)
+  {
+    outputLayer = network.outputLayer;
+    initializeRule = network.initializeRule;
+    layers = network.layers;
+    width = network.width;
+    height = network.height;
+    reset = network.reset;
+    predictors = network.predictors;
+    responses = network.responses;
+    parameter = network.parameter;
+    error = network.error;
+    deterministic = network.deterministic;
+
+    // The copied layers still use the parameters of the given network.
+    if (!parameter.is_empty())
+      SetWeights<0>(0);
+  }
+
+  return *this;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType, typename... CallbackTypes>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    arma::mat predictors,
+    arma::mat responses,
+    OptimizerType& optimizer,
+    CallbackTypes&&... callbacks)
+{
+  CheckInputShape(predictors.n_rows, "StaticFFN<>::Train()");
+
+  this->predictors = std::move(predictors);
+  this->responses = std::move(responses);
+  this->deterministic = false;
+  ResetDeterministic<0>();
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter, callbacks...);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "StaticFFN::StaticFFN(): final objective of trained model is "
+      << out << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType, typename... CallbackTypes>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    arma::mat predictors,
+    arma::mat responses,
+    CallbackTypes&&... callbacks)
+{
+  OptimizerType optimizer;
+  return Train(std::move(predictors), std::move(responses), optimizer,
+      callbacks...);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Predict(
+    arma::mat predictors, arma::mat& results, const size_t batchSize)
+{
+  CheckInputShape(predictors.n_rows, "StaticFFN<>::Predict()");
+
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("StaticFFN<>::Predict(): the batch size must "
+        "be positive!");
+  }
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  SetDeterministic(true);
+
+  // Without any predictors the loop below never sets the results.
+  results.reset();
+  for (size_t begin = 0; begin < predictors.n_cols; begin += batchSize)
+  {
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols) - begin);
+    Forward<0>(arma::mat(predictors.colptr(begin), predictors.n_rows,
+        effectiveBatchSize, false, true));
+    reset = true;
+
+    const arma::mat& output = Output();
+
+    // The size of the output is only known once the first batch is done.
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+
+    results.cols(begin, begin + effectiveBatchSize - 1) = output;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& parameters)
+{
+  return Evaluate(parameters, 0, predictors.n_cols, true);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& /* parameters */,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  SetDeterministic(deterministic);
+
+  return ForwardBatch(begin, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& parameters, const size_t begin, const size_t batchSize)
+{
+  return Evaluate(parameters, begin, batchSize, true);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+EvaluateWithGradient(const arma::mat& parameters, arma::mat& gradient)
+{
+  return EvaluateWithGradient(parameters, 0, gradient, predictors.n_cols);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+EvaluateWithGradient(const arma::mat& /* parameters */,
+                     const size_t begin,
+                     arma::mat& gradient,
+                     const size_t batchSize)
+{
+  if (gradient.is_empty())
+  {
+    if (parameter.is_empty())
+      ResetParameters();
+
+    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  }
+  else
+  {
+    gradient.zeros();
+  }
+
+  SetDeterministic(false);
+
+  const double res = ForwardBatch(begin, batchSize);
+
+  outputLayer.Backward(Output(), arma::mat(responses.colptr(begin),
+      responses.n_rows, batchSize, false, true), error);
+
+  Backward<sizeof...(Layers) - 1>();
+  SetGradients<0>(gradient, 0);
+  Gradient<0>(arma::mat(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true));
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  this->EvaluateWithGradient(parameters, begin, gradient, batchSize);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Shuffle()
+{
+  math::ShuffleData(predictors, responses, predictors, responses);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType,
+               Layers...>::ResetParameters()
+{
+  ResetDeterministic<0>();
+
+  // Initialize the network parameter with the given initialization rule,
+  // either layer by layer or for the complete network.
+  parameter.set_size(WeightSize<0>(), 1);
+  if (InitTraits<InitializationRuleType>::UseLayer)
+    InitializeLayers<0>(0);
+  else
+    initializeRule.Initialize(parameter, parameter.n_elem, 1);
+
+  SetWeights<0>(0);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<typename Archive>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::serialize(
+    Archive& ar, const uint32_t /* version */)
+{
+  ar(CEREAL_NVP(parameter));
+  ar(CEREAL_NVP(width));
+  ar(CEREAL_NVP(height));
+  ar(CEREAL_NVP(reset));
+  ar(CEREAL_NVP(layers));
+
+  // If we are loading, we need to initialize the weights.
+  if (cereal::is_loading<Archive>())
+  {
+    SetWeights<0>(0);
+
+    deterministic = true;
+    ResetDeterministic<0>();
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    const arma::mat& input)
+{
+  auto& layer = std::get<I>(layers);
+
+  // The input of the first layer has no width and height.
+  if (!reset && I > 0)
+  {
+    SetInputWidthVisitor(width)(&layer);
+    SetInputHeightVisitor(height)(&layer);
+  }
+
+  arma::mat& output = OutputParameterVisitor()(&layer);
+  ForwardVisitor(input, output)(&layer);
+
+  if (!reset)
+  {
+    if (OutputWidthVisitor()(&layer) != 0)
+      width = OutputWidthVisitor()(&layer);
+
+    if (OutputHeightVisitor()(&layer) != 0)
+      height = OutputHeightVisitor()(&layer);
+  }
+
+  Forward<I + 1>(output);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I > 0), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward()
+{
+  auto& layer = std::get<I>(layers);
+  BackwardVisitor(OutputParameterVisitor()(&layer), NextDelta<I>(),
+      DeltaVisitor()(&layer))(&layer);
+
+  Backward<I - 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& input)
+{
+  auto& layer = std::get<I>(layers);
+  GradientVisitor(input, NextDelta<I>())(&layer);
+
+  Gradient<I + 1>(OutputParameterVisitor()(&layer));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::WeightSize()
+{
+  return WeightSizeVisitor()(&std::get<I>(layers)) + WeightSize<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+InitializeLayers(const size_t offset)
+{
+  const size_t weight = WeightSizeVisitor()(&std::get<I>(layers));
+  arma::mat layerParameter(parameter.memptr() + offset, weight, 1, false,
+      false);
+  initializeRule.Initialize(layerParameter, layerParameter.n_elem, 1);
+
+  InitializeLayers<I + 1>(offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetWeights(
+    const size_t offset)
+{
+  auto& layer = std::get<I>(layers);
+  const size_t weight = WeightSetVisitor(parameter, offset)(&layer);
+  ResetVisitor()(&layer);
+
+  SetWeights<I + 1>(offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetGradients(
+    arma::mat& gradient, const size_t offset)
+{
+  const size_t weight = GradientSetVisitor(gradient, offset)(
+      &std::get<I>(layers));
+
+  SetGradients<I + 1>(gradient, offset + weight);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetDeterministic()
+{
+  DeterministicSetVisitor(deterministic)(&std::get<I>(layers));
+
+  ResetDeterministic<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), double>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Loss()
+{
+  return LossVisitor()(&std::get<I>(layers)) + Loss<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::InputShape()
+{
+  const size_t inputShape = InShapeVisitor()(&std::get<I>(layers));
+  return (inputShape != 0) ? inputShape : InputShape<I + 1>();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+CheckInputShape(const size_t dimensions, const std::string& functionName)
+{
+  const size_t inputShape = InputShape<0>();
+  if (inputShape != 0 && inputShape != dimensions)
+  {
+    std::string estr = functionName + ": the first layer of the network " +
+        "expects " + std::to_string(inputShape) + " elements, but the " +
+        "input has " + std::to_string(dimensions) + " dimensions!";
+    throw std::logic_error(estr);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+SetDeterministic(const bool deterministic)
+{
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic<0>();
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ForwardBatch(const size_t begin, const size_t batchSize)
+{
+  // Pass the points through the network without copying them.
+  Forward<0>(arma::mat(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true));
+  reset = true;
+
+  return outputLayer.Forward(Output(), arma::mat(responses.colptr(begin),
+      responses.n_rows, batchSize, false, true)) + Loss<0>();
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
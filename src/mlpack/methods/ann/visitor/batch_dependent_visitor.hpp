@@ -0,0 +1,125 @@
+/**
+ * @file methods/ann/visitor/batch_dependent_visitor.hpp
+ *
+ * This file provides an abstraction to check whether the output of a layer for
+ * a point depends on the other points of the batch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_DEPENDENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_DEPENDENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * BatchDependentVisitor returns whether the output of the given module (in
+ * training mode) or its loss for a point depends on the other points of the
+ * batch.  A batch can only be split into parts that are computed separately if
+ * none of the modules of the network depend on the batch.
+ *
+ * Modules that draw random numbers in training mode are treated as depending
+ * on the batch too: the parts of a split batch are computed in other threads,
+ * whose random number generators are not seeded by math::RandomSeed() and give
+ * the same numbers in every thread.
+ */
+class BatchDependentVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the module depends on the batch.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Batch normalization uses the mean and variance of the batch.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(BatchNorm<InputDataType, OutputDataType>* layer) const;
+
+  //! Minibatch discrimination compares each point with the rest of the batch.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(
+      MiniBatchDiscrimination<InputDataType, OutputDataType>* layer) const;
+
+  //! The recurrent layers keep the state of the whole batch from one time
+  //! step to the next.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LSTM<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(FastLSTM<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(GRU<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType,
+           typename... CustomLayers>
+  bool operator()(
+      Recurrent<InputDataType, OutputDataType, CustomLayers...>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(
+      RecurrentAttention<InputDataType, OutputDataType>* layer) const;
+
+  //! The random layers draw their masks or samples from the random number
+  //! generator of the current thread.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(AlphaDropout<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(DropConnect<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Dropout<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(
+      ReinforceNormal<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(
+      Reparametrization<InputDataType, OutputDataType>* layer) const;
+
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(SpatialDropout<InputDataType, OutputDataType>* layer) const;
+
+  bool operator()(MoreTypes layer) const;
+
+ private:
+  //! Return false if the module doesn't implement the Loss() or Model()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      !HasLoss<T, double(T::*)()>::value &&
+      !HasModelCheck<T>::value, bool>::type
+  LayerBatchDependent(T* layer) const;
+
+  //! Return true if the module implements the Loss() function, since the loss
+  //! is computed over the whole batch.
+  template<typename T>
+  typename std::enable_if<
+      HasLoss<T, double(T::*)()>::value, bool>::type
+  LayerBatchDependent(T* layer) const;
+
+  //! Return whether any of the modules of the model depends on the batch if
+  //! the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasLoss<T, double(T::*)()>::value &&
+      HasModelCheck<T>::value, bool>::type
+  LayerBatchDependent(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_dependent_visitor_impl.hpp"
+
+#endif
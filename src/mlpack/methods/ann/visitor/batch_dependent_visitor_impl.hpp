@@ -0,0 +1,160 @@
+/**
+ * @file methods/ann/visitor/batch_dependent_visitor_impl.hpp
+ *
+ * Implementation of the batch dependence layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_DEPENDENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_DEPENDENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_dependent_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! BatchDependentVisitor visitor class.
+template<typename LayerType>
+inline bool BatchDependentVisitor::operator()(LayerType* layer) const
+{
+  return LayerBatchDependent(layer);
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    BatchNorm<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    MiniBatchDiscrimination<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    LSTM<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    FastLSTM<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    GRU<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType,
+         typename... CustomLayers>
+inline bool BatchDependentVisitor::operator()(
+    Recurrent<InputDataType, OutputDataType, CustomLayers...>* /* layer */)
+    const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    RecurrentAttention<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    AlphaDropout<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    DropConnect<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    Dropout<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    ReinforceNormal<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    Reparametrization<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool BatchDependentVisitor::operator()(
+    SpatialDropout<InputDataType, OutputDataType>* /* layer */) const
+{
+  return true;
+}
+
+inline bool BatchDependentVisitor::operator()(MoreTypes layer) const
+{
+  return layer.apply_visitor(*this);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasLoss<T, double(T::*)()>::value &&
+    !HasModelCheck<T>::value, bool>::type
+BatchDependentVisitor::LayerBatchDependent(T* /* layer */) const
+{
+  return false;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasLoss<T, double(T::*)()>::value, bool>::type
+BatchDependentVisitor::LayerBatchDependent(T* /* layer */) const
+{
+  return true;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasLoss<T, double(T::*)()>::value &&
+    HasModelCheck<T>::value, bool>::type
+BatchDependentVisitor::LayerBatchDependent(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    if (boost::apply_visitor(BatchDependentVisitor(), layer->Model()[i]))
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -15,7 +15,8 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
-#include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
+#include "grid_cluster.hpp"
 #include "random_point_selection.hpp"
 #include "ordered_point_selection.hpp"
 
@@ -43,6 +44,18 @@ namespace dbscan {
  * range search technique used and the point selection strategy by means of
  * template parameters.
  *
+ * The points are searched in blocks, and the neighbors of each block are
+ * merged into the clusters as soon as the block has been searched, so only the
+ * neighborhoods of one block per thread are held in memory at any time.  When
+ * OpenMP is available, the blocks are searched in parallel and the clusters
+ * are merged with a lock-free union-find structure; the clusters found do not
+ * depend on the number of threads.
+ *
+ * For dense data with few dimensions, GridMode() may be set to find the
+ * neighbors with a grid of cells (see GridCluster) instead of range search.
+ * The grid always uses the Euclidean distance, and the range search object is
+ * not used at all in that case.
+ *
  * @tparam RangeSearchType Class to use for range searching.
  * @tparam PointSelectionPolicy Strategy for selecting next point to cluster
  *      with.
@@ -56,8 +69,9 @@ class DBSCAN
    * Construct the DBSCAN object with the given parameters.  The batchMode
    * parameter should be set to false in the case where RAM issues will be
    * encountered (i.e. if the dataset is very large or if epsilon is large).
-   * When batchMode is false, each point will be searched iteratively, which
-   * could be slower but will use less memory.
+   * When batchMode is false, each point will be searched individually, which
+   * could be slower but will use less memory; when it is true, the points are
+   * searched in blocks of BlockSize() points.
    *
    * @param epsilon Size of range query.
    * @param minPoints Minimum number of points for each cluster.
@@ -111,6 +125,17 @@ class DBSCAN
                  arma::Row<size_t>& assignments,
                  arma::mat& centroids);
 
+  //! Get the number of points searched at once in batch mode.
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the number of points searched at once in batch mode.
+  size_t& BlockSize() { return blockSize; }
+
+  //! Get whether the neighbors are found with a grid instead of range search.
+  bool GridMode() const { return gridMode; }
+  //! Modify whether the neighbors are found with a grid instead of range
+  //! search.
+  bool& GridMode() { return gridMode; }
+
  private:
   //! Maximum distance between two points to be part of same cluster.
   double epsilon;
@@ -128,6 +153,12 @@ class DBSCAN
   //! Instantiated point selection policy.
   PointSelectionPolicy pointSelector;
 
+  //! The number of points searched at once in batch mode.
+  size_t blockSize;
+
+  //! Whether the neighbors are found with a grid instead of range search.
+  bool gridMode;
+
   /**
    * Performs DBSCAN clustering on the data, returning the number of clusters and
    * also the list of cluster assignments.  This searches each point iteratively,
@@ -135,12 +166,13 @@ class DBSCAN
    * dual-tree algorithm.
    *
    * @param data Dataset to cluster.
-   * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param order Order in which to search the points.
+   * @param uf Union-find structure that will be modified.
    */
   template<typename MatType>
   void PointwiseCluster(const MatType& data,
-                        emst::UnionFind& uf);
+                        const std::vector<size_t>& order,
+                        emst::ConcurrentUnionFind& uf);
 
   /**
    * Performs DBSCAN clustering on the data, returning number of clusters
@@ -148,12 +180,29 @@ class DBSCAN
    * so it is well suited for dual-tree or naive search.
    *
    * @param data Dataset to cluster.
-   * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param order Order in which to search the points.
+   * @param uf Union-find structure that will be modified.
    */
   template<typename MatType>
   void BatchCluster(const MatType& data,
-                    emst::UnionFind& uf);
+                    const std::vector<size_t>& order,
+                    emst::ConcurrentUnionFind& uf);
+
+  /**
+   * Search the points of the data in the given order, in blocks of the given
+   * size, and unite each point with all of its neighbors.  The blocks are
+   * searched in parallel when the range search allows it.
+   *
+   * @param data Dataset to cluster.
+   * @param order Order in which to search the points.
+   * @param uf Union-find structure that will be modified.
+   * @param searchBlockSize Number of points to search at once.
+   */
+  template<typename MatType>
+  void BlockCluster(const MatType& data,
+                    const std::vector<size_t>& order,
+                    emst::ConcurrentUnionFind& uf,
+                    const size_t searchBlockSize);
 };
 
 } // namespace dbscan
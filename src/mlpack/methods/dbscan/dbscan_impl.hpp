@@ -31,7 +31,9 @@ DBSCAN<RangeSearchType, PointSelectionPolicy>::DBSCAN(
     minPoints(minPoints),
     batchMode(batchMode),
     rangeSearch(rangeSearch),
-    pointSelector(pointSelector)
+    pointSelector(pointSelector),
+    blockSize(4096),
+    gridMode(false)
 {
   // Nothing to do.
 }
@@ -100,35 +102,52 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
     const MatType& data,
     arma::Row<size_t>& assignments)
 {
-  // Initialize the UnionFind object.
-  emst::UnionFind uf(data.n_cols);
-  rangeSearch.Train(data);
+  // The point selection policy may have state, so the order of the points is
+  // chosen before the search starts.  The clusters themselves do not depend on
+  // it, but they are numbered in this order.
+  std::vector<size_t> order(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    order[i] = pointSelector.Select(i, data);
+
+  // Initialize the union-find object.
+  emst::ConcurrentUnionFind uf(data.n_cols);
 
-  if (batchMode)
-    BatchCluster(data, uf);
+  if (gridMode)
+  {
+    GridCluster::Cluster(data, epsilon, uf);
+  }
   else
-    PointwiseCluster(data, uf);
+  {
+    rangeSearch.Train(data);
+
+    if (batchMode)
+      BatchCluster(data, order, uf);
+    else
+      PointwiseCluster(data, order, uf);
+  }
 
   // Now set assignments.
   assignments.set_size(data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
     assignments[i] = uf.Find(i);
 
   // Get a count of all clusters.
-  const size_t numClusters = arma::max(assignments) + 1;
-  arma::Col<size_t> counts(numClusters, arma::fill::zeros);
+  arma::Col<size_t> counts(data.n_cols, arma::fill::zeros);
   for (size_t i = 0; i < assignments.n_elem; ++i)
     counts[assignments[i]]++;
 
-  // Now assign clusters to new indices.
+  // Now assign clusters to new indices, in the order in which their first
+  // point was selected.
   size_t currentCluster = 0;
-  arma::Col<size_t> newAssignments(numClusters);
-  for (size_t i = 0; i < counts.n_elem; ++i)
+  arma::Col<size_t> newAssignments(data.n_cols);
+  newAssignments.fill(SIZE_MAX);
+  for (size_t i = 0; i < order.size(); ++i)
   {
-    if (counts[i] >= minPoints)
-      newAssignments[i] = currentCluster++;
-    else
-      newAssignments[i] = SIZE_MAX;
+    const size_t component = assignments[order[i]];
+    if (counts[component] >= minPoints &&
+        newAssignments[component] == SIZE_MAX)
+      newAssignments[component] = currentCluster++;
   }
 
   // Now reassign.
@@ -150,24 +169,10 @@ template<typename RangeSearchType, typename PointSelectionPolicy>
 template<typename MatType>
 void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
     const MatType& data,
-    emst::UnionFind& uf)
+    const std::vector<size_t>& order,
+    emst::ConcurrentUnionFind& uf)
 {
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    if (i % 10000 == 0 && i > 0)
-      Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
-
-    // Do the range search for only this point.
-    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), neighbors,
-        distances);
-
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[0].size(); ++j)
-      uf.Union(i, neighbors[0][j]);
-  }
+  BlockCluster(data, order, uf, 1);
 }
 
 /**
@@ -179,23 +184,58 @@ template<typename RangeSearchType, typename PointSelectionPolicy>
 template<typename MatType>
 void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
     const MatType& data,
-    emst::UnionFind& uf)
+    const std::vector<size_t>& order,
+    emst::ConcurrentUnionFind& uf)
 {
-  // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-  Log::Info << "Performing range search." << std::endl;
-  rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
-  Log::Info << "Range search complete." << std::endl;
-
-  // Now loop over all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("DBSCAN::Cluster(): the block size must be "
+        "positive!");
+  }
+
+  BlockCluster(data, order, uf, blockSize);
+}
+
+/**
+ * Search the points in blocks and unite each point with its neighbors.
+ */
+template<typename RangeSearchType, typename PointSelectionPolicy>
+template<typename MatType>
+void DBSCAN<RangeSearchType, PointSelectionPolicy>::BlockCluster(
+    const MatType& data,
+    const std::vector<size_t>& order,
+    emst::ConcurrentUnionFind& uf,
+    const size_t searchBlockSize)
+{
+  // Single-tree search caches distances in the nodes of trees whose first
+  // point is the centroid, so the range search cannot be shared by threads.
+  const bool parallel = !(tree::TreeTraits<typename
+      RangeSearchType::Tree>::FirstPointIsCentroid && rangeSearch.SingleMode());
+
+  const size_t numBlocks = (data.n_cols + searchBlockSize - 1) /
+      searchBlockSize;
+  Log::Info << "Performing range search in " << numBlocks << " blocks."
+      << std::endl;
+
+  #pragma omp parallel for schedule(dynamic) if (parallel)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
   {
-    // Get the next index.
-    const size_t index = pointSelector.Select(i, data);
-    for (size_t j = 0; j < neighbors[index].size(); ++j)
-      uf.Union(index, neighbors[index][j]);
+    const size_t begin = b * searchBlockSize;
+    const size_t end = std::min(begin + searchBlockSize, (size_t) data.n_cols);
+
+    MatType block(data.n_rows, end - begin);
+    for (size_t i = begin; i < end; ++i)
+      block.col(i - begin) = data.col(order[i]);
+
+    // Only the neighborhoods of this block are held at once.
+    std::vector<std::vector<size_t>> neighbors;
+    std::vector<std::vector<double>> distances;
+    rangeSearch.Search(block, math::Range(0.0, epsilon), neighbors,
+        distances);
+
+    for (size_t i = 0; i < neighbors.size(); ++i)
+      for (size_t j = 0; j < neighbors[i].size(); ++j)
+        uf.Union(order[begin + i], neighbors[i][j]);
   }
 }
 
@@ -63,7 +63,14 @@ BINDING_LONG_DESC(
     " 'hilbert-r', 'r-plus', 'r-plus-plus', 'cover', 'ball'. The " +
     PRINT_PARAM_STRING("single_mode") + " parameter will force single-tree "
     "search (as opposed to the default dual-tree search), and '" +
-    PRINT_PARAM_STRING("naive") + " will force brute-force range search.");
+    PRINT_PARAM_STRING("naive") + " will force brute-force range search."
+    "\n\n"
+    "For low-dimensional data (such as 2-D or 3-D spatial data), the " +
+    PRINT_PARAM_STRING("grid") + " parameter may be specified to find the "
+    "neighbors of each point with a grid of cells of side epsilon / sqrt(d) "
+    "instead of range search; this is usually much faster for such data.  "
+    "The grid always uses the Euclidean distance, and it can be used for data "
+    "with at most 8 dimensions.");
 
 // Example.
 BINDING_EXAMPLE(
@@ -98,6 +105,8 @@ PARAM_FLAG("single_mode", "If set, single-tree range search (not dual-tree) "
     "will be used.", "S");
 PARAM_FLAG("naive", "If set, brute-force range search (not tree-based) "
     "will be used.", "N");
+PARAM_FLAG("grid", "If set, a grid of cells (not range search) will be used "
+    "to find the neighbors of each point.", "g");
 
 // Actually run the clustering, and process the output.
 template<typename RangeSearchType, typename PointSelectionPolicy>
@@ -115,6 +124,7 @@ void RunDBSCAN(RangeSearchType rs,
 
   DBSCAN<RangeSearchType, PointSelectionPolicy> d(epsilon, minSize,
       !IO::HasParam("single_mode"), rs, pointSelector);
+  d.GridMode() = IO::HasParam("grid");
 
   // If possible, avoid the overhead of calculating centroids.
   if (IO::HasParam("centroids"))
@@ -152,6 +162,9 @@ static void mlpackMain()
       "no output will be saved");
 
   ReportIgnoredParam({{ "naive", true }}, "single_mode");
+  ReportIgnoredParam({{ "grid", true }}, "tree_type");
+  ReportIgnoredParam({{ "grid", true }}, "single_mode");
+  ReportIgnoredParam({{ "grid", true }}, "naive");
 
   RequireParamInSet<string>("tree_type", { "kd", "cover", "r", "r-star", "x",
       "hilbert-r", "r-plus", "r-plus-plus", "ball" }, true,
@@ -165,8 +178,12 @@ static void mlpackMain()
   RequireParamValue<int>("min_size", [](int y) { return y > 0; },
       true, "invalid value of min_size specified");
 
-  // Fire off naive search if needed.
-  if (IO::HasParam("naive"))
+  // The grid does not use range search at all.
+  if (IO::HasParam("grid"))
+  {
+    ChoosePointSelectionPolicy<RangeSearch<>>();
+  }
+  else if (IO::HasParam("naive"))
   {
     RangeSearch<> rs(true);
     ChoosePointSelectionPolicy(rs);
@@ -0,0 +1,119 @@
+/**
+ * @file methods/dbscan/grid_cluster.hpp
+ *
+ * Definition of the GridCluster class, which connects the epsilon-neighbors of
+ * a low-dimensional dataset by bucketing the points into a grid of cells
+ * instead of using range search.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_CLUSTER_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_CLUSTER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * GridCluster unites every point of a dataset with all points within Euclidean
+ * distance epsilon of it, using a grid of cells with side epsilon / sqrt(d)
+ * instead of range search.  Any two points in the same cell are within
+ * epsilon of each other, so each cell is united at once; two cells close
+ * enough to hold neighbors are united if a bichromatic closest-pair check finds
+ * any pair of their points within epsilon.  The cells are processed in
+ * parallel when OpenMP is available.
+ *
+ * The number of cells that must be checked around each cell grows
+ * exponentially with the dimension, so this is only worthwhile for data with
+ * few dimensions (such as 2-D or 3-D spatial data), where it avoids the cost
+ * of tree traversal entirely.
+ *
+ * @code
+ * @mastersthesis{gunawan2013faster,
+ *   title = {A Faster Algorithm for DBSCAN},
+ *   author = {Gunawan, A.},
+ *   school = {Technische Universiteit Eindhoven},
+ *   year = {2013}
+ * }
+ * @endcode
+ */
+class GridCluster
+{
+ public:
+  /**
+   * Unite each point of the given dataset with all points within Euclidean
+   * distance epsilon of it.
+   *
+   * @param data Dataset to cluster.
+   * @param epsilon Maximum distance between neighbors.
+   * @param uf Union-find structure that will be modified.
+   */
+  template<typename ElemType>
+  static void Cluster(const arma::Mat<ElemType>& data,
+                      const double epsilon,
+                      emst::ConcurrentUnionFind& uf);
+
+  /**
+   * The grid is only available for dense matrices; this overload throws a
+   * std::invalid_argument.
+   */
+  template<typename MatType>
+  static void Cluster(const MatType& data,
+                      const double epsilon,
+                      emst::ConcurrentUnionFind& uf);
+
+  //! Above this dimensionality, a warning is issued that the grid is slow.
+  static const size_t MaxEfficientDimensionality = 4;
+  //! The grid can't be used above this dimensionality.
+  static const size_t MaxDimensionality = 8;
+
+ private:
+  /**
+   * Compute the offsets of the cells that may hold neighbors of the points of
+   * a cell.  Only offsets that are lexicographically positive are returned, so
+   * each pair of cells is checked once.
+   *
+   * @param dimensionality Dimensionality of the grid.
+   * @param offsets Vector to store the offsets in, one after another.
+   */
+  static void NeighborOffsets(const size_t dimensionality,
+                              std::vector<int64_t>& offsets);
+
+  /**
+   * Return whether any point in the first range of sorted points is within
+   * epsilon of any point in the second range.
+   *
+   * @param data Dataset.
+   * @param points Indices of the points, sorted by cell.
+   * @param aBegin Position of the first point of the first cell.
+   * @param aEnd Position after the last point of the first cell.
+   * @param bBegin Position of the first point of the second cell.
+   * @param bEnd Position after the last point of the second cell.
+   * @param bLo Lower corner of the bounding box of the second cell.
+   * @param bHi Upper corner of the bounding box of the second cell.
+   * @param epsilon Maximum distance between neighbors.
+   */
+  template<typename ElemType>
+  static bool HasNeighbor(const arma::Mat<ElemType>& data,
+                          const std::vector<size_t>& points,
+                          const size_t aBegin,
+                          const size_t aEnd,
+                          const size_t bBegin,
+                          const size_t bEnd,
+                          const ElemType* bLo,
+                          const ElemType* bHi,
+                          const double epsilon);
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+// Include implementation.
+#include "grid_cluster_impl.hpp"
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @file methods/dbscan/grid_cluster_impl.hpp
+ *
+ * Implementation of the GridCluster class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_CLUSTER_IMPL_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_CLUSTER_IMPL_HPP
+
+// In case it wasn't included already for some reason.
+#include "grid_cluster.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename ElemType>
+void GridCluster::Cluster(const arma::Mat<ElemType>& data,
+                          const double epsilon,
+                          emst::ConcurrentUnionFind& uf)
+{
+  const size_t dims = data.n_rows;
+  if (data.n_cols == 0)
+    return;
+
+  if (dims == 0 || dims > MaxDimensionality)
+  {
+    std::ostringstream oss;
+    oss << "GridCluster::Cluster(): the grid can only be used for data with "
+        << "between 1 and " << MaxDimensionality << " dimensions!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (dims > MaxEfficientDimensionality)
+  {
+    Log::Warn << "GridCluster::Cluster(): the grid is slow for data with more "
+        << "than " << MaxEfficientDimensionality << " dimensions; tree-based "
+        << "range search may be faster." << std::endl;
+  }
+
+  // Points in the same cell are never further apart than the diagonal of the
+  // cell, which is epsilon.
+  const double side = epsilon / std::sqrt((double) dims);
+  const arma::Col<ElemType> minValues = arma::min(data, 1);
+  const arma::Col<ElemType> maxValues = arma::max(data, 1);
+  for (size_t d = 0; d < dims; ++d)
+  {
+    // This is also false if the values are not finite.
+    if (!((double(maxValues[d]) - double(minValues[d])) / side < 1e18))
+    {
+      throw std::invalid_argument("GridCluster::Cluster(): the range of the "
+          "data is too large for a grid with the given epsilon!");
+    }
+  }
+
+  // Compute the cell of each point.
+  std::vector<int64_t> coords(dims * data.n_cols);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t d = 0; d < dims; ++d)
+    {
+      coords[dims * i + d] = (int64_t) std::floor(
+          (double(data(d, i)) - double(minValues[d])) / side);
+    }
+  }
+
+  // Sort the points by cell, so that each cell is a run of points.
+  std::vector<size_t> points(data.n_cols);
+  for (size_t i = 0; i < points.size(); ++i)
+    points[i] = i;
+
+  std::sort(points.begin(), points.end(),
+      [&coords, dims](const size_t a, const size_t b)
+      {
+        for (size_t d = 0; d < dims; ++d)
+        {
+          if (coords[dims * a + d] != coords[dims * b + d])
+            return coords[dims * a + d] < coords[dims * b + d];
+        }
+        return a < b;
+      });
+
+  std::vector<size_t> cellStarts(1, 0);
+  for (size_t i = 1; i < points.size(); ++i)
+  {
+    if (!std::equal(coords.begin() + dims * points[i],
+                    coords.begin() + dims * (points[i] + 1),
+                    coords.begin() + dims * points[i - 1]))
+      cellStarts.push_back(i);
+  }
+  const size_t numCells = cellStarts.size();
+  cellStarts.push_back(points.size());
+
+  Log::Info << "Grid has " << numCells << " non-empty cells." << std::endl;
+
+  // Compute the bounding box of the points in each cell.
+  arma::Mat<ElemType> lo(dims, numCells);
+  arma::Mat<ElemType> hi(dims, numCells);
+  #pragma omp parallel for
+  for (omp_size_t c = 0; c < (omp_size_t) numCells; ++c)
+  {
+    lo.col(c) = data.col(points[cellStarts[c]]);
+    hi.col(c) = lo.col(c);
+    for (size_t i = cellStarts[c] + 1; i < cellStarts[c + 1]; ++i)
+    {
+      for (size_t d = 0; d < dims; ++d)
+      {
+        const ElemType val = data(d, points[i]);
+        if (val < lo(d, c))
+          lo(d, c) = val;
+        if (val > hi(d, c))
+          hi(d, c) = val;
+      }
+    }
+  }
+
+  std::vector<int64_t> offsets;
+  NeighborOffsets(dims, offsets);
+  const size_t numOffsets = offsets.size() / dims;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) numCells; ++c)
+  {
+    const size_t first = points[cellStarts[c]];
+    for (size_t i = cellStarts[c] + 1; i < cellStarts[c + 1]; ++i)
+      uf.Union(first, points[i]);
+
+    const int64_t* cell = coords.data() + dims * first;
+    std::vector<int64_t> target(dims);
+    for (size_t o = 0; o < numOffsets; ++o)
+    {
+      for (size_t d = 0; d < dims; ++d)
+        target[d] = cell[d] + offsets[dims * o + d];
+
+      // The offset is positive, so the target cell can only come after this
+      // one.
+      const size_t neighbor = std::lower_bound(
+          cellStarts.begin() + c + 1, cellStarts.begin() + numCells,
+          target, [&coords, &points, dims](const size_t start,
+                                           const std::vector<int64_t>& key)
+          {
+            const int64_t* startCell = coords.data() + dims * points[start];
+            return std::lexicographical_compare(startCell, startCell + dims,
+                key.begin(), key.end());
+          }) - cellStarts.begin();
+      if (neighbor == numCells || !std::equal(target.begin(), target.end(),
+          coords.begin() + dims * points[cellStarts[neighbor]]))
+        continue;
+
+      // If the cells are already connected, there is nothing to check.
+      const size_t neighborFirst = points[cellStarts[neighbor]];
+      if (uf.Find(first) == uf.Find(neighborFirst))
+        continue;
+
+      // Check whether the bounding boxes of the cells are close enough.
+      double boxDistance = 0.0;
+      for (size_t d = 0; d < dims; ++d)
+      {
+        const double gap = std::max(std::max(
+            double(lo(d, c)) - double(hi(d, neighbor)),
+            double(lo(d, neighbor)) - double(hi(d, c))), 0.0);
+        boxDistance += gap * gap;
+      }
+      if (std::sqrt(boxDistance) > epsilon)
+        continue;
+
+      if (HasNeighbor(data, points, cellStarts[c], cellStarts[c + 1],
+          cellStarts[neighbor], cellStarts[neighbor + 1],
+          lo.colptr(neighbor), hi.colptr(neighbor), epsilon))
+        uf.Union(first, neighborFirst);
+    }
+  }
+}
+
+template<typename MatType>
+void GridCluster::Cluster(const MatType& /* data */,
+                          const double /* epsilon */,
+                          emst::ConcurrentUnionFind& /* uf */)
+{
+  throw std::invalid_argument("GridCluster::Cluster(): the grid can only be "
+      "used with dense matrices!");
+}
+
+inline void GridCluster::NeighborOffsets(const size_t dimensionality,
+                                         std::vector<int64_t>& offsets)
+{
+  // Two cells whose coordinates differ by o are at least
+  // side * sqrt(sum_d max(|o_d| - 1, 0)^2) apart, and epsilon is
+  // side * sqrt(dimensionality), so the condition is exact in integers.
+  const int64_t maxOffset = (int64_t) std::floor(
+      std::sqrt((double) dimensionality)) + 1;
+
+  offsets.clear();
+  std::vector<int64_t> offset(dimensionality, -maxOffset);
+  while (true)
+  {
+    int64_t gaps = 0;
+    size_t firstNonzero = dimensionality;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const int64_t gap = std::max(std::abs(offset[d]) - 1, (int64_t) 0);
+      gaps += gap * gap;
+      if (firstNonzero == dimensionality && offset[d] != 0)
+        firstNonzero = d;
+    }
+
+    if (gaps <= (int64_t) dimensionality && firstNonzero < dimensionality &&
+        offset[firstNonzero] > 0)
+      offsets.insert(offsets.end(), offset.begin(), offset.end());
+
+    // Move to the next offset.
+    size_t d = 0;
+    while (d < dimensionality && offset[d] == maxOffset)
+      offset[d++] = -maxOffset;
+    if (d == dimensionality)
+      break;
+    ++offset[d];
+  }
+}
+
+template<typename ElemType>
+bool GridCluster::HasNeighbor(const arma::Mat<ElemType>& data,
+                              const std::vector<size_t>& points,
+                              const size_t aBegin,
+                              const size_t aEnd,
+                              const size_t bBegin,
+                              const size_t bEnd,
+                              const ElemType* bLo,
+                              const ElemType* bHi,
+                              const double epsilon)
+{
+  const size_t dims = data.n_rows;
+  for (size_t i = aBegin; i < aEnd; ++i)
+  {
+    const ElemType* a = data.colptr(points[i]);
+
+    // Skip points that are too far from every point of the other cell.
+    double boxDistance = 0.0;
+    for (size_t d = 0; d < dims; ++d)
+    {
+      const double gap = std::max(std::max(double(a[d]) - double(bHi[d]),
+          double(bLo[d]) - double(a[d])), 0.0);
+      boxDistance += gap * gap;
+    }
+    if (std::sqrt(boxDistance) > epsilon)
+      continue;
+
+    for (size_t j = bBegin; j < bEnd; ++j)
+    {
+      const ElemType* b = data.colptr(points[j]);
+      double distance = 0.0;
+      for (size_t d = 0; d < dims; ++d)
+      {
+        const double diff = double(a[d]) - double(b[d]);
+        distance += diff * diff;
+      }
+      if (std::sqrt(distance) <= epsilon)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file methods/emst/concurrent_union_find.hpp
+ *
+ * Implementation of a union-find data structure that may be used by many
+ * threads at once without locking.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+#define MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+
+namespace mlpack {
+namespace emst {
+
+/**
+ * A lock-free union-find data structure, with the same interface as UnionFind.
+ * Find() and Union() may be called concurrently from any number of threads.
+ * Each parent pointer is an atomic: Find() shortens paths with path halving,
+ * and Union() links one root under the other with a single compare-and-swap,
+ * retrying if another thread changed either root first.  This is the
+ * randomized linking scheme of Jayanti and Tarjan, where the random order of
+ * the elements is replaced by a fixed hash of their indices.  Since a root is
+ * only ever linked under a root that is later in that order, the
+ * representative returned by Find() is always the last element of the
+ * component in that order, whatever order the unions were done in.
+ *
+ * @code
+ * @inproceedings{jayanti2016concurrent,
+ *   title = {A Randomized Concurrent Algorithm for Disjoint Set Union},
+ *   author = {Jayanti, S.V. and Tarjan, R.E.},
+ *   booktitle = {Proceedings of the 2016 ACM Symposium on Principles of
+ *       Distributed Computing (PODC '16)},
+ *   pages = {75--82},
+ *   year = {2016}
+ * }
+ * @endcode
+ */
+class ConcurrentUnionFind
+{
+ private:
+  std::vector<std::atomic<size_t>> parent;
+
+  /**
+   * Return whether x should be linked under y when the roots x and y are
+   * united.
+   */
+  static bool LinksBelow(const size_t x, const size_t y)
+  {
+    // A multiplicative hash gives the elements a pseudorandom order.
+    const uint64_t xKey = uint64_t(x) * 0x9E3779B97F4A7C15ULL;
+    const uint64_t yKey = uint64_t(y) * 0x9E3779B97F4A7C15ULL;
+    return (xKey != yKey) ? (xKey < yKey) : (x < y);
+  }
+
+ public:
+  //! Construct the object with the given size.
+  ConcurrentUnionFind(const size_t size) : parent(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the component containing an element.  If another thread is
+   * uniting components at the same time, the result may already be out of
+   * date when it is returned.
+   *
+   * @param x the component to be found
+   * @return The index of the component containing x
+   */
+  size_t Find(size_t x)
+  {
+    while (true)
+    {
+      size_t xParent = parent[x].load(std::memory_order_acquire);
+      if (xParent == x)
+        return x;
+
+      // Point x at its grandparent.  If this fails, another thread already
+      // changed the pointer, and it still points into the same component.
+      const size_t xGrandparent =
+          parent[xParent].load(std::memory_order_acquire);
+      if (xGrandparent != xParent)
+      {
+        parent[x].compare_exchange_weak(xParent, xGrandparent,
+            std::memory_order_acq_rel, std::memory_order_acquire);
+      }
+
+      x = xGrandparent;
+    }
+  }
+
+  /**
+   * Union the components containing x and y.
+   *
+   * @param x one component
+   * @param y the other component
+   * @return true if the components were united by this call, false if x and y
+   *     were already in the same component.
+   */
+  bool Union(const size_t x, const size_t y)
+  {
+    size_t xRoot = x;
+    size_t yRoot = y;
+    while (true)
+    {
+      xRoot = Find(xRoot);
+      yRoot = Find(yRoot);
+      if (xRoot == yRoot)
+        return false;
+
+      if (!LinksBelow(xRoot, yRoot))
+        std::swap(xRoot, yRoot);
+
+      // xRoot is only linked if it is still a root.
+      size_t expected = xRoot;
+      if (parent[xRoot].compare_exchange_strong(expected, yRoot,
+          std::memory_order_acq_rel, std::memory_order_acquire))
+        return true;
+    }
+  }
+
+  //! Return the number of elements.
+  size_t Size() const { return parent.size(); }
+}; // class ConcurrentUnionFind
+
+} // namespace emst
+} // namespace mlpack
+
+#endif // MLPACK_METHODS_EMST_CONCURRENT_UNION_FIND_HPP
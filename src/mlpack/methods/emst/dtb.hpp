@@ -26,7 +26,9 @@
 #define MLPACK_METHODS_EMST_DTB_HPP
 
 #include "dtb_stat.hpp"
+#include "dtb_rules.hpp"
 #include "edge_pair.hpp"
+#include "concurrent_union_find.hpp"
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
@@ -68,6 +70,13 @@ namespace emst /** Euclidean Minimum Spanning Trees. */ {
  * More advanced usage of the class can use different types of trees, pass in an
  * already-built tree, or compute the MST using the O(n^2) naive algorithm.
  *
+ * When OpenMP is available, each Boruvka round is run in parallel: the tree is
+ * split into disjoint query subtrees that are traversed against the whole tree
+ * as separate tasks, and the components are then united with a lock-free
+ * union-find structure.  Ties between edges of equal length are broken by the
+ * indices of their points, so the result does not depend on the number of
+ * threads.
+ *
  * @tparam MetricType The metric to use.
  * @tparam MatType The type of data matrix to use.
  * @tparam TreeType Type of tree to use.  This should follow the TreeType policy
@@ -103,14 +112,17 @@ class DualTreeBoruvka
   std::vector<EdgePair> edges; // We must use vector with non-numerical types.
 
   //! Connections.
-  UnionFind connections;
-
-  //! List of edge nodes.
-  arma::Col<size_t> neighborsInComponent;
-  //! List of edge nodes.
-  arma::Col<size_t> neighborsOutComponent;
-  //! List of edge distances.
-  arma::vec neighborsDistances;
+  ConcurrentUnionFind connections;
+
+  //! For each component, the point of the component that is an endpoint of
+  //! its candidate edge (or the number of points, if there is none yet).
+  std::vector<std::atomic<size_t>> neighborsInComponent;
+  //! For each component, the length of its candidate edge.
+  std::vector<std::atomic<double>> neighborsDistances;
+  //! For each point, the nearest point outside its component found so far.
+  arma::Col<size_t> pointNeighbors;
+  //! For each point, the distance to pointNeighbors.
+  arma::vec pointDistances;
 
   //! Total distance of the tree.
   double totalDist;
@@ -118,15 +130,26 @@ class DualTreeBoruvka
   //! The instantiated metric.
   MetricType metric;
 
-  //! For sorting the edge list after the computation.
+  //! For sorting the edge list after the computation.  Edges of equal length
+  //! are ordered by their indices.
   struct SortEdgesHelper
   {
     bool operator()(const EdgePair& pairA, const EdgePair& pairB)
     {
-      return (pairA.Distance() < pairB.Distance());
+      if (pairA.Distance() != pairB.Distance())
+        return (pairA.Distance() < pairB.Distance());
+      if (pairA.Lesser() != pairB.Lesser())
+        return (pairA.Lesser() < pairB.Lesser());
+      return (pairA.Greater() < pairB.Greater());
     }
   } SortFun;
 
+  //! The rules used for the traversals.
+  typedef DTBRules<MetricType, Tree> RuleType;
+
+  //! Nodes with at least this many descendants are cleaned up in parallel.
+  static const size_t ParallelCleanupSize = 4096;
+
  public:
   /**
    * Create the tree from the given dataset.  This copies the dataset to an
@@ -181,6 +204,23 @@ class DualTreeBoruvka
    */
   void AddEdge(const size_t e1, const size_t e2, const double distance);
 
+  /**
+   * Find the nearest point outside its component for each point (or at least
+   * for each point that may be an endpoint of the candidate edge of its
+   * component).  If OpenMP is available, the given query subtrees are
+   * traversed in parallel.
+   *
+   * @param rules Rules that accumulate the number of base cases and scores.
+   * @param subtrees Disjoint subtrees of the tree that hold every point.
+   */
+  void FindNeighbors(RuleType& rules, const std::vector<Tree*>& subtrees);
+
+  /**
+   * Return whether the candidate edge of point a comes before the candidate
+   * edge of point b, when both have the same length.
+   */
+  bool CandidateBefore(const size_t a, const size_t b) const;
+
   /**
    * Adds all the edges found in one iteration to the list of neighbors.
    */
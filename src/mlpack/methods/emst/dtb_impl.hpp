@@ -14,6 +14,8 @@
 
 #include "dtb_rules.hpp"
 
+#include <mlpack/core/tree/subtree_partition.hpp>
+
 namespace mlpack {
 namespace emst {
 
@@ -58,15 +60,17 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     ownTree(!naive),
     naive(naive),
     connections(dataset.n_cols),
+    neighborsInComponent(dataset.n_cols),
+    neighborsDistances(dataset.n_cols),
     totalDist(0.0),
     metric(metric)
 {
   edges.reserve(data.n_cols - 1); // Set size.
 
-  neighborsInComponent.set_size(data.n_cols);
-  neighborsOutComponent.set_size(data.n_cols);
-  neighborsDistances.set_size(data.n_cols);
-  neighborsDistances.fill(DBL_MAX);
+  pointNeighbors.set_size(data.n_cols);
+  pointNeighbors.fill(data.n_cols);
+  pointDistances.set_size(data.n_cols);
+  Cleanup();
 }
 
 template<
@@ -83,15 +87,17 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     ownTree(false),
     naive(false),
     connections(data.n_cols),
+    neighborsInComponent(data.n_cols),
+    neighborsDistances(data.n_cols),
     totalDist(0.0),
     metric(metric)
 {
   edges.reserve(data.n_cols - 1); // Fill with EdgePairs.
 
-  neighborsInComponent.set_size(data.n_cols);
-  neighborsOutComponent.set_size(data.n_cols);
-  neighborsDistances.set_size(data.n_cols);
-  neighborsDistances.fill(DBL_MAX);
+  pointNeighbors.set_size(data.n_cols);
+  pointNeighbors.fill(data.n_cols);
+  pointDistances.set_size(data.n_cols);
+  Cleanup();
 }
 
 template<
@@ -121,25 +127,20 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
 {
   Timer::Start("emst/mst_computation");
 
-  totalDist = 0; // Reset distance.
+  RuleType rules(data, connections, neighborsDistances, pointDistances,
+                 pointNeighbors, metric);
+
+  // Split the tree into many more subtrees than there are threads, so that
+  // dynamic scheduling can balance the uneven cost of the subtrees.
+  std::vector<Tree*> subtrees;
+  #ifdef HAS_OPENMP
+    if (!naive && omp_get_max_threads() > 1)
+      tree::PartitionSubtrees(*tree, 8 * omp_get_max_threads(), subtrees);
+  #endif
 
-  typedef DTBRules<MetricType, Tree> RuleType;
-  RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
   while (edges.size() < (data.n_cols - 1))
   {
-    if (naive)
-    {
-      // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
-    }
-    else
-    {
-      typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-      traverser.Traverse(*tree, *tree);
-    }
+    FindNeighbors(rules, subtrees);
 
     AddAllEdges();
 
@@ -161,6 +162,64 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
   Log::Info << "Total spanning tree length: " << totalDist << std::endl;
 }
 
+/**
+ * Find the candidate nearest neighbor of each point in one iteration.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::FindNeighbors(
+    RuleType& rules,
+    const std::vector<Tree*>& subtrees)
+{
+  if (naive)
+  {
+    // Full O(N^2) traversal.  Each thread handles its own query points.
+    #pragma omp parallel
+    {
+      RuleType threadRules(data, connections, neighborsDistances,
+          pointDistances, pointNeighbors, metric);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+        for (size_t j = 0; j < data.n_cols; ++j)
+          threadRules.BaseCase(i, j);
+    }
+  }
+  else if (subtrees.size() <= 1)
+  {
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(*tree, *tree);
+  }
+  else
+  {
+    // The subtrees are disjoint, so the candidate of each point is only ever
+    // touched by one task; the bounds of the components are shared atomics.
+    size_t taskScores = 0;
+    size_t taskBaseCases = 0;
+
+    #pragma omp parallel for schedule(dynamic) \
+        reduction(+:taskScores, taskBaseCases)
+    for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+    {
+      RuleType taskRules(data, connections, neighborsDistances,
+          pointDistances, pointNeighbors, metric);
+      typename Tree::template DualTreeTraverser<RuleType>
+          traverser(taskRules);
+      traverser.Traverse(*subtrees[i], *tree);
+
+      taskScores += taskRules.Scores();
+      taskBaseCases += taskRules.BaseCases();
+    }
+
+    rules.Scores() += taskScores;
+    rules.BaseCases() += taskBaseCases;
+  }
+}
+
 /**
  * Adds a single edge to the edge list
  */
@@ -195,22 +254,66 @@ template<
              typename TreeMatType> class TreeType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::AddAllEdges()
 {
-  for (size_t i = 0; i < data.n_cols; ++i)
+  const size_t numPoints = data.n_cols;
+
+  // The candidate edge of each component is the shortest candidate of its
+  // points; ties are broken by the indices of the edge, so that two
+  // components never choose different edges between them.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) numPoints; ++i)
   {
-    size_t component = connections.Find(i);
-    size_t inEdge = neighborsInComponent[component];
-    size_t outEdge = neighborsOutComponent[component];
-    if (connections.Find(inEdge) != connections.Find(outEdge))
+    const size_t component = connections.Find(i);
+    if (pointDistances[i] !=
+        neighborsDistances[component].load(std::memory_order_relaxed))
+      continue;
+
+    std::atomic<size_t>& candidate = neighborsInComponent[component];
+    size_t oldCandidate = candidate.load(std::memory_order_relaxed);
+    while ((oldCandidate == numPoints || CandidateBefore(i, oldCandidate)) &&
+        !candidate.compare_exchange_weak(oldCandidate, i,
+            std::memory_order_relaxed)) { }
+  }
+
+  // Now unite each component with the component of its candidate.  If two
+  // components chose the same edge, only one of the unions succeeds.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t c = 0; c < (omp_size_t) numPoints; ++c)
+  {
+    const size_t inEdge =
+        neighborsInComponent[c].load(std::memory_order_relaxed);
+    if (inEdge == numPoints)
+      continue;
+
+    const size_t outEdge = pointNeighbors[inEdge];
+    if (connections.Union(inEdge, outEdge))
     {
-      // totalDist = totalDist + dist;
-      // changed to make this agree with the cover tree code
-      totalDist += neighborsDistances[component];
-      AddEdge(inEdge, outEdge, neighborsDistances[component]);
-      connections.Union(inEdge, outEdge);
+      #pragma omp critical(DTBAddEdge)
+      AddEdge(inEdge, outEdge, pointDistances[inEdge]);
     }
   }
 }
 
+/**
+ * Compare the candidate edges of two points of the same length.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+bool DualTreeBoruvka<MetricType, MatType, TreeType>::CandidateBefore(
+    const size_t a,
+    const size_t b) const
+{
+  const size_t aLesser = std::min(a, pointNeighbors[a]);
+  const size_t bLesser = std::min(b, pointNeighbors[b]);
+  if (aLesser != bLesser)
+    return aLesser < bLesser;
+
+  return std::max(a, pointNeighbors[a]) < std::max(b, pointNeighbors[b]);
+}
+
 /**
  * Unpermute the edge list (if necessary) and output it to results.
  */
@@ -223,12 +326,17 @@ template<
 void DualTreeBoruvka<MetricType, MatType, TreeType>::EmitResults(
     arma::mat& results)
 {
-  // Sort the edges.
+  // Sort the edges.  The edges of each iteration are found in an arbitrary
+  // order, so the total distance is only summed now.
   std::sort(edges.begin(), edges.end(), SortFun);
 
   Log::Assert(edges.size() == data.n_cols - 1);
   results.set_size(3, edges.size());
 
+  totalDist = 0.0;
+  for (size_t i = 0; i < edges.size(); ++i)
+    totalDist += edges[i].Distance();
+
   // Need to unpermute the point labels.
   if (!naive && ownTree && tree::TreeTraits<Tree>::RearrangesDataset)
   {
@@ -283,9 +391,14 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::CleanupHelper(Tree* tree)
   tree->Stat().MinNeighborDistance() = DBL_MAX;
   tree->Stat().Bound() = DBL_MAX;
 
-  // Recurse into all children.
+  // Recurse into all children; large subtrees are handled as separate tasks.
   for (size_t i = 0; i < tree->NumChildren(); ++i)
+  {
+    #pragma omp task if (tree->NumDescendants() >= ParallelCleanupSize) \
+        firstprivate(i) shared(tree)
     CleanupHelper(&tree->Child(i));
+  }
+  #pragma omp taskwait
 
   // Get the component of the first child or point.  Then we will check to see
   // if all other components of children and points are the same.
@@ -318,11 +431,22 @@ template<
              typename TreeMatType> class TreeType>
 void DualTreeBoruvka<MetricType, MatType, TreeType>::Cleanup()
 {
-  for (size_t i = 0; i < data.n_cols; ++i)
-    neighborsDistances[i] = DBL_MAX;
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    neighborsInComponent[i].store(data.n_cols, std::memory_order_relaxed);
+    neighborsDistances[i].store(DBL_MAX, std::memory_order_relaxed);
+    pointDistances[i] = DBL_MAX;
+  }
 
   if (!naive)
-    CleanupHelper(tree);
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      CleanupHelper(tree);
+    }
+  }
 }
 
 } // namespace emst
@@ -16,18 +16,45 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
+#include "concurrent_union_find.hpp"
+
 namespace mlpack {
 namespace emst {
 
+/**
+ * The rules for a dual-tree traversal that finds, for each component of the
+ * spanning forest, the nearest point outside of it.  Each point keeps its own
+ * nearest point outside its component (ties are broken by the index of that
+ * point), while each component keeps only the distance to its nearest
+ * neighbor, which is used for pruning.  The candidate edge of a component is
+ * chosen from the candidates of its points after the traversal.
+ *
+ * This allows several DTBRules objects to traverse disjoint query subtrees of
+ * the same tree at once: the candidates of each point are only touched by the
+ * traversal that holds it, and the component distances are atomics that are
+ * only ever lowered.
+ */
 template<typename MetricType, typename TreeType>
 class DTBRules
 {
  public:
+  /**
+   * Construct the rules.
+   *
+   * @param dataSet The data points.
+   * @param connections The components found so far.
+   * @param neighborsDistances The distance to the candidate nearest neighbor
+   *     of each component.
+   * @param pointDistances The distance to the candidate nearest neighbor of
+   *     each point.
+   * @param pointNeighbors The candidate nearest neighbor of each point.
+   * @param metric The instantiated metric.
+   */
   DTBRules(const arma::mat& dataSet,
-           UnionFind& connections,
-           arma::vec& neighborsDistances,
-           arma::Col<size_t>& neighborsInComponent,
-           arma::Col<size_t>& neighborsOutComponent,
+           ConcurrentUnionFind& connections,
+           std::vector<std::atomic<double>>& neighborsDistances,
+           arma::vec& pointDistances,
+           arma::Col<size_t>& pointNeighbors,
            MetricType& metric);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -102,22 +129,27 @@ class DTBRules
   const arma::mat& dataSet;
 
   //! Stores the tree structure so far
-  UnionFind& connections;
+  ConcurrentUnionFind& connections;
 
   //! The distance to the candidate nearest neighbor for each component.
-  arma::vec& neighborsDistances;
+  std::vector<std::atomic<double>>& neighborsDistances;
 
-  //! The index of the point in the component that is an endpoint of the
-  //! candidate edge.
-  arma::Col<size_t>& neighborsInComponent;
+  //! The distance to the candidate nearest neighbor for each point.
+  arma::vec& pointDistances;
 
-  //! The index of the point outside of the component that is an endpoint
-  //! of the candidate edge.
-  arma::Col<size_t>& neighborsOutComponent;
+  //! The index of the point outside of the component of each point that is
+  //! its candidate nearest neighbor.
+  arma::Col<size_t>& pointNeighbors;
 
   //! The instantiated metric.
   MetricType& metric;
 
+  //! Return the distance to the candidate nearest neighbor of a component.
+  double ComponentBound(const size_t component) const
+  {
+    return neighborsDistances[component].load(std::memory_order_relaxed);
+  }
+
   /**
    * Update the bound for the given query node.
    */
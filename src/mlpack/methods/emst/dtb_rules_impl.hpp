@@ -18,17 +18,17 @@ namespace emst {
 template<typename MetricType, typename TreeType>
 DTBRules<MetricType, TreeType>::
 DTBRules(const arma::mat& dataSet,
-         UnionFind& connections,
-         arma::vec& neighborsDistances,
-         arma::Col<size_t>& neighborsInComponent,
-         arma::Col<size_t>& neighborsOutComponent,
+         ConcurrentUnionFind& connections,
+         std::vector<std::atomic<double>>& neighborsDistances,
+         arma::vec& pointDistances,
+         arma::Col<size_t>& pointNeighbors,
          MetricType& metric)
 :
   dataSet(dataSet),
   connections(connections),
   neighborsDistances(neighborsDistances),
-  neighborsInComponent(neighborsInComponent),
-  neighborsOutComponent(neighborsOutComponent),
+  pointDistances(pointDistances),
+  pointNeighbors(pointNeighbors),
   metric(metric),
   baseCases(0),
   scores(0)
@@ -57,18 +57,28 @@ double DTBRules<MetricType, TreeType>::BaseCase(const size_t queryIndex,
     double distance = metric.Evaluate(dataSet.col(queryIndex),
                                       dataSet.col(referenceIndex));
 
-    if (distance < neighborsDistances[queryComponentIndex])
+    // Ties are broken by the index of the reference point, so that the
+    // candidate does not depend on the order of the base cases.
+    if (distance < pointDistances[queryIndex] ||
+        (distance == pointDistances[queryIndex] &&
+         referenceIndex < pointNeighbors[queryIndex]))
     {
       Log::Assert(queryIndex != referenceIndex);
 
-      neighborsDistances[queryComponentIndex] = distance;
-      neighborsInComponent[queryComponentIndex] = queryIndex;
-      neighborsOutComponent[queryComponentIndex] = referenceIndex;
+      pointDistances[queryIndex] = distance;
+      pointNeighbors[queryIndex] = referenceIndex;
+
+      // Lower the bound of the component.  Other traversals may be lowering
+      // it at the same time.
+      std::atomic<double>& bound = neighborsDistances[queryComponentIndex];
+      double oldBound = bound.load(std::memory_order_relaxed);
+      while (distance < oldBound && !bound.compare_exchange_weak(oldBound,
+          distance, std::memory_order_relaxed)) { }
     }
   }
 
-  if (newUpperBound < neighborsDistances[queryComponentIndex])
-    newUpperBound = neighborsDistances[queryComponentIndex];
+  if (newUpperBound < ComponentBound(queryComponentIndex))
+    newUpperBound = ComponentBound(queryComponentIndex);
 
   Log::Assert(newUpperBound >= 0.0);
 
@@ -93,8 +103,7 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
-  return neighborsDistances[queryComponentIndex] < distance
-      ? DBL_MAX : distance;
+  return ComponentBound(queryComponentIndex) < distance ? DBL_MAX : distance;
 }
 
 template<typename MetricType, typename TreeType>
@@ -104,7 +113,7 @@ double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
 {
   // We don't need to check component membership again, because it can't
   // change inside a single iteration.
-  return (oldScore > neighborsDistances[connections.Find(queryIndex)])
+  return (oldScore > ComponentBound(connections.Find(queryIndex)))
       ? DBL_MAX : oldScore;
 }
 
@@ -153,7 +162,7 @@ inline double DTBRules<MetricType, TreeType>::CalculateBound(
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
     const size_t pointComponent = connections.Find(queryNode.Point(i));
-    const double bound = neighborsDistances[pointComponent];
+    const double bound = ComponentBound(pointComponent);
 
     if (bound > worstPointBound)
       worstPointBound = bound;
@@ -0,0 +1,124 @@
+/**
+ * @file methods/fastmks/block_kernels.hpp
+ *
+ * Evaluation of a kernel between every pair of points of two blocks of points.
+ * For kernels that are functions of the dot product, this is done with a
+ * single matrix multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_FASTMKS_BLOCK_KERNELS_HPP
+#define MLPACK_METHODS_FASTMKS_BLOCK_KERNELS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/cosine_distance.hpp>
+
+namespace mlpack {
+namespace fastmks {
+
+/**
+ * BlockKernels computes the kernel value between each point of a block of
+ * points a and each point of a block of points b, so that element (i, j) of
+ * the result is K(a_i, b_j).  In general this is done one pair at a time, but
+ * for the linear kernel, the polynomial kernel, and the cosine distance, all of
+ * the dot products are computed at once with a matrix multiplication (which is
+ * much faster, as it can use an optimized BLAS).
+ *
+ * @tparam KernelType Type of kernel to evaluate.
+ */
+template<typename KernelType>
+class BlockKernels
+{
+ public:
+  /**
+   * Compute the kernel value between each point of a and each point of b.
+   *
+   * @param kernel Instantiated kernel.
+   * @param a First block of points.
+   * @param b Second block of points.
+   * @param kernels Matrix to store the kernel values in.
+   */
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(KernelType& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& kernels)
+  {
+    kernels.set_size(a.n_cols, b.n_cols);
+    for (size_t j = 0; j < b.n_cols; ++j)
+      for (size_t i = 0; i < a.n_cols; ++i)
+        kernels(i, j) = kernel.Evaluate(a.col(i), b.col(j));
+  }
+};
+
+//! The linear kernel is the dot product itself.
+template<>
+class BlockKernels<kernel::LinearKernel>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(kernel::LinearKernel& /* kernel */,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& kernels)
+  {
+    kernels = a.t() * b;
+  }
+};
+
+//! The polynomial kernel is a function of the dot product.
+template<>
+class BlockKernels<kernel::PolynomialKernel>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(kernel::PolynomialKernel& kernel,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& kernels)
+  {
+    kernels = a.t() * b;
+    kernels = arma::pow(kernels + kernel.Offset(), kernel.Degree());
+  }
+};
+
+//! The cosine distance is the dot product divided by the norms of the points.
+template<>
+class BlockKernels<kernel::CosineDistance>
+{
+ public:
+  template<typename MatTypeA, typename MatTypeB>
+  static void Evaluate(kernel::CosineDistance& /* kernel */,
+                       const MatTypeA& a,
+                       const MatTypeB& b,
+                       arma::mat& kernels)
+  {
+    kernels = a.t() * b;
+
+    arma::vec aNorms(a.n_cols);
+    for (size_t i = 0; i < a.n_cols; ++i)
+      aNorms[i] = arma::norm(a.col(i), 2);
+
+    for (size_t j = 0; j < b.n_cols; ++j)
+    {
+      const double bNorm = arma::norm(b.col(j), 2);
+      for (size_t i = 0; i < a.n_cols; ++i)
+      {
+        // As in CosineDistance::Evaluate(), a zero norm gives a kernel of 0.
+        const double denominator = aNorms[i] * bNorm;
+        kernels(i, j) = (denominator == 0.0) ? 0.0 :
+            kernels(i, j) / denominator;
+      }
+    }
+  }
+};
+
+} // namespace fastmks
+} // namespace mlpack
+
+#endif
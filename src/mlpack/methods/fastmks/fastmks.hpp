@@ -16,6 +16,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/ip_metric.hpp>
 #include "fastmks_stat.hpp"
+#include "fastmks_rules.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <queue>
 
@@ -302,6 +303,12 @@ class FastMKS
   //! Modify whether or not brute-force (naive) search is used.
   bool& Naive() { return naive; }
 
+  //! Get whether or not search is done in parallel.  This is not serialized.
+  bool Parallel() const { return parallel; }
+  //! Modify whether or not search is done in parallel.  This is not
+  //! serialized.
+  bool& Parallel() { return parallel; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */);
@@ -321,6 +328,10 @@ class FastMKS
   bool singleMode;
   //! If true, naive (brute-force) search is used.
   bool naive;
+  //! If true, dual-tree and brute-force search are done in parallel with
+  //! OpenMP.  Single-tree search is always serial, because it stores kernel
+  //! values in the reference tree.
+  bool parallel;
 
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
@@ -339,6 +350,41 @@ class FastMKS
   //! Use a priority queue to represent the list of candidate points.
   typedef std::priority_queue<Candidate, std::vector<Candidate>,
       CandidateCmp> CandidateList;
+
+  //! The type of rules used for tree search.
+  typedef FastMKSRules<KernelType, Tree> RuleType;
+
+  /**
+   * Perform brute-force search for each point in the query set.  The kernel
+   * values are computed for blocks of query and reference points at a time
+   * with BlockKernels, and the blocks of query points are searched in parallel
+   * if Parallel() is true.
+   *
+   * @param querySet Set of query points.
+   * @param sameSet Whether the query set is the reference set, in which case
+   *     each point is not returned as its own candidate.
+   * @param k The number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices of max-kernel search in.
+   * @param kernels Matrix to store resulting max-kernel values in.
+   */
+  void BruteForceSearch(const MatType& querySet,
+                        const bool sameSet,
+                        const size_t k,
+                        arma::Mat<size_t>& indices,
+                        arma::mat& kernels);
+
+  /**
+   * Run the dual-tree traversal with the given query tree and rules.  If
+   * Parallel() is true, the query tree is split into subtrees that are
+   * traversed in parallel.
+   *
+   * @param queryTree Tree built on query points.
+   * @param rules Rules that hold the results of the search.
+   */
+  void DualTreeTraverse(Tree& queryTree, RuleType& rules);
+
+  //! Reset the bound of each node in the given query tree.
+  static void ResetBounds(Tree& queryNode);
 };
 
 } // namespace fastmks
@@ -15,9 +15,10 @@
 // In case it hasn't yet been included.
 #include "fastmks.hpp"
 
-#include "fastmks_rules.hpp"
+#include "block_kernels.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/tree/subtree_partition.hpp>
 
 namespace mlpack {
 namespace fastmks {
@@ -35,7 +36,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const bool singleMode,
     treeOwner(true),
     setOwner(true),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    parallel(false)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -58,7 +60,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(false),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    parallel(false)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -82,6 +85,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const MatType& referenceSet,
     setOwner(false),
     singleMode(singleMode),
     naive(naive),
+    parallel(false),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -108,7 +112,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(naive),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    parallel(false)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -135,6 +140,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(MatType&& referenceSet,
     setOwner(naive),
     singleMode(singleMode),
     naive(naive),
+    parallel(false),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -163,6 +169,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(Tree* referenceTree,
     setOwner(false),
     singleMode(singleMode),
     naive(false),
+    parallel(false),
     metric(referenceTree->Metric())
 {
   // Nothing to do.
@@ -180,6 +187,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const FastMKS& other) :
     setOwner(other.referenceTree == NULL),
     singleMode(other.singleMode),
     naive(other.naive),
+    parallel(other.parallel),
     metric(other.metric)
 {
   // Set reference set correctly.
@@ -201,6 +209,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
     setOwner(other.setOwner),
     singleMode(other.singleMode),
     naive(other.naive),
+    parallel(other.parallel),
     metric(std::move(other.metric))
 {
   // Clear information from the other.
@@ -210,6 +219,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
   other.setOwner = false;
   other.singleMode = false;
   other.naive = false;
+  other.parallel = false;
 }
 
 template<typename KernelType,
@@ -248,6 +258,8 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  parallel = other.parallel;
+  return *this;
 }
 
 template<typename KernelType,
@@ -266,6 +278,7 @@ FastMKS<KernelType, MatType, TreeType>::operator=(FastMKS&& other)
     setOwner = other.setOwner;
     singleMode = other.singleMode;
     naive = other.naive;
+    parallel = other.parallel;
     metric = std::move(other.metric);
 
     // Clear information from the other.
@@ -275,6 +288,7 @@ FastMKS<KernelType, MatType, TreeType>::operator=(FastMKS&& other)
     other.setOwner = false;
     other.singleMode = false;
     other.naive = false;
+    other.parallel = false;
   }
   return *this;
 }
@@ -455,33 +469,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; ++j)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    BruteForceSearch(querySet, false, k, indices, kernels);
 
     Timer::Stop("computing_products");
 
@@ -493,7 +481,6 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   {
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
-    typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, querySet, k, metric.Kernel());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
@@ -559,12 +546,9 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   kernels.set_size(k, queryTree->Dataset().n_cols);
 
   Timer::Start("computing_products");
-  typedef FastMKSRules<KernelType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
 
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeTraverse(*queryTree, rules);
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
@@ -592,36 +576,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; ++j)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    // Don't return each point as its own candidate.
+    BruteForceSearch(*referenceSet, true, k, indices, kernels);
 
     Timer::Stop("computing_products");
 
@@ -633,7 +589,6 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   {
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
-    typedef FastMKSRules<KernelType, Tree> RuleType;
     RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
@@ -661,6 +616,152 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::BruteForceSearch(
+    const MatType& querySet,
+    const bool sameSet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels)
+{
+  // The kernel values between a block of query points and a block of reference
+  // points are computed at once, which lets dot-product kernels use a single
+  // matrix multiplication.  The blocks are small enough that the kernel values
+  // of one block fit in cache.
+  const size_t queryBlockSize = 256;
+  const size_t referenceBlockSize = 2048;
+  const size_t numQueryBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+  // Each block of query points has its own candidate lists, so the blocks can
+  // be searched in parallel without locking.
+  #pragma omp parallel for schedule(dynamic) if (parallel)
+  for (omp_size_t b = 0; b < (omp_size_t) numQueryBlocks; ++b)
+  {
+    const size_t queryBegin = b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+        (size_t) querySet.n_cols);
+
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+    std::vector<Candidate> cList(k, def);
+    std::vector<CandidateList> pqueues(queryEnd - queryBegin,
+        CandidateList(CandidateCmp(), std::move(cList)));
+
+    arma::mat blockKernels;
+    for (size_t referenceBegin = 0; referenceBegin < referenceSet->n_cols;
+         referenceBegin += referenceBlockSize)
+    {
+      const size_t referenceEnd = std::min(referenceBegin + referenceBlockSize,
+          (size_t) referenceSet->n_cols);
+
+      BlockKernels<KernelType>::Evaluate(metric.Kernel(),
+          querySet.cols(queryBegin, queryEnd - 1),
+          referenceSet->cols(referenceBegin, referenceEnd - 1), blockKernels);
+
+      for (size_t r = referenceBegin; r < referenceEnd; ++r)
+      {
+        for (size_t q = queryBegin; q < queryEnd; ++q)
+        {
+          if (sameSet && q == r)
+            continue; // Don't return the point as its own candidate.
+
+          const double eval = blockKernels(q - queryBegin, r - referenceBegin);
+          CandidateList& pqueue = pqueues[q - queryBegin];
+          if (eval > pqueue.top().first)
+          {
+            Candidate c = std::make_pair(eval, r);
+            pqueue.pop();
+            pqueue.push(c);
+          }
+        }
+      }
+    }
+
+    for (size_t q = queryBegin; q < queryEnd; ++q)
+    {
+      CandidateList& pqueue = pqueues[q - queryBegin];
+      for (size_t j = 1; j <= k; ++j)
+      {
+        indices(k - j, q) = pqueue.top().second;
+        kernels(k - j, q) = pqueue.top().first;
+        pqueue.pop();
+      }
+    }
+  }
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::DualTreeTraverse(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  // The bounds left in the query tree by an earlier search are not valid for
+  // this one.
+  ResetBounds(queryTree);
+
+  if (!parallel)
+  {
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    return;
+  }
+
+  // Split the query tree into many more subtrees than there are threads, so
+  // that dynamic scheduling can balance the uneven cost of the subtrees.  Each
+  // query point is held by only one subtree, so its candidate list is only
+  // touched by one task.  The dual-tree rules only modify the bounds of query
+  // nodes, and the ancestors of the subtrees keep the bound set above, so this
+  // is also safe when the query tree is the reference tree.
+  #ifdef HAS_OPENMP
+    const size_t numTasks = (omp_get_max_threads() == 1) ? 1 :
+        8 * omp_get_max_threads();
+  #else
+    const size_t numTasks = 1;
+  #endif
+
+  std::vector<Tree*> subtrees;
+  tree::PartitionSubtrees(queryTree, numTasks, subtrees);
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    // Each task gets its own traversal info and base case cache.
+    RuleType taskRules(rules, true /* share candidates */);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(taskRules);
+    traverser.Traverse(*subtrees[i], *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::ResetBounds(Tree& queryNode)
+{
+  queryNode.Stat().Bound() = -DBL_MAX;
+  for (size_t i = 0; i < queryNode.NumChildren(); ++i)
+    ResetBounds(queryNode.Child(i));
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
@@ -101,6 +101,8 @@ PARAM_INT_IN("k", "Number of maximum kernels to find.", "k", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_FLAG("parallel", "If true, dual-tree and naive search are split among "
+    "threads.", "P");
 
 PARAM_MATRIX_OUT("kernels", "Output matrix of kernels.", "p");
 PARAM_UMATRIX_OUT("indices", "Output matrix of indices.", "i");
@@ -146,6 +148,9 @@ static void mlpackMain()
   // Naive mode overrides single mode.
   ReportIgnoredParam({{ "naive", true }}, "single");
 
+  // Single-tree search is always serial.
+  ReportIgnoredParam({{ "single", true }, { "naive", false }}, "parallel");
+
   FastMKSModel* model;
   arma::mat referenceData;
   if (IO::HasParam("reference"))
@@ -222,6 +227,7 @@ static void mlpackMain()
   // Set search preferences.
   model->Naive() = IO::HasParam("naive");
   model->SingleMode() = IO::HasParam("single");
+  model->Parallel() = IO::HasParam("parallel");
 
   // Should we do search?
   if (IO::HasParam("k"))
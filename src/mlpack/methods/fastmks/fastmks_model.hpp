@@ -89,6 +89,11 @@ class FastMKSModel
   //! Set whether or not single-tree search is used.
   bool& SingleMode();
 
+  //! Get whether or not search is done in parallel.
+  bool Parallel() const;
+  //! Set whether or not search is done in parallel.
+  bool& Parallel();
+
   //! Get the kernel type.
   int KernelType() const { return kernelType; }
   //! Modify the kernel type.
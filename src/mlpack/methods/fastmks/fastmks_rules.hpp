@@ -48,6 +48,30 @@ class FastMKSRules
                const size_t k,
                KernelType& kernel);
 
+  /**
+   * Copy the given FastMKSRules object, including its candidate lists.
+   *
+   * @param other FastMKSRules object to copy.
+   */
+  FastMKSRules(const FastMKSRules& other);
+
+  /**
+   * Construct a FastMKSRules object that searches for the same query points as
+   * the given object, but has its own traversal information, base case cache,
+   * and counters, so it can be used by a different thread than the given
+   * object.  The given object must outlive the new one.
+   *
+   * If shareCandidates is true, the new object stores its results in the same
+   * candidate lists as the given object.  This is what the parallel dual-tree
+   * search uses: each task traverses a disjoint subtree of the query tree, so
+   * no two tasks ever modify the same candidate list.
+   *
+   * @param other FastMKSRules object to take the settings from.
+   * @param shareCandidates If true, share the candidate lists of the other
+   *      object; otherwise, start from new, empty candidate lists.
+   */
+  FastMKSRules(FastMKSRules& other, const bool shareCandidates);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -152,8 +176,12 @@ class FastMKSRules
   typedef boost::heap::priority_queue<Candidate,
       boost::heap::compare<CandidateCmp>> CandidateList;
 
-  //! Set of candidates for each point.
-  std::vector<CandidateList> candidates;
+  //! Set of candidates for each point, if they are not shared with another
+  //! FastMKSRules object.
+  std::vector<CandidateList> ownedCandidates;
+  //! Set of candidates for each point; either ownedCandidates or the
+  //! candidates of the object they are shared with.
+  std::vector<CandidateList>* candidates;
 
   //! Number of points to search for.
   const size_t k;
@@ -26,6 +26,7 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     KernelType& kernel) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(&ownedCandidates),
     k(k),
     kernel(kernel),
     lastQueryIndex(-1),
@@ -61,7 +62,62 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   for (size_t i = 0; i < k; ++i)
     pqueue.push(def);
   std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
-  candidates.swap(tmp);
+  ownedCandidates.swap(tmp);
+}
+
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(const FastMKSRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    ownedCandidates(*other.candidates),
+    candidates(&ownedCandidates),
+    k(other.k),
+    queryKernels(other.queryKernels),
+    referenceKernels(other.referenceKernels),
+    kernel(other.kernel),
+    lastQueryIndex(other.lastQueryIndex),
+    lastReferenceIndex(other.lastReferenceIndex),
+    lastKernel(other.lastKernel),
+    baseCases(other.baseCases),
+    scores(other.scores)
+{
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+}
+
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(FastMKSRules& other,
+                                                 const bool shareCandidates) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(shareCandidates ? other.candidates : &ownedCandidates),
+    k(other.k),
+    // Alias the self-kernels of the other object instead of copying them.
+    queryKernels(other.queryKernels.memptr(), other.queryKernels.n_elem, false,
+        true),
+    referenceKernels(other.referenceKernels.memptr(),
+        other.referenceKernels.n_elem, false, true),
+    kernel(other.kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    baseCases(0),
+    scores(0)
+{
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+
+  if (!shareCandidates)
+  {
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+
+    CandidateList pqueue;
+    pqueue.reserve(k);
+    for (size_t i = 0; i < k; ++i)
+      pqueue.push(def);
+    std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
+    ownedCandidates.swap(tmp);
+  }
 }
 
 template<typename KernelType, typename TreeType>
@@ -74,7 +130,7 @@ void FastMKSRules<KernelType, TreeType>::GetResults(
 
   for (size_t i = 0; i < querySet.n_cols; ++i)
   {
-    CandidateList& pqueue = candidates[i];
+    CandidateList& pqueue = (*candidates)[i];
     for (size_t j = 1; j <= k; ++j)
     {
       indices(k - j, i) = pqueue.top().second;
@@ -129,7 +185,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
                                                  TreeType& referenceNode)
 {
   // Compare with the current best.
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = (*candidates)[queryIndex].top().first;
 
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
@@ -412,7 +468,7 @@ double FastMKSRules<KernelType, TreeType>::Rescore(const size_t queryIndex,
                                                    TreeType& /*referenceNode*/,
                                                    const double oldScore) const
 {
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = (*candidates)[queryIndex].top().first;
 
   return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
 }
@@ -459,7 +515,7 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
     const size_t point = queryNode.Point(i);
-    const CandidateList& candidatesPoints = candidates[point];
+    const CandidateList& candidatesPoints = (*candidates)[point];
     if (candidatesPoints.top().first < worstPointKernel)
       worstPointKernel = candidatesPoints.top().first;
 
@@ -529,7 +585,7 @@ inline void FastMKSRules<KernelType, TreeType>::InsertNeighbor(
     const size_t index,
     const double product)
 {
-  CandidateList& pqueue = candidates[queryIndex];
+  CandidateList& pqueue = (*candidates)[queryIndex];
   if (product > pqueue.top().first)
   {
     Candidate c = std::make_pair(product, index);
@@ -16,7 +16,10 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 
+#include <mlpack/core/tree/subtree_partition.hpp>
+
 #include "kde_stat.hpp"
+#include "kde_rules.hpp"
 
 namespace mlpack {
 namespace kde /** Kernel Density Estimation. */ {
@@ -55,6 +58,12 @@ struct KDEDefaultParams
 
   //! Monte Carlo break coefficient.
   static constexpr double mcBreakCoef = 0.4;
+
+  //! Whether to use series expansions when possible.
+  static constexpr bool seriesExpansion = false;
+
+  //! Maximum order of the series expansions.
+  static constexpr size_t seriesOrder = 8;
 };
 
 /**
@@ -64,6 +73,23 @@ struct KDEDefaultParams
  * This implementation performs this estimation using a tree-independent
  * dual-tree algorithm. Details about this algorithm are available in KDERules.
  *
+ * If Parallel() is set, the evaluation is split among OpenMP threads, which
+ * share the reference tree.  In dual-tree mode the query tree is split into
+ * disjoint subtrees, and in single-tree mode the query set is split into
+ * blocks of points; each of these is then traversed by its own task.  Since
+ * the error tolerances are accounted for separately for each query point (or
+ * query node), the relative and absolute error guarantees still hold, but the
+ * estimations may differ slightly from those of a serial evaluation.  Each
+ * task draws its Monte Carlo samples from its own random number generator,
+ * seeded from mlpack's random seed.
+ *
+ * If SeriesExpansion() is set and the kernel is the Gaussian kernel with the
+ * Euclidean distance, the dual-tree and single-tree algorithms may also
+ * approximate the contributions of pairs of nodes with the Hermite and Taylor
+ * expansions of the fast Gauss transform, up to order SeriesOrder(), while
+ * still respecting the error tolerances; see KDERules for details.  This is
+ * most useful for data with few dimensions and large bandwidths.
+ *
  * @tparam KernelType Kernel function to use for KDE calculations.
  * @tparam MetricType Metric to use for KDE calculations.
  * @tparam MatType Type of data to use.
@@ -295,11 +321,38 @@ class KDE
   //! Modify Monte Carlo break coefficient. (0 < newCoef <= 1).
   void MCBreakCoef(const double newCoef);
 
+  //! Get whether the evaluation is split among threads.
+  bool Parallel() const { return parallel; }
+
+  //! Modify whether the evaluation is split among threads.  This setting is
+  //! not serialized with the model.
+  bool& Parallel() { return parallel; }
+
+  //! Get whether series expansions are being used or not.
+  bool SeriesExpansion() const { return seriesExpansion; }
+
+  //! Modify whether series expansions are being used or not.  This setting is
+  //! not serialized with the model.
+  bool& SeriesExpansion() { return seriesExpansion; }
+
+  //! Get the maximum order of the series expansions.
+  size_t SeriesOrder() const { return seriesOrder; }
+
+  //! Modify the maximum order of the series expansions.  This setting is not
+  //! serialized with the model.
+  size_t& SeriesOrder() { return seriesOrder; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t version);
 
  private:
+  //! The type of rules used for evaluation.
+  typedef KDERules<MetricType, KernelType, Tree> RuleType;
+
+  //! In parallel single-tree mode, each task evaluates this many query points.
+  static const size_t ParallelBlockSize = 256;
+
   //! Kernel.
   KernelType kernel;
 
@@ -346,6 +399,35 @@ class KDE
   //! is the limit before Monte Carlo estimation recurses.
   double mcBreakCoef;
 
+  //! If true, the evaluation is split among OpenMP threads.
+  bool parallel;
+
+  //! If true, series expansions will be used when possible.
+  bool seriesExpansion;
+
+  //! Maximum order of the series expansions.
+  size_t seriesOrder;
+
+  /**
+   * Traverse the reference tree for each of the given number of query points
+   * with the given rules.  If parallel is true, blocks of query points are
+   * traversed as separate tasks.
+   *
+   * @param rules Rules to use for the traversal.
+   * @param numQueries Number of query points.
+   */
+  void SingleTreeTraverse(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Traverse the given query tree and the reference tree with the given rules.
+   * If parallel is true, the query tree is split into disjoint subtrees that
+   * are traversed as separate tasks.
+   *
+   * @param rules Rules to use for the traversal.
+   * @param queryTree Query tree.
+   */
+  void DualTreeTraverse(RuleType& rules, Tree& queryTree);
+
   //! Check whether absolute and relative error values are compatible.
   static void CheckErrorValues(const double relError, const double absError);
 
@@ -72,7 +72,10 @@ KDE(const double relError,
     trained(false),
     mode(mode),
     monteCarlo(monteCarlo),
-    initialSampleSize(initialSampleSize)
+    initialSampleSize(initialSampleSize),
+    parallel(false),
+    seriesExpansion(KDEDefaultParams::seriesExpansion),
+    seriesOrder(KDEDefaultParams::seriesOrder)
 {
   CheckErrorValues(relError, absError);
   MCProb(mcProb);
@@ -106,7 +109,10 @@ KDE(const KDE& other) :
     mcProb(other.mcProb),
     initialSampleSize(other.initialSampleSize),
     mcEntryCoef(other.mcEntryCoef),
-    mcBreakCoef(other.mcBreakCoef)
+    mcBreakCoef(other.mcBreakCoef),
+    parallel(other.parallel),
+    seriesExpansion(other.seriesExpansion),
+    seriesOrder(other.seriesOrder)
 {
   if (trained)
   {
@@ -152,7 +158,10 @@ KDE(KDE&& other) :
     mcProb(other.mcProb),
     initialSampleSize(other.initialSampleSize),
     mcEntryCoef(other.mcEntryCoef),
-    mcBreakCoef(other.mcBreakCoef)
+    mcBreakCoef(other.mcBreakCoef),
+    parallel(other.parallel),
+    seriesExpansion(other.seriesExpansion),
+    seriesOrder(other.seriesOrder)
 {
   other.kernel = std::move(KernelType());
   other.metric = std::move(MetricType());
@@ -168,6 +177,9 @@ KDE(KDE&& other) :
   other.initialSampleSize = KDEDefaultParams::initialSampleSize;
   other.mcEntryCoef = KDEDefaultParams::mcEntryCoef;
   other.mcBreakCoef = KDEDefaultParams::mcBreakCoef;
+  other.parallel = false;
+  other.seriesExpansion = KDEDefaultParams::seriesExpansion;
+  other.seriesOrder = KDEDefaultParams::seriesOrder;
 }
 
 template<typename KernelType,
@@ -212,6 +224,9 @@ operator=(const KDE& other)
     initialSampleSize = other.initialSampleSize;
     mcEntryCoef = other.mcEntryCoef;
     mcBreakCoef = other.mcBreakCoef;
+    parallel = other.parallel;
+    seriesExpansion = other.seriesExpansion;
+    seriesOrder = other.seriesOrder;
     if (trained)
     {
       if (ownsReferenceTree)
@@ -276,6 +291,9 @@ operator=(KDE&& other)
     this->initialSampleSize = other.initialSampleSize;
     this->mcEntryCoef = other.mcEntryCoef;
     this->mcBreakCoef = other.mcBreakCoef;
+    this->parallel = other.parallel;
+    this->seriesExpansion = other.seriesExpansion;
+    this->seriesOrder = other.seriesOrder;
   }
   return *this;
 }
@@ -442,7 +460,6 @@ Evaluate(MatType querySet, arma::vec& estimations)
     Timer::Start("computing_kde");
 
     // Evaluate.
-    typedef KDERules<MetricType, KernelType, Tree> RuleType;
     RuleType rules = RuleType(referenceTree->Dataset(),
                               querySet,
                               estimations,
@@ -455,14 +472,12 @@ Evaluate(MatType querySet, arma::vec& estimations)
                               metric,
                               kernel,
                               monteCarlo,
-                              false);
-
-    // Create traverser.
-    SingleTreeTraversalType<RuleType> traverser(rules);
+                              false,
+                              seriesExpansion,
+                              seriesOrder);
 
     // Traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeTraverse(rules, querySet.n_cols);
 
     estimations /= referenceTree->Dataset().n_cols;
     Timer::Stop("computing_kde");
@@ -540,7 +555,6 @@ Evaluate(Tree* queryTree,
   Timer::Start("computing_kde");
 
   // Evaluate.
-  typedef KDERules<MetricType, KernelType, Tree> RuleType;
   RuleType rules = RuleType(referenceTree->Dataset(),
                             queryTree->Dataset(),
                             estimations,
@@ -553,11 +567,11 @@ Evaluate(Tree* queryTree,
                             metric,
                             kernel,
                             monteCarlo,
-                            false);
+                            false,
+                            seriesExpansion,
+                            seriesOrder);
 
-  // Create traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeTraverse(rules, *queryTree);
   estimations /= referenceTree->Dataset().n_cols;
   Timer::Stop("computing_kde");
 
@@ -609,7 +623,6 @@ Evaluate(arma::vec& estimations)
   Timer::Start("computing_kde");
 
   // Evaluate.
-  typedef KDERules<MetricType, KernelType, Tree> RuleType;
   RuleType rules = RuleType(referenceTree->Dataset(),
                             referenceTree->Dataset(),
                             estimations,
@@ -622,20 +635,14 @@ Evaluate(arma::vec& estimations)
                             metric,
                             kernel,
                             monteCarlo,
-                            true);
+                            true,
+                            seriesExpansion,
+                            seriesOrder);
 
   if (mode == DUAL_TREE_MODE)
-  {
-    // Create traverser.
-    DualTreeTraversalType<RuleType> traverser(rules);
-    traverser.Traverse(*referenceTree, *referenceTree);
-  }
+    DualTreeTraverse(rules, *referenceTree);
   else if (mode == SINGLE_TREE_MODE)
-  {
-    SingleTreeTraversalType<RuleType> traverser(rules);
-    for (size_t i = 0; i < referenceTree->Dataset().n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-  }
+    SingleTreeTraverse(rules, referenceTree->Dataset().n_cols);
 
   estimations /= referenceTree->Dataset().n_cols;
   // Rearrange if necessary.
@@ -646,6 +653,139 @@ Evaluate(arma::vec& estimations)
   Log::Info << rules.BaseCases() << " base cases were calculated." << std::endl;
 }
 
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+SingleTreeTraverse(RuleType& rules, const size_t numQueries)
+{
+  // The far-field expansions of the reference nodes are needed by the
+  // traversal.
+  rules.PrepareFarFieldExpansions(*referenceTree);
+
+  if (!parallel)
+  {
+    SingleTreeTraversalType<RuleType> traverser(rules);
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+    return;
+  }
+
+  // The tasks may only read the statistics of the reference tree.
+  rules.CalculateAlphas(*referenceTree);
+
+  // Each block of query points gets its own seed, so that the results do not
+  // depend on the number of threads.
+  const size_t numBlocks = (numQueries + ParallelBlockSize - 1) /
+      ParallelBlockSize;
+  std::vector<size_t> seeds(numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i)
+    seeds[i] = math::randGen();
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    RuleType taskRules(rules, seeds[b]);
+    SingleTreeTraversalType<RuleType> traverser(taskRules);
+
+    const size_t end = std::min((b + 1) * ParallelBlockSize, numQueries);
+    for (size_t i = b * ParallelBlockSize; i < end; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void KDE<KernelType,
+         MetricType,
+         MatType,
+         TreeType,
+         DualTreeTraversalType,
+         SingleTreeTraversalType>::
+DualTreeTraverse(RuleType& rules, Tree& queryTree)
+{
+  // The far-field expansions of the reference nodes are needed by the
+  // traversal, and the local expansions are accumulated in the query nodes.
+  rules.PrepareFarFieldExpansions(*referenceTree);
+  rules.PrepareLocalExpansions(queryTree);
+
+  if (!parallel)
+  {
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    rules.EvaluateLocalExpansions(queryTree);
+    return;
+  }
+
+  // The tasks may only read the statistics of the reference tree.  (In
+  // monochromatic evaluation the query tree is the reference tree, but each
+  // task only modifies the error tolerances of the nodes of its own subtree.)
+  rules.CalculateAlphas(*referenceTree);
+
+  // Split the query tree into many more subtrees than there are threads, so
+  // that dynamic scheduling can balance the uneven cost of the subtrees.  The
+  // subtrees are disjoint, so each query point's estimation is only ever
+  // touched by one task.
+  #ifdef HAS_OPENMP
+    const size_t numTasks = (omp_get_max_threads() == 1) ? 1 :
+        8 * omp_get_max_threads();
+  #else
+    const size_t numTasks = 1;
+  #endif
+
+  std::vector<Tree*> subtrees;
+  tree::PartitionSubtrees(queryTree, numTasks, subtrees);
+
+  std::vector<size_t> seeds(subtrees.size());
+  for (size_t i = 0; i < subtrees.size(); ++i)
+    seeds[i] = math::randGen();
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    RuleType taskRules(rules, seeds[i]);
+    DualTreeTraversalType<RuleType> traverser(taskRules);
+    traverser.Traverse(*subtrees[i], *referenceTree);
+    taskRules.EvaluateLocalExpansions(*subtrees[i]);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
 template<typename KernelType,
          typename MetricType,
          typename MatType,
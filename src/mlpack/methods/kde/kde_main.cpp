@@ -54,7 +54,18 @@ BINDING_LONG_DESC(
     "type of tree to use for the dual-tree algorithm with " +
     PRINT_PARAM_STRING("tree") + ". It is also possible to select whether to "
     "use dual-tree algorithm or single-tree algorithm using the " +
-    PRINT_PARAM_STRING("algorithm") + " option."
+    PRINT_PARAM_STRING("algorithm") + " option.  If the " +
+    PRINT_PARAM_STRING("parallel") + " flag is given, the evaluation is split "
+    "among threads (if mlpack was compiled with OpenMP); this keeps the same "
+    "error guarantees, but the predictions may differ slightly from those of a "
+    "serial evaluation."
+    "\n\n"
+    "When the Gaussian kernel is used, the " +
+    PRINT_PARAM_STRING("series_expansion") + " flag enables the Hermite and "
+    "Taylor series expansions of the fast Gauss transform, which can "
+    "approximate the contributions of whole groups of points at once while "
+    "keeping the same error guarantees.  This is most useful for data with "
+    "few dimensions (up to about 8) and large bandwidths."
     "\n\n"
     "Monte Carlo estimations can be used to accelerate the KDE estimate when "
     "the Gaussian Kernel is used. This provides a probabilistic guarantee on "
@@ -185,6 +196,13 @@ PARAM_DOUBLE_IN("mc_break_coef",
                 "the limit for the sample size before it recurses.",
                 "c",
                 KDEDefaultParams::mcBreakCoef);
+PARAM_FLAG("parallel",
+           "If set, the evaluation will be split among threads.",
+           "l");
+PARAM_FLAG("series_expansion",
+           "If set, series expansions will be used when possible (only with "
+           "the Gaussian kernel).",
+           "x");
 
 // Output predictions options.
 PARAM_COL_OUT("predictions", "Vector to store density predictions.",
@@ -225,6 +243,11 @@ static void mlpackMain()
     ReportIgnoredParam("monte_carlo",
                        "Monte Carlo only works with Gaussian kernel");
   }
+  if (IO::HasParam("series_expansion") && kernelStr != "gaussian")
+  {
+    ReportIgnoredParam("series_expansion",
+                       "series expansions only work with Gaussian kernel");
+  }
 
   // Requirements for parameter values.
   RequireParamInSet<string>("kernel", { "gaussian", "epanechnikov",
@@ -306,6 +329,8 @@ static void mlpackMain()
   kde->MCInitialSampleSize(initialSampleSize);
   kde->MCEntryCoefficient(mcEntryCoef);
   kde->MCBreakCoefficient(mcBreakCoef);
+  kde->Parallel() = IO::HasParam("parallel");
+  kde->SeriesExpansion() = IO::HasParam("series_expansion");
 
   // Evaluation.
   if (IO::HasParam("query"))
@@ -115,6 +115,16 @@ class KDEWrapperBase
   //! Modify the search mode.
   virtual KDEMode& Mode() = 0;
 
+  //! Get whether the evaluation is split among threads.
+  virtual bool Parallel() const = 0;
+  //! Modify whether the evaluation is split among threads.
+  virtual bool& Parallel() = 0;
+
+  //! Get whether series expansions are used.
+  virtual bool SeriesExpansion() const = 0;
+  //! Modify whether series expansions are used.
+  virtual bool& SeriesExpansion() = 0;
+
   //! Train the model (build the tree).
   virtual void Train(arma::mat&& referenceSet) = 0;
 
@@ -193,6 +203,16 @@ class KDEWrapper : public KDEWrapperBase
   //! Modify the search mode.
   virtual KDEMode& Mode() { return kde.Mode(); }
 
+  //! Get whether the evaluation is split among threads.
+  virtual bool Parallel() const { return kde.Parallel(); }
+  //! Modify whether the evaluation is split among threads.
+  virtual bool& Parallel() { return kde.Parallel(); }
+
+  //! Get whether series expansions are used.
+  virtual bool SeriesExpansion() const { return kde.SeriesExpansion(); }
+  //! Modify whether series expansions are used.
+  virtual bool& SeriesExpansion() { return kde.SeriesExpansion(); }
+
   //! Train the model (build the tree).
   virtual void Train(arma::mat&& referenceSet);
 
@@ -414,6 +434,20 @@ class KDEModel
   //! Modify the mode of the model.
   KDEMode& Mode() { return kdeModel->Mode(); }
 
+  //! Get whether the evaluation is split among threads.
+  bool Parallel() const { return kdeModel->Parallel(); }
+
+  //! Modify whether the evaluation is split among threads.  This setting is
+  //! not serialized with the model.
+  bool& Parallel() { return kdeModel->Parallel(); }
+
+  //! Get whether series expansions are used.
+  bool SeriesExpansion() const { return kdeModel->SeriesExpansion(); }
+
+  //! Modify whether series expansions are used (only with the Gaussian
+  //! kernel).  This setting is not serialized with the model.
+  bool& SeriesExpansion() { return kdeModel->SeriesExpansion(); }
+
   /**
    * Initialize the KDE model.
    */
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KDE_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace kde {
@@ -21,6 +22,35 @@ namespace kde {
 /**
  * A dual-tree traversal Rules class for kernel density estimation.  This
  * contains the Score() and BaseCase() implementations.
+ *
+ * If series expansions are enabled and the kernel is the Gaussian kernel with
+ * the Euclidean distance, combinations of nodes that can't be pruned with the
+ * kernel bounds may instead be approximated with the truncated Hermite and
+ * Taylor expansions of the fast Gauss transform.  A far-field expansion
+ * summarizes the points of a reference node around its center, and is
+ * evaluated at each query point; a local expansion summarizes the contribution
+ * of a reference node around the center of a query node, and is evaluated at
+ * each query point once the traversal is done.  The local expansion is either
+ * accumulated directly from the reference points, or translated from the
+ * far-field expansion of the reference node (the Hermite-to-local
+ * translation), whose cost does not depend on the number of points of either
+ * node.  The orders of the expansions are the lowest whose truncation error
+ * (bounded with Cramer's inequality for Hermite functions) fits in the error
+ * tolerance, and the cheapest approximation is used only if it is cheaper
+ * than computing the kernel values exactly.  The expansions are truncated by
+ * total degree, so the number of terms grows polynomially with the dimension;
+ * they are most useful for low-dimensional data (up to about 8 dimensions).
+ *
+ * @code
+ * @inproceedings{lee2006dual,
+ *   title = {Faster Gaussian Summation: Theory and Experiment},
+ *   author = {Lee, D. and Gray, A.G.},
+ *   booktitle = {Proceedings of the Twenty-Second Conference on Uncertainty
+ *       in Artificial Intelligence (UAI '06)},
+ *   pages = {281--288},
+ *   year = {2006}
+ * }
+ * @endcode
  */
 template<typename MetricType, typename KernelType, typename TreeType>
 class KDERules
@@ -45,6 +75,9 @@ class KDERules
    *                   possible.
    * @param sameSet True if query and reference sets are the same
    *                (monochromatic evaluation).
+   * @param seriesExpansion If true, series expansions will be applied when
+   *                        possible.
+   * @param seriesOrder Maximum order of the series expansions.
    */
   KDERules(const arma::mat& referenceSet,
            const arma::mat& querySet,
@@ -58,7 +91,22 @@ class KDERules
            MetricType& metric,
            KernelType& kernel,
            const bool monteCarlo,
-           const bool sameSet);
+           const bool sameSet,
+           const bool seriesExpansion,
+           const size_t seriesOrder);
+
+  /**
+   * Construct a KDERules object with the same reference set, query set,
+   * metric, kernel, and settings as the given object, for use by a different
+   * thread.  The new object adds to the same density estimations and per-query
+   * error tolerances as the given object, so the two must never be used on the
+   * same query points at the same time; it has its own traversal information,
+   * counters, and random number generator for Monte Carlo sampling.
+   *
+   * @param other Rules object to take the settings from.
+   * @param seed Seed of the random number generator of the new object.
+   */
+  KDERules(KDERules& other, const size_t seed);
 
   //! Base Case.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
@@ -89,9 +137,51 @@ class KDERules
 
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
 
   //! Get the number of scores.
   size_t Scores() const { return scores; }
+  //! Modify the number of scores.
+  size_t& Scores() { return scores; }
+
+  /**
+   * Calculate the Monte Carlo alpha of every node of the given reference tree
+   * in advance.  The traversal otherwise stores them in the node statistics
+   * the first time each node is scored, which is not safe when several threads
+   * traverse the tree at once.
+   *
+   * @param node Root of the reference tree.
+   */
+  void CalculateAlphas(TreeType& node);
+
+  /**
+   * Calculate the center and far-field coefficients of every node of the given
+   * reference tree, if series expansions are used and they are not already
+   * computed for the current bandwidth.  This must be done before the
+   * traversal.
+   *
+   * @param node Root of the reference tree.
+   */
+  void PrepareFarFieldExpansions(TreeType& node);
+
+  /**
+   * Calculate the center of every node of the given query tree and clear
+   * their local coefficients, if series expansions are used.  This must be
+   * done before a dual-tree traversal.
+   *
+   * @param node Root of the query tree.
+   */
+  void PrepareLocalExpansions(TreeType& node);
+
+  /**
+   * Add the local expansions accumulated in the nodes of the given query tree
+   * during a dual-tree traversal to the density estimations of their points,
+   * and clear them.
+   *
+   * @param node Root of the query tree.
+   */
+  void EvaluateLocalExpansions(TreeType& node);
 
   //! Get the minimum number of base cases we need to perform to have acceptable
   //! results.
@@ -109,6 +199,94 @@ class KDERules
   //! Calculate depth alpha for some node.
   double CalculateAlpha(TreeType* node);
 
+  //! Return a random integer in [lo, hiExclusive) for Monte Carlo sampling.
+  size_t RandInt(const size_t lo, const size_t hiExclusive);
+
+  /**
+   * Try to approximate the contribution of the given reference node to the
+   * given query node (or, if queryNode is NULL, to the given query point) with
+   * a series expansion.  If an expansion is cheaper than the exact computation
+   * and its error is at most maxError for each query point, it is applied and
+   * true is returned.  The expansions include every reference point, so the
+   * nodes must not share points other than the first points of the nodes
+   * (which is why, in monochromatic evaluation, nodes at distance 0 are never
+   * approximated).
+   *
+   * @param queryNode Query node, or NULL for single-tree evaluation.
+   * @param queryIndex Query point, for single-tree evaluation.
+   * @param referenceNode Reference node.
+   * @param minDistance Minimum distance between the query and reference nodes.
+   * @param maxError Maximum error allowed for each query point.
+   * @param alreadyDidRefPoint0 Whether the base case of the first points of the
+   *     nodes has already been computed.
+   * @param error Set to the error bound of the applied expansion.
+   */
+  bool SeriesApproximation(TreeType* queryNode,
+                           const size_t queryIndex,
+                           TreeType& referenceNode,
+                           const double minDistance,
+                           const double maxError,
+                           const bool alreadyDidRefPoint0,
+                           double& error);
+
+  /**
+   * Compute the bounds on the truncation error of a series expansion of a node
+   * with the given radius (scaled by the series scale).  factors(p) bounds the
+   * error of the expansion of order p (with the terms of total degree less
+   * than p), for each point of the node and each evaluation point, divided by
+   * exp(-d^2 / scale^2) where d is the distance between them.  Returns false if
+   * the error can't be bounded.
+   */
+  bool SeriesErrorFactors(const double radius,
+                          const size_t maxOrder,
+                          arma::vec& factors) const;
+
+  //! Return the constant of Cramer's inequality for the product of the
+  //! Hermite functions of the given number of dimensions.
+  static double HermiteBound(const size_t dims)
+  {
+    return std::pow(1.086435, (double) dims);
+  }
+
+  //! Return the largest order whose number of terms is less than the given
+  //! number of points, or 0 if there is none.
+  size_t MaxOrder(const size_t numPoints) const;
+
+  //! Return the order of an expansion with the given number of terms.
+  size_t OrderOfTerms(const size_t terms) const;
+
+  //! Compute, for the first numTerms multi-indices, the product over the
+  //! dimensions of values(d, alpha_d).
+  void MultiIndexProducts(const arma::mat& values,
+                          const size_t terms,
+                          arma::vec& products) const;
+
+  //! Compute the powers 0, ..., order - 1 of each element of x.
+  static void Powers(const arma::vec& x, const size_t order, arma::mat& values);
+
+  //! Compute the Hermite functions 0, ..., order - 1 of each element of x.
+  static void HermiteFunctions(const arma::vec& x,
+                               const size_t order,
+                               arma::mat& values);
+
+  //! Add all multi-indices of the given dimensionality with the given total
+  //! degree to the list.
+  static void AddMultiIndices(std::vector<size_t>& index,
+                              const size_t dimension,
+                              const size_t degree,
+                              std::vector<std::vector<size_t>>& indices);
+
+  //! Return the scale of the series expansions for the given kernel.
+  template<typename KernelT>
+  static double SeriesScale(const KernelT& /* kernel */) { return 0.0; }
+
+  //! Return the scale of the series expansions for the Gaussian kernel.
+  static double SeriesScale(const kernel::GaussianKernel& kernel)
+  {
+    // exp(-d^2 / (2 h^2)) = exp(-(d / scale)^2).
+    return std::sqrt(2.0) * kernel.Bandwidth();
+  }
+
   //! The reference set.
   const arma::mat& referenceSet;
 
@@ -165,6 +343,26 @@ class KDERules
   //! Absolute error tolerance available for each reference point.
   const double absErrorTol;
 
+  //! Whether series expansions are going to be applied.
+  const bool seriesExpansion;
+
+  //! Maximum order of the series expansions.
+  const size_t seriesOrder;
+
+  //! Scale of the series expansions.
+  const double seriesScale;
+
+  //! Multi-indices of the terms of the series expansions, one per column,
+  //! sorted by total degree.
+  arma::Mat<size_t> multiIndices;
+
+  //! 1 / alpha! for each multi-index alpha.
+  arma::vec inverseFactorials;
+
+  //! The number of multi-indices with total degree less than p, for each order
+  //! p.
+  std::vector<size_t> numTerms;
+
   //! The last query index.
   size_t lastQueryIndex;
 
@@ -179,6 +377,9 @@ class KDERules
 
   //! The number of scores.
   size_t scores;
+
+  //! Random number generator for Monte Carlo sampling.
+  std::mt19937 rng;
 };
 
 /**
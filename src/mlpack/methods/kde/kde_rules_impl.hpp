@@ -36,7 +36,9 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     MetricType& metric,
     KernelType& kernel,
     const bool monteCarlo,
-    const bool sameSet) :
+    const bool sameSet,
+    const bool seriesExpansion,
+    const size_t seriesOrder) :
     referenceSet(referenceSet),
     querySet(querySet),
     densities(densities),
@@ -51,10 +53,15 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
     monteCarlo(monteCarlo),
     sameSet(sameSet),
     absErrorTol(absError / referenceSet.n_cols),
+    seriesExpansion(seriesExpansion && seriesOrder > 0 && kernelIsGaussian &&
+        std::is_same<MetricType, metric::EuclideanDistance>::value),
+    seriesOrder(seriesOrder),
+    seriesScale(SeriesScale(kernel)),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
     baseCases(0),
-    scores(0)
+    scores(0),
+    rng(math::randGen())
 {
   // Initialize accumError.
   accumError = arma::vec(querySet.n_cols, arma::fill::zeros);
@@ -62,6 +69,71 @@ KDERules<MetricType, KernelType, TreeType>::KDERules(
   // Initialize accumMCAlpha only if Monte Carlo estimations are available.
   if (monteCarlo && kernelIsGaussian)
     accumMCAlpha = arma::vec(querySet.n_cols, arma::fill::zeros);
+
+  // Enumerate the multi-indices of the series expansions by total degree, so
+  // that the terms of an expansion of some order are the first terms of any
+  // expansion of a higher order.
+  if (this->seriesExpansion)
+  {
+    const size_t dims = referenceSet.n_rows;
+    std::vector<std::vector<size_t>> indices;
+    std::vector<size_t> index(dims);
+    numTerms.push_back(0);
+    for (size_t degree = 0; degree < seriesOrder; ++degree)
+    {
+      AddMultiIndices(index, 0, degree, indices);
+      numTerms.push_back(indices.size());
+    }
+
+    multiIndices.set_size(dims, indices.size());
+    inverseFactorials.set_size(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      double factorial = 1.0;
+      for (size_t d = 0; d < dims; ++d)
+      {
+        multiIndices(d, i) = indices[i][d];
+        factorial *= std::tgamma(indices[i][d] + 1.0);
+      }
+      inverseFactorials[i] = 1.0 / factorial;
+    }
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+KDERules<MetricType, KernelType, TreeType>::KDERules(KDERules& other,
+                                                     const size_t seed) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    densities(other.densities),
+    absError(other.absError),
+    relError(other.relError),
+    mcBeta(other.mcBeta),
+    initialSampleSize(other.initialSampleSize),
+    mcAccessCoef(other.mcAccessCoef),
+    mcBreakCoef(other.mcBreakCoef),
+    metric(other.metric),
+    kernel(other.kernel),
+    monteCarlo(other.monteCarlo),
+    // The per-query accumulators alias the memory of the other object.
+    accumMCAlpha(other.accumMCAlpha.memptr(), other.accumMCAlpha.n_elem, false,
+        true),
+    accumError(other.accumError.memptr(), other.accumError.n_elem, false, true),
+    sameSet(other.sameSet),
+    absErrorTol(other.absErrorTol),
+    seriesExpansion(other.seriesExpansion),
+    seriesOrder(other.seriesOrder),
+    seriesScale(other.seriesScale),
+    multiIndices(other.multiIndices),
+    inverseFactorials(other.inverseFactorials),
+    numTerms(other.numTerms),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0),
+    rng(seed)
+{
+  // Nothing to do.
 }
 
 //! The base case.
@@ -104,7 +176,7 @@ Score(const size_t queryIndex, TreeType& referenceNode)
   // Auxiliary variables.
   const arma::vec& queryPoint = querySet.unsafe_col(queryIndex);
   const size_t refNumDesc = referenceNode.NumDescendants();
-  double score, minDistance, maxDistance, depthAlpha;
+  double score, minDistance, maxDistance, depthAlpha, seriesError;
   // Calculations are not duplicated.
   bool alreadyDidRefPoint0 = false;
 
@@ -154,11 +226,8 @@ Score(const size_t queryIndex, TreeType& referenceNode)
   // We relax the bound for pruning by accumError(queryIndex), so that if there
   // is any leftover error tolerance from the rest of the traversal, we can use
   // it here to prune more.
-  double pointAccumErrorTol;
-  if (alreadyDidRefPoint0)
-    pointAccumErrorTol = accumError(queryIndex) / (refNumDesc - 1);
-  else
-    pointAccumErrorTol = accumError(queryIndex) / refNumDesc;
+  const size_t numPairs = alreadyDidRefPoint0 ? refNumDesc - 1 : refNumDesc;
+  const double pointAccumErrorTol = accumError(queryIndex) / numPairs;
 
   if (bound <= 2 * errorTolerance + pointAccumErrorTol)
   {
@@ -184,6 +253,22 @@ Score(const size_t queryIndex, TreeType& referenceNode)
     if (kernelIsGaussian && monteCarlo)
       accumMCAlpha(queryIndex) += depthAlpha;
   }
+  else if (seriesExpansion &&
+           !(sameSet && minDistance == 0.0) &&
+           SeriesApproximation(NULL, queryIndex, referenceNode, minDistance,
+               numPairs * errorTolerance + accumError(queryIndex) / 2,
+               alreadyDidRefPoint0, seriesError))
+  {
+    // The series expansion has been added to the estimation, so prune.
+    score = DBL_MAX;
+
+    // Subtract used error tolerance or add extra available tolerance.
+    accumError(queryIndex) += 2 * (numPairs * errorTolerance - seriesError);
+
+    // Store not used alpha for Monte Carlo.
+    if (kernelIsGaussian && monteCarlo)
+      accumMCAlpha(queryIndex) += depthAlpha;
+  }
   else if (monteCarlo &&
            refNumDesc >= mcAccessCoef * initialSampleSize &&
            kernelIsGaussian)
@@ -222,9 +307,9 @@ Score(const size_t queryIndex, TreeType& referenceNode)
         // Sample and evaluate random points from the reference node.
         size_t randomPoint;
         if (alreadyDidRefPoint0)
-          randomPoint = math::RandInt(1, refNumDesc);
+          randomPoint = RandInt(1, refNumDesc);
         else
-          randomPoint = math::RandInt(0, refNumDesc);
+          randomPoint = RandInt(0, refNumDesc);
 
         sample(oldSize + i) =
             EvaluateKernel(queryIndex, referenceNode.Descendant(randomPoint));
@@ -310,7 +395,7 @@ Score(TreeType& queryNode, TreeType& referenceNode)
 {
   kde::KDEStat& queryStat = queryNode.Stat();
   const size_t refNumDesc = referenceNode.NumDescendants();
-  double score, minDistance, maxDistance, depthAlpha;
+  double score, minDistance, maxDistance, depthAlpha, seriesError;
   // Calculations are not duplicated.
   bool alreadyDidRefPoint0 = false;
 
@@ -393,6 +478,23 @@ Score(TreeType& queryNode, TreeType& referenceNode)
     if (kernelIsGaussian && monteCarlo)
       queryStat.AccumAlpha() += depthAlpha;
   }
+  else if (seriesExpansion &&
+           !(sameSet && minDistance == 0.0) &&
+           SeriesApproximation(&queryNode, 0, referenceNode, minDistance,
+               refNumDesc * errorTolerance + queryStat.AccumError() / 2,
+               alreadyDidRefPoint0, seriesError))
+  {
+    // The series expansion has been added to the estimations (or will be, for
+    // a local expansion), so prune.
+    score = DBL_MAX;
+
+    // Subtract used error tolerance or add extra available tolerance.
+    queryStat.AccumError() += 2 * (refNumDesc * errorTolerance - seriesError);
+
+    // Store not used alpha for Monte Carlo.
+    if (kernelIsGaussian && monteCarlo)
+      queryStat.AccumAlpha() += depthAlpha;
+  }
   else if (monteCarlo &&
            refNumDesc >= mcAccessCoef * initialSampleSize &&
            kernelIsGaussian)
@@ -439,9 +541,9 @@ Score(TreeType& queryNode, TreeType& referenceNode)
           // Sample and evaluate random points from the reference node.
           size_t randomPoint;
           if (alreadyDidRefPoint0)
-            randomPoint = math::RandInt(1, refNumDesc);
+            randomPoint = RandInt(1, refNumDesc);
           else
-            randomPoint = math::RandInt(0, refNumDesc);
+            randomPoint = RandInt(0, refNumDesc);
 
           sample(oldSize + i) =
               EvaluateKernel(queryIndex, referenceNode.Descendant(randomPoint));
@@ -573,6 +675,447 @@ CalculateAlpha(TreeType* node)
   return stat.MCAlpha();
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::CalculateAlphas(
+    TreeType& node)
+{
+  if (!monteCarlo || !kernelIsGaussian)
+    return;
+
+  // A node's alpha depends on its parent's, so the tree is visited top-down.
+  CalculateAlpha(&node);
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    CalculateAlphas(node.Child(i));
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::PrepareFarFieldExpansions(
+    TreeType& node)
+{
+  if (!seriesExpansion)
+    return;
+
+  // Collect the nodes, so that their coefficients can be computed in
+  // parallel.
+  std::vector<TreeType*> nodes;
+  std::vector<TreeType*> stack(1, &node);
+  while (!stack.empty())
+  {
+    TreeType* current = stack.back();
+    stack.pop_back();
+    nodes.push_back(current);
+    for (size_t i = 0; i < current->NumChildren(); ++i)
+      stack.push_back(&current->Child(i));
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) nodes.size(); ++i)
+  {
+    TreeType& current = *nodes[i];
+    KDEStat& stat = current.Stat();
+    const size_t order = MaxOrder(current.NumDescendants());
+
+    // Skip the node if its coefficients are already computed.
+    if (stat.SeriesScale() == seriesScale &&
+        stat.FarFieldCoefficients().n_elem == numTerms[order])
+      continue;
+
+    current.Center(stat.SeriesCenter());
+    arma::vec& coefficients = stat.FarFieldCoefficients();
+    coefficients.zeros(numTerms[order]);
+    if (order > 0)
+    {
+      // A_alpha = (1 / alpha!) sum_y ((y - c) / scale)^alpha.
+      arma::mat values;
+      arma::vec products;
+      for (size_t j = 0; j < current.NumDescendants(); ++j)
+      {
+        Powers((referenceSet.col(current.Descendant(j)) - stat.SeriesCenter()) /
+            seriesScale, order, values);
+        MultiIndexProducts(values, coefficients.n_elem, products);
+        coefficients += products;
+      }
+      coefficients %= inverseFactorials.head(coefficients.n_elem);
+    }
+
+    stat.SeriesScale() = seriesScale;
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::PrepareLocalExpansions(
+    TreeType& node)
+{
+  if (!seriesExpansion)
+    return;
+
+  node.Center(node.Stat().SeriesCenter());
+  node.Stat().LocalCoefficients().reset();
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    PrepareLocalExpansions(node.Child(i));
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::EvaluateLocalExpansions(
+    TreeType& node)
+{
+  if (!seriesExpansion)
+    return;
+
+  KDEStat& stat = node.Stat();
+  if (stat.LocalCoefficients().n_elem > 0)
+  {
+    // The local expansion is sum_beta B_beta ((x - c) / scale)^beta.
+    const arma::vec& coefficients = stat.LocalCoefficients();
+    const size_t order = OrderOfTerms(coefficients.n_elem);
+    arma::mat values;
+    arma::vec products;
+    for (size_t i = 0; i < node.NumDescendants(); ++i)
+    {
+      const size_t queryIndex = node.Descendant(i);
+      Powers((querySet.col(queryIndex) - stat.SeriesCenter()) / seriesScale,
+          order, values);
+      MultiIndexProducts(values, coefficients.n_elem, products);
+      densities(queryIndex) += arma::dot(coefficients, products);
+    }
+
+    stat.LocalCoefficients().reset();
+  }
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    EvaluateLocalExpansions(node.Child(i));
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline force_inline size_t KDERules<MetricType, KernelType, TreeType>::
+RandInt(const size_t lo, const size_t hiExclusive)
+{
+  std::uniform_int_distribution<size_t> dist(lo, hiExclusive - 1);
+  return dist(rng);
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+bool KDERules<MetricType, KernelType, TreeType>::SeriesApproximation(
+    TreeType* queryNode,
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const double minDistance,
+    const double maxError,
+    const bool alreadyDidRefPoint0,
+    double& error)
+{
+  const KDEStat& referenceStat = referenceNode.Stat();
+  const size_t refNumDesc = referenceNode.NumDescendants();
+  const size_t queryNumDesc = (queryNode == NULL) ? 1 :
+      queryNode->NumDescendants();
+
+  // The truncation error of either expansion, for each query point, is at
+  // most this times the error factor of the order.
+  const double scaledDistance = minDistance / seriesScale;
+  const double weight = refNumDesc *
+      std::exp(-scaledDistance * scaledDistance / 2);
+
+  // Find the cheapest expansion whose error is small enough; it must be
+  // cheaper than computing all the kernel values.
+  double bestCost = (double) queryNumDesc * refNumDesc;
+  size_t bestOrder = 0;
+  size_t bestLocalOrder = 0;
+  bool bestIsLocal = false;
+  arma::vec factors;
+
+  // The far-field expansion of the reference node is evaluated at each query
+  // point.
+  const size_t farFieldOrder =
+      OrderOfTerms(referenceStat.FarFieldCoefficients().n_elem);
+  if (farFieldOrder > 0 && SeriesErrorFactors(
+      referenceNode.FurthestDescendantDistance() / seriesScale, farFieldOrder,
+      factors))
+  {
+    for (size_t p = 1; p <= farFieldOrder; ++p)
+    {
+      if (weight * factors[p] <= maxError)
+      {
+        const double cost = (double) queryNumDesc * numTerms[p];
+        if (cost < bestCost)
+        {
+          bestCost = cost;
+          bestOrder = p;
+          error = weight * factors[p];
+        }
+        break;
+      }
+    }
+  }
+
+  // The local expansion around the center of the query node is accumulated
+  // from each reference point.
+  const size_t localOrder = (queryNode == NULL) ? 0 : MaxOrder(queryNumDesc);
+  if (localOrder > 0 && SeriesErrorFactors(
+      queryNode->FurthestDescendantDistance() / seriesScale, localOrder,
+      factors))
+  {
+    for (size_t p = 1; p <= localOrder; ++p)
+    {
+      if (weight * factors[p] <= maxError)
+      {
+        const double cost = (double) refNumDesc * numTerms[p];
+        if (cost < bestCost)
+        {
+          bestCost = cost;
+          bestOrder = p;
+          bestIsLocal = true;
+          error = weight * factors[p];
+        }
+        break;
+      }
+    }
+  }
+
+  // The far-field expansion of the reference node is translated into a local
+  // expansion around the center of the query node (the Hermite-to-local
+  // translation of the fast Gauss transform); its cost does not depend on the
+  // number of points of either node.
+  arma::vec refFactors, queryFactors;
+  if (farFieldOrder > 0 && localOrder > 0 &&
+      SeriesErrorFactors(std::sqrt(2.0) *
+          referenceNode.FurthestDescendantDistance() / seriesScale,
+          farFieldOrder, refFactors) &&
+      SeriesErrorFactors(std::sqrt(2.0) *
+          queryNode->FurthestDescendantDistance() / seriesScale, localOrder,
+          queryFactors))
+  {
+    // The error is bounded by the terms of the double expansion in which the
+    // far-field order or the local order is exceeded; the bound of each term
+    // factors into a reference part and a query part.
+    const double bound = HermiteBound(referenceSet.n_rows);
+    for (size_t p = 1; p <= farFieldOrder; ++p)
+    {
+      for (size_t q = 1; q <= localOrder; ++q)
+      {
+        const double cost = (double) numTerms[p] * numTerms[q];
+        const double translationError = weight * (refFactors[p] *
+            queryFactors[0] + refFactors[0] * queryFactors[q]) / bound;
+        if (cost < bestCost && translationError <= maxError)
+        {
+          bestCost = cost;
+          bestOrder = p;
+          bestLocalOrder = q;
+          bestIsLocal = false;
+          error = translationError;
+        }
+      }
+    }
+  }
+
+  if (bestOrder == 0)
+    return false;
+
+  const size_t terms = numTerms[bestOrder];
+  arma::mat values;
+  arma::vec products;
+  if (bestLocalOrder > 0)
+  {
+    // B_beta += ((-1)^|beta| / beta!) sum_alpha A_alpha h_{alpha + beta}(u),
+    // where u = (c_Q - c_R) / scale.
+    KDEStat& queryStat = queryNode->Stat();
+    if (queryStat.LocalCoefficients().n_elem == 0)
+      queryStat.LocalCoefficients().zeros(numTerms[localOrder]);
+
+    HermiteFunctions((queryStat.SeriesCenter() -
+        referenceStat.SeriesCenter()) / seriesScale,
+        bestOrder + bestLocalOrder - 1, values);
+    const arma::vec& coefficients = referenceStat.FarFieldCoefficients();
+    for (size_t b = 0; b < numTerms[bestLocalOrder]; ++b)
+    {
+      double sum = 0.0;
+      for (size_t a = 0; a < terms; ++a)
+      {
+        double product = coefficients[a];
+        for (size_t d = 0; d < values.n_rows; ++d)
+          product *= values(d, multiIndices(d, a) + multiIndices(d, b));
+        sum += product;
+      }
+
+      const double sign = (arma::accu(multiIndices.col(b)) % 2 == 0) ? 1.0 :
+          -1.0;
+      queryStat.LocalCoefficients()[b] += sign * inverseFactorials[b] * sum;
+    }
+  }
+  else if (bestIsLocal)
+  {
+    // B_beta += (1 / beta!) sum_y h_beta((y - c) / scale).
+    KDEStat& queryStat = queryNode->Stat();
+    if (queryStat.LocalCoefficients().n_elem == 0)
+      queryStat.LocalCoefficients().zeros(numTerms[localOrder]);
+
+    arma::vec sums(terms, arma::fill::zeros);
+    for (size_t i = 0; i < refNumDesc; ++i)
+    {
+      HermiteFunctions((referenceSet.col(referenceNode.Descendant(i)) -
+          queryStat.SeriesCenter()) / seriesScale, bestOrder, values);
+      MultiIndexProducts(values, terms, products);
+      sums += products;
+    }
+    queryStat.LocalCoefficients().head(terms) +=
+        inverseFactorials.head(terms) % sums;
+  }
+  else
+  {
+    // Evaluate sum_alpha A_alpha h_alpha((x - c) / scale).
+    const arma::vec coefficients =
+        referenceStat.FarFieldCoefficients().head(terms);
+    for (size_t i = 0; i < queryNumDesc; ++i)
+    {
+      const size_t index = (queryNode == NULL) ? queryIndex :
+          queryNode->Descendant(i);
+      HermiteFunctions((querySet.col(index) - referenceStat.SeriesCenter()) /
+          seriesScale, bestOrder, values);
+      MultiIndexProducts(values, terms, products);
+      densities(index) += arma::dot(coefficients, products);
+    }
+  }
+
+  // The expansion includes the base case of the first points of the nodes,
+  // which was already computed.
+  if (alreadyDidRefPoint0)
+  {
+    const size_t index = (queryNode == NULL) ? queryIndex :
+        queryNode->Point(0);
+    densities(index) -= EvaluateKernel(index, referenceNode.Point(0));
+  }
+
+  return true;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+bool KDERules<MetricType, KernelType, TreeType>::SeriesErrorFactors(
+    const double radius,
+    const size_t maxOrder,
+    arma::vec& factors) const
+{
+  // By Cramer's inequality, |h_n(x)| <= K 2^(n / 2) sqrt(n!) exp(-x^2 / 2) for
+  // each Hermite function, so (with the Cauchy-Schwarz inequality) the terms
+  // of total degree n of either expansion sum to at most
+  // K^D sqrt(C(n + D - 1, D - 1)) (sqrt(2 D) r)^n / sqrt(n!) times
+  // exp(-|t|^2 / 2), where |t| is the scaled distance to the center.
+  const size_t maxTerms = 256;
+  const size_t dims = referenceSet.n_rows;
+  const double x = std::sqrt(2.0 * dims) * radius;
+
+  std::vector<double> terms;
+  double term = 1.0;
+  double ratio = 0.0;
+  for (size_t n = 0; ; ++n)
+  {
+    terms.push_back(term);
+
+    // The ratio of consecutive terms decreases, so once it is below 1 the rest
+    // of the series is bounded by a geometric series.
+    ratio = std::sqrt((n + dims) / (n + 1.0)) * x / std::sqrt(n + 1.0);
+    if (n >= maxOrder && ratio < 1.0)
+      break;
+    if (n == maxTerms)
+      return false;
+
+    term *= ratio;
+  }
+
+  factors.set_size(maxOrder + 1);
+  const double scale = HermiteBound(dims);
+  double tail = term * ratio / (1.0 - ratio);
+  for (size_t n = terms.size(); n-- > 0; )
+  {
+    tail += terms[n];
+    if (n <= maxOrder)
+      factors[n] = scale * tail;
+  }
+
+  return true;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline size_t KDERules<MetricType, KernelType, TreeType>::MaxOrder(
+    const size_t numPoints) const
+{
+  size_t order = 0;
+  while (order < seriesOrder && numTerms[order + 1] < numPoints)
+    ++order;
+  return order;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline size_t KDERules<MetricType, KernelType, TreeType>::OrderOfTerms(
+    const size_t terms) const
+{
+  return std::find(numTerms.begin(), numTerms.end(), terms) -
+      numTerms.begin();
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline void KDERules<MetricType, KernelType, TreeType>::MultiIndexProducts(
+    const arma::mat& values,
+    const size_t terms,
+    arma::vec& products) const
+{
+  products.set_size(terms);
+  for (size_t i = 0; i < terms; ++i)
+  {
+    double product = 1.0;
+    for (size_t d = 0; d < values.n_rows; ++d)
+      product *= values(d, multiIndices(d, i));
+    products[i] = product;
+  }
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline void KDERules<MetricType, KernelType, TreeType>::Powers(
+    const arma::vec& x,
+    const size_t order,
+    arma::mat& values)
+{
+  values.set_size(x.n_elem, order);
+  values.col(0).ones();
+  for (size_t n = 1; n < order; ++n)
+    values.col(n) = values.col(n - 1) % x;
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+inline void KDERules<MetricType, KernelType, TreeType>::HermiteFunctions(
+    const arma::vec& x,
+    const size_t order,
+    arma::mat& values)
+{
+  // h_0(x) = exp(-x^2), h_1(x) = 2 x exp(-x^2), and
+  // h_{n + 1}(x) = 2 x h_n(x) - 2 n h_{n - 1}(x).
+  values.set_size(x.n_elem, order);
+  values.col(0) = arma::exp(-arma::square(x));
+  if (order > 1)
+    values.col(1) = 2 * x % values.col(0);
+  for (size_t n = 1; n + 1 < order; ++n)
+    values.col(n + 1) = 2 * x % values.col(n) - 2.0 * n * values.col(n - 1);
+}
+
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::AddMultiIndices(
+    std::vector<size_t>& index,
+    const size_t dimension,
+    const size_t degree,
+    std::vector<std::vector<size_t>>& indices)
+{
+  if (dimension + 1 == index.size())
+  {
+    index[dimension] = degree;
+    indices.push_back(index);
+    return;
+  }
+
+  for (size_t k = degree + 1; k-- > 0; )
+  {
+    index[dimension] = k;
+    AddMultiIndices(index, dimension + 1, degree - k, indices);
+  }
+}
+
 //! Clean rules base case.
 template<typename TreeType>
 inline force_inline
@@ -29,7 +29,8 @@ class KDEStat
       mcBeta(0),
       mcAlpha(0),
       accumAlpha(0),
-      accumError(0)
+      accumError(0),
+      series(NULL)
   { /* Nothing to do.*/ }
 
   //! Initialization for a fully initialized node.
@@ -38,9 +39,64 @@ class KDEStat
       mcBeta(0),
       mcAlpha(0),
       accumAlpha(0),
-      accumError(0)
+      accumError(0),
+      series(NULL)
   { /* Nothing to do. */ }
 
+  //! Copy the statistic, including its series expansion state.
+  KDEStat(const KDEStat& other) :
+      mcBeta(other.mcBeta),
+      mcAlpha(other.mcAlpha),
+      accumAlpha(other.accumAlpha),
+      accumError(other.accumError),
+      series(other.series ? new SeriesState(*other.series) : NULL)
+  { /* Nothing to do. */ }
+
+  //! Take ownership of the other statistic's series expansion state.
+  KDEStat(KDEStat&& other) :
+      mcBeta(other.mcBeta),
+      mcAlpha(other.mcAlpha),
+      accumAlpha(other.accumAlpha),
+      accumError(other.accumError),
+      series(other.series)
+  {
+    other.series = NULL;
+  }
+
+  //! Copy the statistic, including its series expansion state.
+  KDEStat& operator=(const KDEStat& other)
+  {
+    if (this != &other)
+    {
+      mcBeta = other.mcBeta;
+      mcAlpha = other.mcAlpha;
+      accumAlpha = other.accumAlpha;
+      accumError = other.accumError;
+      delete series;
+      series = other.series ? new SeriesState(*other.series) : NULL;
+    }
+    return *this;
+  }
+
+  //! Take ownership of the other statistic's series expansion state.
+  KDEStat& operator=(KDEStat&& other)
+  {
+    if (this != &other)
+    {
+      mcBeta = other.mcBeta;
+      mcAlpha = other.mcAlpha;
+      accumAlpha = other.accumAlpha;
+      accumError = other.accumError;
+      delete series;
+      series = other.series;
+      other.series = NULL;
+    }
+    return *this;
+  }
+
+  //! Free the series expansion state.
+  ~KDEStat() { delete series; }
+
   //! Get accumulated Monte Carlo alpha of the node.
   inline double MCBeta() const { return mcBeta; }
 
@@ -65,7 +121,40 @@ class KDEStat
   //! Modify Monte Carlo alpha of the node.
   inline double& MCAlpha() { return mcAlpha; }
 
-  //! Serialize the statistic to/from an archive.
+  //! Get whether the series expansion state of the node has been allocated.
+  //! It is only allocated when series expansions are used.
+  inline bool HasSeriesState() const { return series != NULL; }
+
+  //! Get the center of the node used for series expansions.
+  inline const arma::vec& SeriesCenter() const
+  { return series ? series->center : EmptyVector(); }
+
+  //! Modify the center of the node used for series expansions.
+  inline arma::vec& SeriesCenter() { return Series().center; }
+
+  //! Get the scale for which the far-field coefficients are valid.
+  inline double SeriesScale() const { return series ? series->scale : 0.0; }
+
+  //! Modify the scale for which the far-field coefficients are valid.
+  inline double& SeriesScale() { return Series().scale; }
+
+  //! Get the far-field (Hermite) coefficients of the node.
+  inline const arma::vec& FarFieldCoefficients() const
+  { return series ? series->farFieldCoefficients : EmptyVector(); }
+
+  //! Modify the far-field (Hermite) coefficients of the node.
+  inline arma::vec& FarFieldCoefficients()
+  { return Series().farFieldCoefficients; }
+
+  //! Get the local (Taylor) coefficients of the node.
+  inline const arma::vec& LocalCoefficients() const
+  { return series ? series->localCoefficients : EmptyVector(); }
+
+  //! Modify the local (Taylor) coefficients of the node.
+  inline arma::vec& LocalCoefficients() { return Series().localCoefficients; }
+
+  //! Serialize the statistic to/from an archive.  The series expansion
+  //! coefficients are not serialized, since they are recomputed when needed.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
   {
@@ -73,6 +162,12 @@ class KDEStat
     ar(CEREAL_NVP(mcAlpha));
     ar(CEREAL_NVP(accumAlpha));
     ar(CEREAL_NVP(accumError));
+
+    if (cereal::is_loading<Archive>())
+    {
+      delete series;
+      series = NULL;
+    }
   }
 
  private:
@@ -87,6 +182,46 @@ class KDEStat
 
   //! Accumulated not used error tolerance in the current node.
   double accumError;
+
+  /**
+   * The state of the series expansions of a node.  Most searches don't use
+   * series expansions, so this is only allocated when it is first modified.
+   */
+  struct SeriesState
+  {
+    SeriesState() : scale(0) { }
+
+    //! Center of the node for series expansions.
+    arma::vec center;
+
+    //! Scale for which farFieldCoefficients is valid (0 if it is not
+    //! computed).
+    double scale;
+
+    //! Coefficients of the far-field expansion of the node's points.
+    arma::vec farFieldCoefficients;
+
+    //! Coefficients of the local expansion accumulated for the node's points.
+    arma::vec localCoefficients;
+  };
+
+  //! Series expansion state of the node, or NULL if it is not allocated.
+  SeriesState* series;
+
+  //! Return the series expansion state, allocating it if needed.
+  SeriesState& Series()
+  {
+    if (!series)
+      series = new SeriesState();
+    return *series;
+  }
+
+  //! Return an empty vector, for nodes without series expansion state.
+  static const arma::vec& EmptyVector()
+  {
+    static const arma::vec empty;
+    return empty;
+  }
 };
 
 } // namespace kde
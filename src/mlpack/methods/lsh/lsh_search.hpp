@@ -196,6 +196,32 @@ class LSHSearch
              const size_t bucketSize = 500,
              const arma::cube& projection = arma::cube());
 
+  /**
+   * Add the given points to the reference set, hashing them with the existing
+   * projections and offsets instead of rebuilding the hash tables.  The new
+   * points get the indices after the current reference set.  A bucket that is
+   * already full (see BucketSize()) does not take any new points.
+   *
+   * The flat second hash table is rewritten by each call (which also drops the
+   * points that were removed with Remove() from it), so it is much cheaper to
+   * insert points in batches than one at a time.
+   *
+   * @param points New reference points.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Mark the reference point with the given index as removed: it will not be
+   * returned as a neighbor by later searches.  The point is kept in the
+   * reference set, so the indices of the other points do not change; it is
+   * only dropped from the second hash table by the next call to Insert().
+   * (Monochromatic searches still return neighbors for removed points.)
+   * Calling Train() clears all removals.
+   *
+   * @param index Index of the reference point to remove.
+   */
+  void Remove(const size_t index);
+
   /**
    * Compute the nearest neighbors of the points in the given query set and
    * store the output in the given matrices.  The matrices will be set to the
@@ -278,6 +304,12 @@ class LSHSearch
   //! Return the reference dataset.
   const MatType& ReferenceSet() const { return referenceSet; }
 
+  //! Return whether the reference point with the given index was removed.
+  //! Throws std::invalid_argument if the index is not in the reference set.
+  bool IsRemoved(const size_t index) const;
+  //! Get the number of reference points that were removed.
+  size_t NumRemoved() const { return numRemoved; }
+
   //! Get the number of projections.
   size_t NumProjections() const { return projections.n_slices; }
 
@@ -290,9 +322,14 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  //! Get the offsets of the buckets of the second hash table.  The points in
+  //! bucket h are held in BucketContents() between BucketOffsets()[h] and
+  //! BucketOffsets()[h + 1].
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  //! Get the indices of the points in all buckets of the second hash table,
+  //! stored one bucket after another.
+  const arma::Col<uint32_t>& BucketContents() const { return bucketContents; }
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -316,6 +353,9 @@ class LSHSearch
    * @param referenceIndices The list of neighbor candidates obtained from
    *    hashing the query into all the hash tables and eventually into
    *    multiple buckets of the second hash table.
+   * @param candidateBits Bitset with one bit for each reference point, used to
+   *    discard duplicate candidates.  It must be all zeros, and is all zeros
+   *    again when the function returns.
    * @param numTablesToSearch The number of tables to perform the search in. If
    *    0, all tables are searched.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
@@ -324,9 +364,33 @@ class LSHSearch
   template<typename VecType>
   void ReturnIndicesFromTable(const VecType& queryPoint,
                               arma::uvec& referenceIndices,
+                              std::vector<uint64_t>& candidateBits,
                               size_t numTablesToSearch,
                               const size_t T) const;
 
+  /**
+   * Hash each of the given points into each table, and compute the bucket of
+   * the second hash table that the key falls into.
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Matrix to store the buckets in; column i holds
+   *    the bucket of each point in table i.
+   */
+  void SecondHashVectors(const MatType& points,
+                         arma::Mat<size_t>& secondHashVectors) const;
+
+  /**
+   * Rebuild the second hash table with the given points added to it.  Points
+   * that are already in the table stay in front of the new points in each
+   * bucket, unless they have been removed.
+   *
+   * @param secondHashVectors Buckets of the new points, as computed by
+   *    SecondHashVectors().
+   * @param firstIndex Index in the reference set of the first new point.
+   */
+  void AddToHashTable(const arma::Mat<size_t>& secondHashVectors,
+                      const size_t firstIndex);
+
   /**
    * This is a helper function that computes the distance of the query to the
    * neighbor candidates and appropriately stores the best 'k' candidates.  This
@@ -450,17 +514,19 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! For a particular hash value h, the points in its bucket are held in
+  //! bucketContents between bucketOffsets[h] and bucketOffsets[h + 1].
+  //! Length secondHashSize + 1.
+  arma::Col<size_t> bucketOffsets;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The final hash table: the indices of the points in each bucket (at most
+  //! bucketSize per bucket), stored one bucket after another.
+  arma::Col<uint32_t> bucketContents;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value. Length secondHashSize.
-  arma::Col<size_t> bucketRowInHashTable;
+  //! For each reference point, whether it was removed with Remove().
+  std::vector<bool> removedPoints;
+  //! The number of reference points that were removed.
+  size_t numRemoved;
 
   //! The number of distance evaluations.
   size_t distanceEvaluations;
@@ -484,6 +550,40 @@ class LSHSearch
 } // namespace neighbor
 } // namespace mlpack
 
+namespace cereal {
+namespace detail {
+
+/**
+ * Set the serialization version of LSHSearch to 1 (version 1 replaced the
+ * per-row second hash table with the flat bucket layout).  This is what
+ * CEREAL_CLASS_VERSION() does, but that macro can only be used with a concrete
+ * type, not a class template.
+ */
+template<typename SortPolicy, typename MatType>
+struct Version<mlpack::neighbor::LSHSearch<SortPolicy, MatType>>
+{
+  static const std::uint32_t version;
+
+  static std::uint32_t registerVersion()
+  {
+    StaticObject<Versions>::getInstance().mapping.emplace(std::type_index(
+        typeid(mlpack::neighbor::LSHSearch<SortPolicy, MatType>)).hash_code(),
+        1);
+    return 1;
+  }
+
+  static void unused() { (void) version; }
+};
+
+template<typename SortPolicy, typename MatType>
+const std::uint32_t
+    Version<mlpack::neighbor::LSHSearch<SortPolicy, MatType>>::version =
+    Version<mlpack::neighbor::LSHSearch<SortPolicy, MatType>>::
+    registerVersion();
+
+} // namespace detail
+} // namespace cereal
+
 // Include implementation.
 #include "lsh_search_impl.hpp"
 
@@ -32,6 +32,7 @@ LSHSearch(MatType referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numRemoved(0),
   distanceEvaluations(0)
 {
   // Pass work to training function.
@@ -52,6 +53,7 @@ LSHSearch(MatType referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numRemoved(0),
   distanceEvaluations(0)
 {
   // Pass work to training function.
@@ -67,6 +69,7 @@ LSHSearch<SortPolicy, MatType>::LSHSearch() :
     hashWidth(0),
     secondHashSize(99901),
     bucketSize(500),
+    numRemoved(0),
     distanceEvaluations(0)
 {
 }
@@ -83,9 +86,10 @@ LSHSearch<SortPolicy, MatType>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
-    bucketRowInHashTable(other.bucketRowInHashTable),
+    bucketOffsets(other.bucketOffsets),
+    bucketContents(other.bucketContents),
+    removedPoints(other.removedPoints),
+    numRemoved(other.numRemoved),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Nothing to do.
@@ -103,9 +107,10 @@ LSHSearch<SortPolicy, MatType>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
-    bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
+    bucketOffsets(std::move(other.bucketOffsets)),
+    bucketContents(std::move(other.bucketContents)),
+    removedPoints(std::move(other.removedPoints)),
+    numRemoved(other.numRemoved),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Reset other model to defaults.
@@ -114,6 +119,7 @@ LSHSearch<SortPolicy, MatType>::LSHSearch(LSHSearch&& other) :
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.numRemoved = 0;
   other.distanceEvaluations = 0;
 }
 
@@ -131,9 +137,10 @@ LSHSearch<SortPolicy, MatType>& LSHSearch<SortPolicy, MatType>::operator=(
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
-  bucketRowInHashTable = other.bucketRowInHashTable;
+  bucketOffsets = other.bucketOffsets;
+  bucketContents = other.bucketContents;
+  removedPoints = other.removedPoints;
+  numRemoved = other.numRemoved;
   distanceEvaluations = other.distanceEvaluations;
 
   return *this;
@@ -153,9 +160,10 @@ LSHSearch<SortPolicy, MatType>& LSHSearch<SortPolicy, MatType>::operator=(
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
-  bucketRowInHashTable = std::move(other.bucketRowInHashTable);
+  bucketOffsets = std::move(other.bucketOffsets);
+  bucketContents = std::move(other.bucketContents);
+  removedPoints = std::move(other.removedPoints);
+  numRemoved = other.numRemoved;
   distanceEvaluations = other.distanceEvaluations;
 
   // Reset other model to defaults.
@@ -164,6 +172,7 @@ LSHSearch<SortPolicy, MatType>& LSHSearch<SortPolicy, MatType>::operator=(
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.numRemoved = 0;
   other.distanceEvaluations = 0;
 
   return *this;
@@ -179,6 +188,16 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
                                            const size_t bucketSize,
                                            const arma::cube& projection)
 {
+  // The points in the hash table are stored as 32-bit indices.
+  if (referenceSet.n_cols > (size_t) std::numeric_limits<uint32_t>::max())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Train(): reference set has " << referenceSet.n_cols
+        << " points, but at most " << std::numeric_limits<uint32_t>::max()
+        << " points are supported!";
+    throw std::invalid_argument(oss.str());
+  }
+
   // Set new reference set.
   this->referenceSet = std::move(referenceSet);
 
@@ -219,13 +238,6 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
   secondHashWeights = arma::floor(arma::randu(numProj) *
                                   (double) secondHashSize);
 
-  // Instead of putting the points in the row corresponding to the bucket, we
-  // chose the next empty row and keep track of the row in which the bucket
-  // lies. This allows us to stack together and slice out the empty buckets at
-  // the end of the hashing.
-  bucketRowInHashTable.set_size(secondHashSize);
-  bucketRowInHashTable.fill(secondHashSize);
-
   // Step II: The offsets for all projections in all tables.
   // Since the 'offsets' are in [0, hashWidth], we obtain the 'offsets'
   // as randu(numProj, numTables) * hashWidth.
@@ -253,33 +265,117 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
         "tables provided must be equal to numProj");
   }
 
+  // Step IV: Hash every point into the second hash table.
+  arma::Mat<size_t> secondHashVectors;
+  SecondHashVectors(this->referenceSet, secondHashVectors);
+
+  // Step V: Put the points in the second hash table.
+  bucketOffsets.reset();
+  bucketContents.reset();
+  removedPoints.assign(this->referenceSet.n_cols, false);
+  numRemoved = 0;
+  AddToHashTable(secondHashVectors, 0);
+}
+
+// Add new points to the reference set.
+template<typename SortPolicy, typename MatType>
+void LSHSearch<SortPolicy, MatType>::Insert(const MatType& points)
+{
+  if (bucketOffsets.n_elem != secondHashSize + 1)
+  {
+    throw std::invalid_argument("LSHSearch::Insert(): the model must be "
+        "trained before points can be inserted!");
+  }
+
+  util::CheckSameDimensionality(points, referenceSet, "LSHSearch::Insert()",
+      "points");
+
+  if (referenceSet.n_cols + points.n_cols >
+      (size_t) std::numeric_limits<uint32_t>::max())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): reference set would have "
+        << referenceSet.n_cols + points.n_cols << " points, but at most "
+        << std::numeric_limits<uint32_t>::max() << " points are supported!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Hash the new points with the existing projections and offsets.
+  arma::Mat<size_t> secondHashVectors;
+  SecondHashVectors(points, secondHashVectors);
+
+  const size_t firstIndex = referenceSet.n_cols;
+  referenceSet = arma::join_rows(referenceSet, points);
+  removedPoints.resize(referenceSet.n_cols, false);
+
+  AddToHashTable(secondHashVectors, firstIndex);
+}
+
+// Mark a point of the reference set as removed.
+template<typename SortPolicy, typename MatType>
+void LSHSearch<SortPolicy, MatType>::Remove(const size_t index)
+{
+  if (index >= removedPoints.size())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Remove(): cannot remove point " << index << ", since "
+        << "the reference set only has " << removedPoints.size() << " points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (!removedPoints[index])
+  {
+    removedPoints[index] = true;
+    ++numRemoved;
+  }
+}
+
+// Return whether a point of the reference set was removed.
+template<typename SortPolicy, typename MatType>
+bool LSHSearch<SortPolicy, MatType>::IsRemoved(const size_t index) const
+{
+  if (index >= removedPoints.size())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::IsRemoved(): point " << index << " does not exist, "
+        << "since the reference set only has " << removedPoints.size()
+        << " points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  return removedPoints[index];
+}
+
+// Compute the second hash value of each point in each table.
+template<typename SortPolicy, typename MatType>
+void LSHSearch<SortPolicy, MatType>::SecondHashVectors(
+    const MatType& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
   // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, this->referenceSet.n_cols);
+  // vector for table i will be held in column i, so that the tables can be
+  // hashed independently.
+  secondHashVectors.set_size(points.n_cols, numTables);
 
-  for (size_t i = 0; i < numTables; ++i)
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) numTables; ++i)
   {
-    // Step IV: create the 'numProj'-dimensional key for each point in each
-    // table.
+    // Create the 'numProj'-dimensional key for each point in each table.
 
     // The following code performs the task of hashing each point to a
     // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
+    // 'points.n_cols') key matrix.
     //
     // For a single table, let the 'numProj' projections be denoted by 'proj_i'
     // and the corresponding offset be 'offset_i'.  Then the key of a single
     // point is obtained as:
     // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       this->referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (this->referenceSet);
-    hashMat += offsetMat;
+    arma::mat hashMat = projections.slice(i).t() * points;
+    hashMat.each_col() += offsets.col(i);
     hashMat /= hashWidth;
 
-    // Step V: Putting the points in the 'secondHashTable' by hashing the key.
-    // Now we hash every key, point ID to its corresponding bucket.  We must
-    // also normalize the hashes to the range [0, secondHashSize).
+    // Compute the bucket of every point by hashing its key.  We must also
+    // normalize the hashes to the range [0, secondHashSize).
     arma::rowvec unmodVector = secondHashWeights.t() * arma::floor(hashMat);
     for (size_t j = 0; j < unmodVector.n_elem; ++j)
     {
@@ -287,66 +383,120 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
       if (unmodVector[j] >= 0.0)
       {
         const size_t key = size_t(fmod(unmodVector[j], shs));
-        secondHashVectors(i, j) = key;
+        secondHashVectors(j, i) = key;
       }
       else
       {
         const double mod = fmod(-unmodVector[j], shs);
         const size_t key = (mod < 1.0) ? 0 : secondHashSize - size_t(mod);
-        secondHashVectors(i, j) = key;
+        secondHashVectors(j, i) = key;
       }
     }
   }
+}
 
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
-
-  // Enforce the maximum bucket size.
+// Add points to the second hash table.
+template<typename SortPolicy, typename MatType>
+void LSHSearch<SortPolicy, MatType>::AddToHashTable(
+    const arma::Mat<size_t>& secondHashVectors,
+    const size_t firstIndex)
+{
+  // The buckets are shared by all tables, and a full bucket holds the first
+  // points hashed to it: the points already in the table, and then the new
+  // points in order of table and then point.  So, first count how many new
+  // points of each table fall into each bucket.
+  const size_t numPoints = secondHashVectors.n_rows;
+  arma::Mat<size_t> bucketPositions(secondHashSize, numTables,
+      arma::fill::zeros);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) numTables; ++i)
+    for (size_t j = 0; j < numPoints; ++j)
+      bucketPositions(secondHashVectors(j, i), i)++;
+
+  // For each bucket, count the points that are already in it and have not been
+  // removed, turn the counts into the position in the bucket of the first new
+  // point of each table, and enforce the maximum bucket size.
+  const bool hasPoints = (bucketOffsets.n_elem == secondHashSize + 1);
   const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
-  secondHashBinCounts.transform([effectiveBucketSize](size_t val)
-      { return std::min(val, effectiveBucketSize); });
+  arma::Col<size_t> newBucketOffsets(secondHashSize + 1);
+  newBucketOffsets[0] = 0;
+
+  #pragma omp parallel for
+  for (omp_size_t h = 0; h < (omp_size_t) secondHashSize; ++h)
+  {
+    size_t total = 0;
+    if (hasPoints)
+    {
+      for (size_t j = bucketOffsets[h]; j < bucketOffsets[h + 1]; ++j)
+        if (!removedPoints[bucketContents[j]])
+          ++total;
+    }
+
+    for (size_t i = 0; i < numTables; ++i)
+    {
+      const size_t count = bucketPositions(h, i);
+      bucketPositions(h, i) = total;
+      total += count;
+    }
+
+    newBucketOffsets[h + 1] = std::min(total, effectiveBucketSize);
+  }
+
+  // The bucket sizes are turned into offsets into the flat array.
+  size_t numNonEmptyBuckets = 0;
+  size_t maxBucketSize = 0;
+  for (size_t h = 0; h < secondHashSize; ++h)
+  {
+    if (newBucketOffsets[h + 1] > 0)
+      ++numNonEmptyBuckets;
+    maxBucketSize = std::max(maxBucketSize, newBucketOffsets[h + 1]);
+    newBucketOffsets[h + 1] += newBucketOffsets[h];
+  }
 
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
+  arma::Col<uint32_t> newBucketContents(newBucketOffsets[secondHashSize]);
+
+  // Copy the points that are already in each bucket.
+  if (hasPoints)
+  {
+    #pragma omp parallel for
+    for (omp_size_t h = 0; h < (omp_size_t) secondHashSize; ++h)
+    {
+      size_t position = newBucketOffsets[h];
+      for (size_t j = bucketOffsets[h]; j < bucketOffsets[h + 1] &&
+          position < newBucketOffsets[h + 1]; ++j)
+      {
+        if (!removedPoints[bucketContents[j]])
+          newBucketContents[position++] = bucketContents[j];
+      }
+    }
+  }
 
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
-  for (size_t i = 0; i < numTables; ++i)
+  // Now each table can place its new points independently.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) numTables; ++i)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
-    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    for (size_t j = 0; j < numPoints; ++j)
     {
       // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
+      const size_t hashInd = secondHashVectors(j, i);
+      const size_t position = bucketPositions(hashInd, i)++;
 
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      // If the bucket is not full, add the point.
+      if (position < newBucketOffsets[hashInd + 1] - newBucketOffsets[hashInd])
       {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
+        newBucketContents[newBucketOffsets[hashInd] + position] =
+            (uint32_t) (firstIndex + j);
       }
+    }
+  }
 
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
-    } // Loop over all points in the reference set.
-  } // Loop over tables.
-
-  Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
-            << "maximum length of " << arma::max(secondHashBinCounts) << ", "
-            << "totaling " << arma::accu(secondHashBinCounts) << " elements."
-            << std::endl;
+  bucketOffsets = std::move(newBucketOffsets);
+  bucketContents = std::move(newBucketContents);
+
+  Log::Info << "Final hash table size: " << numNonEmptyBuckets << " rows, "
+            << "with a maximum length of " << maxBucketSize << ", totaling "
+            << bucketContents.n_elem << " elements." << std::endl;
 }
 
 // Base case where the query set is the reference set.  (So, we can't return
@@ -707,6 +857,7 @@ template<typename VecType>
 void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
     const VecType& queryPoint,
     arma::uvec& referenceIndices,
+    std::vector<uint64_t>& candidateBits,
     size_t numTablesToSearch,
     const size_t T) const
 {
@@ -739,7 +890,7 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
   hashMat.set_size(T + 1, numTablesToSearch);
 
   // Compute the primary hash value of each key of the query into a bucket of
-  // the secondHashTable using the secondHashWeights.
+  // the second hash table using the secondHashWeights.
   hashMat.row(0) = arma::conv_to<arma::Row<size_t>> // Floor by typecasting
       ::from(secondHashWeights.t() * allProjInTables);
   // Mod to compute 2nd-level codes.
@@ -758,8 +909,8 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
                                 T,
                                 additionalProbingBins);
 
-      // Map each probing bin to a bin in secondHashTable (just like we did for
-      // the primary hash table).
+      // Map each probing bin to a bin in the second hash table (just like we
+      // did for the primary hash table).
       hashMat(arma::span(1, T), i) = // Compute code of rows 1:end of column i
         arma::conv_to< arma::Col<size_t> >:: // floor by typecasting to size_t
         from(secondHashWeights.t() * additionalProbingBins);
@@ -775,82 +926,73 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
     for (size_t p = 0; p < T + 1; ++p)
     {
       const size_t hashInd = hashMat(p, i); // find query's bucket
-      const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      maxNumPoints += bucketOffsets[hashInd + 1] - bucketOffsets[hashInd];
     }
   }
 
-  // There are two ways to proceed here:
-  // Either allocate a maxNumPoints-size vector, place all candidates, and run
-  // unique on the vector to discard duplicates.
-  // Or allocate a referenceSet.n_cols size vector (i.e. number of reference
-  // points) of zeros, and mark found indices as 1.
+  // Each candidate is marked in the bitset the first time it is seen, so that
+  // duplicates are discarded.  There are two ways to proceed then:
+  // Either store the candidates in the order they are found, and clear their
+  // bits afterwards.
+  // Or scan (and clear) the whole bitset, which gives the candidates in sorted
+  // order, so that the reference set is accessed sequentially in BaseCase().
   // Option 1 runs faster for small maxNumPoints but worse for larger values, so
   // we choose based on a heuristic.
   const float cutoff = 0.1;
   const float selectivity = static_cast<float>(maxNumPoints) /
       static_cast<float>(referenceSet.n_cols);
+  const bool scanBitset = (selectivity > cutoff);
 
-  if (selectivity > cutoff)
-  {
-    // Heuristic: larger maxNumPoints means we should use find() because it
-    // should be faster.
-    // Reference points hashed in the same bucket as the query are set to >0.
-    arma::Col<size_t> refPointsConsidered;
-    refPointsConsidered.zeros(referenceSet.n_cols);
+  if (!scanBitset)
+    referenceIndices.set_size(maxNumPoints);
 
-    for (size_t i = 0; i < numTablesToSearch; ++i) // for all tables
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
+  {
+    for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
     {
-      for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
+      // Get the sequence code.
+      const size_t hashInd = hashMat(p, i);
+      for (size_t j = bucketOffsets[hashInd]; j < bucketOffsets[hashInd + 1];
+          ++j)
       {
-        // get the sequence code
-        size_t hashInd = hashMat(p, i);
-        size_t tableRow = bucketRowInHashTable[hashInd];
+        // Points that were removed are never candidates.
+        const size_t index = bucketContents[j];
+        if (removedPoints[index])
+          continue;
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+        const uint64_t mask = uint64_t(1) << (index % 64);
+        if ((candidateBits[index / 64] & mask) == 0)
         {
-          // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          candidateBits[index / 64] |= mask;
+          if (!scanBitset)
+            referenceIndices[numCandidates] = index;
+          ++numCandidates;
         }
       }
     }
-
-    // Only keep reference points found in at least one bucket.
-    referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
-  else
-  {
-    // Heuristic: smaller maxNumPoints means we should use unique() because it
-    // should be faster.
-    // Allocate space for the query's potential neighbors.
-    arma::uvec refPointsConsideredSmall;
-    refPointsConsideredSmall.zeros(maxNumPoints);
 
-    // Retrieve candidates.
-    size_t start = 0;
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
+  if (scanBitset)
+  {
+    // Collect the marked reference points, and clear the bitset.
+    referenceIndices.set_size(numCandidates);
+    size_t c = 0;
+    for (size_t w = 0; w < candidateBits.size(); ++w)
     {
-      for (size_t p = 0; p < T + 1; ++p)
-      {
-        const size_t hashInd =  hashMat(p, i); // Find the query's bucket.
-        const size_t tableRow = bucketRowInHashTable[hashInd];
-
-        if (tableRow < secondHashSize)
-        {
-          // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
-      }
+      uint64_t word = candidateBits[w];
+      for (size_t b = 0; word != 0; ++b, word >>= 1)
+        if (word & 1)
+          referenceIndices[c++] = 64 * w + b;
+      candidateBits[w] = 0;
     }
-
-    // Keep only one copy of each candidate.
-    referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
+  }
+  else
+  {
+    // Keep only the distinct candidates, and clear their bits.
+    referenceIndices.resize(numCandidates);
+    for (size_t c = 0; c < numCandidates; ++c)
+      candidateBits[referenceIndices[c] / 64] = 0;
   }
 }
 
@@ -905,29 +1047,32 @@ void LSHSearch<SortPolicy, MatType>::Search(
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
+  // Parallelization to process more than one query at a time.  Each thread
+  // has its own bitset to discard duplicate candidates.
+  #pragma omp parallel \
       shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
+    std::vector<uint64_t> candidateBits((referenceSet.n_cols + 63) / 64, 0);
     arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      ReturnIndicesFromTable(querySet.col(i), refIndices, candidateBits,
+          numTablesToSearch, Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -971,29 +1116,32 @@ Search(const size_t k,
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
+  // Parallelization to process more than one query at a time.  Each thread
+  // has its own bitset to discard duplicate candidates.
+  #pragma omp parallel \
       shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
       reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
+    std::vector<uint64_t> candidateBits((referenceSet.n_cols + 63) / 64, 0);
     arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+
+    #pragma omp for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      ReturnIndicesFromTable(referenceSet.col(i), refIndices, candidateBits,
+          numTablesToSearch, Teffective);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1034,7 +1182,7 @@ double LSHSearch<SortPolicy, MatType>::ComputeRecall(
 template<typename SortPolicy, typename MatType>
 template<typename Archive>
 void LSHSearch<SortPolicy, MatType>::serialize(Archive& ar,
-                                               const uint32_t /* version */)
+                                               const uint32_t version)
 {
   ar(CEREAL_NVP(referenceSet));
   ar(CEREAL_NVP(numProj));
@@ -1050,9 +1198,51 @@ void LSHSearch<SortPolicy, MatType>::serialize(Archive& ar,
   ar(CEREAL_NVP(secondHashSize));
   ar(CEREAL_NVP(secondHashWeights));
   ar(CEREAL_NVP(bucketSize));
-  ar(CEREAL_NVP(secondHashTable));
-  ar(CEREAL_NVP(bucketContentSize));
-  ar(CEREAL_NVP(bucketRowInHashTable));
+  if (version >= 1)
+  {
+    ar(CEREAL_NVP(bucketOffsets));
+    ar(CEREAL_NVP(bucketContents));
+  }
+  else
+  {
+    // Older models stored each occupied bucket as its own row, and mapped hash
+    // values to rows with bucketRowInHashTable (a row of secondHashSize means
+    // the bucket is empty).  Convert that into the flat layout.
+    std::vector<arma::Col<size_t>> secondHashTable;
+    arma::Col<size_t> bucketContentSize;
+    arma::Col<size_t> bucketRowInHashTable;
+    ar(CEREAL_NVP(secondHashTable));
+    ar(CEREAL_NVP(bucketContentSize));
+    ar(CEREAL_NVP(bucketRowInHashTable));
+
+    bucketOffsets.zeros(secondHashSize + 1);
+    for (size_t h = 0; h < secondHashSize; ++h)
+    {
+      const size_t row = bucketRowInHashTable[h];
+      const size_t count = (row < secondHashTable.size()) ?
+          bucketContentSize[row] : 0;
+      bucketOffsets[h + 1] = bucketOffsets[h] + count;
+    }
+
+    bucketContents.set_size(bucketOffsets[secondHashSize]);
+    for (size_t h = 0; h < secondHashSize; ++h)
+    {
+      const size_t row = bucketRowInHashTable[h];
+      for (size_t j = 0; j < bucketOffsets[h + 1] - bucketOffsets[h]; ++j)
+        bucketContents[bucketOffsets[h] + j] = secondHashTable[row][j];
+    }
+  }
+  if (version >= 1)
+  {
+    ar(CEREAL_NVP(removedPoints));
+    ar(CEREAL_NVP(numRemoved));
+  }
+  else
+  {
+    // Older models could not remove points.
+    removedPoints.assign(referenceSet.n_cols, false);
+    numRemoved = 0;
+  }
   ar(CEREAL_NVP(distanceEvaluations));
 }
 
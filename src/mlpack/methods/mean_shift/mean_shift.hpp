@@ -17,6 +17,7 @@
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/core/kernels/kernel_traits.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <unordered_map>
 
 namespace mlpack {
 namespace meanshift /** Mean shift clustering. */ {
@@ -39,6 +40,12 @@ namespace meanshift /** Mean shift clustering. */ {
  * meanShift.Cluster(dataset, assignments, centroids, forceConvergence);
  * @endcode
  *
+ * All seeds are shifted at the same time: in each iteration, the neighbors of
+ * every seed that has not converged yet are found with a batched (dual-tree)
+ * range search, and the new centroids can then be computed in parallel (see
+ * Parallel()).  Duplicate centroids are found with a hash grid of cells with
+ * side equal to the radius.
+ *
  * @tparam UseKernel Use kernel or mean to calculate new centroid.
  *         If false, KernelType will be ignored.
  * @tparam KernelType The kernel to use.
@@ -106,7 +113,51 @@ class MeanShift
   //! Modify the kernel.
   KernelType& Kernel() { return kernel; }
 
+  //! Get whether the seeds are shifted in parallel.
+  bool Parallel() const { return parallel; }
+  //! Modify whether the seeds are shifted in parallel.
+  bool& Parallel() { return parallel; }
+
  private:
+  //! Hash the coordinates of a grid cell.
+  struct CellHash
+  {
+    size_t operator()(const std::vector<int64_t>& cell) const
+    {
+      uint64_t hash = 0;
+      for (size_t i = 0; i < cell.size(); ++i)
+        hash = (hash ^ uint64_t(cell[i])) * 0x9E3779B97F4A7C15ULL;
+      return size_t(hash ^ (hash >> 32));
+    }
+  };
+
+  //! A grid of cells with side equal to the radius, holding the indices of the
+  //! centroids in each cell.
+  typedef std::unordered_map<std::vector<int64_t>, std::vector<size_t>,
+      CellHash> CentroidGrid;
+
+  /**
+   * Compute the cell of the centroid grid that holds the given point.
+   *
+   * @param point Point to find the cell of.
+   * @param cell Vector to store the coordinates of the cell in.
+   */
+  void GridCell(const arma::colvec& point, std::vector<int64_t>& cell) const;
+
+  /**
+   * Return whether any of the given centroids is closer than the radius to the
+   * given point.  Such a centroid can only be in one of the 3^d cells of the
+   * grid around the point; if there are fewer centroids than that, they are
+   * all checked instead.
+   *
+   * @param centroids Centroids found so far.
+   * @param grid Grid holding the centroids.
+   * @param point Point to check.
+   */
+  bool HasNearbyCentroid(const arma::mat& centroids,
+                         const CentroidGrid& grid,
+                         const arma::colvec& point) const;
+
   /**
    * To speed up, we can generate some seeds from data set and use
    * them as initial centroids rather than all the points in the data set.  The
@@ -167,6 +218,9 @@ class MeanShift
 
   //! Instantiated kernel.
   KernelType kernel;
+
+  //! If true, the seeds are shifted in parallel with OpenMP.
+  bool parallel;
 };
 
 } // namespace meanshift
@@ -36,7 +36,8 @@ MeanShift(const double radius,
           const KernelType kernel) :
     radius(radius),
     maxIterations(maxIterations),
-    kernel(kernel)
+    kernel(kernel),
+    parallel(false)
 {
   // Nothing to do.
 }
@@ -176,6 +177,71 @@ CalculateCentroid(const MatType& data,
   return true;
 }
 
+// Compute the cell of the centroid grid that holds a point.
+template<bool UseKernel, typename KernelType, typename MatType>
+void MeanShift<UseKernel, KernelType, MatType>::GridCell(
+    const arma::colvec& point,
+    std::vector<int64_t>& cell) const
+{
+  cell.resize(point.n_elem);
+  for (size_t d = 0; d < point.n_elem; ++d)
+    cell[d] = (int64_t) std::floor(point[d] / radius);
+}
+
+// Determine whether any centroid is closer than the radius to a point.
+template<bool UseKernel, typename KernelType, typename MatType>
+bool MeanShift<UseKernel, KernelType, MatType>::HasNearbyCentroid(
+    const arma::mat& centroids,
+    const CentroidGrid& grid,
+    const arma::colvec& point) const
+{
+  const size_t dims = point.n_elem;
+  if (std::pow(3.0, (double) dims) > (double) centroids.n_cols)
+  {
+    // It is cheaper to check every centroid than every neighboring cell.
+    for (size_t k = 0; k < centroids.n_cols; ++k)
+    {
+      if (metric::EuclideanDistance::Evaluate(point,
+          centroids.unsafe_col(k)) < radius)
+        return true;
+    }
+    return false;
+  }
+
+  std::vector<int64_t> cell;
+  GridCell(point, cell);
+
+  // Visit each cell whose coordinates differ by at most 1 in each dimension.
+  std::vector<int64_t> offset(dims, -1);
+  std::vector<int64_t> neighbor(dims);
+  while (true)
+  {
+    for (size_t d = 0; d < dims; ++d)
+      neighbor[d] = cell[d] + offset[d];
+
+    typename CentroidGrid::const_iterator it = grid.find(neighbor);
+    if (it != grid.end())
+    {
+      for (size_t k = 0; k < it->second.size(); ++k)
+      {
+        if (metric::EuclideanDistance::Evaluate(point,
+            centroids.unsafe_col(it->second[k])) < radius)
+          return true;
+      }
+    }
+
+    // Move to the next offset.
+    size_t d = 0;
+    while (d < dims && offset[d] == 1)
+      offset[d++] = -1;
+    if (d == dims)
+      break;
+    ++offset[d];
+  }
+
+  return false;
+}
+
 /**
  * Perform Mean Shift clustering on the data set, returning a list of cluster
  * assignments and centroids.
@@ -204,6 +270,8 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
 
   // Holds all centroids before removing duplicate ones.
   arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
+  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+    allCentroids.col(i) = pSeeds->col(i);
 
   assignments.set_size(data.n_cols);
 
@@ -212,53 +280,84 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
   std::vector<std::vector<size_t> > neighbors;
   std::vector<std::vector<double> > distances;
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  // The seeds that are still being shifted, and whether each seed has
+  // converged.
+  std::vector<size_t> active(pSeeds->n_cols);
+  for (size_t i = 0; i < active.size(); ++i)
+    active[i] = i;
+  std::vector<char> converged(pSeeds->n_cols, false);
+
+  // The range search results for all active seeds can take a lot of memory, so
+  // at most this many seeds are searched at once.
+  const size_t batchSize = 4096;
+
+  // Shift all seeds at once, until they have converged or the maximum number
+  // of iterations is reached.
+  for (size_t completedIterations = 0; !active.empty() &&
+      (completedIterations < maxIterations || forceConvergence);
+      completedIterations++)
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations
-        || forceConvergence; completedIterations++)
-    {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+    // Whether each active seed is done shifting.
+    std::vector<char> done(active.size(), false);
 
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() == 0) // There are no points in the cluster.
-        break;
+    for (size_t begin = 0; begin < active.size(); begin += batchSize)
+    {
+      const size_t end = std::min(begin + batchSize, active.size());
+      arma::mat queries(allCentroids.n_rows, end - begin);
+      for (size_t j = begin; j < end; ++j)
+        queries.col(j - begin) = allCentroids.col(active[j]);
 
-      // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
+      rangeSearcher.Search(queries, validRadius, neighbors, distances);
 
-      // If the mean shift vector is small enough, it has converged.
-      if (metric::EuclideanDistance::Evaluate(newCentroid,
-          allCentroids.unsafe_col(i)) < 1e-3 * radius)
+      #pragma omp parallel for schedule(dynamic) if (parallel)
+      for (omp_size_t j = (omp_size_t) begin; j < (omp_size_t) end; ++j)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
+        const size_t i = active[j];
+        const size_t q = j - begin;
+        if (neighbors[q].size() == 0) // There are no points in the cluster.
         {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
-          {
-            isDuplicated = true;
-            break;
-          }
+          done[j] = true;
+          continue;
         }
 
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
+        // Calculate new centroid.
+        arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+        if (!CalculateCentroid(data, neighbors[q], distances[q], newCentroid))
+          newCentroid = allCentroids.col(i);
 
-        // Get out of the loop.
-        break;
-      }
+        // If the mean shift vector is small enough, it has converged.
+        if (metric::EuclideanDistance::Evaluate(newCentroid,
+            allCentroids.unsafe_col(i)) < 1e-3 * radius)
+        {
+          converged[i] = true;
+          done[j] = true;
+          continue;
+        }
 
-      // Update the centroid.
-      allCentroids.col(i) = newCentroid;
+        // Update the centroid.
+        allCentroids.col(i) = newCentroid;
+      }
     }
+
+    size_t numActive = 0;
+    for (size_t j = 0; j < active.size(); ++j)
+      if (!done[j])
+        active[numActive++] = active[j];
+    active.resize(numActive);
+  }
+
+  // Keep each converged centroid unless an earlier one is within the radius.
+  CentroidGrid grid;
+  std::vector<int64_t> cell;
+  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  {
+    if (!converged[i] ||
+        HasNearbyCentroid(centroids, grid, allCentroids.unsafe_col(i)))
+      continue;
+
+    GridCell(allCentroids.unsafe_col(i), cell);
+    grid[cell].push_back(centroids.n_cols);
+    centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
   }
 
   // If no centroid has converged due to too little iterations and without
@@ -91,6 +91,8 @@ PARAM_INT_IN("max_iterations", "Maximum number of iterations before mean shift "
 PARAM_DOUBLE_IN("radius", "If the distance between two centroids is less than "
     "the given radius, one will be removed.  A radius of 0 or less means an "
     "estimate will be calculated and used for the radius.", "r", 0);
+PARAM_FLAG("parallel", "If specified, the seeds will be shifted in parallel.",
+    "p");
 
 static void mlpackMain()
 {
@@ -112,6 +114,7 @@ static void mlpackMain()
   arma::Row<size_t> assignments;
 
   MeanShift<> meanShift(radius, maxIterations);
+  meanShift.Parallel() = IO::HasParam("parallel");
 
   Timer::Start("clustering");
   Log::Info << "Performing mean shift clustering..." << endl;
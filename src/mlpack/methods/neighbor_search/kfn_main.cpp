@@ -107,7 +107,7 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'parallel_dual_tree'.", "a", "dual_tree");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate furthest neighbor"
     " search with given relative error. Must be in the range [0,1).", "e", 0);
 PARAM_DOUBLE_IN("percentage", "If specified, will do approximate furthest "
@@ -182,7 +182,8 @@ static void mlpackMain()
 
   const string algorithm = IO::GetParam<string>("algorithm");
   RequireParamInSet<string>("algorithm", { "naive", "single_tree", "dual_tree",
-      "greedy" }, true, "unknown neighbor search algorithm");
+      "greedy", "parallel_dual_tree" }, true,
+      "unknown neighbor search algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
@@ -193,6 +194,8 @@ static void mlpackMain()
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "parallel_dual_tree")
+    searchMode = PARALLEL_DUAL_TREE_MODE;
 
   if (IO::HasParam("reference"))
   {
@@ -263,7 +266,7 @@ static void mlpackMain()
 
     Log::Info << "Using kFN model from '"
         << IO::GetPrintableParam<KFNModel*>("input_model") << "' (trained on "
-        << kfn->Dataset().n_rows << "x" << kfn->Dataset().n_cols
+        << kfn->Dimensionality() << "x" << kfn->NumPoints()
         << " dataset)." << endl;
   }
 
@@ -278,10 +281,10 @@ static void mlpackMain()
       Log::Info << "Using query data from "
           << IO::GetPrintableParam<arma::mat>("query") << "." << endl;
       queryData = std::move(IO::GetParam<arma::mat>("query"));
-      if (queryData.n_rows != kfn->Dataset().n_rows)
+      if (queryData.n_rows != kfn->Dimensionality())
       {
         // Clean memory if needed.
-        const size_t dimensions = kfn->Dataset().n_rows;
+        const size_t dimensions = kfn->Dimensionality();
         if (IO::HasParam("reference"))
           delete kfn;
         Log::Fatal << "Query has invalid dimensions (" << queryData.n_rows <<
@@ -292,10 +295,10 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than or
     // equal to the number of reference points.  Since it is unsigned,
     // we only test the upper bound.
-    if (k > kfn->Dataset().n_cols)
+    if (k > kfn->NumPoints())
     {
       // Clean memory if needed.
-      const size_t referencePoints = kfn->Dataset().n_cols;
+      const size_t referencePoints = kfn->NumPoints();
       if (IO::HasParam("reference"))
         delete kfn;
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
@@ -305,10 +308,10 @@ static void mlpackMain()
 
     // Sanity check on k value: must not be equal to the number of reference
     // points when query data has not been provided.
-    if (!IO::HasParam("query") && k == kfn->Dataset().n_cols)
+    if (!IO::HasParam("query") && k == kfn->NumPoints())
     {
       // Clean memory if needed.
-      const size_t referencePoints = kfn->Dataset().n_cols;
+      const size_t referencePoints = kfn->NumPoints();
       if (IO::HasParam("reference"))
         delete kfn;
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
@@ -93,6 +93,12 @@ PARAM_UMATRIX_IN("true_neighbors", "Matrix of true neighbors to compute the "
 PARAM_MODEL_IN(KNNModel, "input_model", "Pre-trained kNN model.", "m");
 PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
     "output here.", "M");
+PARAM_STRING_IN("input_mapped_model_file", "File containing a pre-trained kNN "
+    "model saved in the mapped format; the file is memory-mapped instead of "
+    "being read.", "", "");
+PARAM_STRING_IN("output_mapped_model_file", "If specified, the kNN model will "
+    "be saved to this file in the mapped format, which can be loaded quickly "
+    "by memory-mapping it.", "", "");
 
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
@@ -115,13 +121,19 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_FLAG("single_precision", "If set, the reference set is held in single "
+    "precision, which halves its memory use (only for the 'kd', 'rp', and "
+    "'max-rp' tree types).", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'parallel_dual_tree'.", "a", "dual_tree");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_FLAG("verify_distances", "If set, and the reference set is held in "
+    "single precision, the distances to the neighbors that were found are "
+    "recomputed in double precision (and the neighbors are sorted again).", "");
 
 static void mlpackMain()
 {
@@ -131,22 +143,30 @@ static void mlpackMain()
     math::RandomSeed((size_t) std::time(NULL));
 
   // A user cannot specify both reference data and a model.
-  RequireOnlyOnePassed({ "reference", "input_model" }, true);
+  RequireOnlyOnePassed({ "reference", "input_model",
+      "input_mapped_model_file" }, true);
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "single_precision");
   ReportIgnoredParam({{ "input_model", true }}, "tau");
   ReportIgnoredParam({{ "input_model", true }}, "rho");
-  if (IO::HasParam("input_model") && IO::HasParam("leaf_size"))
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "tree_type");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "single_precision");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "tau");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "rho");
+  if ((IO::HasParam("input_model") ||
+       IO::HasParam("input_mapped_model_file")) && IO::HasParam("leaf_size"))
   {
     Log::Warn << PRINT_PARAM_STRING("leaf_size") << " will only be considered"
-        << " for the query tree, because --input_model_file is specified."
+        << " for the query tree, because an input model is specified."
         << endl;
   }
 
   // The user should give something to do...
-  RequireAtLeastOnePassed({ "k", "output_model" }, false,
-      "no results will be saved");
+  RequireAtLeastOnePassed({ "k", "output_model", "output_mapped_model_file" },
+      false, "no results will be saved");
 
   // If the user specifies k but no output files, they should be warned.
   if (IO::HasParam("k"))
@@ -194,7 +214,8 @@ static void mlpackMain()
 
   const string algorithm = IO::GetParam<string>("algorithm");
   RequireParamInSet<string>("algorithm", { "naive", "single_tree", "dual_tree",
-      "greedy" }, true, "unknown neighbor search algorithm");
+      "greedy", "parallel_dual_tree" }, true,
+      "unknown neighbor search algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
@@ -205,6 +226,8 @@ static void mlpackMain()
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "parallel_dual_tree")
+    searchMode = PARALLEL_DUAL_TREE_MODE;
 
   if (IO::HasParam("reference"))
   {
@@ -216,6 +239,12 @@ static void mlpackMain()
     RequireParamInSet<string>("tree_type", { "kd", "cover", "r", "r-star",
         "ball", "x", "hilbert-r", "r-plus", "r-plus-plus", "spill", "vp", "rp",
         "max-rp", "ub", "oct" }, true, "unknown tree type");
+    if (IO::HasParam("single_precision") && treeType != "kd" &&
+        treeType != "rp" && treeType != "max-rp")
+    {
+      Log::Fatal << PRINT_PARAM_STRING("single_precision") << " is only "
+          << "supported for the 'kd', 'rp', and 'max-rp' tree types." << endl;
+    }
 
     knn = new KNNModel();
 
@@ -252,6 +281,7 @@ static void mlpackMain()
 
     knn->TreeType() = tree;
     knn->RandomBasis() = randomBasis;
+    knn->SinglePrecision() = IO::HasParam("single_precision");
     knn->LeafSize() = size_t(lsInt);
     knn->Tau() = tau;
     knn->Rho() = rho;
@@ -263,6 +293,22 @@ static void mlpackMain()
 
     knn->BuildModel(std::move(referenceSet), searchMode, epsilon);
   }
+  else if (IO::HasParam("input_mapped_model_file"))
+  {
+    // Map the model from file; the reference set is not copied.
+    const string filename = IO::GetParam<string>("input_mapped_model_file");
+    knn = new KNNModel();
+    knn->LoadMapped(filename, true);
+
+    knn->SearchMode() = searchMode;
+    knn->Epsilon() = epsilon;
+    if (IO::HasParam("leaf_size"))
+      knn->LeafSize() = size_t(lsInt);
+
+    Log::Info << "Mapped kNN model from '" << filename << "' (trained on "
+        << knn->Dimensionality() << "x" << knn->NumPoints()
+        << " dataset)." << endl;
+  }
   else
   {
     // Load the model from file.
@@ -280,13 +326,20 @@ static void mlpackMain()
 
     Log::Info << "Loaded kNN model from '"
         << IO::GetPrintableParam<KNNModel*>("input_model") << "' (trained on "
-        << knn->Dataset().n_rows << "x" << knn->Dataset().n_cols
+        << knn->Dimensionality() << "x" << knn->NumPoints()
         << " dataset)." << endl;
   }
 
   // Perform search, if desired.
   if (IO::HasParam("k"))
   {
+    if (IO::HasParam("verify_distances") && !knn->SinglePrecision())
+    {
+      Log::Warn << PRINT_PARAM_STRING("verify_distances") << " ignored "
+          << "because the reference set is held in double precision." << endl;
+    }
+    knn->VerifyDistances() = IO::HasParam("verify_distances");
+
     const size_t k = (size_t) IO::GetParam<int>("k");
 
     arma::mat queryData;
@@ -295,10 +348,10 @@ static void mlpackMain()
       Log::Info << "Using query data from "
           << IO::GetPrintableParam<arma::mat>("query") << "." << endl;
       queryData = std::move(IO::GetParam<arma::mat>("query"));
-      if (queryData.n_rows != knn->Dataset().n_rows)
+      if (queryData.n_rows != knn->Dimensionality())
       {
         // Clean memory if needed before crashing.
-        const size_t dimensions = knn->Dataset().n_rows;
+        const size_t dimensions = knn->Dimensionality();
         if (IO::HasParam("reference"))
           delete knn;
         Log::Fatal << "Query has invalid dimensions(" << queryData.n_rows <<
@@ -309,10 +362,10 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than or
     // equal to the number of reference points.  Since it is unsigned,
     // we only test the upper bound.
-    if (k > knn->Dataset().n_cols)
+    if (k > knn->NumPoints())
     {
       // Clean memory if needed before crashing.
-      const size_t referencePoints = knn->Dataset().n_cols;
+      const size_t referencePoints = knn->NumPoints();
       if (IO::HasParam("reference"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
@@ -322,10 +375,10 @@ static void mlpackMain()
 
     // Sanity check on k value: must not be equal to the number of reference
     // points when query data has not been provided.
-    if (!IO::HasParam("query") && k == knn->Dataset().n_cols)
+    if (!IO::HasParam("query") && k == knn->NumPoints())
     {
       // Clean memory if needed before crashing.
-      const size_t referencePoints = knn->Dataset().n_cols;
+      const size_t referencePoints = knn->NumPoints();
       if (IO::HasParam("reference"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
@@ -395,5 +448,8 @@ static void mlpackMain()
     IO::GetParam<arma::mat>("distances") = std::move(distances);
   }
 
+  if (IO::HasParam("output_mapped_model_file"))
+    knn->SaveMapped(IO::GetParam<string>("output_mapped_model_file"), true);
+
   IO::GetParam<KNNModel*>("output_model") = knn;
 }
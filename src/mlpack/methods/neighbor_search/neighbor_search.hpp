@@ -20,6 +20,7 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/subtree_partition.hpp>
 
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
@@ -30,22 +31,40 @@ namespace mlpack {
 // all-furthest-neighbors searches.
 namespace neighbor  {
 
-// Forward declaration.
+// Forward declarations.
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+class NSWrapper;
+
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 class LeafSizeNSWrapper;
 
-//! NeighborSearchMode represents the different neighbor search modes available.
+/**
+ * NeighborSearchMode represents the different neighbor search modes available.
+ * PARALLEL_DUAL_TREE_MODE is dual-tree search where the query tree is split
+ * into many disjoint subtrees, each of which is traversed against the
+ * reference tree as a separate OpenMP task.  It returns the same results as
+ * DUAL_TREE_MODE, and falls back to a serial traversal if mlpack is compiled
+ * without OpenMP.
+ */
 enum NeighborSearchMode
 {
   NAIVE_MODE,
   SINGLE_TREE_MODE,
   DUAL_TREE_MODE,
-  GREEDY_SINGLE_TREE_MODE
+  GREEDY_SINGLE_TREE_MODE,
+  PARALLEL_DUAL_TREE_MODE
 };
 
 /**
@@ -90,6 +109,67 @@ class NeighborSearch
  public:
   //! Convenience typedef.
   typedef TreeType<MetricType, NeighborSearchStat<SortPolicy>, MatType> Tree;
+  //! The rules type used for all tree-based searches.
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
+
+  /**
+   * Caller-owned storage for repeated searches of small batches of query
+   * points (see the Search() overload that takes a SearchBuffers object).  The
+   * buffers hold the result matrices and the lists of candidate neighbors, and
+   * they are reused by each search, so once they are large enough for the
+   * largest batch, the search itself does not allocate them again.  Whether a
+   * search allocates no memory at all also depends on the tree type; see the
+   * Search() overload that takes a SearchBuffers object.
+   *
+   * After a search of n query points, the results are held in the first n
+   * columns of Neighbors() and Distances().  A SearchBuffers object must not be
+   * used by two searches at the same time.
+   */
+  class SearchBuffers
+  {
+   public:
+    /**
+     * Create the buffers, preallocating space for batches of up to the given
+     * number of query points with the given number of neighbors.
+     *
+     * @param k Number of neighbors that will be searched for.
+     * @param batchSize Largest number of query points in a single search.
+     */
+    SearchBuffers(const size_t k = 0, const size_t batchSize = 1);
+
+    /**
+     * Make sure the buffers can hold the results of a search for k neighbors
+     * of batchSize query points.  Memory is only allocated if the buffers are
+     * too small or k has changed.
+     *
+     * @param k Number of neighbors that will be searched for.
+     * @param batchSize Number of query points in a single search.
+     */
+    void Reserve(const size_t k, const size_t batchSize);
+
+    //! Get the number of neighbors the buffers are sized for.
+    size_t K() const { return neighbors.n_rows; }
+    //! Get the number of query points the buffers can hold.
+    size_t BatchSize() const { return neighbors.n_cols; }
+
+    //! Get the neighbors found by the last search (only the first n columns
+    //! are valid, where n is the number of query points of that search).
+    const arma::Mat<size_t>& Neighbors() const { return neighbors; }
+    //! Get the distances found by the last search (only the first n columns
+    //! are valid, where n is the number of query points of that search).
+    const arma::mat& Distances() const { return distances; }
+
+   private:
+    //! The lists of candidate neighbors, one for each query point.
+    std::vector<typename RuleType::CandidateList> candidates;
+    //! The neighbors of each query point.
+    arma::Mat<size_t> neighbors;
+    //! The distances to the neighbors of each query point.
+    arma::mat distances;
+
+    //! The NeighborSearch class fills the buffers.
+    friend class NeighborSearch;
+  };
 
   /**
    * Initialize the NeighborSearch object, passing a reference dataset (this is
@@ -211,6 +291,49 @@ class NeighborSearch
    */
   void Train(Tree referenceTree);
 
+  /**
+   * Add a point to the reference set, without rebuilding the reference tree
+   * from scratch: the point is inserted into the tree, and only the parts of
+   * the tree that become unbalanced are rebuilt (see
+   * BinarySpaceTree::Insert()).  The points of the reference tree are not
+   * shifted: the point goes into a free column of the dataset of the tree, so
+   * the amortized cost is polylogarithmic in the size of the reference set.
+   *
+   * Every reference point keeps its index in the results of later searches
+   * until it is deleted.  The new point gets the next unused index, as if it
+   * had been appended to the original reference set; indices of deleted points
+   * are not reused.  (If the reference tree was given directly, the points
+   * of the tree are numbered by their column in its dataset at the time of the
+   * first call to Insert() or Delete().)
+   *
+   * This is only available when TreeType is a BinarySpaceTree (like the
+   * default kd-tree) or in naive mode.  Packed trees can't be modified.  In
+   * naive mode, the reference set is a plain matrix, so it is copied on every
+   * call.
+   *
+   * @param point Point to add.
+   * @param maxLeafSize Leaf size that was used to build the reference tree.
+   */
+  template<typename VecType>
+  void Insert(const VecType& point, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point with the given index from the reference set, without
+   * rebuilding the reference tree from scratch (see BinarySpaceTree::Delete()).
+   * The point is found in constant time, and the indices of the other
+   * reference points do not change.  If no point has the given index (or it
+   * was already deleted), a std::invalid_argument exception is thrown.
+   *
+   * This is only available when TreeType is a BinarySpaceTree (like the
+   * default kd-tree) or in naive mode.  Packed trees can't be modified.  In
+   * naive mode, the reference set is a plain matrix, so it is copied on every
+   * call.
+   *
+   * @param index Index of the point to remove (as returned by Search()).
+   * @param maxLeafSize Leaf size that was used to build the reference tree.
+   */
+  void Delete(const size_t index, const size_t maxLeafSize = 20);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -233,6 +356,39 @@ class NeighborSearch
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * For each point in the query set, compute the nearest neighbors and store
+   * the output in the given buffers, which are reused across calls.  This is
+   * meant for answering many small batches of queries (or single queries)
+   * with low and predictable latency: once the buffers are large enough, the
+   * results and candidate lists are not allocated again, no query tree is
+   * built, and nothing is timed or logged.  After the call, the first
+   * querySet.n_cols columns of buffers.Neighbors() and buffers.Distances()
+   * hold the results.
+   *
+   * No memory at all is allocated in naive mode, and in the tree-based modes
+   * with trees whose single-tree traversers don't allocate memory
+   * (BinarySpaceTree, such as the default KDTree, and SpillTree).  The
+   * single-tree traversers of CoverTree, RectangleTree (R, R*, X, and
+   * Hilbert R trees) and Octree allocate memory to sort the children of the
+   * nodes they visit, so with those trees each search still allocates
+   * memory.
+   *
+   * This overload never does a dual-tree search, because building a query
+   * tree is not worthwhile for small batches: DUAL_TREE_MODE and
+   * PARALLEL_DUAL_TREE_MODE do a single-tree search instead (with the same
+   * results), and the other modes are used as-is.  To avoid copying a query
+   * point that is already in memory, pass an Armadillo matrix that uses that
+   * memory (i.e. constructed with copy_aux_mem = false).
+   *
+   * @param querySet Set of query points (can be just one point).
+   * @param k Number of neighbors to search for.
+   * @param buffers Buffers to store the results in.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              SearchBuffers& buffers);
+
   /**
    * Given a pre-built query tree, search for the nearest neighbors of each
    * point in the query tree, storing the output in the given matrices.  The
@@ -268,6 +424,12 @@ class NeighborSearch
    * where n is the number of points in the query dataset and k is the number of
    * neighbors being searched for.
    *
+   * If points were deleted with Delete(), n is the number of indices given out
+   * so far, and the columns of the deleted points hold SIZE_MAX as neighbors
+   * and SortPolicy::WorstDistance() as distances.  If points were inserted or
+   * deleted, the free columns this leaves in the dataset of the reference tree
+   * are removed first (see BinarySpaceTree::Compact()).
+   *
    * @param k Number of neighbors to search for.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
@@ -326,8 +488,10 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
-  //! Access the reference dataset.
-  const MatType& ReferenceSet() const { return *referenceSet; }
+  //! Access the reference dataset.  If points were inserted or deleted, the
+  //! free columns this leaves in the dataset of the reference tree are removed
+  //! first, so every column holds a reference point.
+  const MatType& ReferenceSet() const;
 
   //! Access the reference tree.
   const Tree& ReferenceTree() const { return *referenceTree; }
@@ -339,8 +503,14 @@ class NeighborSearch
   void serialize(Archive& ar, const uint32_t version);
 
  private:
-  //! Permutations of reference points during tree building.
+  //! Permutations of reference points during tree building.  After Insert()
+  //! or Delete(), this has an entry for every column of the reference set, and
+  //! free columns map to SIZE_MAX.
   std::vector<size_t> oldFromNewReferences;
+  //! The inverse of oldFromNewReferences, used to find points by index in
+  //! Delete(); deleted points map to SIZE_MAX.  This is only filled after the
+  //! first call to Insert() or Delete().
+  std::vector<size_t> newFromOldReferences;
   //! Pointer to the root of the reference tree.
   Tree* referenceTree;
   //! Reference dataset.  In some situations we may be the owner of this.
@@ -363,14 +533,95 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  /**
+   * Perform the dual-tree traversal of the given query tree and the reference
+   * tree with the given rules.  In PARALLEL_DUAL_TREE_MODE, the query tree is
+   * split into disjoint subtrees that are traversed in parallel, each with its
+   * own rules object that shares the candidate lists of the given rules.  The
+   * number of scores and base cases of all tasks is added to the given rules.
+   *
+   * @param queryTree Tree built on query points.
+   * @param rules Rules to use for the traversal.
+   */
+  void DualTreeTraverse(Tree& queryTree, RuleType& rules);
+
+  //! Fill oldFromNewReferences and newFromOldReferences, if they are not
+  //! filled yet, before the reference set is modified.
+  void InitializeMappings();
+
+  //! Remove the free columns left in the dataset of the reference tree by
+  //! Insert() and Delete(), if any.
+  void CompactReferenceSet();
+
+  //! Return the number of reference points.
+  size_t NumReferencePoints() const
+  {
+    return referenceTree ? referenceTree->NumDescendants() :
+        referenceSet->n_cols;
+  }
+
   //! The NSModel class should have access to internal members.
-  friend class LeafSizeNSWrapper<SortPolicy, TreeType, DualTreeTraversalType,
+  friend class NSWrapper<SortPolicy, TreeType, MatType, DualTreeTraversalType,
       SingleTreeTraversalType>;
+  friend class LeafSizeNSWrapper<SortPolicy, TreeType, MatType,
+      DualTreeTraversalType, SingleTreeTraversalType>;
 }; // class NeighborSearch
 
 } // namespace neighbor
 } // namespace mlpack
 
+namespace cereal {
+namespace detail {
+
+/**
+ * Set the serialization version of NeighborSearch to 1 (version 1 added
+ * newFromOldReferences, and the mappings of a modified reference set in naive
+ * mode).  This is what CEREAL_CLASS_VERSION() does, but that macro can only be
+ * used with a concrete type, not a class template.
+ */
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+struct Version<mlpack::neighbor::NeighborSearch<SortPolicy, MetricType, MatType,
+    TreeType, DualTreeTraversalType, SingleTreeTraversalType>>
+{
+  typedef mlpack::neighbor::NeighborSearch<SortPolicy, MetricType, MatType,
+      TreeType, DualTreeTraversalType, SingleTreeTraversalType> NSType;
+
+  static const std::uint32_t version;
+
+  static std::uint32_t registerVersion()
+  {
+    StaticObject<Versions>::getInstance().mapping.emplace(std::type_index(
+        typeid(NSType)).hash_code(), 1);
+    return 1;
+  }
+
+  static void unused() { (void) version; }
+};
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+const std::uint32_t Version<mlpack::neighbor::NeighborSearch<SortPolicy,
+    MetricType, MatType, TreeType, DualTreeTraversalType,
+    SingleTreeTraversalType>>::version = Version<mlpack::neighbor::
+    NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+    DualTreeTraversalType, SingleTreeTraversalType>>::registerVersion();
+
+} // namespace detail
+} // namespace cereal
+
 // Include implementation.
 #include "neighbor_search_impl.hpp"
 
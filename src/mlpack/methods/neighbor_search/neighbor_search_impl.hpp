@@ -45,6 +45,34 @@ TreeType* BuildTree(
   return new TreeType(std::forward<MatType>(dataset));
 }
 
+//! Remove the free columns left by Insert() and Delete() in the dataset of a
+//! BinarySpaceTree.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void CompactTree(tree::BinarySpaceTree<MetricType, StatisticType, MatType,
+                                       BoundType, SplitType>& tree,
+                 std::vector<size_t>& oldFromNew,
+                 std::vector<size_t>& newFromOld)
+{
+  if (oldFromNew.empty())
+    tree.Compact();
+  else
+    tree.Compact(oldFromNew, newFromOld);
+}
+
+//! Other trees can't be modified, so there is nothing to do.
+template<typename TreeType>
+void CompactTree(TreeType& /* tree */,
+                 std::vector<size_t>& /* oldFromNew */,
+                 std::vector<size_t>& /* newFromOld */)
+{
+  // Nothing to do.
+}
+
 // Construct the object.
 template<typename SortPolicy,
          typename MetricType,
@@ -129,7 +157,7 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
   // Build the tree on the empty dataset, if necessary.
   if (mode != NAIVE_MODE)
   {
-    referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+    referenceTree = BuildTree<Tree>(std::move(MatType()),
         oldFromNewReferences);
     referenceSet = &referenceTree->Dataset();
   }
@@ -147,6 +175,7 @@ template<typename SortPolicy,
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
 SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
+    newFromOldReferences(other.newFromOldReferences),
     referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
         new MatType(*other.referenceSet)),
@@ -172,6 +201,7 @@ template<typename SortPolicy,
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
 SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     oldFromNewReferences(std::move(other.oldFromNewReferences)),
+    newFromOldReferences(std::move(other.newFromOldReferences)),
     referenceTree(other.referenceTree),
     referenceSet(other.referenceSet),
     searchMode(other.searchMode),
@@ -182,6 +212,7 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     treeNeedsReset(other.treeNeedsReset)
 {
   // Clear the other model.
+  other.newFromOldReferences.clear();
   other.referenceTree = BuildTree<Tree>(std::move(MatType()),
       other.oldFromNewReferences);
   other.referenceSet = &other.referenceTree->Dataset();
@@ -224,6 +255,7 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = other.oldFromNewReferences;
+  newFromOldReferences = other.newFromOldReferences;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
@@ -267,6 +299,7 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = std::move(other.oldFromNewReferences);
+  newFromOldReferences = std::move(other.newFromOldReferences);
   referenceTree = other.referenceTree;
   referenceSet = other.referenceSet;
   searchMode = other.searchMode;
@@ -280,7 +313,8 @@ NeighborSearch<SortPolicy,
   if (!other.referenceTree)
     delete other.referenceSet;
 
-  other.referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+  other.newFromOldReferences.clear();
+  other.referenceTree = BuildTree<Tree>(std::move(MatType()),
       other.oldFromNewReferences);
   other.referenceSet = &other.referenceTree->Dataset();
   other.searchMode = DUAL_TREE_MODE,
@@ -319,10 +353,13 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType referenceSetIn)
 {
+  // The mappings of the old reference set are no longer valid.
+  oldFromNewReferences.clear();
+  newFromOldReferences.clear();
+
   // Clean up the old tree, if we built one.
   if (referenceTree)
   {
-    oldFromNewReferences.clear();
     delete referenceTree;
     referenceTree = NULL;
   }
@@ -359,9 +396,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
     throw std::invalid_argument("cannot train on given reference tree when "
         "naive search (without trees) is desired");
 
+  oldFromNewReferences.clear();
+  newFromOldReferences.clear();
+
   if (this->referenceTree)
   {
-    oldFromNewReferences.clear();
     delete this->referenceTree;
   }
   else
@@ -373,6 +412,154 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
   this->referenceSet = &this->referenceTree->Dataset();
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename VecType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(const VecType& point,
+                                          const size_t maxLeafSize)
+{
+  if (point.n_elem != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "NeighborSearch::Insert(): dimensionality of point ("
+        << point.n_elem << ") does not match dimensionality of reference set ("
+        << referenceSet->n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  InitializeMappings();
+  if (referenceTree)
+  {
+    referenceTree->Insert(point, oldFromNewReferences, newFromOldReferences,
+        maxLeafSize);
+  }
+  else
+  {
+    // Without a tree, we own the reference set.
+    MatType& referenceMat = const_cast<MatType&>(*referenceSet);
+    referenceMat.insert_cols(referenceMat.n_cols, point);
+    oldFromNewReferences.push_back(newFromOldReferences.size());
+    newFromOldReferences.push_back(referenceMat.n_cols - 1);
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Delete(const size_t index,
+                                          const size_t maxLeafSize)
+{
+  InitializeMappings();
+  if (index >= newFromOldReferences.size() ||
+      newFromOldReferences[index] == SIZE_MAX)
+  {
+    std::ostringstream oss;
+    oss << "NeighborSearch::Delete(): there is no reference point with index "
+        << index;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t column = newFromOldReferences[index];
+  if (referenceTree)
+  {
+    referenceTree->Delete(column, oldFromNewReferences, newFromOldReferences,
+        maxLeafSize);
+  }
+  else
+  {
+    // Without a tree, we own the reference set.  Move the last point into the
+    // column of the deleted one, so that only one point changes its column.
+    MatType& referenceMat = const_cast<MatType&>(*referenceSet);
+    const size_t last = referenceMat.n_cols - 1;
+    referenceMat.col(column) = referenceMat.col(last);
+    referenceMat.shed_col(last);
+
+    oldFromNewReferences[column] = oldFromNewReferences[last];
+    newFromOldReferences[oldFromNewReferences[column]] = column;
+    newFromOldReferences[index] = SIZE_MAX;
+    oldFromNewReferences.pop_back();
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::InitializeMappings()
+{
+  // If the tree was given to us, or if it does not rearrange the points, the
+  // points are numbered by their column.
+  if (oldFromNewReferences.empty())
+  {
+    oldFromNewReferences.resize(referenceSet->n_cols);
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      oldFromNewReferences[i] = i;
+  }
+
+  if (newFromOldReferences.empty())
+  {
+    size_t numIndices = 0;
+    for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+      if (oldFromNewReferences[i] != SIZE_MAX)
+        numIndices = std::max(numIndices, oldFromNewReferences[i] + 1);
+
+    newFromOldReferences.assign(numIndices, SIZE_MAX);
+    for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+      if (oldFromNewReferences[i] != SIZE_MAX)
+        newFromOldReferences[oldFromNewReferences[i]] = i;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::CompactReferenceSet()
+{
+  if (referenceTree && NumReferencePoints() != referenceSet->n_cols)
+    CompactTree(*referenceTree, oldFromNewReferences, newFromOldReferences);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+const MatType& NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::ReferenceSet() const
+{
+  // Removing the free columns does not change the reference points, or their
+  // indices.
+  const_cast<NeighborSearch*>(this)->CompactReferenceSet();
+  return *referenceSet;
+}
+
 /**
  * Computes the best neighbors and stores them in resultingNeighbors and
  * distances.
@@ -392,11 +579,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -415,16 +602,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  // Both dual-tree modes build a query tree.
+  const bool dualTreeSearch = (searchMode == DUAL_TREE_MODE ||
+      searchMode == PARALLEL_DUAL_TREE_MODE);
+
+  // Query indices need mapping only if the tree rearranges points; reference
+  // indices need mapping if the tree rearranged them or if the reference set
+  // was modified.
+  if (tree::TreeTraits<Tree>::RearrangesDataset && dualTreeSearch)
   {
-    if (searchMode == DUAL_TREE_MODE)
-    {
-      distancePtr = new arma::mat; // Query indices need to be mapped.
-      neighborPtr = new arma::Mat<size_t>;
-    }
-    else if (!oldFromNewReferences.empty())
-      neighborPtr = new arma::Mat<size_t>; // Reference indices need mapping.
+    distancePtr = new arma::mat; // Query indices need to be mapped.
+    neighborPtr = new arma::Mat<size_t>;
+  }
+  else if (!oldFromNewReferences.empty())
+  {
+    neighborPtr = new arma::Mat<size_t>; // Reference indices need mapping.
   }
 
   // Set the size of the neighbor and distance matrices.
@@ -474,6 +666,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       break;
     }
     case DUAL_TREE_MODE:
+    case PARALLEL_DUAL_TREE_MODE:
     {
       // Build the query tree.
       Timer::Stop("computing_neighbors");
@@ -485,10 +678,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
-      traverser.Traverse(*queryTree, *referenceTree);
+      DualTreeTraverse(*queryTree, rules);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -531,9 +721,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  if (tree::TreeTraits<Tree>::RearrangesDataset && dualTreeSearch)
   {
-    if (searchMode == DUAL_TREE_MODE && !oldFromNewReferences.empty())
+    if (!oldFromNewReferences.empty())
     {
       // We must map both query and reference indices.
       neighbors.set_size(k, querySet.n_cols);
@@ -556,7 +746,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       delete neighborPtr;
       delete distancePtr;
     }
-    else if (searchMode == DUAL_TREE_MODE)
+    else
     {
       // We must map query indices only.
       neighbors.set_size(k, querySet.n_cols);
@@ -574,21 +764,151 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       delete neighborPtr;
       delete distancePtr;
     }
-    else if (!oldFromNewReferences.empty())
+  }
+  else if (!oldFromNewReferences.empty())
+  {
+    // We must map reference indices only.
+    neighbors.set_size(k, querySet.n_cols);
+
+    // Map indices of neighbors.
+    for (size_t i = 0; i < neighbors.n_cols; ++i)
+      for (size_t j = 0; j < neighbors.n_rows; ++j)
+        neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
+
+    // Finished with temporary matrix.
+    delete neighborPtr;
+  }
+} // Search()
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
+SingleTreeTraversalType>::SearchBuffers::SearchBuffers(const size_t k,
+                                                       const size_t batchSize)
+{
+  Reserve(k, batchSize);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SearchBuffers::Reserve(
+    const size_t k,
+    const size_t batchSize)
+{
+  if (neighbors.n_rows != k || neighbors.n_cols < batchSize)
+  {
+    const size_t cols = std::max(batchSize, (size_t) neighbors.n_cols);
+    neighbors.set_size(k, cols);
+    distances.set_size(k, cols);
+  }
+
+  // Fill the candidate lists once, so that their memory is already allocated
+  // for the first search.
+  if (candidates.size() < batchSize)
+  {
+    const typename RuleType::Candidate def = std::make_pair(
+        SortPolicy::WorstDistance(), size_t() - 1);
+    candidates.resize(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
     {
-      // We must map reference indices only.
-      neighbors.set_size(k, querySet.n_cols);
+      while (candidates[i].size() < k)
+        candidates[i].push(def);
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    SearchBuffers& buffers)
+{
+  if (k > NumReferencePoints())
+  {
+    std::stringstream ss;
+    ss << "Requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << NumReferencePoints() << ")";
+    throw std::invalid_argument(ss.str());
+  }
 
-      // Map indices of neighbors.
-      for (size_t i = 0; i < neighbors.n_cols; ++i)
-        for (size_t j = 0; j < neighbors.n_rows; ++j)
-          neighbors(j, i) = oldFromNewReferences[(*neighborPtr)(j, i)];
+  baseCases = 0;
+  scores = 0;
 
-      // Finished with temporary matrix.
-      delete neighborPtr;
+  // This is a no-op if the buffers are already large enough.
+  buffers.Reserve(k, querySet.n_cols);
+
+  RuleType rules(*referenceSet, querySet, k, metric, buffers.candidates,
+      (searchMode == GREEDY_SINGLE_TREE_MODE) ? 0.0 : epsilon);
+
+  switch (searchMode)
+  {
+    case NAIVE_MODE:
+    {
+      // The naive brute-force traversal.
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          rules.BaseCase(i, j);
+
+      baseCases += querySet.n_cols * referenceSet->n_cols;
+      break;
+    }
+    case SINGLE_TREE_MODE:
+    case DUAL_TREE_MODE:
+    case PARALLEL_DUAL_TREE_MODE:
+    {
+      // Small batches are not worth a query tree, so the dual-tree modes do a
+      // single-tree search here (as documented).
+      SingleTreeTraversalType<RuleType> traverser(rules);
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+
+      scores += rules.Scores();
+      baseCases += rules.BaseCases();
+      break;
+    }
+    case GREEDY_SINGLE_TREE_MODE:
+    {
+      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+
+      scores += rules.Scores();
+      baseCases += rules.BaseCases();
+      break;
     }
   }
-} // Search()
+
+  rules.GetResultsInPlace(buffers.neighbors, buffers.distances);
+
+  // Map reference indices back to their original indices, if necessary.
+  if (!oldFromNewReferences.empty())
+  {
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      for (size_t j = 0; j < k; ++j)
+        buffers.neighbors(j, i) = oldFromNewReferences[buffers.neighbors(j, i)];
+  }
+}
 
 template<typename SortPolicy,
          typename MetricType,
@@ -606,16 +926,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
   // Make sure we are in dual-tree mode.
-  if (searchMode != DUAL_TREE_MODE)
+  if (searchMode != DUAL_TREE_MODE && searchMode != PARALLEL_DUAL_TREE_MODE)
     throw std::invalid_argument("cannot call NeighborSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
@@ -630,8 +950,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // We won't need to map query indices, but will we need to map distances?
   arma::Mat<size_t>* neighborPtr = &neighbors;
 
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
     neighborPtr = new arma::Mat<size_t>;
 
   neighborPtr->set_size(k, querySet.n_cols);
@@ -641,9 +960,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  DualTreeTraverse(queryTree, rules);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -659,8 +976,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Do we need to map indices?
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
     // We must map reference indices only.
     neighbors.set_size(k, querySet.n_cols);
@@ -689,11 +1005,15 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  // The reference set is used as the query set, so it must not have any free
+  // columns.
+  CompactReferenceSet();
+
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
   if (k == referenceSet->n_cols)
@@ -713,8 +1033,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
     // We will always need to rearrange in this case.
     distancePtr = new arma::mat;
@@ -761,6 +1080,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       break;
     }
     case DUAL_TREE_MODE:
+    case PARALLEL_DUAL_TREE_MODE:
     {
       // The dual-tree monochromatic search case may require resetting the
       // bounds in the tree.
@@ -782,19 +1102,18 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
-        traverser.Traverse(queryTree, *referenceTree);
+        DualTreeTraverse(queryTree, rules);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        // Query nodes only modify their own statistics, so the reference tree
+        // can also be used as the query tree in the parallel search.
+        DualTreeTraverse(*referenceTree, rules);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -836,13 +1155,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Do we need to map the reference indices?
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
-    neighbors.set_size(k, referenceSet->n_cols);
-    distances.set_size(k, referenceSet->n_cols);
+    // The results are indexed by the original indices, some of which may
+    // belong to deleted points.
+    const size_t numIndices = std::max((size_t) referenceSet->n_cols,
+        newFromOldReferences.size());
+    neighbors.set_size(k, numIndices);
+    distances.set_size(k, numIndices);
+    if (numIndices > referenceSet->n_cols)
+    {
+      neighbors.fill(SIZE_MAX);
+      distances.fill(SortPolicy::WorstDistance());
+    }
 
-    for (size_t i = 0; i < distances.n_cols; ++i)
+    for (size_t i = 0; i < distancePtr->n_cols; ++i)
     {
       // Map distances (copy a column).
       const size_t refMapping = oldFromNewReferences[i];
@@ -859,6 +1186,60 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DualTreeTraverse(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  if (searchMode != PARALLEL_DUAL_TREE_MODE)
+  {
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    return;
+  }
+
+  // Split the query tree into many more subtrees than there are threads, so
+  // that dynamic scheduling can balance the uneven cost of the subtrees.  The
+  // subtrees are disjoint, so each query point's candidate list is only ever
+  // touched by one task, and no locking is needed.
+  #ifdef HAS_OPENMP
+    const size_t numTasks = (omp_get_max_threads() == 1) ? 1 :
+        8 * omp_get_max_threads();
+  #else
+    const size_t numTasks = 1;
+  #endif
+
+  std::vector<Tree*> subtrees;
+  tree::PartitionSubtrees(queryTree, numTasks, subtrees);
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    // Each task gets its own traversal info and base case cache.
+    RuleType taskRules(rules, true /* share candidates */);
+    DualTreeTraversalType<RuleType> traverser(taskRules);
+    traverser.Traverse(*subtrees[i], *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -940,7 +1321,7 @@ template<typename SortPolicy,
 template<typename Archive>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::serialize(
-    Archive& ar, const uint32_t /* version */)
+    Archive& ar, const uint32_t version)
 {
   // Serialize preferences for search.
   ar(CEREAL_NVP(searchMode));
@@ -989,6 +1370,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     }
   }
 
+  // Version 1 added the mappings kept by Insert() and Delete(); older models
+  // rebuild them when they are needed.
+  if (version >= 1)
+  {
+    if (searchMode == NAIVE_MODE)
+      ar(CEREAL_NVP(oldFromNewReferences));
+    ar(CEREAL_NVP(newFromOldReferences));
+  }
+  else if (cereal::is_loading<Archive>())
+  {
+    newFromOldReferences.clear();
+  }
+
   // Reset base cases and scores.
   if (cereal::is_loading<Archive>())
   {
@@ -35,6 +35,21 @@ template<typename SortPolicy, typename MetricType, typename TreeType>
 class NeighborSearchRules
 {
  public:
+  //! Candidate represents a possible candidate neighbor (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Compare two candidates based on the distance.
+  struct CandidateCmp {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return !SortPolicy::IsBetter(c2.first, c1.first);
+    };
+  };
+
+  //! Use a priority queue to represent the list of candidate neighbors.
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateList;
+
   /**
    * Construct the NeighborSearchRules object.  This is usually done from within
    * the NeighborSearch class at search time.
@@ -54,6 +69,57 @@ class NeighborSearchRules
                       const double epsilon = 0,
                       const bool sameSet = false);
 
+  /**
+   * Copy the given NeighborSearchRules object, including its candidate lists.
+   * The copy always stores its candidate lists itself, even if the given
+   * object shares them or stores them in a given vector.
+   *
+   * @param other Rules object to copy.
+   */
+  NeighborSearchRules(const NeighborSearchRules& other);
+
+  /**
+   * Construct a NeighborSearchRules object with the same reference set, query
+   * set, metric, and settings as the given object.  The new object has its own
+   * traversal information, cache of the last base case, and counters, so it
+   * can be used by a different thread than the given object.
+   *
+   * If shareCandidates is true, the new object writes to the same lists of
+   * candidate neighbors as the given object.  This is what the parallel
+   * dual-tree search uses: each task traverses a different query subtree, so
+   * no two tasks ever modify the same candidate list.
+   *
+   * @param other Rules object to take the settings from.
+   * @param shareCandidates If true, share the candidate lists of the other
+   *      object; otherwise, start from new, empty candidate lists.
+   */
+  NeighborSearchRules(NeighborSearchRules& other, const bool shareCandidates);
+
+  /**
+   * Construct the NeighborSearchRules object, storing the candidate lists in
+   * the given vector instead of in the object itself.  The first
+   * querySet.n_cols lists of the vector are reset to k empty candidates; the
+   * vector is only grown if it holds too few lists.  Since GetResults() empties
+   * each list but keeps its memory, reusing the same vector for many searches
+   * with the same k does not allocate any memory after the first search.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param k Number of neighbors to search for.
+   * @param metric Instantiated metric.
+   * @param candidateStorage Vector of candidate lists to use.
+   * @param epsilon Relative approximate error.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  NeighborSearchRules(const typename TreeType::Mat& referenceSet,
+                      const typename TreeType::Mat& querySet,
+                      const size_t k,
+                      MetricType& metric,
+                      std::vector<CandidateList>& candidateStorage,
+                      const double epsilon = 0,
+                      const bool sameSet = false);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -63,6 +129,18 @@ class NeighborSearchRules
    */
   void GetResults(arma::Mat<size_t>& neighbors, arma::mat& distances);
 
+  /**
+   * Store the list of candidates for each query point in the first
+   * querySet.n_cols columns of the given matrices, which must already have k
+   * rows and at least that many columns.  The matrices are not resized, so no
+   * memory is allocated.
+   *
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void GetResultsInPlace(arma::Mat<size_t>& neighbors, arma::mat& distances);
+
   /**
    * Get the distance from the query point to the reference point.
    * This will update the list of candidates with the new point if appropriate
@@ -168,23 +246,13 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
-
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
+  //! Candidate lists owned by this object.  This is empty if the candidate
+  //! lists are shared with another object or stored in a given vector.
+  std::vector<CandidateList> ownedCandidates;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! Set of candidate neighbors for each point; either ownedCandidates, the
+  //! candidates of the object they are shared with, or the given vector.
+  std::vector<CandidateList>* candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
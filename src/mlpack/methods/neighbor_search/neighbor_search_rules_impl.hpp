@@ -29,6 +29,7 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(&ownedCandidates),
     k(k),
     metric(metric),
     sameSet(sameSet),
@@ -54,9 +55,110 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   std::vector<Candidate> vect(k, def);
   CandidateList pqueue(CandidateCmp(), std::move(vect));
 
-  candidates.reserve(querySet.n_cols);
+  candidates->reserve(querySet.n_cols);
   for (size_t i = 0; i < querySet.n_cols; ++i)
-    candidates.push_back(pqueue);
+    candidates->push_back(pqueue);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    const NeighborSearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    ownedCandidates(*other.candidates),
+    candidates(&ownedCandidates),
+    k(other.k),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    epsilon(other.epsilon),
+    lastQueryIndex(other.lastQueryIndex),
+    lastReferenceIndex(other.lastReferenceIndex),
+    lastBaseCase(other.lastBaseCase),
+    baseCases(other.baseCases),
+    scores(other.scores)
+{
+  // The traversal info of the other object may point to the other object
+  // itself, so don't copy it.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    NeighborSearchRules& other,
+    const bool shareCandidates) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(shareCandidates ? other.candidates : &ownedCandidates),
+    k(other.k),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    epsilon(other.epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // As in the other constructor, the traversal info must point to something
+  // that is not a tree node.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+
+  if (!shareCandidates)
+  {
+    const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
+        size_t() - 1);
+
+    std::vector<Candidate> vect(k, def);
+    CandidateList pqueue(CandidateCmp(), std::move(vect));
+
+    candidates->reserve(querySet.n_cols);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      candidates->push_back(pqueue);
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
+    const size_t k,
+    MetricType& metric,
+    std::vector<CandidateList>& candidateStorage,
+    const double epsilon,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    candidates(&candidateStorage),
+    k(k),
+    metric(metric),
+    sameSet(sameSet),
+    epsilon(epsilon),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // As in the other constructors, the traversal info must point to something
+  // that is not a tree node.
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+
+  if (candidates->size() < querySet.n_cols)
+    candidates->resize(querySet.n_cols);
+
+  // Reset the lists in place, so that the memory of each list is reused.  A
+  // list may still hold candidates if an earlier search did not finish.
+  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
+      size_t() - 1);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    CandidateList& pqueue = (*candidates)[i];
+    while (!pqueue.empty())
+      pqueue.pop();
+    for (size_t j = 0; j < k; ++j)
+      pqueue.push(def);
+  }
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -67,9 +169,17 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
   neighbors.set_size(k, querySet.n_cols);
   distances.set_size(k, querySet.n_cols);
 
+  GetResultsInPlace(neighbors, distances);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResultsInPlace(
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
   for (size_t i = 0; i < querySet.n_cols; ++i)
   {
-    CandidateList& pqueue = candidates[i];
+    CandidateList& pqueue = (*candidates)[i];
     for (size_t j = 1; j <= k; ++j)
     {
       neighbors(k - j, i) = pqueue.top().second;
@@ -143,7 +253,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ?
@@ -179,7 +289,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
@@ -402,7 +512,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
+    const double distance = (*candidates)[queryNode.Point(i)].top().first;
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestPointDistance))
@@ -497,7 +607,7 @@ InsertNeighbor(
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
+  CandidateList& pqueue = (*candidates)[queryIndex];
   Candidate c = std::make_pair(distance, neighbor);
 
   if (CandidateCmp()(c, pqueue.top()))
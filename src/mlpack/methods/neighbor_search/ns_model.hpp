@@ -21,6 +21,8 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/spill_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/data/mapped_model.hpp>
+#include <mlpack/core/data/precision.hpp>
 #include "neighbor_search.hpp"
 
 namespace mlpack {
@@ -46,8 +48,17 @@ class NSWrapperBase
   //! Destruct the NSWrapperBase (nothing to do).
   virtual ~NSWrapperBase() { }
 
-  //! Return a reference to the dataset.
+  //! Return a reference to the dataset in double precision.  If the dataset is
+  //! held in single precision, it is converted on the first call.
   virtual const arma::mat& Dataset() const = 0;
+  //! Return a reference to the dataset in single precision.  If the dataset is
+  //! held in double precision, it is converted on the first call.
+  virtual const arma::fmat& FloatDataset() const = 0;
+
+  //! Get the dimensionality of the dataset.
+  virtual size_t Dimensionality() const = 0;
+  //! Get the number of points in the dataset.
+  virtual size_t NumPoints() const = 0;
 
   //! Get the search mode.
   virtual NeighborSearchMode SearchMode() const = 0;
@@ -79,23 +90,33 @@ class NSWrapperBase
   virtual void Search(const size_t k,
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances) = 0;
+
+  //! Recompute the distances of the given neighbors in double precision, and
+  //! sort the neighbors of each query point again by those distances.  If the
+  //! query set is empty, the reference set is used as the query set.
+  virtual void RecomputeDistances(const arma::mat& querySet,
+                                  arma::Mat<size_t>& neighbors,
+                                  arma::mat& distances) const = 0;
 };
 
 /**
- * NSWrapper is a wrapper class for most NeighborSearch types.
+ * NSWrapper is a wrapper class for most NeighborSearch types.  The data is held
+ * as MatType (arma::mat or arma::fmat); datasets given to Train() and Search()
+ * are converted to MatType, and distances are always returned as arma::mat.
  */
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType = arma::mat,
          template<typename RuleType> class DualTreeTraversalType =
              TreeType<metric::EuclideanDistance,
                       NeighborSearchStat<SortPolicy>,
-                      arma::mat>::template DualTreeTraverser,
+                      MatType>::template DualTreeTraverser,
          template<typename RuleType> class SingleTreeTraversalType =
              TreeType<metric::EuclideanDistance,
                       NeighborSearchStat<SortPolicy>,
-                      arma::mat>::template SingleTreeTraverser>
+                      MatType>::template SingleTreeTraverser>
 class NSWrapper : public NSWrapperBase
 {
  public:
@@ -115,8 +136,23 @@ class NSWrapper : public NSWrapperBase
   //! polymorphism.
   virtual NSWrapper* Clone() const { return new NSWrapper(*this); }
 
-  //! Get a reference to the reference set.
-  const arma::mat& Dataset() const { return ns.ReferenceSet(); }
+  //! Get the reference set in double precision (converted on the first call
+  //! if it is held in single precision).
+  const arma::mat& Dataset() const
+  {
+    return data::MatrixOfType<double>(ns.ReferenceSet(), doubleDataset);
+  }
+  //! Get the reference set in single precision (converted on the first call
+  //! if it is held in double precision).
+  const arma::fmat& FloatDataset() const
+  {
+    return data::MatrixOfType<float>(ns.ReferenceSet(), floatDataset);
+  }
+
+  //! Get the dimensionality of the reference set.
+  size_t Dimensionality() const { return ns.ReferenceSet().n_rows; }
+  //! Get the number of points in the reference set.
+  size_t NumPoints() const { return ns.ReferenceSet().n_cols; }
 
   //! Get the search mode.
   NeighborSearchMode SearchMode() const { return ns.SearchMode(); }
@@ -150,6 +186,12 @@ class NSWrapper : public NSWrapperBase
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances);
 
+  //! Recompute the distances of the given neighbors in double precision, and
+  //! sort the neighbors of each query point again.
+  virtual void RecomputeDistances(const arma::mat& querySet,
+                                  arma::Mat<size_t>& neighbors,
+                                  arma::mat& distances) const;
+
   //! Serialize the NeighborSearch model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
@@ -161,13 +203,21 @@ class NSWrapper : public NSWrapperBase
   // Convenience typedef for the neighbor search type held by this class.
   typedef NeighborSearch<SortPolicy,
                          metric::EuclideanDistance,
-                         arma::mat,
+                         MatType,
                          TreeType,
                          DualTreeTraversalType,
                          SingleTreeTraversalType> NSType;
 
   //! The instantiated NeighborSearch object that we are wrapping.
   NSType ns;
+
+  //! The reference set converted to double precision, if it is held in single
+  //! precision and Dataset() was called.  The wrapper is recreated whenever
+  //! the model is built or loaded, so this never goes out of date.
+  mutable arma::mat doubleDataset;
+  //! The reference set converted to single precision, if it is held in double
+  //! precision and FloatDataset() was called.
+  mutable arma::fmat floatDataset;
 };
 
 /**
@@ -179,17 +229,19 @@ template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType = arma::mat,
          template<typename RuleType> class DualTreeTraversalType =
              TreeType<metric::EuclideanDistance,
                       NeighborSearchStat<SortPolicy>,
-                      arma::mat>::template DualTreeTraverser,
+                      MatType>::template DualTreeTraverser,
          template<typename RuleType> class SingleTreeTraversalType =
              TreeType<metric::EuclideanDistance,
                       NeighborSearchStat<SortPolicy>,
-                      arma::mat>::template SingleTreeTraverser>
+                      MatType>::template SingleTreeTraverser>
 class LeafSizeNSWrapper :
     public NSWrapper<SortPolicy,
                      TreeType,
+                     MatType,
                      DualTreeTraversalType,
                      SingleTreeTraversalType>
 {
@@ -200,6 +252,7 @@ class LeafSizeNSWrapper :
                     const double epsilon) :
       NSWrapper<SortPolicy,
                 TreeType,
+                MatType,
                 DualTreeTraversalType,
                 SingleTreeTraversalType>(searchMode, epsilon)
   {
@@ -241,6 +294,7 @@ class LeafSizeNSWrapper :
  protected:
   using NSWrapper<SortPolicy,
                   TreeType,
+                  MatType,
                   DualTreeTraversalType,
                   SingleTreeTraversalType>::ns;
 };
@@ -249,17 +303,18 @@ class LeafSizeNSWrapper :
  * The SpillNSWrapper class wraps the NeighborSearch class when the spill tree
  * is used.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class SpillNSWrapper :
     public NSWrapper<
         SortPolicy,
         tree::SPTree,
+        MatType,
         tree::SPTree<metric::EuclideanDistance,
                      NeighborSearchStat<SortPolicy>,
-                     arma::mat>::template DefeatistDualTreeTraverser,
+                     MatType>::template DefeatistDualTreeTraverser,
         tree::SPTree<metric::EuclideanDistance,
                      NeighborSearchStat<SortPolicy>,
-                     arma::mat>::template DefeatistSingleTreeTraverser>
+                     MatType>::template DefeatistSingleTreeTraverser>
 {
  public:
   //! Construct the SpillNSWrapper.
@@ -268,12 +323,13 @@ class SpillNSWrapper :
       NSWrapper<
           SortPolicy,
           tree::SPTree,
+          MatType,
           tree::SPTree<metric::EuclideanDistance,
                        NeighborSearchStat<SortPolicy>,
-                       arma::mat>::template DefeatistDualTreeTraverser,
+                       MatType>::template DefeatistDualTreeTraverser,
           tree::SPTree<metric::EuclideanDistance,
                        NeighborSearchStat<SortPolicy>,
-                       arma::mat>::template DefeatistSingleTreeTraverser>(
+                       MatType>::template DefeatistSingleTreeTraverser>(
           searchMode, epsilon)
   {
     // Nothing to do.
@@ -311,12 +367,13 @@ class SpillNSWrapper :
   using NSWrapper<
       SortPolicy,
       tree::SPTree,
+      MatType,
       tree::SPTree<metric::EuclideanDistance,
                    NeighborSearchStat<SortPolicy>,
-                   arma::mat>::template DefeatistDualTreeTraverser,
+                   MatType>::template DefeatistDualTreeTraverser,
       tree::SPTree<metric::EuclideanDistance,
                    NeighborSearchStat<SortPolicy>,
-                   arma::mat>::template DefeatistSingleTreeTraverser>::ns;
+                   MatType>::template DefeatistSingleTreeTraverser>::ns;
 };
 
 /**
@@ -327,6 +384,12 @@ class SpillNSWrapper :
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * For kd-trees and random projection trees, the reference set can be held in
+ * single precision (as an arma::fmat), which halves its memory use; the
+ * datasets passed to the model are still arma::mat and are converted.  In that
+ * case the distances can optionally be recomputed in double precision after the
+ * search (see VerifyDistances()).
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
 template<typename SortPolicy>
@@ -362,6 +425,12 @@ class NSModel
   //! This is the random projection matrix; only used if randomBasis is true.
   arma::mat q;
 
+  //! If true, the reference set is held in single precision.
+  bool singlePrecision;
+  //! If true, and singlePrecision is true, the distances of the neighbors found
+  //! by a search are recomputed in double precision.
+  bool verifyDistances;
+
   size_t leafSize;
   double tau;
   double rho;
@@ -372,6 +441,12 @@ class NSModel
    */
   NSWrapperBase* nSearch;
 
+  /**
+   * If the model was loaded with LoadMapped(), this holds the mapped file that
+   * the matrices of the model point into.
+   */
+  std::shared_ptr<data::MappedFile> mapping;
+
  public:
   /**
    * Initialize the NSModel with the given type and whether or not a random
@@ -380,8 +455,12 @@ class NSModel
    * @param treeType Type of tree to use.
    * @param randomBasis Whether or not to project the points onto a random basis
    *      before searching.
+   * @param singlePrecision Whether or not to hold the reference set in single
+   *      precision (only supported for kd-trees and random projection trees).
    */
-  NSModel(TreeTypes treeType = TreeTypes::KD_TREE, bool randomBasis = false);
+  NSModel(TreeTypes treeType = TreeTypes::KD_TREE,
+          bool randomBasis = false,
+          bool singlePrecision = false);
 
   /**
    * Copy the given NSModel.
@@ -418,8 +497,43 @@ class NSModel
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */);
 
-  //! Expose the dataset.
+  /**
+   * Save the model to a file in the mapped binary format (see
+   * data::SaveMapped()), so that it can be loaded quickly with LoadMapped().
+   *
+   * @param filename File to save the model to.
+   * @param fatal If true, an error will throw a std::runtime_error.
+   * @return Whether or not the saving was successful.
+   */
+  bool SaveMapped(const std::string& filename, const bool fatal = false);
+
+  /**
+   * Load the model from a file saved with SaveMapped().  The file is mapped
+   * into memory, and the reference set (and the other matrices of the model)
+   * use the mapped memory directly instead of being copied; the tree itself
+   * is still deserialized onto the heap.  See data::LoadMapped().  The mapping
+   * is held by the model.
+   *
+   * @param filename File to load the model from.
+   * @param fatal If true, an error will throw a std::runtime_error.
+   * @return Whether or not the loading was successful.
+   */
+  bool LoadMapped(const std::string& filename, const bool fatal = false);
+
+  //! Expose the dataset in double precision.  If the dataset is held in
+  //! single precision (see SinglePrecision()), a converted copy is made on the
+  //! first call and kept until the model is built or loaded again; use
+  //! FloatDataset() then to avoid the copy.
   const arma::mat& Dataset() const;
+  //! Expose the dataset in single precision.  If the dataset is held in double
+  //! precision, a converted copy is made on the first call and kept until the
+  //! model is built or loaded again.
+  const arma::fmat& FloatDataset() const;
+
+  //! Get the dimensionality of the dataset.
+  size_t Dimensionality() const { return nSearch->Dimensionality(); }
+  //! Get the number of points in the dataset.
+  size_t NumPoints() const { return nSearch->NumPoints(); }
 
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
@@ -449,6 +563,21 @@ class NSModel
   bool RandomBasis() const { return randomBasis; }
   bool& RandomBasis() { return randomBasis; }
 
+  //! Get whether the reference set is held in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+  //! Modify whether the reference set is held in single precision (this takes
+  //! effect the next time the model is built).  Single precision is supported
+  //! for kd-trees and random projection trees only; BuildModel() throws
+  //! std::invalid_argument for any other tree type before doing any work.
+  bool& SinglePrecision() { return singlePrecision; }
+
+  //! Get whether distances are recomputed in double precision after a search
+  //! (only used if the reference set is held in single precision).
+  bool VerifyDistances() const { return verifyDistances; }
+  //! Modify whether distances are recomputed in double precision after a
+  //! search (only used if the reference set is held in single precision).
+  bool& VerifyDistances() { return verifyDistances; }
+
   //! Initialize the model type.  (This does not perform any training.)
   void InitializeModel(const NeighborSearchMode searchMode,
                        const double epsilon);
@@ -471,11 +600,52 @@ class NSModel
 
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
+
+ private:
+  //! Serialize nSearch, which must be of type WrapperType.
+  template<typename WrapperType, typename Archive>
+  void SerializeWrapper(Archive& ar);
+
+  //! Recompute the distances of the search results in double precision, if
+  //! the model is set up to do so.
+  void Verify(const arma::mat& querySet,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
 };
 
 } // namespace neighbor
 } // namespace mlpack
 
+namespace cereal {
+namespace detail {
+
+/**
+ * Set the serialization version of NSModel to 1 (version 1 added
+ * singlePrecision).  This is what CEREAL_CLASS_VERSION() does, but that macro
+ * can only be used with a concrete type, not a class template.
+ */
+template<typename SortPolicy>
+struct Version<mlpack::neighbor::NSModel<SortPolicy>>
+{
+  static const std::uint32_t version;
+
+  static std::uint32_t registerVersion()
+  {
+    StaticObject<Versions>::getInstance().mapping.emplace(std::type_index(
+        typeid(mlpack::neighbor::NSModel<SortPolicy>)).hash_code(), 1);
+    return 1;
+  }
+
+  static void unused() { (void) version; }
+};
+
+template<typename SortPolicy>
+const std::uint32_t Version<mlpack::neighbor::NSModel<SortPolicy>>::version =
+    Version<mlpack::neighbor::NSModel<SortPolicy>>::registerVersion();
+
+} // namespace detail
+} // namespace cereal
+
 // Include implementation.
 #include "ns_model_impl.hpp"
 
@@ -21,22 +21,64 @@
 namespace mlpack {
 namespace neighbor {
 
+//! Store the nodes of a BinarySpaceTree contiguously for faster searches.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void PackTree(tree::BinarySpaceTree<MetricType, StatisticType, MatType,
+                                    BoundType, SplitType>& tree)
+{
+  tree.Pack();
+}
+
+//! Store the nodes of a CoverTree contiguously for faster searches.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename RootPointPolicy>
+void PackTree(tree::CoverTree<MetricType, StatisticType, MatType,
+                              RootPointPolicy>& tree)
+{
+  tree.Pack();
+}
+
+//! Store the nodes of an Octree contiguously for faster searches.
+template<typename MetricType, typename StatisticType, typename MatType>
+void PackTree(tree::Octree<MetricType, StatisticType, MatType>& tree)
+{
+  tree.Pack();
+}
+
+//! Other trees can't be packed, so there is nothing to do.
+template<typename TreeType>
+void PackTree(TreeType& /* tree */)
+{
+  // Nothing to do.
+}
+
 //! Train the model with the given options.  For NSWrapper, we ignore the
 //! extra parameters.
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 void NSWrapper<
-    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
 >::Train(arma::mat&& referenceSet,
          const size_t /* leafSize */,
          const double /* tau */,
          const double /* rho */)
 {
-  ns.Train(std::move(referenceSet));
+  ns.Train(data::ConvertPrecision<MatType>(std::move(referenceSet)));
+  if (ns.SearchMode() != NAIVE_MODE)
+    PackTree(ns.ReferenceTree());
 }
 
 //! Perform bichromatic neighbor search (i.e. search with a separate query
@@ -45,10 +87,12 @@ template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 void NSWrapper<
-    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
 >::Search(arma::mat&& querySet,
           const size_t k,
           arma::Mat<size_t>& neighbors,
@@ -56,7 +100,8 @@ void NSWrapper<
           const size_t /* leafSize */,
           const double /* rho */)
 {
-  ns.Search(std::move(querySet), k, neighbors, distances);
+  ns.Search(data::ConvertPrecision<MatType>(std::move(querySet)), k, neighbors,
+      distances);
 }
 
 //! Perform monochromatic neighbor search (i.e. use the reference set as the
@@ -65,10 +110,12 @@ template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 void NSWrapper<
-    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
 >::Search(const size_t k,
           arma::Mat<size_t>& neighbors,
           arma::mat& distances)
@@ -76,16 +123,90 @@ void NSWrapper<
   ns.Search(k, neighbors, distances);
 }
 
+//! Recompute the distances of the given neighbors in double precision, and sort
+//! the neighbors of each query point again.
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+void NSWrapper<
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
+>::RecomputeDistances(const arma::mat& querySet,
+                      arma::Mat<size_t>& neighbors,
+                      arma::mat& distances) const
+{
+  // The reference set may have been rearranged by the tree, so find the column
+  // that holds each reference point.
+  const MatType& referenceSet = ns.ReferenceSet();
+  std::vector<size_t> newFromOld(referenceSet.n_cols);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+    newFromOld[i] = i;
+  if (ns.oldFromNewReferences.size() == referenceSet.n_cols)
+  {
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      newFromOld[ns.oldFromNewReferences[i]] = i;
+  }
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) neighbors.n_cols; ++i)
+  {
+    const arma::vec query = (querySet.n_cols > 0) ?
+        arma::vec(querySet.col(i)) :
+        arma::conv_to<arma::vec>::from(referenceSet.col(newFromOld[i]));
+
+    // Neighbors that were not found (if any) are left at the end.
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      const size_t neighbor = neighbors(j, i);
+      if (neighbor >= referenceSet.n_cols)
+        continue;
+
+      const arma::vec reference = arma::conv_to<arma::vec>::from(
+          referenceSet.col(newFromOld[neighbor]));
+      candidates.push_back(std::make_pair(
+          metric::EuclideanDistance::Evaluate(query, reference), neighbor));
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const std::pair<double, size_t>& a,
+           const std::pair<double, size_t>& b)
+        {
+          return a.first != b.first && SortPolicy::IsBetter(a.first, b.first);
+        });
+
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      if (j < candidates.size())
+      {
+        neighbors(j, i) = candidates[j].second;
+        distances(j, i) = candidates[j].first;
+      }
+      else
+      {
+        neighbors(j, i) = size_t() - 1;
+        distances(j, i) = SortPolicy::WorstDistance();
+      }
+    }
+  }
+}
+
 //! Train a model with the given parameters.  This overload uses leafSize but
 //! ignores the other parameters.
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 void LeafSizeNSWrapper<
-    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
 >::Train(arma::mat&& referenceSet,
          const size_t leafSize,
          const double /* tau */,
@@ -93,16 +214,18 @@ void LeafSizeNSWrapper<
 {
   if (ns.SearchMode() == NAIVE_MODE)
   {
-    ns.Train(std::move(referenceSet));
+    ns.Train(data::ConvertPrecision<MatType>(std::move(referenceSet)));
   }
   else
   {
     // Build the tree with the specified leaf size.
     std::vector<size_t> oldFromNewReferences;
-    typename decltype(ns)::Tree referenceTree(std::move(referenceSet),
+    typename decltype(ns)::Tree referenceTree(
+        data::ConvertPrecision<MatType>(std::move(referenceSet)),
         oldFromNewReferences, leafSize);
     ns.Train(std::move(referenceTree));
     ns.oldFromNewReferences = std::move(oldFromNewReferences);
+    PackTree(ns.ReferenceTree());
   }
 }
 
@@ -112,10 +235,12 @@ template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
+         typename MatType,
          template<typename RuleType> class DualTreeTraversalType,
          template<typename RuleType> class SingleTreeTraversalType>
 void LeafSizeNSWrapper<
-    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+    SortPolicy, TreeType, MatType, DualTreeTraversalType,
+    SingleTreeTraversalType
 >::Search(arma::mat&& querySet,
           const size_t k,
           arma::Mat<size_t>& neighbors,
@@ -123,14 +248,16 @@ void LeafSizeNSWrapper<
           const size_t leafSize,
           const double /* rho */)
 {
-  if (ns.SearchMode() == DUAL_TREE_MODE)
+  if (ns.SearchMode() == DUAL_TREE_MODE ||
+      ns.SearchMode() == PARALLEL_DUAL_TREE_MODE)
   {
     // We actually have to do the mapping of query points ourselves, since the
     // NeighborSearch class does not provide a way for us to specify the leaf
     // size when building the query tree.  (Therefore we must also build the
     // query tree manually.)
     std::vector<size_t> oldFromNewQueries;
-    typename decltype(ns)::Tree queryTree(std::move(querySet),
+    typename decltype(ns)::Tree queryTree(
+        data::ConvertPrecision<MatType>(std::move(querySet)),
         oldFromNewQueries, leafSize);
 
     arma::Mat<size_t> neighborsOut;
@@ -148,43 +275,48 @@ void LeafSizeNSWrapper<
   }
   else
   {
-    ns.Search(querySet, k, neighbors, distances);
+    ns.Search(data::ConvertPrecision<MatType>(std::move(querySet)), k,
+        neighbors, distances);
   }
 }
 
 //! Train the model using the given parameters.
-template<typename SortPolicy>
-void SpillNSWrapper<SortPolicy>::Train(arma::mat&& referenceSet,
-                                       const size_t leafSize,
-                                       const double tau,
-                                       const double rho)
+template<typename SortPolicy, typename MatType>
+void SpillNSWrapper<SortPolicy, MatType>::Train(arma::mat&& referenceSet,
+                                                const size_t leafSize,
+                                                const double tau,
+                                                const double rho)
 {
-  typename decltype(ns)::Tree tree(std::move(referenceSet), tau, leafSize,
+  typename decltype(ns)::Tree tree(
+      data::ConvertPrecision<MatType>(std::move(referenceSet)), tau, leafSize,
       rho);
   ns.Train(std::move(tree));
 }
 
 //! Perform bichromatic search (i.e. search with a different query set) using
 //! the given parameters.
-template<typename SortPolicy>
-void SpillNSWrapper<SortPolicy>::Search(arma::mat&& querySet,
-                                        const size_t k,
-                                        arma::Mat<size_t>& neighbors,
-                                        arma::mat& distances,
-                                        const size_t leafSize,
-                                        const double rho)
-{
-  if (ns.SearchMode() == DUAL_TREE_MODE)
+template<typename SortPolicy, typename MatType>
+void SpillNSWrapper<SortPolicy, MatType>::Search(arma::mat&& querySet,
+                                                 const size_t k,
+                                                 arma::Mat<size_t>& neighbors,
+                                                 arma::mat& distances,
+                                                 const size_t leafSize,
+                                                 const double rho)
+{
+  if (ns.SearchMode() == DUAL_TREE_MODE ||
+      ns.SearchMode() == PARALLEL_DUAL_TREE_MODE)
   {
     // For Dual Tree Search on SpillTrees, the queryTree must be built with
     // non overlapping (tau = 0).
-    typename decltype(ns)::Tree queryTree(std::move(querySet), 0 /* tau */,
+    typename decltype(ns)::Tree queryTree(
+        data::ConvertPrecision<MatType>(std::move(querySet)), 0 /* tau */,
         leafSize, rho);
     ns.Search(queryTree, k, neighbors, distances);
   }
   else
   {
-    ns.Search(querySet, k, neighbors, distances);
+    ns.Search(data::ConvertPrecision<MatType>(std::move(querySet)), k,
+        neighbors, distances);
   }
 }
 
@@ -193,15 +325,24 @@ void SpillNSWrapper<SortPolicy>::Search(arma::mat&& querySet,
  * basis should be used.
  */
 template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
+NSModel<SortPolicy>::NSModel(TreeTypes treeType,
+                             bool randomBasis,
+                             bool singlePrecision) :
     treeType(treeType),
     randomBasis(randomBasis),
+    singlePrecision(singlePrecision),
+    verifyDistances(false),
     leafSize(20),
     tau(0.0),
     rho(0.7),
     nSearch(NULL)
 {
-  // Nothing to do.
+  if (singlePrecision && treeType != KD_TREE && treeType != RP_TREE &&
+      treeType != MAX_RP_TREE)
+  {
+    throw std::invalid_argument("NSModel::NSModel(): single precision is only "
+        "supported for kd-trees and random projection trees!");
+  }
 }
 
 template<typename SortPolicy>
@@ -209,10 +350,13 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     treeType(other.treeType),
     randomBasis(other.randomBasis),
     q(other.q),
+    singlePrecision(other.singlePrecision),
+    verifyDistances(other.verifyDistances),
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
-    nSearch(other.nSearch->Clone())
+    nSearch(other.nSearch->Clone()),
+    mapping(other.mapping)
 {
   // Nothing to do.
 }
@@ -222,14 +366,19 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     treeType(other.treeType),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
+    singlePrecision(other.singlePrecision),
+    verifyDistances(other.verifyDistances),
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    mapping(std::move(other.mapping))
 {
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
   other.randomBasis = false;
+  other.singlePrecision = false;
+  other.verifyDistances = false;
   other.leafSize = 20;
   other.tau = 0.0;
   other.rho = 0.7;
@@ -245,11 +394,15 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
 
     treeType = other.treeType;
     randomBasis = other.randomBasis;
+    q.reset(); // q may point into the mapping that is about to be released.
     q = other.q;
+    singlePrecision = other.singlePrecision;
+    verifyDistances = other.verifyDistances;
     leafSize = other.leafSize;
     tau = other.tau;
     rho = other.rho;
     nSearch = other.nSearch->Clone();
+    mapping = other.mapping;
   }
 
   return *this;
@@ -264,15 +417,21 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
 
     treeType = other.treeType;
     randomBasis = other.randomBasis;
+    q.reset(); // q may point into the mapping that is about to be released.
     q = std::move(other.q);
+    singlePrecision = other.singlePrecision;
+    verifyDistances = other.verifyDistances;
     leafSize = other.leafSize;
     tau = other.tau;
     rho = other.rho;
     nSearch = other.nSearch;
+    mapping = std::move(other.mapping);
 
     // Reset parameters of the other model.
     other.treeType = TreeTypes::KD_TREE;
     other.randomBasis = false;
+    other.singlePrecision = false;
+    other.verifyDistances = false;
     other.leafSize = 20;
     other.tau = 0.0;
     other.rho = 0.7;
@@ -289,14 +448,38 @@ NSModel<SortPolicy>::~NSModel()
   delete nSearch;
 }
 
+//! Save the model in the mapped binary format.
+template<typename SortPolicy>
+bool NSModel<SortPolicy>::SaveMapped(const std::string& filename,
+                                     const bool fatal)
+{
+  return data::SaveMapped(filename, "model", *this, fatal);
+}
+
+//! Load the model from a file in the mapped binary format.
+template<typename SortPolicy>
+bool NSModel<SortPolicy>::LoadMapped(const std::string& filename,
+                                     const bool fatal)
+{
+  return data::LoadMapped(filename, "model", *this, mapping, fatal);
+}
+
 //! Serialize the kNN model.
 template<typename SortPolicy>
 template<typename Archive>
-void NSModel<SortPolicy>::serialize(Archive& ar, const uint32_t /* version */)
+void NSModel<SortPolicy>::serialize(Archive& ar, const uint32_t version)
 {
   ar(CEREAL_NVP(treeType));
   ar(CEREAL_NVP(randomBasis));
   ar(CEREAL_NVP(q));
+
+  // Models saved before version 1 always hold the reference set in double
+  // precision.
+  if (version >= 1)
+    ar(CEREAL_NVP(singlePrecision));
+  else
+    singlePrecision = false;
+
   ar(CEREAL_NVP(leafSize));
   ar(CEREAL_NVP(tau));
   ar(CEREAL_NVP(rho));
@@ -306,120 +489,88 @@ void NSModel<SortPolicy>::serialize(Archive& ar, const uint32_t /* version */)
     InitializeModel(DUAL_TREE_MODE, 0.0); // Values will be overwritten.
 
   // Avoid polymorphic serialization by explicitly serializing the correct type.
-  switch (treeType)
+  if (singlePrecision)
   {
-    case KD_TREE:
-      {
-        LeafSizeNSWrapper<SortPolicy, tree::KDTree>& typedSearch =
-            dynamic_cast<LeafSizeNSWrapper<SortPolicy,
-                         tree::KDTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+    switch (treeType)
+    {
+      case KD_TREE:
+        SerializeWrapper<
+            LeafSizeNSWrapper<SortPolicy, tree::KDTree, arma::fmat>>(ar);
         break;
-      }
-    case COVER_TREE:
-      {
-        NSWrapper<SortPolicy, tree::StandardCoverTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy,
-                                   tree::StandardCoverTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case RP_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RPTree, arma::fmat>>(ar);
         break;
-      }
-    case R_TREE:
-      {
-        NSWrapper<SortPolicy, tree::RTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::RTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case MAX_RP_TREE:
+        SerializeWrapper<
+            NSWrapper<SortPolicy, tree::MaxRPTree, arma::fmat>>(ar);
         break;
-      }
-    case R_STAR_TREE:
-      {
-        NSWrapper<SortPolicy, tree::RStarTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::RStarTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      default:
+        throw std::invalid_argument("NSModel::serialize(): single precision "
+            "is only supported for kd-trees and random projection trees!");
+    }
+  }
+  else
+  {
+    switch (treeType)
+    {
+      case KD_TREE:
+        SerializeWrapper<LeafSizeNSWrapper<SortPolicy, tree::KDTree>>(ar);
         break;
-      }
-    case BALL_TREE:
-      {
-        LeafSizeNSWrapper<SortPolicy, tree::BallTree>& typedSearch =
-            dynamic_cast<LeafSizeNSWrapper<SortPolicy,
-                                           tree::BallTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case COVER_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::StandardCoverTree>>(ar);
         break;
-      }
-    case X_TREE:
-      {
-        NSWrapper<SortPolicy, tree::XTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::XTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RTree>>(ar);
         break;
-      }
-    case HILBERT_R_TREE:
-      {
-        NSWrapper<SortPolicy, tree::HilbertRTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::HilbertRTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_STAR_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RStarTree>>(ar);
         break;
-      }
-    case R_PLUS_TREE:
-      {
-        NSWrapper<SortPolicy, tree::RPlusTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::RPlusTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case BALL_TREE:
+        SerializeWrapper<LeafSizeNSWrapper<SortPolicy, tree::BallTree>>(ar);
         break;
-      }
-    case R_PLUS_PLUS_TREE:
-      {
-        NSWrapper<SortPolicy, tree::RPlusPlusTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::RPlusPlusTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case X_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::XTree>>(ar);
         break;
-      }
-    case SPILL_TREE:
-      {
-        SpillNSWrapper<SortPolicy>& typedSearch =
-            dynamic_cast<SpillNSWrapper<SortPolicy>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case HILBERT_R_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::HilbertRTree>>(ar);
         break;
-      }
-    case VP_TREE:
-      {
-        NSWrapper<SortPolicy, tree::VPTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::VPTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_PLUS_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RPlusTree>>(ar);
         break;
-      }
-    case RP_TREE:
-      {
-        NSWrapper<SortPolicy, tree::RPTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::RPTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_PLUS_PLUS_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RPlusPlusTree>>(ar);
         break;
-      }
-    case MAX_RP_TREE:
-      {
-        NSWrapper<SortPolicy, tree::MaxRPTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::MaxRPTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case VP_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::VPTree>>(ar);
         break;
-      }
-    case UB_TREE:
-      {
-        NSWrapper<SortPolicy, tree::UBTree>& typedSearch =
-            dynamic_cast<NSWrapper<SortPolicy, tree::UBTree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case RP_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::RPTree>>(ar);
         break;
-      }
-    case OCTREE:
-      {
-        LeafSizeNSWrapper<SortPolicy, tree::Octree>& typedSearch =
-            dynamic_cast<LeafSizeNSWrapper<SortPolicy,
-                                           tree::Octree>&>(*nSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case MAX_RP_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::MaxRPTree>>(ar);
         break;
-      }
+      case SPILL_TREE:
+        SerializeWrapper<SpillNSWrapper<SortPolicy>>(ar);
+        break;
+      case UB_TREE:
+        SerializeWrapper<NSWrapper<SortPolicy, tree::UBTree>>(ar);
+        break;
+      case OCTREE:
+        SerializeWrapper<LeafSizeNSWrapper<SortPolicy, tree::Octree>>(ar);
+        break;
+    }
   }
 }
 
+//! Serialize nSearch, which must be of type WrapperType.
+template<typename SortPolicy>
+template<typename WrapperType, typename Archive>
+void NSModel<SortPolicy>::SerializeWrapper(Archive& ar)
+{
+  WrapperType& typedSearch = dynamic_cast<WrapperType&>(*nSearch);
+  ar(CEREAL_NVP(typedSearch));
+}
+
 //! Expose the dataset.
 template<typename SortPolicy>
 const arma::mat& NSModel<SortPolicy>::Dataset() const
@@ -427,6 +578,13 @@ const arma::mat& NSModel<SortPolicy>::Dataset() const
   return nSearch->Dataset();
 }
 
+//! Expose the dataset held in single precision.
+template<typename SortPolicy>
+const arma::fmat& NSModel<SortPolicy>::FloatDataset() const
+{
+  return nSearch->FloatDataset();
+}
+
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
@@ -461,60 +619,90 @@ void NSModel<SortPolicy>::InitializeModel(const NeighborSearchMode searchMode,
   // Clear existing memory.
   if (nSearch)
     delete nSearch;
+  nSearch = NULL;
 
-  switch (treeType)
+  if (singlePrecision)
   {
-    case KD_TREE:
-      nSearch = new LeafSizeNSWrapper<SortPolicy, tree::KDTree>(searchMode,
-          epsilon);
-      break;
-    case COVER_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::StandardCoverTree>(searchMode,
-          epsilon);
-      break;
-    case R_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::RTree>(searchMode, epsilon);
-      break;
-    case R_STAR_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::RStarTree>(searchMode, epsilon);
-      break;
-    case BALL_TREE:
-      nSearch = new LeafSizeNSWrapper<SortPolicy, tree::BallTree>(searchMode,
-          epsilon);
-      break;
-    case X_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::XTree>(searchMode, epsilon);
-      break;
-    case HILBERT_R_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::HilbertRTree>(searchMode,
-          epsilon);
-      break;
-    case R_PLUS_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::RPlusTree>(searchMode, epsilon);
-      break;
-    case R_PLUS_PLUS_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::RPlusPlusTree>(searchMode,
-          epsilon);
-      break;
-    case VP_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::VPTree>(searchMode, epsilon);
-      break;
-    case RP_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::RPTree>(searchMode, epsilon);
-      break;
-    case MAX_RP_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::MaxRPTree>(searchMode, epsilon);
-      break;
-    case SPILL_TREE:
-      nSearch = new SpillNSWrapper<SortPolicy>(searchMode, epsilon);
-      break;
-    case UB_TREE:
-      nSearch = new NSWrapper<SortPolicy, tree::UBTree>(searchMode, epsilon);
-      break;
-    case OCTREE:
-      nSearch = new LeafSizeNSWrapper<SortPolicy, tree::Octree>(searchMode,
-          epsilon);
-      break;
+    // Only the trees with hyperrectangle bounds can hold single-precision data.
+    switch (treeType)
+    {
+      case KD_TREE:
+        nSearch = new LeafSizeNSWrapper<SortPolicy, tree::KDTree, arma::fmat>(
+            searchMode, epsilon);
+        break;
+      case RP_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RPTree, arma::fmat>(
+            searchMode, epsilon);
+        break;
+      case MAX_RP_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::MaxRPTree, arma::fmat>(
+            searchMode, epsilon);
+        break;
+      default:
+        throw std::invalid_argument("NSModel::InitializeModel(): single "
+            "precision is only supported for kd-trees and random projection "
+            "trees!");
+    }
+  }
+  else
+  {
+    switch (treeType)
+    {
+      case KD_TREE:
+        nSearch = new LeafSizeNSWrapper<SortPolicy, tree::KDTree>(
+            searchMode, epsilon);
+        break;
+      case COVER_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::StandardCoverTree>(
+            searchMode, epsilon);
+        break;
+      case R_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RTree>(searchMode, epsilon);
+        break;
+      case R_STAR_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RStarTree>(
+            searchMode, epsilon);
+        break;
+      case BALL_TREE:
+        nSearch = new LeafSizeNSWrapper<SortPolicy, tree::BallTree>(
+            searchMode, epsilon);
+        break;
+      case X_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::XTree>(searchMode, epsilon);
+        break;
+      case HILBERT_R_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::HilbertRTree>(
+            searchMode, epsilon);
+        break;
+      case R_PLUS_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RPlusTree>(
+            searchMode, epsilon);
+        break;
+      case R_PLUS_PLUS_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RPlusPlusTree>(
+            searchMode, epsilon);
+        break;
+      case VP_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::VPTree>(searchMode, epsilon);
+        break;
+      case RP_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::RPTree>(searchMode, epsilon);
+        break;
+      case MAX_RP_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::MaxRPTree>(
+            searchMode, epsilon);
+        break;
+      case SPILL_TREE:
+        nSearch = new SpillNSWrapper<SortPolicy>(searchMode, epsilon);
+        break;
+      case UB_TREE:
+        nSearch = new NSWrapper<SortPolicy, tree::UBTree>(searchMode, epsilon);
+        break;
+      case OCTREE:
+        nSearch = new LeafSizeNSWrapper<SortPolicy, tree::Octree>(
+            searchMode, epsilon);
+        break;
+    }
   }
 }
 
@@ -524,6 +712,14 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
                                      const NeighborSearchMode searchMode,
                                      const double epsilon)
 {
+  // Reject unsupported settings before any work is done.
+  if (singlePrecision && treeType != KD_TREE && treeType != RP_TREE &&
+      treeType != MAX_RP_TREE)
+  {
+    throw std::invalid_argument("NSModel::BuildModel(): single precision is "
+        "only supported for kd-trees and random projection trees!");
+  }
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -604,9 +800,20 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case PARALLEL_DUAL_TREE_MODE:
+      Log::Info << "parallel dual-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
+  // The query set is consumed by the search, so keep a copy if the distances
+  // will be recomputed afterwards.
+  arma::mat verificationSet;
+  if (singlePrecision && verifyDistances)
+    verificationSet = querySet;
+
   nSearch->Search(std::move(querySet), k, neighbors, distances, leafSize, rho);
+  Verify(verificationSet, neighbors, distances);
 }
 
 //! Perform neighbor search.
@@ -632,6 +839,10 @@ void NSModel<SortPolicy>::Search(const size_t k,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case PARALLEL_DUAL_TREE_MODE:
+      Log::Info << "parallel dual-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
 
   if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
@@ -639,6 +850,20 @@ void NSModel<SortPolicy>::Search(const size_t k,
         << std::endl;
 
   nSearch->Search(k, neighbors, distances);
+  Verify(arma::mat(), neighbors, distances);
+}
+
+//! Recompute the distances of the search results in double precision.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Verify(const arma::mat& querySet,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& distances) const
+{
+  if (!singlePrecision || !verifyDistances)
+    return;
+
+  Log::Info << "Recomputing distances in double precision..." << std::endl;
+  nSearch->RecomputeDistances(querySet, neighbors, distances);
 }
 
 //! Get the name of the tree type.
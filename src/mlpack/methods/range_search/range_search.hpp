@@ -17,14 +17,22 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include "range_search_stat.hpp"
+#include "range_search_rules.hpp"
 
 namespace mlpack {
 namespace range /** Range-search routines. */ {
 
-//! Forward declaration.
+//! Forward declarations.
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+class RSWrapper;
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType>
 class LeafSizeRSWrapper;
 
 /**
@@ -182,6 +190,11 @@ class RangeSearch
    *
    * - neighbors[i] and distances[i] are not sorted in any particular order.
    *
+   * This overload may be called from several threads at once (for instance,
+   * to search disjoint blocks of queries), except in single-tree mode with a
+   * tree type whose first point is its centroid (like the cover tree), since
+   * single-tree search caches distances in the statistics of such trees.
+   *
    * @param querySet Set of query points to search with.
    * @param range Range of distances in which to search.
    * @param neighbors Object which will hold the list of neighbors for each
@@ -268,6 +281,55 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, passing the results for each query point to the given callback
+   * instead of storing the results for every query point.  The query points
+   * are searched in blocks of blockSize points, and the results of a block are
+   * passed on as soon as the block is done, so at most the results of one
+   * block are held in memory at once.  This is useful when the results for
+   * the whole query set would not fit in memory.
+   *
+   * The callback is called once for each query point, in order, from the
+   * calling thread, as
+   *
+   * @code
+   * callback(queryIndex, neighbors, distances);
+   * @endcode
+   *
+   * where neighbors (a const std::vector<size_t>&) and distances (a const
+   * std::vector<double>&) hold the indices of and distances to the reference
+   * points in the range of the query point, as in the overload that returns
+   * the results for every query point; they are only valid during the call.
+   * If Parallel() is true, each block is searched in parallel.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Function to call with the results of each query point.
+   * @param blockSize Number of query points to search at once.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType callback,
+              const size_t blockSize = 10000);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing the results for each point to the given callback instead of
+   * storing the results for every point; see the overload above.  The query
+   * point itself is not returned in its results.  The callback is called once
+   * for each point, but not in any particular order.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Function to call with the results of each point.
+   * @param blockSize Number of points to search at once.
+   */
+  template<typename CallbackType>
+  void Search(const math::Range& range,
+              CallbackType callback,
+              const size_t blockSize = 10000);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -278,6 +340,11 @@ class RangeSearch
   //! Modify whether naive search is being used.
   bool& Naive() { return naive; }
 
+  //! Get whether search is done in parallel.  This is not serialized.
+  bool Parallel() const { return parallel; }
+  //! Modify whether search is done in parallel.  This is not serialized.
+  bool& Parallel() { return parallel; }
+
   //! Get the number of base cases during the last search.
   size_t BaseCases() const { return baseCases; }
   //! Get the number of scores during the last search.
@@ -309,6 +376,8 @@ class RangeSearch
   bool naive;
   //! If true, single-tree computation is used.
   bool singleMode;
+  //! If true, search is done in parallel with OpenMP.
+  bool parallel;
 
   //! Instantiated distance metric.
   MetricType metric;
@@ -318,8 +387,42 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  //! The type of rules used for search.
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+
+  /**
+   * Compute the base case between each query point and each reference point.
+   * If Parallel() is true, the query points are split among threads.
+   *
+   * @param rules Rules that hold the results of the search.
+   * @param numQueries Number of query points.
+   */
+  void BruteForceSearch(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Run the single-tree traversal for each query point.  If Parallel() is
+   * true, the query points are split among threads, unless the first point of
+   * each node of the tree is its centroid (like the cover tree), since
+   * single-tree search then stores distances in the reference tree.
+   *
+   * @param rules Rules that hold the results of the search.
+   * @param numQueries Number of query points.
+   */
+  void SingleTreeTraverse(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Run the dual-tree traversal with the given query tree.  If Parallel() is
+   * true, the query tree is split into subtrees that are traversed in
+   * parallel.
+   *
+   * @param queryTree Tree built on query points.
+   * @param rules Rules that hold the results of the search.
+   */
+  void DualTreeTraverse(Tree& queryTree, RuleType& rules);
+
   //! For access to mappings when building models.
-  friend class LeafSizeRSWrapper<TreeType>;
+  friend class RSWrapper<TreeType, MatType>;
+  friend class LeafSizeRSWrapper<TreeType, MatType>;
 };
 
 } // namespace range
@@ -18,6 +18,8 @@
 // The rules for traversal.
 #include "range_search_rules.hpp"
 
+#include <mlpack/core/tree/subtree_partition.hpp>
+
 namespace mlpack {
 namespace range {
 
@@ -59,6 +61,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(!naive),
     naive(naive),
     singleMode(!naive && singleMode),
+    parallel(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -80,6 +83,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(false),
     naive(false),
     singleMode(singleMode),
+    parallel(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -101,6 +105,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(false),
     naive(naive),
     singleMode(singleMode),
+    parallel(false),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -108,7 +113,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
   // Build the tree on the empty dataset, if necessary.
   if (!naive)
   {
-    referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+    referenceTree = BuildTree<Tree>(std::move(MatType()),
         oldFromNewReferences);
     referenceSet = &referenceTree->Dataset();
     treeOwner = true;
@@ -129,6 +134,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     treeOwner(other.referenceTree),
     naive(other.naive),
     singleMode(other.singleMode),
+    parallel(other.parallel),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores)
@@ -148,17 +154,19 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     treeOwner(other.treeOwner),
     naive(other.naive),
     singleMode(other.singleMode),
+    parallel(other.parallel),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores)
 {
   // Clear other object.
   other.referenceTree =
-      BuildTree<Tree>(std::move(arma::mat()), other.oldFromNewReferences);
+      BuildTree<Tree>(std::move(MatType()), other.oldFromNewReferences);
   other.referenceSet = &other.referenceTree->Dataset();
   other.treeOwner = true;
   other.naive = false;
   other.singleMode = false;
+  other.parallel = false;
   other.baseCases = 0;
   other.scores = 0;
 }
@@ -181,6 +189,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
     treeOwner = other.referenceTree;
     naive = other.naive;
     singleMode = other.singleMode;
+    parallel = other.parallel;
     metric = other.metric;
     baseCases = other.baseCases;
     scores = other.scores;
@@ -211,6 +220,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
     treeOwner = other.treeOwner;
     naive = other.naive;
     singleMode = other.singleMode;
+    parallel = other.parallel;
     metric = std::move(other.metric);
     baseCases = other.baseCases;
     scores = other.scores;
@@ -221,6 +231,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
     other.treeOwner = false;
     other.naive = false;
     other.singleMode = false;
+    other.parallel = false;
     other.baseCases = 0;
     other.scores = 0;
   }
@@ -354,12 +365,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   distancePtr->clear();
   distancePtr->resize(querySet.n_cols);
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-
-  // Reset counts.
-  baseCases = 0;
-  scores = 0;
+  // The counts are only stored in the object at the end, so that several
+  // searches can run at once.
+  size_t searchBaseCases = 0;
+  size_t searchScores = 0;
 
   if (naive)
   {
@@ -367,25 +376,18 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
         metric);
 
     // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    BruteForceSearch(rules, querySet.n_cols);
 
-    baseCases += (querySet.n_cols * referenceSet->n_cols);
+    searchBaseCases += (querySet.n_cols * referenceSet->n_cols);
   }
   else if (singleMode)
   {
-    // Create the traverser.
     RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
         metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeTraverse(rules, querySet.n_cols);
 
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    searchBaseCases += rules.BaseCases();
+    searchScores += rules.Scores();
   }
   else // Dual-tree recursion.
   {
@@ -396,15 +398,12 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
     RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
         *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    DualTreeTraverse(*queryTree, rules);
 
-    traverser.Traverse(*queryTree, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    searchBaseCases += rules.BaseCases();
+    searchScores += rules.Scores();
 
     // Clean up tree memory.
     delete queryTree;
@@ -412,6 +411,12 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   Timer::Stop("range_search/computing_neighbors");
 
+  #pragma omp critical(RangeSearchCounts)
+  {
+    baseCases = searchBaseCases;
+    scores = searchScores;
+  }
+
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
   {
@@ -517,14 +522,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   distances.resize(querySet.n_cols);
 
   // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
       distances, metric);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeTraverse(*queryTree, rules);
 
   Timer::Stop("range_search/computing_neighbors");
 
@@ -584,38 +585,29 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   distancePtr->resize(referenceSet->n_cols);
 
   // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
       *distancePtr, metric, true /* don't return the query in the results */);
 
   if (naive)
   {
     // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    BruteForceSearch(rules, referenceSet->n_cols);
 
     baseCases = (referenceSet->n_cols * referenceSet->n_cols);
     scores = 0;
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    SingleTreeTraverse(rules, referenceSet->n_cols);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // Query nodes are never modified by the dual-tree rules, so the reference
+    // tree can also be used as the query tree in the parallel search.
+    DualTreeTraverse(*referenceTree, rules);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
@@ -651,6 +643,228 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType callback,
+    const size_t blockSize)
+{
+  util::CheckSameDimensionality(querySet, *referenceSet,
+      "RangeSearch::Search()", "query set");
+
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("RangeSearch::Search(): the block size must "
+        "be positive!");
+  }
+
+  // If there are no reference points, no query point has any results.
+  if (referenceSet->n_cols == 0)
+  {
+    const std::vector<size_t> noNeighbors;
+    const std::vector<double> noDistances;
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      callback(i, noNeighbors, noDistances);
+    return;
+  }
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+  for (size_t begin = 0; begin < querySet.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) querySet.n_cols);
+    Search(MatType(querySet.cols(begin, end - 1)), range, neighbors,
+        distances);
+    totalBaseCases += baseCases;
+    totalScores += scores;
+
+    for (size_t i = begin; i < end; ++i)
+      callback(i, neighbors[i - begin], distances[i - begin]);
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    CallbackType callback,
+    const size_t blockSize)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("RangeSearch::Search(): the block size must "
+        "be positive!");
+  }
+
+  // The reference set may have been rearranged by the tree, in which case the
+  // results use the original indices of the points.
+  const bool mapped = (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  std::vector<std::vector<size_t>> neighbors;
+  std::vector<std::vector<double>> distances;
+  std::vector<size_t> pointNeighbors;
+  std::vector<double> pointDistances;
+  for (size_t begin = 0; begin < referenceSet->n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize,
+        (size_t) referenceSet->n_cols);
+    Search(MatType(referenceSet->cols(begin, end - 1)), range, neighbors,
+        distances);
+    totalBaseCases += baseCases;
+    totalScores += scores;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+      const size_t point = mapped ? oldFromNewReferences[i] : i;
+
+      // Don't return the point in its own results.
+      pointNeighbors.clear();
+      pointDistances.clear();
+      for (size_t j = 0; j < neighbors[i - begin].size(); ++j)
+      {
+        if (neighbors[i - begin][j] != point)
+        {
+          pointNeighbors.push_back(neighbors[i - begin][j]);
+          pointDistances.push_back(distances[i - begin][j]);
+        }
+      }
+
+      callback(point, pointNeighbors, pointDistances);
+    }
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::BruteForceSearch(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  // Each query point's results are only touched by the thread that handles it.
+  #pragma omp parallel for schedule(dynamic, 16) if (parallel)
+  for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+  {
+    // Each thread needs its own last base case.
+    RuleType taskRules(rules);
+    for (size_t j = 0; j < referenceSet->n_cols; ++j)
+      taskRules.BaseCase(i, j);
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::SingleTreeTraverse(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  if (!parallel || tree::TreeTraits<Tree>::FirstPointIsCentroid)
+  {
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    // Now have it traverse for each point.
+    for (size_t i = 0; i < numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    return;
+  }
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic, 16) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+  {
+    RuleType taskRules(rules);
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(taskRules);
+    traverser.Traverse(i, *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::DualTreeTraverse(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  if (!parallel)
+  {
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    return;
+  }
+
+  // Split the query tree into many more subtrees than there are threads, so
+  // that dynamic scheduling can balance the uneven cost of the subtrees.  The
+  // subtrees are disjoint, so each query point's results are only ever touched
+  // by one task, and no locking is needed.
+  #ifdef HAS_OPENMP
+    const size_t numTasks = (omp_get_max_threads() == 1) ? 1 :
+        8 * omp_get_max_threads();
+  #else
+    const size_t numTasks = 1;
+  #endif
+
+  std::vector<Tree*> subtrees;
+  tree::PartitionSubtrees(queryTree, numTasks, subtrees);
+
+  size_t taskScores = 0;
+  size_t taskBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:taskScores, taskBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    // Each task gets its own traversal info and last base case.
+    RuleType taskRules(rules);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(taskRules);
+    traverser.Traverse(*subtrees[i], *referenceTree);
+
+    taskScores += taskRules.Scores();
+    taskBaseCases += taskRules.BaseCases();
+  }
+
+  rules.Scores() += taskScores;
+  rules.BaseCases() += taskBaseCases;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
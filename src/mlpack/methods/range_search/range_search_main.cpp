@@ -90,6 +90,12 @@ PARAM_MODEL_IN(RSModel, "input_model", "File containing pre-trained range "
     "search model.", "m");
 PARAM_MODEL_OUT(RSModel, "output_model", "If specified, the range search model "
     "will be saved to the given file.", "M");
+PARAM_STRING_IN("input_mapped_model_file", "File containing a pre-trained "
+    "range search model saved in the mapped format; the file is memory-mapped "
+    "instead of being read.", "", "");
+PARAM_STRING_IN("output_mapped_model_file", "If specified, the range search "
+    "model will be saved to this file in the mapped format, which can be "
+    "loaded quickly by memory-mapping it.", "", "");
 
 // The user may specify a query file of query points and a range to search for.
 PARAM_MATRIX_IN("query", "File containing query points (optional).", "q");
@@ -107,12 +113,20 @@ PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, "
     "Hilbert R trees, R+ trees, R++ trees, and octrees).", "l", 20);
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_FLAG("single_precision", "If set, the reference set is held in single "
+    "precision, which halves its memory use (only for the 'kd', 'rp', and "
+    "'max-rp' tree types).", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
+PARAM_FLAG("parallel", "If true, the search is split among threads.", "P");
+PARAM_FLAG("verify_distances", "If set, and the reference set is held in "
+    "single precision, the distances to the points that were found are "
+    "recomputed in double precision (and points outside of the range are "
+    "removed).", "");
 
 static void mlpackMain()
 {
@@ -122,16 +136,23 @@ static void mlpackMain()
     math::RandomSeed((size_t) std::time(NULL));
 
   // A user cannot specify both reference data and a model.
-  RequireOnlyOnePassed({ "reference", "input_model" }, true);
+  RequireOnlyOnePassed({ "reference", "input_model",
+      "input_mapped_model_file" }, true);
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "single_precision");
   ReportIgnoredParam({{ "input_model", true }}, "leaf_size");
   ReportIgnoredParam({{ "input_model", true }}, "naive");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "tree_type");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "single_precision");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "leaf_size");
+  ReportIgnoredParam({{ "input_mapped_model_file", true }}, "naive");
 
   // The user must give something to do...
-  RequireAtLeastOnePassed({ "min", "max", "output_model" }, false, "no results "
-      "will be saved");
+  RequireAtLeastOnePassed({ "min", "max", "output_model",
+      "output_mapped_model_file" }, false, "no results will be saved");
 
   // If the user specifies a range but not output files, they should be warned.
   if (IO::HasParam("min") || IO::HasParam("max"))
@@ -146,7 +167,8 @@ static void mlpackMain()
     ReportIgnoredParam("distances_file", "no range is specified for searching");
   }
 
-  if (IO::HasParam("input_model") &&
+  if ((IO::HasParam("input_model") ||
+       IO::HasParam("input_mapped_model_file")) &&
       (IO::HasParam("min") || IO::HasParam("max")))
   {
     RequireAtLeastOnePassed({ "query" }, true, "query set must be passed if "
@@ -169,6 +191,12 @@ static void mlpackMain()
     RequireParamInSet<string>("tree_type", { "kd", "cover", "r", "r-star",
         "ball", "x", "hilbert-r", "r-plus", "r-plus-plus", "vp", "rp", "max-rp",
         "ub", "oct" }, true, "unknown tree type");
+    if (IO::HasParam("single_precision") && treeType != "kd" &&
+        treeType != "rp" && treeType != "max-rp")
+    {
+      Log::Fatal << PRINT_PARAM_STRING("single_precision") << " is only "
+          << "supported for the 'kd', 'rp', and 'max-rp' tree types." << endl;
+    }
     const bool randomBasis = IO::HasParam("random_basis");
 
     rs = new RSModel();
@@ -205,6 +233,7 @@ static void mlpackMain()
 
     rs->TreeType() = tree;
     rs->RandomBasis() = randomBasis;
+    rs->SinglePrecision() = IO::HasParam("single_precision");
 
     Log::Info << "Using reference data from "
         << IO::GetPrintableParam<arma::mat>("reference") << "." << endl;
@@ -217,13 +246,27 @@ static void mlpackMain()
   }
   else
   {
-    // Load the model from file.
-    rs = IO::GetParam<RSModel*>("input_model");
+    if (IO::HasParam("input_mapped_model_file"))
+    {
+      // Map the model from file; the reference set is not copied.
+      const string filename = IO::GetParam<string>("input_mapped_model_file");
+      rs = new RSModel();
+      rs->LoadMapped(filename, true);
+
+      Log::Info << "Using mapped range search model from '" << filename
+          << "' (trained on " << rs->Dimensionality() << "x"
+          << rs->NumPoints() << " dataset)." << endl;
+    }
+    else
+    {
+      // Load the model from file.
+      rs = IO::GetParam<RSModel*>("input_model");
 
-    Log::Info << "Using range search model from '"
-        << IO::GetPrintableParam<RSModel*>("input_model") << "' ("
-        << "trained on " << rs->Dataset().n_rows << "x" << rs->Dataset().n_cols
-        << " dataset)." << endl;
+      Log::Info << "Using range search model from '"
+          << IO::GetPrintableParam<RSModel*>("input_model") << "' ("
+          << "trained on " << rs->Dimensionality() << "x"
+          << rs->NumPoints() << " dataset)." << endl;
+    }
 
     // Adjust singleMode and naive if necessary.
     rs->SingleMode() = IO::HasParam("single_mode");
@@ -248,6 +291,14 @@ static void mlpackMain()
       queryData = std::move(IO::GetParam<arma::mat>("query"));
     }
 
+    if (IO::HasParam("verify_distances") && !rs->SinglePrecision())
+    {
+      Log::Warn << PRINT_PARAM_STRING("verify_distances") << " ignored "
+          << "because the reference set is held in double precision." << endl;
+    }
+    rs->VerifyDistances() = IO::HasParam("verify_distances");
+    rs->Parallel() = IO::HasParam("parallel");
+
     // Naive mode overrides single mode.
     if (singleMode && naive)
       Log::Warn << PRINT_PARAM_STRING("single_mode") << " ignored because "
@@ -325,5 +376,8 @@ static void mlpackMain()
   }
 
   // Save the output model.
+  if (IO::HasParam("output_mapped_model_file"))
+    rs->SaveMapped(IO::GetParam<string>("output_mapped_model_file"), true);
+
   IO::GetParam<RSModel*>("output_model") = rs;
 }
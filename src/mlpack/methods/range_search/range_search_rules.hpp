@@ -41,14 +41,25 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
                    MetricType& metric,
                    const bool sameSet = false);
 
+  /**
+   * Construct a RangeSearchRules object that searches with the same settings
+   * as the given object and stores its results in the same vectors, but has
+   * its own traversal information, last base case, and counters.  This is used
+   * for parallel search, where each task searches for a disjoint set of query
+   * points.
+   *
+   * @param other RangeSearchRules object to share results with.
+   */
+  RangeSearchRules(const RangeSearchRules& other);
+
   /**
    * Compute the base case between the given query point and reference point.
    *
@@ -114,8 +125,12 @@ class RangeSearchRules
 
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
   //! Get the number of scores (that is, calls to RangeDistance()).
   size_t Scores() const { return scores; }
+  //! Modify the number of scores.
+  size_t& Scores() { return scores; }
 
   //! Get the minimum number of base cases we need to perform to have acceptable
   //! results.
@@ -123,10 +138,10 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
@@ -20,8 +20,8 @@ namespace range {
 
 template<typename MetricType, typename TreeType>
 RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -42,6 +42,24 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
   // Nothing to do.
 }
 
+template<typename MetricType, typename TreeType>
+RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
+    const RangeSearchRules& other) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    range(other.range),
+    neighbors(other.neighbors),
+    distances(other.distances),
+    metric(other.metric),
+    sameSet(other.sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
 //! The base case.  Evaluate the distance between the two points and add to the
 //! results if necessary.
 template<typename MetricType, typename TreeType>
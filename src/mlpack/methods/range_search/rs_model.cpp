@@ -12,6 +12,7 @@
 #include "rs_model.hpp"
 
 #include <mlpack/core/math/random_basis.hpp>
+#include <mlpack/core/data/mapped_model.hpp>
 
 namespace mlpack {
 namespace range {
@@ -20,13 +21,20 @@ namespace range {
  * Initialize the RSModel with the given tree type and whether or not a random
  * basis should be used.
  */
-RSModel::RSModel(TreeTypes treeType, bool randomBasis) :
+RSModel::RSModel(TreeTypes treeType, bool randomBasis, bool singlePrecision) :
     treeType(treeType),
     leafSize(0),
     randomBasis(randomBasis),
+    singlePrecision(singlePrecision),
+    verifyDistances(false),
     rSearch(NULL)
 {
-  // Nothing to do.
+  if (singlePrecision && treeType != KD_TREE && treeType != RP_TREE &&
+      treeType != MAX_RP_TREE)
+  {
+    throw std::invalid_argument("RSModel::RSModel(): single precision is only "
+        "supported for kd-trees and random projection trees!");
+  }
 }
 
 // Copy constructor.
@@ -35,7 +43,10 @@ RSModel::RSModel(const RSModel& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(other.q),
-    rSearch(other.rSearch->Clone())
+    singlePrecision(other.singlePrecision),
+    verifyDistances(other.verifyDistances),
+    rSearch(other.rSearch->Clone()),
+    mapping(other.mapping)
 {
   // Nothing to do.
 }
@@ -46,12 +57,17 @@ RSModel::RSModel(RSModel&& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
-    rSearch(std::move(other.rSearch))
+    singlePrecision(other.singlePrecision),
+    verifyDistances(other.verifyDistances),
+    rSearch(std::move(other.rSearch)),
+    mapping(std::move(other.mapping))
 {
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
   other.leafSize = 0;
   other.randomBasis = false;
+  other.singlePrecision = false;
+  other.verifyDistances = false;
 }
 
 // Copy operator.
@@ -64,8 +80,12 @@ RSModel& RSModel::operator=(const RSModel& other)
     treeType = other.treeType;
     leafSize = other.leafSize;
     randomBasis = other.randomBasis;
+    q.reset(); // q may point into the mapping that is about to be released.
     q = other.q;
+    singlePrecision = other.singlePrecision;
+    verifyDistances = other.verifyDistances;
     rSearch = other.rSearch->Clone();
+    mapping = other.mapping;
   }
 
   return *this;
@@ -81,12 +101,18 @@ RSModel& RSModel::operator=(RSModel&& other)
     treeType = other.treeType;
     leafSize = other.leafSize;
     randomBasis = other.randomBasis;
+    q.reset(); // q may point into the mapping that is about to be released.
     q = std::move(other.q);
+    singlePrecision = other.singlePrecision;
+    verifyDistances = other.verifyDistances;
     rSearch = std::move(other.rSearch);
+    mapping = std::move(other.mapping);
 
     other.treeType = TreeTypes::KD_TREE;
     other.leafSize = 0;
     other.randomBasis = false;
+    other.singlePrecision = false;
+    other.verifyDistances = false;
   }
 
   return *this;
@@ -98,68 +124,108 @@ RSModel::~RSModel()
   delete rSearch;
 }
 
+// Save the model in the mapped binary format.
+bool RSModel::SaveMapped(const std::string& filename, const bool fatal)
+{
+  return data::SaveMapped(filename, "model", *this, fatal);
+}
+
+// Load the model from a file in the mapped binary format.
+bool RSModel::LoadMapped(const std::string& filename, const bool fatal)
+{
+  return data::LoadMapped(filename, "model", *this, mapping, fatal);
+}
+
 void RSModel::InitializeModel(const bool naive, const bool singleMode)
 {
   // Clean memory, if necessary.
   delete rSearch;
+  rSearch = NULL;
 
-  switch (treeType)
+  if (singlePrecision)
   {
-    case KD_TREE:
-      rSearch = new LeafSizeRSWrapper<tree::KDTree>(naive, singleMode);
-      break;
-
-    case COVER_TREE:
-      rSearch = new RSWrapper<tree::StandardCoverTree>(naive, singleMode);
-      break;
-
-    case R_TREE:
-      rSearch = new RSWrapper<tree::RTree>(naive, singleMode);
-      break;
-
-    case R_STAR_TREE:
-      rSearch = new RSWrapper<tree::RStarTree>(naive, singleMode);
-      break;
-
-    case BALL_TREE:
-      rSearch = new LeafSizeRSWrapper<tree::BallTree>(naive, singleMode);
-      break;
-
-    case X_TREE:
-      rSearch = new RSWrapper<tree::XTree>(naive, singleMode);
-      break;
-
-    case HILBERT_R_TREE:
-      rSearch = new RSWrapper<tree::HilbertRTree>(naive, singleMode);
-      break;
-
-    case R_PLUS_TREE:
-      rSearch = new RSWrapper<tree::RPlusTree>(naive, singleMode);
-      break;
-
-    case R_PLUS_PLUS_TREE:
-      rSearch = new RSWrapper<tree::RPlusPlusTree>(naive, singleMode);
-      break;
-
-    case VP_TREE:
-      rSearch = new RSWrapper<tree::VPTree>(naive, singleMode);
-      break;
-
-    case RP_TREE:
-      rSearch = new RSWrapper<tree::RPTree>(naive, singleMode);
-      break;
-
-    case MAX_RP_TREE:
-      rSearch = new RSWrapper<tree::MaxRPTree>(naive, singleMode);
-      break;
-
-    case UB_TREE:
-      rSearch = new RSWrapper<tree::UBTree>(naive, singleMode);
-      break;
-
-    case OCTREE:
-      rSearch = new LeafSizeRSWrapper<tree::Octree>(naive, singleMode);
-      break;
+    // Only the trees with hyperrectangle bounds can hold single-precision data.
+    switch (treeType)
+    {
+      case KD_TREE:
+        rSearch = new LeafSizeRSWrapper<tree::KDTree, arma::fmat>(naive,
+            singleMode);
+        break;
+
+      case RP_TREE:
+        rSearch = new RSWrapper<tree::RPTree, arma::fmat>(naive, singleMode);
+        break;
+
+      case MAX_RP_TREE:
+        rSearch = new RSWrapper<tree::MaxRPTree, arma::fmat>(naive, singleMode);
+        break;
+
+      default:
+        throw std::invalid_argument("RSModel::InitializeModel(): single "
+            "precision is only supported for kd-trees and random projection "
+            "trees!");
+    }
+  }
+  else
+  {
+    switch (treeType)
+    {
+      case KD_TREE:
+        rSearch = new LeafSizeRSWrapper<tree::KDTree>(naive, singleMode);
+        break;
+
+      case COVER_TREE:
+        rSearch = new RSWrapper<tree::StandardCoverTree>(naive, singleMode);
+        break;
+
+      case R_TREE:
+        rSearch = new RSWrapper<tree::RTree>(naive, singleMode);
+        break;
+
+      case R_STAR_TREE:
+        rSearch = new RSWrapper<tree::RStarTree>(naive, singleMode);
+        break;
+
+      case BALL_TREE:
+        rSearch = new LeafSizeRSWrapper<tree::BallTree>(naive, singleMode);
+        break;
+
+      case X_TREE:
+        rSearch = new RSWrapper<tree::XTree>(naive, singleMode);
+        break;
+
+      case HILBERT_R_TREE:
+        rSearch = new RSWrapper<tree::HilbertRTree>(naive, singleMode);
+        break;
+
+      case R_PLUS_TREE:
+        rSearch = new RSWrapper<tree::RPlusTree>(naive, singleMode);
+        break;
+
+      case R_PLUS_PLUS_TREE:
+        rSearch = new RSWrapper<tree::RPlusPlusTree>(naive, singleMode);
+        break;
+
+      case VP_TREE:
+        rSearch = new RSWrapper<tree::VPTree>(naive, singleMode);
+        break;
+
+      case RP_TREE:
+        rSearch = new RSWrapper<tree::RPTree>(naive, singleMode);
+        break;
+
+      case MAX_RP_TREE:
+        rSearch = new RSWrapper<tree::MaxRPTree>(naive, singleMode);
+        break;
+
+      case UB_TREE:
+        rSearch = new RSWrapper<tree::UBTree>(naive, singleMode);
+        break;
+
+      case OCTREE:
+        rSearch = new LeafSizeRSWrapper<tree::Octree>(naive, singleMode);
+        break;
+    }
   }
 }
 
@@ -168,6 +234,14 @@ void RSModel::BuildModel(arma::mat&& referenceSet,
                          const bool naive,
                          const bool singleMode)
 {
+  // Reject unsupported settings before any work is done.
+  if (singlePrecision && treeType != KD_TREE && treeType != RP_TREE &&
+      treeType != MAX_RP_TREE)
+  {
+    throw std::invalid_argument("RSModel::BuildModel(): single precision is "
+        "only supported for kd-trees and random projection trees!");
+  }
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -217,7 +291,15 @@ void RSModel::Search(arma::mat&& querySet,
   else
     Log::Info << "brute-force (naive) search..." << std::endl;
 
-  rSearch->Search(std::move(querySet), range, neighbors, distances, leafSize);
+  // The query set is consumed by the search, so keep a copy if the distances
+  // will be recomputed afterwards.
+  arma::mat verificationSet;
+  if (singlePrecision && verifyDistances)
+    verificationSet = querySet;
+
+  rSearch->Search(std::move(querySet), SearchRange(range), neighbors,
+      distances, leafSize);
+  Verify(verificationSet, range, neighbors, distances);
 }
 
 // Perform range search (monochromatic case).
@@ -234,7 +316,31 @@ void RSModel::Search(const math::Range& range,
   else
     Log::Info << "brute-force (naive) search..." << std::endl;
 
-  rSearch->Search(range, neighbors, distances);
+  rSearch->Search(SearchRange(range), neighbors, distances);
+  Verify(arma::mat(), range, neighbors, distances);
+}
+
+// Get the range to search.
+math::Range RSModel::SearchRange(const math::Range& range) const
+{
+  if (!singlePrecision || !verifyDistances)
+    return range;
+
+  // The relative error of the single-precision distances is well below this.
+  return math::Range(range.Lo() * (1 - 1e-5), range.Hi() * (1 + 1e-5));
+}
+
+// Recompute the distances of the search results in double precision.
+void RSModel::Verify(const arma::mat& querySet,
+                     const math::Range& range,
+                     std::vector<std::vector<size_t>>& neighbors,
+                     std::vector<std::vector<double>>& distances) const
+{
+  if (!singlePrecision || !verifyDistances)
+    return;
+
+  Log::Info << "Recomputing distances in double precision..." << std::endl;
+  rSearch->RecomputeDistances(querySet, range, neighbors, distances);
 }
 
 // Get the name of the tree type.
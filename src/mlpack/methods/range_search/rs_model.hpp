@@ -19,6 +19,8 @@
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
+#include <mlpack/core/data/precision.hpp>
 
 #include "range_search.hpp"
 
@@ -45,8 +47,17 @@ class RSWrapperBase
   //! Destruct the RSWrapperBase (nothing to do).
   virtual ~RSWrapperBase() { }
 
-  //! Get the dataset.
+  //! Get the dataset in double precision.  If the dataset is held in single
+  //! precision, it is converted on the first call.
   virtual const arma::mat& Dataset() const = 0;
+  //! Get the dataset in single precision.  If the dataset is held in double
+  //! precision, it is converted on the first call.
+  virtual const arma::fmat& FloatDataset() const = 0;
+
+  //! Get the dimensionality of the dataset.
+  virtual size_t Dimensionality() const = 0;
+  //! Get the number of points in the dataset.
+  virtual size_t NumPoints() const = 0;
 
   //! Get whether single-tree search is being used.
   virtual bool SingleMode() const = 0;
@@ -58,6 +69,11 @@ class RSWrapperBase
   //! Modify whether naive search is being used.
   virtual bool& Naive() = 0;
 
+  //! Get whether search is done in parallel.
+  virtual bool Parallel() const = 0;
+  //! Modify whether search is done in parallel.
+  virtual bool& Parallel() = 0;
+
   //! Train the model (build the reference tree if needed).
   virtual void Train(arma::mat&& referenceSet,
                      const size_t leafSize) = 0;
@@ -75,14 +91,26 @@ class RSWrapperBase
   virtual void Search(const math::Range& range,
                       std::vector<std::vector<size_t>>& neighbors,
                       std::vector<std::vector<double>>& distances) = 0;
+
+  //! Recompute the distances of the given neighbors in double precision, and
+  //! remove the neighbors that are then outside of the range.  If the query set
+  //! is empty, the reference set is used as the query set.
+  virtual void RecomputeDistances(
+      const arma::mat& querySet,
+      const math::Range& range,
+      std::vector<std::vector<size_t>>& neighbors,
+      std::vector<std::vector<double>>& distances) const = 0;
 };
 
 /**
- * RSWrapper is a wrapper class for most RangeSearch types.
+ * RSWrapper is a wrapper class for most RangeSearch types.  The data is held as
+ * MatType (arma::mat or arma::fmat); datasets given to Train() and Search() are
+ * converted to MatType.
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 class RSWrapper : public RSWrapperBase
 {
  public:
@@ -100,8 +128,23 @@ class RSWrapper : public RSWrapperBase
   //! Destruct the RSWrapper (nothing to do).
   virtual ~RSWrapper() { }
 
-  //! Get the dataset.
-  const arma::mat& Dataset() const { return rs.ReferenceSet(); }
+  //! Get the reference set in double precision (converted on the first call
+  //! if it is held in single precision).
+  const arma::mat& Dataset() const
+  {
+    return data::MatrixOfType<double>(rs.ReferenceSet(), doubleDataset);
+  }
+  //! Get the reference set in single precision (converted on the first call
+  //! if it is held in double precision).
+  const arma::fmat& FloatDataset() const
+  {
+    return data::MatrixOfType<float>(rs.ReferenceSet(), floatDataset);
+  }
+
+  //! Get the dimensionality of the dataset.
+  size_t Dimensionality() const { return rs.ReferenceSet().n_rows; }
+  //! Get the number of points in the dataset.
+  size_t NumPoints() const { return rs.ReferenceSet().n_cols; }
 
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return rs.SingleMode(); }
@@ -113,6 +156,11 @@ class RSWrapper : public RSWrapperBase
   //! Modify whether naive search is being used.
   bool& Naive() { return rs.Naive(); }
 
+  //! Get whether search is done in parallel.
+  bool Parallel() const { return rs.Parallel(); }
+  //! Modify whether search is done in parallel.
+  bool& Parallel() { return rs.Parallel(); }
+
   //! Train the model (build the reference tree if needed).  This ignores the
   //! leaf size.
   virtual void Train(arma::mat&& referenceSet,
@@ -132,6 +180,14 @@ class RSWrapper : public RSWrapperBase
                       std::vector<std::vector<size_t>>& neighbors,
                       std::vector<std::vector<double>>& distances);
 
+  //! Recompute the distances of the given neighbors in double precision, and
+  //! remove the neighbors that are then outside of the range.
+  virtual void RecomputeDistances(
+      const arma::mat& querySet,
+      const math::Range& range,
+      std::vector<std::vector<size_t>>& neighbors,
+      std::vector<std::vector<double>>& distances) const;
+
   //! Serialize the RangeSearch model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
@@ -140,10 +196,18 @@ class RSWrapper : public RSWrapperBase
   }
 
  protected:
-  typedef RangeSearch<metric::EuclideanDistance, arma::mat, TreeType> RSType;
+  typedef RangeSearch<metric::EuclideanDistance, MatType, TreeType> RSType;
 
   //! The instantiated RangeSearch object that we are wrapping.
   RSType rs;
+
+  //! The reference set converted to double precision, if it is held in single
+  //! precision and Dataset() was called.  The wrapper is recreated whenever
+  //! the model is built or loaded, so this never goes out of date.
+  mutable arma::mat doubleDataset;
+  //! The reference set converted to single precision, if it is held in double
+  //! precision and FloatDataset() was called.
+  mutable arma::fmat floatDataset;
 };
 
 /**
@@ -153,14 +217,15 @@ class RSWrapper : public RSWrapperBase
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-class LeafSizeRSWrapper : public RSWrapper<TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
+class LeafSizeRSWrapper : public RSWrapper<TreeType, MatType>
 {
  public:
   //! Construct the LeafSizeRSWrapper by delegating to the RSWrapper
   //! constructor.
   LeafSizeRSWrapper(const bool singleMode, const bool naive) :
-      RSWrapper<TreeType>(singleMode, naive)
+      RSWrapper<TreeType, MatType>(singleMode, naive)
   {
     // Nothing else to do.
   }
@@ -194,7 +259,7 @@ class LeafSizeRSWrapper : public RSWrapper<TreeType>
   }
 
  protected:
-  using RSWrapper<TreeType>::rs;
+  using RSWrapper<TreeType, MatType>::rs;
 };
 
 /**
@@ -202,6 +267,12 @@ class LeafSizeRSWrapper : public RSWrapper<TreeType>
  * abstracting away the TreeType parameter and allowing it to be specified at
  * runtime.  This class is written for the sake of the `range_search` binding,
  * but is not necessarily restricted to that usage.
+ *
+ * For kd-trees and random projection trees, the reference set can be held in
+ * single precision (as an arma::fmat), which halves its memory use; the
+ * datasets passed to the model are still arma::mat and are converted.  In that
+ * case the distances can optionally be recomputed in double precision after the
+ * search (see VerifyDistances()).
  */
 class RSModel
 {
@@ -230,9 +301,12 @@ class RSModel
    *
    * @param treeType Type of tree to use.
    * @param randomBasis Whether or not to use a random basis.
+   * @param singlePrecision Whether or not to hold the reference set in single
+   *      precision (only supported for kd-trees and random projection trees).
    */
   RSModel(const TreeTypes treeType = TreeTypes::KD_TREE,
-          const bool randomBasis = false);
+          const bool randomBasis = false,
+          const bool singlePrecision = false);
 
   /**
    * Copy the given RSModel.
@@ -271,8 +345,43 @@ class RSModel
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */);
 
-  //! Expose the dataset.
+  /**
+   * Save the model to a file in the mapped binary format (see
+   * data::SaveMapped()), so that it can be loaded quickly with LoadMapped().
+   *
+   * @param filename File to save the model to.
+   * @param fatal If true, an error will throw a std::runtime_error.
+   * @return Whether or not the saving was successful.
+   */
+  bool SaveMapped(const std::string& filename, const bool fatal = false);
+
+  /**
+   * Load the model from a file saved with SaveMapped().  The file is mapped
+   * into memory, and the reference set (and the other matrices of the model)
+   * use the mapped memory directly instead of being copied; the tree itself
+   * is still deserialized onto the heap.  See data::LoadMapped().  The mapping
+   * is held by the model.
+   *
+   * @param filename File to load the model from.
+   * @param fatal If true, an error will throw a std::runtime_error.
+   * @return Whether or not the loading was successful.
+   */
+  bool LoadMapped(const std::string& filename, const bool fatal = false);
+
+  //! Expose the dataset in double precision.  If the dataset is held in
+  //! single precision (see SinglePrecision()), a converted copy is made on the
+  //! first call and kept until the model is built or loaded again; use
+  //! FloatDataset() then to avoid the copy.
   const arma::mat& Dataset() const { return rSearch->Dataset(); }
+  //! Expose the dataset in single precision.  If the dataset is held in double
+  //! precision, a converted copy is made on the first call and kept until the
+  //! model is built or loaded again.
+  const arma::fmat& FloatDataset() const { return rSearch->FloatDataset(); }
+
+  //! Get the dimensionality of the dataset.
+  size_t Dimensionality() const { return rSearch->Dimensionality(); }
+  //! Get the number of points in the dataset.
+  size_t NumPoints() const { return rSearch->NumPoints(); }
 
   //! Get whether the model is in single-tree search mode.
   bool SingleMode() const { return rSearch->SingleMode(); }
@@ -284,6 +393,11 @@ class RSModel
   //! Modify whether the model is in naive search mode.
   bool& Naive() { return rSearch->Naive(); }
 
+  //! Get whether search is done in parallel.
+  bool Parallel() const { return rSearch->Parallel(); }
+  //! Modify whether search is done in parallel.
+  bool& Parallel() { return rSearch->Parallel(); }
+
   //! Get the leaf size (applicable to everything but the cover tree).
   size_t LeafSize() const { return leafSize; }
   //! Modify the leaf size (applicable to everything but the cover tree).
@@ -300,6 +414,21 @@ class RSModel
   //! been built).
   bool& RandomBasis() { return randomBasis; }
 
+  //! Get whether the reference set is held in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
+  //! Modify whether the reference set is held in single precision (don't do
+  //! this after the model has been built).  Single precision is supported for
+  //! kd-trees and random projection trees only; BuildModel() throws
+  //! std::invalid_argument for any other tree type before doing any work.
+  bool& SinglePrecision() { return singlePrecision; }
+
+  //! Get whether distances are recomputed in double precision after a search
+  //! (only used if the reference set is held in single precision).
+  bool VerifyDistances() const { return verifyDistances; }
+  //! Modify whether distances are recomputed in double precision after a
+  //! search (only used if the reference set is held in single precision).
+  bool& VerifyDistances() { return verifyDistances; }
+
   /**
    * Allocate the memory for the range search model.
    */
@@ -359,12 +488,24 @@ class RSModel
   //! Random projection matrix.
   arma::mat q;
 
+  //! If true, the reference set is held in single precision.
+  bool singlePrecision;
+  //! If true, and singlePrecision is true, the distances of the neighbors found
+  //! by a search are recomputed in double precision.
+  bool verifyDistances;
+
   /**
    * rSearch holds an instance of the RangeSearch class for the current
    * treeType. It is initialized every time BuildModel is executed.
    */
   RSWrapperBase* rSearch;
 
+  /**
+   * If the model was loaded with LoadMapped(), this holds the mapped file that
+   * the matrices of the model point into.
+   */
+  std::shared_ptr<data::MappedFile> mapping;
+
   /**
    * Return a string representing the name of the tree.  This is used for
    * logging output.
@@ -375,11 +516,30 @@ class RSModel
    * Clean up memory.
    */
   void CleanMemory();
+
+  //! Serialize rSearch, which must be of type WrapperType.
+  template<typename WrapperType, typename Archive>
+  void SerializeWrapper(Archive& ar);
+
+  //! Get the range to search, which is slightly wider than the given range if
+  //! the distances will be recomputed in double precision, so that points whose
+  //! single-precision distance is rounded out of the range are not missed.
+  math::Range SearchRange(const math::Range& range) const;
+
+  //! Recompute the distances of the search results in double precision, if
+  //! the model is set up to do so, and drop the points out of the range.
+  void Verify(const arma::mat& querySet,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances) const;
 };
 
 } // namespace range
 } // namespace mlpack
 
+//! Version 1 added singlePrecision.
+CEREAL_CLASS_VERSION(mlpack::range::RSModel, 1)
+
 // Include implementation (of serialize() and templated wrapper classes).
 #include "rs_model_impl.hpp"
 
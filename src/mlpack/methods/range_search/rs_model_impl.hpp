@@ -22,52 +22,107 @@ namespace range {
 
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RSWrapper<TreeType>::Train(arma::mat&& referenceSet,
-                                const size_t /* leafSize */)
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void RSWrapper<TreeType, MatType>::Train(arma::mat&& referenceSet,
+                                         const size_t /* leafSize */)
 {
-  rs.Train(std::move(referenceSet));
+  rs.Train(data::ConvertPrecision<MatType>(std::move(referenceSet)));
 }
 
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RSWrapper<TreeType>::Search(arma::mat&& querySet,
-                                 const math::Range& range,
-                                 std::vector<std::vector<size_t>>& neighbors,
-                                 std::vector<std::vector<double>>& distances,
-                                 const size_t /* leafSize */)
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void RSWrapper<TreeType, MatType>::Search(
+    arma::mat&& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances,
+    const size_t /* leafSize */)
 {
-  rs.Search(std::move(querySet), range, neighbors, distances);
+  rs.Search(data::ConvertPrecision<MatType>(std::move(querySet)), range,
+      neighbors, distances);
 }
 
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void RSWrapper<TreeType>::Search(const math::Range& range,
-                                 std::vector<std::vector<size_t>>& neighbors,
-                                 std::vector<std::vector<double>>& distances)
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void RSWrapper<TreeType, MatType>::Search(
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
 {
   rs.Search(range, neighbors, distances);
 }
 
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void LeafSizeRSWrapper<TreeType>::Train(arma::mat&& referenceSet,
-                                        const size_t leafSize)
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void RSWrapper<TreeType, MatType>::RecomputeDistances(
+    const arma::mat& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances) const
+{
+  // The reference set may have been rearranged by the tree, so find the column
+  // that holds each reference point.
+  const MatType& referenceSet = rs.ReferenceSet();
+  std::vector<size_t> newFromOld(referenceSet.n_cols);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+    newFromOld[i] = i;
+  if (rs.oldFromNewReferences.size() == referenceSet.n_cols)
+  {
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      newFromOld[rs.oldFromNewReferences[i]] = i;
+  }
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) neighbors.size(); ++i)
+  {
+    const arma::vec query = (querySet.n_cols > 0) ?
+        arma::vec(querySet.col(i)) :
+        arma::conv_to<arma::vec>::from(referenceSet.col(newFromOld[i]));
+
+    size_t kept = 0;
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+    {
+      const arma::vec reference = arma::conv_to<arma::vec>::from(
+          referenceSet.col(newFromOld[neighbors[i][j]]));
+      const double distance = metric::EuclideanDistance::Evaluate(query,
+          reference);
+      if (range.Contains(distance))
+      {
+        neighbors[i][kept] = neighbors[i][j];
+        distances[i][kept] = distance;
+        ++kept;
+      }
+    }
+
+    neighbors[i].resize(kept);
+    distances[i].resize(kept);
+  }
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void LeafSizeRSWrapper<TreeType, MatType>::Train(arma::mat&& referenceSet,
+                                                 const size_t leafSize)
 {
   if (rs.Naive())
   {
-    rs.Train(std::move(referenceSet));
+    rs.Train(data::ConvertPrecision<MatType>(std::move(referenceSet)));
   }
   else
   {
     std::vector<size_t> oldFromNewReferences;
-    typename decltype(rs)::Tree* tree =
-        new typename decltype(rs)::Tree(std::move(referenceSet),
-                                        oldFromNewReferences,
-                                        leafSize);
+    typename decltype(rs)::Tree* tree = new typename decltype(rs)::Tree(
+        data::ConvertPrecision<MatType>(std::move(referenceSet)),
+        oldFromNewReferences, leafSize);
     rs.Train(tree);
 
     // Give the model ownership of the tree and the mappings.
@@ -78,8 +133,9 @@ void LeafSizeRSWrapper<TreeType>::Train(arma::mat&& referenceSet,
 
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
-void LeafSizeRSWrapper<TreeType>::Search(
+                  typename TreeMatType> class TreeType,
+         typename MatType>
+void LeafSizeRSWrapper<TreeType, MatType>::Search(
     arma::mat&& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
@@ -92,9 +148,9 @@ void LeafSizeRSWrapper<TreeType>::Search(
     Timer::Start("tree_building");
     Log::Info << "Building query tree..." << std::endl;
     std::vector<size_t> oldFromNewQueries;
-    typename decltype(rs)::Tree queryTree(std::move(querySet),
-                                          oldFromNewQueries,
-                                          leafSize);
+    typename decltype(rs)::Tree queryTree(
+        data::ConvertPrecision<MatType>(std::move(querySet)),
+        oldFromNewQueries, leafSize);
     Log::Info << "Tree built." << std::endl;
     Timer::Stop("tree_building");
 
@@ -113,135 +169,107 @@ void LeafSizeRSWrapper<TreeType>::Search(
   }
   else
   {
-    rs.Search(std::move(querySet), range, neighbors, distances);
+    rs.Search(data::ConvertPrecision<MatType>(std::move(querySet)), range,
+        neighbors, distances);
   }
 }
 
 // Serialize the model.
 template<typename Archive>
-void RSModel::serialize(Archive& ar, const uint32_t /* version */)
+void RSModel::serialize(Archive& ar, const uint32_t version)
 {
   ar(CEREAL_NVP(treeType));
   ar(CEREAL_NVP(randomBasis));
   ar(CEREAL_NVP(q));
 
+  // Models saved before version 1 always hold the reference set in double
+  // precision.
+  if (version >= 1)
+    ar(CEREAL_NVP(singlePrecision));
+  else
+    singlePrecision = false;
+
   // This should never happen, but just in case...
   if (cereal::is_loading<Archive>())
     InitializeModel(false, false); // Values will be overwritten.
 
   // Avoid polymorphic serialization by explicitly serializing the correct type.
-  switch (treeType)
+  if (singlePrecision)
   {
-    case KD_TREE:
-      {
-        LeafSizeRSWrapper<tree::KDTree>& typedSearch =
-            dynamic_cast<LeafSizeRSWrapper<tree::KDTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+    switch (treeType)
+    {
+      case KD_TREE:
+        SerializeWrapper<LeafSizeRSWrapper<tree::KDTree, arma::fmat>>(ar);
         break;
-      }
-    case COVER_TREE:
-      {
-        RSWrapper<tree::StandardCoverTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::StandardCoverTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case RP_TREE:
+        SerializeWrapper<RSWrapper<tree::RPTree, arma::fmat>>(ar);
         break;
-      }
-
-    case R_TREE:
-      {
-        RSWrapper<tree::RTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::RTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case MAX_RP_TREE:
+        SerializeWrapper<RSWrapper<tree::MaxRPTree, arma::fmat>>(ar);
         break;
-      }
-
-    case R_STAR_TREE:
-      {
-        RSWrapper<tree::RStarTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::RStarTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      default:
+        throw std::invalid_argument("RSModel::serialize(): single precision "
+            "is only supported for kd-trees and random projection trees!");
+    }
+  }
+  else
+  {
+    switch (treeType)
+    {
+      case KD_TREE:
+        SerializeWrapper<LeafSizeRSWrapper<tree::KDTree>>(ar);
         break;
-      }
-
-    case BALL_TREE:
-      {
-        LeafSizeRSWrapper<tree::BallTree>& typedSearch =
-            dynamic_cast<LeafSizeRSWrapper<tree::BallTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case COVER_TREE:
+        SerializeWrapper<RSWrapper<tree::StandardCoverTree>>(ar);
         break;
-      }
-    case X_TREE:
-      {
-        RSWrapper<tree::XTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::XTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_TREE:
+        SerializeWrapper<RSWrapper<tree::RTree>>(ar);
         break;
-      }
-
-    case HILBERT_R_TREE:
-      {
-        RSWrapper<tree::HilbertRTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::HilbertRTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_STAR_TREE:
+        SerializeWrapper<RSWrapper<tree::RStarTree>>(ar);
         break;
-      }
-
-    case R_PLUS_TREE:
-      {
-        RSWrapper<tree::RPlusTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::RPlusTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case BALL_TREE:
+        SerializeWrapper<LeafSizeRSWrapper<tree::BallTree>>(ar);
         break;
-      }
-
-    case R_PLUS_PLUS_TREE:
-      {
-        RSWrapper<tree::RPlusPlusTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::RPlusPlusTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case X_TREE:
+        SerializeWrapper<RSWrapper<tree::XTree>>(ar);
         break;
-      }
-
-    case VP_TREE:
-      {
-        RSWrapper<tree::VPTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::VPTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case HILBERT_R_TREE:
+        SerializeWrapper<RSWrapper<tree::HilbertRTree>>(ar);
         break;
-      }
-
-    case RP_TREE:
-      {
-        RSWrapper<tree::RPTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::RPTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_PLUS_TREE:
+        SerializeWrapper<RSWrapper<tree::RPlusTree>>(ar);
         break;
-      }
-
-    case MAX_RP_TREE:
-      {
-        RSWrapper<tree::MaxRPTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::MaxRPTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case R_PLUS_PLUS_TREE:
+        SerializeWrapper<RSWrapper<tree::RPlusPlusTree>>(ar);
         break;
-      }
-    case UB_TREE:
-      {
-        RSWrapper<tree::UBTree>& typedSearch =
-            dynamic_cast<RSWrapper<tree::UBTree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case VP_TREE:
+        SerializeWrapper<RSWrapper<tree::VPTree>>(ar);
         break;
-      }
-    case OCTREE:
-      {
-        LeafSizeRSWrapper<tree::Octree>& typedSearch =
-            dynamic_cast<LeafSizeRSWrapper<tree::Octree>&>(*rSearch);
-        ar(CEREAL_NVP(typedSearch));
+      case RP_TREE:
+        SerializeWrapper<RSWrapper<tree::RPTree>>(ar);
         break;
-      }
+      case MAX_RP_TREE:
+        SerializeWrapper<RSWrapper<tree::MaxRPTree>>(ar);
+        break;
+      case UB_TREE:
+        SerializeWrapper<RSWrapper<tree::UBTree>>(ar);
+        break;
+      case OCTREE:
+        SerializeWrapper<LeafSizeRSWrapper<tree::Octree>>(ar);
+        break;
+    }
   }
 }
 
+// Serialize rSearch, which must be of type WrapperType.
+template<typename WrapperType, typename Archive>
+void RSModel::SerializeWrapper(Archive& ar)
+{
+  WrapperType& typedSearch = dynamic_cast<WrapperType&>(*rSearch);
+  ar(CEREAL_NVP(typedSearch));
+}
+
 } // namespace range
 } // namespace mlpack
 
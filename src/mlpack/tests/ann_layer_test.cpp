@@ -4547,6 +4547,146 @@ TEST_CASE("ConvolutionLayerTestCase", "[ANNLayerTest]")
   REQUIRE(arma::accu(output) == 4156);
 }
 
+/**
+ * Check that two convolution layers that only differ in their convolution
+ * rules give the same output, the same delta and the same gradient.
+ */
+template<typename LayerType, typename ReferenceLayerType>
+void CheckConvolutionRules(LayerType& layer,
+                           ReferenceLayerType& referenceLayer,
+                           const arma::mat& input)
+{
+  layer.Parameters().randn();
+  referenceLayer.Parameters() = layer.Parameters();
+  layer.Reset();
+  referenceLayer.Reset();
+
+  arma::mat output, referenceOutput;
+  layer.Forward(input, output);
+  referenceLayer.Forward(input, referenceOutput);
+  CheckMatrices(output, referenceOutput);
+
+  arma::mat error = arma::randn(output.n_rows, output.n_cols);
+  arma::mat delta, referenceDelta;
+  layer.Backward(input, error, delta);
+  referenceLayer.Backward(input, error, referenceDelta);
+  CheckMatrices(delta, referenceDelta);
+
+  arma::mat gradient, referenceGradient;
+  layer.Gradient(input, error, gradient);
+  referenceLayer.Gradient(input, error, referenceGradient);
+  CheckMatrices(gradient, referenceGradient);
+}
+
+/**
+ * Make sure that the convolution layers give the same results with the default
+ * im2col rule as with the naive rule, for a batch of inputs with several maps
+ * and unit strides.
+ */
+TEST_CASE("Im2ColConvolutionLayerTest", "[ANNLayerTest]")
+{
+  // Three points with two 5x4 maps each.
+  arma::mat input = arma::randn(5 * 4 * 2, 3);
+
+  Convolution<> convolution(2, 3, 3, 3, 1, 1, 1, 1, 5, 4);
+  Convolution<NaiveConvolution<ValidConvolution>,
+              NaiveConvolution<FullConvolution>,
+              NaiveConvolution<ValidConvolution>> naiveConvolution(2, 3, 3, 3,
+      1, 1, 1, 1, 5, 4);
+  CheckConvolutionRules(convolution, naiveConvolution, input);
+
+  AtrousConvolution<> atrous(2, 3, 3, 3, 1, 1, 2, 2, 5, 4, 2, 2);
+  AtrousConvolution<NaiveConvolution<ValidConvolution>,
+                    NaiveConvolution<FullConvolution>,
+                    NaiveConvolution<ValidConvolution>> naiveAtrous(2, 3, 3, 3,
+      1, 1, 2, 2, 5, 4, 2, 2);
+  CheckConvolutionRules(atrous, naiveAtrous, input);
+
+  TransposedConvolution<> transposed(2, 3, 3, 3, 1, 1, 1, 1, 5, 4, 5, 4);
+  TransposedConvolution<NaiveConvolution<ValidConvolution>,
+                        NaiveConvolution<ValidConvolution>,
+                        NaiveConvolution<ValidConvolution>> naiveTransposed(2,
+      3, 3, 3, 1, 1, 1, 1, 5, 4, 5, 4);
+  CheckConvolutionRules(transposed, naiveTransposed, input);
+}
+
+/**
+ * Check the delta of a convolution layer against a numerical Jacobian, and the
+ * gradient of its parameters against a numerical gradient of the loss
+ * accu(output % error).
+ */
+template<typename LayerType>
+void CheckConvolutionGradients(LayerType& layer, arma::mat& input)
+{
+  layer.Parameters().randn();
+  layer.Reset();
+
+  REQUIRE(JacobianTest(layer, input) <= 1e-5);
+
+  struct GradientFunction
+  {
+    GradientFunction(LayerType& layer, const arma::mat& input) :
+        layer(layer), input(input)
+    {
+      arma::mat output;
+      layer.Forward(input, output);
+      error = arma::randn(output.n_rows, output.n_cols);
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      arma::mat output;
+      layer.Forward(input, output);
+      layer.Gradient(input, error, gradient);
+      return arma::accu(output % error);
+    }
+
+    arma::mat& Parameters() { return layer.Parameters(); }
+
+    LayerType& layer;
+    const arma::mat& input;
+    arma::mat error;
+  } function(layer, input);
+
+  REQUIRE(CheckGradient(function) <= 1e-6);
+}
+
+/**
+ * The naive rules are only a reference for unit strides, so check the im2col
+ * rule numerically for strided, dilated and output-padded convolutions.
+ */
+TEST_CASE("Im2ColStridedConvolutionLayerTest", "[ANNLayerTest]")
+{
+  // Three points with two 7x6 maps each.
+  arma::mat input(7 * 6 * 2, 3);
+
+  // Stride 2 in both directions, with padding.
+  Convolution<> convolution(2, 3, 3, 3, 2, 2, 1, 1, 7, 6);
+  CheckConvolutionGradients(convolution, input);
+
+  // Non-square strides.
+  Convolution<> convolution21(2, 3, 3, 3, 2, 1, 0, 0, 7, 6);
+  CheckConvolutionGradients(convolution21, input);
+
+  Convolution<> convolution12(2, 3, 3, 2, 1, 2, 0, 0, 7, 6);
+  CheckConvolutionGradients(convolution12, input);
+
+  // Dilation 2, without and with stride.
+  AtrousConvolution<> atrous(2, 3, 3, 3, 1, 1, 0, 0, 7, 6, 2, 2);
+  CheckConvolutionGradients(atrous, input);
+
+  AtrousConvolution<> stridedAtrous(2, 3, 3, 3, 2, 2, 2, 2, 7, 6, 2, 2);
+  CheckConvolutionGradients(stridedAtrous, input);
+
+  // Stride 2 with an output size that gives aW = aH = 1.
+  TransposedConvolution<> transposed(2, 3, 3, 3, 2, 2, 1, 1, 7, 6, 14, 12);
+  CheckConvolutionGradients(transposed, input);
+
+  // Non-square strides, with aW = 1 and aH = 0.
+  TransposedConvolution<> transposed21(2, 3, 3, 3, 2, 1, 1, 1, 7, 6, 14, 6);
+  CheckConvolutionGradients(transposed21, input);
+}
+
 TEST_CASE("BatchNormDeterministicTest", "[ANNLayerTest]")
 {
   FFN<> module;
@@ -16,6 +16,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 
 #include "serialization.hpp"
 #include "catch.hpp"
@@ -140,6 +141,10 @@ TEST_CASE("ValidConvolution2DTest", "[ConvolutionTest]")
   Convolution2DMethodTest<NaiveConvolution<ValidConvolution> >(input, filter,
       output);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  Convolution2DMethodTest<Im2ColConvolution<ValidConvolution> >(input, filter,
+      output);
+
   // Perform the convolution trough fft.
   Convolution2DMethodTest<FFTConvolution<ValidConvolution> >(input, filter,
       output);
@@ -177,6 +182,10 @@ TEST_CASE("FullConvolution2DTest", "[ConvolutionTest]")
   Convolution2DMethodTest<NaiveConvolution<FullConvolution> >(input, filter,
       output);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  Convolution2DMethodTest<Im2ColConvolution<FullConvolution> >(input, filter,
+      output);
+
   // Perform the convolution trough fft.
   Convolution2DMethodTest<FFTConvolution<FullConvolution> >(input, filter,
       output);
@@ -222,6 +231,10 @@ TEST_CASE("ValidConvolution3DTest", "[ConvolutionTest]")
   Convolution3DMethodTest<NaiveConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  Convolution3DMethodTest<Im2ColConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
+
   // Perform the convolution trough fft.
   Convolution3DMethodTest<FFTConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
@@ -271,6 +284,10 @@ TEST_CASE("FullConvolution3DTest", "[ConvolutionTest]")
   Convolution3DMethodTest<NaiveConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  Convolution3DMethodTest<Im2ColConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
+
   // Perform the convolution trough fft.
   Convolution3DMethodTest<FFTConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
@@ -313,6 +330,10 @@ TEST_CASE("ValidConvolutionBatchTest", "[ConvolutionTest]")
   ConvolutionMethodBatchTest<NaiveConvolution<ValidConvolution> >(input,
       filterCube, outputCube);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  ConvolutionMethodBatchTest<Im2ColConvolution<ValidConvolution> >(input,
+      filterCube, outputCube);
+
   // Perform the convolution trough fft.
   ConvolutionMethodBatchTest<FFTConvolution<ValidConvolution> >(input,
       filterCube, outputCube);
@@ -359,6 +380,10 @@ TEST_CASE("FullConvolutionBatchTest", "[ConvolutionTest]")
   ConvolutionMethodBatchTest<NaiveConvolution<FullConvolution> >(input,
       filterCube, outputCube);
 
+  // Perform the convolution with im2col and a matrix multiplication.
+  ConvolutionMethodBatchTest<Im2ColConvolution<FullConvolution> >(input,
+      filterCube, outputCube);
+
   // Perform the convolution trough fft.
   ConvolutionMethodBatchTest<FFTConvolution<FullConvolution> >(input,
       filterCube, outputCube);
@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/dbscan/dbscan.hpp>
 #include <mlpack/methods/dbscan/random_point_selection.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
 
 #include "test_catch_tools.hpp"
 #include "catch.hpp"
@@ -306,3 +307,126 @@ TEST_CASE("RandomPointSelectionTest", "[DBSCANTest]")
   // The number of assignments returned should be the same as points.
   REQUIRE(assignments.n_elem == points.n_cols);
 }
+
+/**
+ * Make sure that the clusters do not depend on the block size or on the number
+ * of threads.
+ */
+TEST_CASE("DBSCANParallelBlockTest", "[DBSCANTest]")
+{
+  arma::mat points(2, 2000, arma::fill::randu);
+
+  DBSCAN<> serial(0.03, 3);
+  serial.BlockSize() = 2000;
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  arma::Row<size_t> serialAssignments;
+  const size_t serialClusters = serial.Cluster(points, serialAssignments);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  DBSCAN<> batch(0.03, 3);
+  batch.BlockSize() = 37;
+  arma::Row<size_t> batchAssignments;
+  const size_t batchClusters = batch.Cluster(points, batchAssignments);
+
+  DBSCAN<> single(0.03, 3, false);
+  arma::Row<size_t> singleAssignments;
+  const size_t singleClusters = single.Cluster(points, singleAssignments);
+
+  // Cover trees can't be searched by several threads in single-tree mode, but
+  // the results must be the same.
+  typedef RangeSearch<metric::EuclideanDistance, arma::mat,
+      tree::StandardCoverTree> CoverTreeRangeSearch;
+  DBSCAN<CoverTreeRangeSearch> cover(0.03, 3, false,
+      CoverTreeRangeSearch(false, true));
+  arma::Row<size_t> coverAssignments;
+  const size_t coverClusters = cover.Cluster(points, coverAssignments);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  REQUIRE(serialClusters > 1);
+  REQUIRE(batchClusters == serialClusters);
+  REQUIRE(singleClusters == serialClusters);
+  REQUIRE(coverClusters == serialClusters);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    REQUIRE(batchAssignments[i] == serialAssignments[i]);
+    REQUIRE(singleAssignments[i] == serialAssignments[i]);
+    REQUIRE(coverAssignments[i] == serialAssignments[i]);
+  }
+}
+
+/**
+ * Make sure that an invalid block size is rejected.
+ */
+TEST_CASE("DBSCANZeroBlockSizeTest", "[DBSCANTest]")
+{
+  arma::mat points(2, 100, arma::fill::randu);
+
+  DBSCAN<> d(0.1, 3);
+  d.BlockSize() = 0;
+
+  arma::Row<size_t> assignments;
+  REQUIRE_THROWS_AS(d.Cluster(points, assignments), std::invalid_argument);
+}
+
+/**
+ * Make sure that the grid finds the same clusters as range search, in two and
+ * three dimensions.
+ */
+TEST_CASE("DBSCANGridModeTest", "[DBSCANTest]")
+{
+  for (size_t dims = 2; dims <= 3; ++dims)
+  {
+    // Use a fixed spacing in the last dimension, so that some pairs of points
+    // are exactly epsilon apart.
+    arma::mat points(dims, 3000, arma::fill::randu);
+    points.cols(0, 99).zeros();
+    for (size_t i = 0; i < 100; ++i)
+      points(dims - 1, i) = 0.05 * i;
+
+    DBSCAN<> rangeDBSCAN(0.05, 3);
+    arma::Row<size_t> rangeAssignments;
+    const size_t rangeClusters = rangeDBSCAN.Cluster(points,
+        rangeAssignments);
+
+    DBSCAN<> gridDBSCAN(0.05, 3);
+    gridDBSCAN.GridMode() = true;
+    arma::Row<size_t> gridAssignments;
+    const size_t gridClusters = gridDBSCAN.Cluster(points, gridAssignments);
+
+    REQUIRE(rangeClusters > 1);
+    REQUIRE(gridClusters == rangeClusters);
+    for (size_t i = 0; i < points.n_cols; ++i)
+      REQUIRE(gridAssignments[i] == rangeAssignments[i]);
+  }
+}
+
+/**
+ * Make sure that the grid rejects data it can't handle.
+ */
+TEST_CASE("DBSCANGridModeInvalidDataTest", "[DBSCANTest]")
+{
+  DBSCAN<RangeSearch<metric::EuclideanDistance, arma::sp_mat>> sparse(0.1, 3);
+  sparse.GridMode() = true;
+  arma::sp_mat sparsePoints;
+  sparsePoints.sprandu(2, 100, 0.3);
+  arma::Row<size_t> assignments;
+  REQUIRE_THROWS_AS(sparse.Cluster(sparsePoints, assignments),
+      std::invalid_argument);
+
+  DBSCAN<> highDimensional(0.1, 3);
+  highDimensional.GridMode() = true;
+  arma::mat points(GridCluster::MaxDimensionality + 1, 100, arma::fill::randu);
+  REQUIRE_THROWS_AS(highDimensional.Cluster(points, assignments),
+      std::invalid_argument);
+}
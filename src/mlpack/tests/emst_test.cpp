@@ -274,3 +274,83 @@ TEST_CASE("EMSTBallTreeTest", "[EMSTTest]")
     REQUIRE(bstResults(2, i) == Approx(ballResults(2, i)).epsilon(1e-7));
   }
 }
+
+/**
+ * Compute the MST of the given dataset with a single thread and with several
+ * threads, and make sure the results are identical.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckParallelMST(const arma::mat& dataset, const bool naive)
+{
+  typedef DualTreeBoruvka<EuclideanDistance, arma::mat, TreeType> DTBType;
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  DTBType serialDtb(dataset, naive);
+  arma::mat serialResults;
+  serialDtb.ComputeMST(serialResults);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  DTBType parallelDtb(dataset, naive);
+  arma::mat parallelResults;
+  parallelDtb.ComputeMST(parallelResults);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  REQUIRE(serialResults.n_rows == parallelResults.n_rows);
+  REQUIRE(serialResults.n_cols == parallelResults.n_cols);
+  for (size_t i = 0; i < serialResults.n_elem; ++i)
+    REQUIRE(serialResults[i] == parallelResults[i]);
+}
+
+/**
+ * Make sure that the MST does not depend on the number of threads.
+ */
+TEST_CASE("EMSTParallelTest", "[EMSTTest]")
+{
+  arma::mat inputData;
+  if (!data::Load("test_data_3_1000.csv", inputData))
+    FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  CheckParallelMST<KDTree>(inputData, false);
+  CheckParallelMST<KDTree>(inputData, true);
+  CheckParallelMST<BallTree>(inputData, false);
+  CheckParallelMST<StandardCoverTree>(inputData, false);
+}
+
+/**
+ * Make sure that ties between edges of equal length are broken the same way
+ * with any number of threads.  On a grid, most edges have the same length.
+ */
+TEST_CASE("EMSTParallelTiesTest", "[EMSTTest]")
+{
+  arma::mat gridData(2, 900);
+  for (size_t i = 0; i < gridData.n_cols; ++i)
+  {
+    gridData(0, i) = i % 30;
+    gridData(1, i) = i / 30;
+  }
+
+  CheckParallelMST<KDTree>(gridData, false);
+  CheckParallelMST<KDTree>(gridData, true);
+  CheckParallelMST<StandardCoverTree>(gridData, false);
+
+  // Every edge of the MST of the grid has length 1.
+  DualTreeBoruvka<> dtb(gridData);
+  arma::mat results;
+  dtb.ComputeMST(results);
+
+  REQUIRE(results.n_cols == gridData.n_cols - 1);
+  for (size_t i = 0; i < results.n_cols; ++i)
+    REQUIRE(results(2, i) == Approx(1.0).epsilon(1e-7));
+}
@@ -1134,3 +1134,196 @@ TEST_CASE("CopyAssignmentTest", "[FastMKSTest]")
       REQUIRE(newKernels[i] == Approx(0.0).margin(1e-5));
   }
 }
+
+/**
+ * Make sure that the block kernel evaluations for dot-product kernels match
+ * evaluating each pair of points one at a time.
+ */
+template<typename KernelType>
+void CheckBlockKernels(KernelType& kernel)
+{
+  arma::mat a(5, 40, arma::fill::randn);
+  arma::mat b(5, 30, arma::fill::randn);
+  b.col(7).zeros(); // The cosine distance handles zero norms specially.
+
+  arma::mat kernels;
+  BlockKernels<KernelType>::Evaluate(kernel, a.cols(3, 22), b, kernels);
+
+  REQUIRE(kernels.n_rows == 20);
+  REQUIRE(kernels.n_cols == b.n_cols);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    for (size_t i = 0; i < 20; ++i)
+    {
+      const double eval = kernel.Evaluate(a.col(i + 3), b.col(j));
+      if (std::abs(eval) > 1e-10)
+        REQUIRE(kernels(i, j) == Approx(eval).epsilon(1e-10));
+      else
+        REQUIRE(kernels(i, j) == Approx(0.0).margin(1e-10));
+    }
+  }
+}
+
+TEST_CASE("FastMKSBlockKernelsTest", "[FastMKSTest]")
+{
+  LinearKernel lk;
+  CheckBlockKernels(lk);
+
+  PolynomialKernel pk(3.0, 0.5);
+  CheckBlockKernels(pk);
+
+  CosineDistance cd;
+  CheckBlockKernels(cd);
+
+  // This one is evaluated one pair at a time.
+  GaussianKernel gk(1.5);
+  CheckBlockKernels(gk);
+}
+
+/**
+ * Make sure that parallel dual-tree and naive search give the same results as
+ * serial search, for both the monochromatic and bichromatic cases.
+ */
+template<typename KernelType>
+void CheckParallelFastMKS(KernelType& kernel, const bool naive)
+{
+  // The naive search works on blocks of 256 query points, so use enough points
+  // for several blocks.
+  arma::mat reference(5, 1500, arma::fill::randn);
+  arma::mat query(5, 700, arma::fill::randn);
+
+  FastMKS<KernelType> serial(reference, kernel, false, naive);
+
+  arma::Mat<size_t> serialIndices, serialMonoIndices;
+  arma::mat serialKernels, serialMonoKernels;
+  serial.Search(query, 5, serialIndices, serialKernels);
+  serial.Search(5, serialMonoIndices, serialMonoKernels);
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  FastMKS<KernelType> parallel(reference, kernel, false, naive);
+  parallel.Parallel() = true;
+
+  arma::Mat<size_t> parallelIndices, parallelMonoIndices;
+  arma::mat parallelKernels, parallelMonoKernels;
+  parallel.Search(query, 5, parallelIndices, parallelKernels);
+  parallel.Search(5, parallelMonoIndices, parallelMonoKernels);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  REQUIRE(parallelIndices.n_rows == 5);
+  REQUIRE(parallelIndices.n_cols == query.n_cols);
+  REQUIRE(parallelMonoIndices.n_rows == 5);
+  REQUIRE(parallelMonoIndices.n_cols == reference.n_cols);
+
+  for (size_t i = 0; i < serialIndices.n_elem; ++i)
+  {
+    REQUIRE(parallelIndices[i] == serialIndices[i]);
+    REQUIRE(parallelKernels[i] == Approx(serialKernels[i]).epsilon(1e-7));
+  }
+
+  for (size_t i = 0; i < serialMonoIndices.n_elem; ++i)
+  {
+    REQUIRE(parallelMonoIndices[i] == serialMonoIndices[i]);
+    REQUIRE(parallelMonoKernels[i] ==
+        Approx(serialMonoKernels[i]).epsilon(1e-7));
+  }
+}
+
+TEST_CASE("FastMKSParallelDualTreeTest", "[FastMKSTest]")
+{
+  LinearKernel lk;
+  CheckParallelFastMKS(lk, false);
+
+  PolynomialKernel pk(2.0, 1.0);
+  CheckParallelFastMKS(pk, false);
+}
+
+TEST_CASE("FastMKSParallelNaiveTest", "[FastMKSTest]")
+{
+  LinearKernel lk;
+  CheckParallelFastMKS(lk, true);
+
+  CosineDistance cd;
+  CheckParallelFastMKS(cd, true);
+}
+
+/**
+ * Make sure that naive search with block kernel evaluations gives the same
+ * results as evaluating each pair of points.
+ */
+TEST_CASE("FastMKSBlockNaiveVsPairwiseTest", "[FastMKSTest]")
+{
+  arma::mat reference(4, 2500, arma::fill::randn);
+  arma::mat query(4, 300, arma::fill::randn);
+  PolynomialKernel pk(3.0, 0.5);
+
+  FastMKS<PolynomialKernel> naive(reference, pk, false, true);
+
+  arma::Mat<size_t> indices;
+  arma::mat kernels;
+  naive.Search(query, 3, indices, kernels);
+
+  for (size_t q = 0; q < query.n_cols; ++q)
+  {
+    arma::vec evals(reference.n_cols);
+    for (size_t r = 0; r < reference.n_cols; ++r)
+      evals[r] = pk.Evaluate(query.col(q), reference.col(r));
+    const arma::uvec order = arma::sort_index(evals, "descend");
+
+    for (size_t j = 0; j < 3; ++j)
+    {
+      REQUIRE(indices(j, q) == order[j]);
+      REQUIRE(kernels(j, q) == Approx(evals[order[j]]).epsilon(1e-7));
+    }
+  }
+}
+
+/**
+ * Make sure that copies of FastMKSRules have their own candidate lists, and
+ * that candidate lists are only shared when that is asked for.
+ */
+TEST_CASE("FastMKSRulesCopyTest", "[FastMKSTest]")
+{
+  typedef FastMKSRules<LinearKernel, FastMKS<LinearKernel>::Tree> RuleType;
+
+  arma::mat referenceData("1 2 3;"
+                          "0 0 0");
+  arma::mat queryData("1 1;"
+                      "0 0");
+  LinearKernel kernel;
+
+  RuleType rules(referenceData, queryData, 1, kernel);
+  rules.BaseCase(0, 0);
+
+  // The copy starts from the same candidates, but doesn't change the original.
+  RuleType copy(rules);
+  copy.BaseCase(1, 1);
+
+  // A sharing object changes the candidates of the original.
+  RuleType shared(rules, true /* share candidates */);
+  shared.BaseCase(1, 2);
+
+  // A non-sharing object starts from empty candidates.
+  RuleType unshared(rules, false /* don't share candidates */);
+  unshared.BaseCase(0, 1);
+
+  arma::Mat<size_t> indices;
+  arma::mat products;
+  rules.GetResults(indices, products);
+  REQUIRE(indices(0, 0) == 0);
+  REQUIRE(indices(0, 1) == 2);
+
+  copy.GetResults(indices, products);
+  REQUIRE(indices(0, 0) == 0);
+  REQUIRE(indices(0, 1) == 1);
+
+  unshared.GetResults(indices, products);
+  REQUIRE(indices(0, 0) == 1);
+  REQUIRE(indices(0, 1) == size_t() - 1);
+}
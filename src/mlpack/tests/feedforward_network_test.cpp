@@ -15,6 +15,7 @@
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/loss_functions/mean_squared_error.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
 
 #include <ensmallen.hpp>
 
@@ -782,6 +783,317 @@ TEST_CASE("FFSerializationTest", "[FeedForwardNetworkTest]")
       binaryPredictions);
 }
 
+/**
+ * Make sure that batched prediction gives the same results as predicting one
+ * point at a time, for batch sizes that do and don't divide the number of
+ * points.
+ */
+TEST_CASE("FFNBatchPredictTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 203);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Dropout<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat predictions;
+  model.Predict(data, predictions, 1);
+  REQUIRE(predictions.n_rows == 3);
+  REQUIRE(predictions.n_cols == data.n_cols);
+
+  const size_t batchSizes[] = { 7, 128, 203, 1000 };
+  for (const size_t batchSize : batchSizes)
+  {
+    arma::mat batchPredictions;
+    model.Predict(data, batchPredictions, batchSize);
+    CheckMatrices(predictions, batchPredictions);
+  }
+
+  arma::mat batchPredictions;
+  REQUIRE_THROWS_AS(model.Predict(data, batchPredictions, 0),
+      std::invalid_argument);
+
+  // Predicting no points should give an empty result.
+  model.Predict(arma::mat(10, 0), predictions, 7);
+  REQUIRE(predictions.n_elem == 0);
+}
+
+/**
+ * Make sure that splitting each mini-batch among replicas of the network gives
+ * the same loss and gradient as computing the whole mini-batch at once.
+ */
+TEST_CASE("FFNReplicasTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 100);
+  arma::mat labels = arma::floor(3 * arma::randu<arma::mat>(1, 100));
+  labels.elem(arma::find(labels > 2)).fill(2);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  // The last mini-batch has fewer points than there are replicas.
+  const size_t batchSizes[] = { 43, 20, 3 };
+  for (const size_t batchSize : batchSizes)
+  {
+    model.Replicas() = 1;
+    arma::mat gradient;
+    const double loss = model.EvaluateWithGradient(model.Parameters(), 5,
+        gradient, batchSize);
+
+    model.Replicas() = 4;
+    arma::mat replicaGradient;
+    const double replicaLoss = model.EvaluateWithGradient(model.Parameters(),
+        5, replicaGradient, batchSize);
+
+    REQUIRE(replicaLoss == Approx(loss).epsilon(1e-7));
+    CheckMatrices(replicaGradient, gradient);
+  }
+
+  // Batch normalization depends on the whole mini-batch, so it must not be
+  // split.
+  FFN<NegativeLogLikelihood<> > batchNormModel;
+  batchNormModel.Predictors() = data;
+  batchNormModel.Responses() = labels;
+  batchNormModel.Add<Linear<> >(10, 8);
+  batchNormModel.Add<BatchNorm<> >(8);
+  batchNormModel.Add<Linear<> >(8, 3);
+  batchNormModel.Add<LogSoftMax<> >();
+
+  arma::mat gradient, replicaGradient;
+  const double loss = batchNormModel.EvaluateWithGradient(
+      batchNormModel.Parameters(), 0, gradient, 50);
+  batchNormModel.Replicas() = 4;
+  const double replicaLoss = batchNormModel.EvaluateWithGradient(
+      batchNormModel.Parameters(), 0, replicaGradient, 50);
+
+  REQUIRE(replicaLoss == Approx(loss).epsilon(1e-7));
+  CheckMatrices(replicaGradient, gradient);
+
+  // The LSTM layer keeps its state for the whole mini-batch between calls, so
+  // it must not be split either.  Since that state changes with each call, use
+  // two models with the same parameters.
+  FFN<NegativeLogLikelihood<> > lstmModel, lstmReplicaModel;
+  FFN<NegativeLogLikelihood<> >* lstmModels[] = { &lstmModel,
+      &lstmReplicaModel };
+  for (FFN<NegativeLogLikelihood<> >* m : lstmModels)
+  {
+    m->Predictors() = data;
+    m->Responses() = labels;
+    m->Add<Linear<> >(10, 8);
+    m->Add<LSTM<> >(8, 6, 5);
+    m->Add<Linear<> >(6, 3);
+    m->Add<LogSoftMax<> >();
+    m->ResetParameters();
+  }
+  lstmReplicaModel.Parameters() = lstmModel.Parameters();
+  lstmReplicaModel.Replicas() = 4;
+
+  arma::mat lstmGradient, lstmReplicaGradient;
+  const double lstmLoss = lstmModel.EvaluateWithGradient(
+      lstmModel.Parameters(), 0, lstmGradient, 50);
+  const double lstmReplicaLoss = lstmReplicaModel.EvaluateWithGradient(
+      lstmReplicaModel.Parameters(), 0, lstmReplicaGradient, 50);
+
+  REQUIRE(lstmReplicaLoss == Approx(lstmLoss).epsilon(1e-7));
+  CheckMatrices(lstmReplicaGradient, lstmGradient);
+
+  // Dropout draws its mask from the random number generator, which is only
+  // seeded in the main thread, so it must not be split either: with the same
+  // seed, the results must be the same as without replicas.
+  FFN<NegativeLogLikelihood<> > dropoutModel;
+  dropoutModel.Predictors() = data;
+  dropoutModel.Responses() = labels;
+  dropoutModel.Add<Linear<> >(10, 8);
+  dropoutModel.Add<Dropout<> >(0.3);
+  dropoutModel.Add<Linear<> >(8, 3);
+  dropoutModel.Add<LogSoftMax<> >();
+  dropoutModel.ResetParameters();
+
+  arma::mat dropoutGradient, dropoutReplicaGradient;
+  math::RandomSeed(42);
+  const double dropoutLoss = dropoutModel.EvaluateWithGradient(
+      dropoutModel.Parameters(), 0, dropoutGradient, 50);
+  dropoutModel.Replicas() = 4;
+  math::RandomSeed(42);
+  const double dropoutReplicaLoss = dropoutModel.EvaluateWithGradient(
+      dropoutModel.Parameters(), 0, dropoutReplicaGradient, 50);
+
+  REQUIRE(dropoutReplicaLoss == Approx(dropoutLoss).epsilon(1e-7));
+  CheckMatrices(dropoutReplicaGradient, dropoutGradient);
+
+  // Training with replicas should work too.
+  ens::StandardSGD opt(0.01, 10, 500, 1e-8, false);
+  model.Train(data, labels, opt);
+}
+
+/**
+ * Make sure that keeping the outputs and deltas of the layers in the activation
+ * arena gives the same results, and that the layers keep writing into the same
+ * memory once the arena is planned.
+ */
+TEST_CASE("FFNActivationArenaTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 100);
+  arma::mat labels = arma::floor(3 * arma::randu<arma::mat>(1, 100));
+  labels.elem(arma::find(labels > 2)).fill(2);
+
+  FFN<NegativeLogLikelihood<> > model, plainModel;
+  for (FFN<NegativeLogLikelihood<> >* network : { &model, &plainModel })
+  {
+    network->Predictors() = data;
+    network->Responses() = labels;
+    network->Add<Linear<> >(10, 8);
+    network->Add<SigmoidLayer<> >();
+    network->Add<Linear<> >(8, 3);
+    network->Add<LogSoftMax<> >();
+    network->ResetParameters();
+  }
+  plainModel.ActivationArena() = false;
+  plainModel.Parameters() = model.Parameters();
+
+  // Alternate between two batch sizes, as the last batch of an epoch does.
+  // Both are planned after the first two steps.
+  const size_t batchSizes[] = { 32, 4, 32, 32, 4, 32 };
+  std::vector<double*> outputs;
+  arma::mat gradient, plainGradient;
+  for (size_t b = 0; b < 6; ++b)
+  {
+    const double loss = model.EvaluateWithGradient(model.Parameters(), 10,
+        gradient, batchSizes[b]);
+    const double plainLoss = plainModel.EvaluateWithGradient(
+        plainModel.Parameters(), 10, plainGradient, batchSizes[b]);
+
+    REQUIRE(loss == Approx(plainLoss).epsilon(1e-7));
+    CheckMatrices(gradient, plainGradient);
+
+    if (batchSizes[b] != 32 || b < 2)
+      continue;
+
+    for (size_t i = 0; i < model.Model().size(); ++i)
+    {
+      double* output = boost::apply_visitor(OutputParameterVisitor(),
+          model.Model()[i]).memptr();
+      if (b == 2)
+        outputs.push_back(output);
+      else
+        REQUIRE(output == outputs[i]);
+    }
+  }
+
+  // Training should give the same model.
+  ens::StandardSGD opt(0.01, 32, 500, 1e-8, false);
+  model.Train(data, labels, opt);
+  plainModel.Train(data, labels, opt);
+  CheckMatrices(model.Parameters(), plainModel.Parameters());
+}
+
+/**
+ * Make sure that a StaticFFN gives the same results as the same network built
+ * as an FFN.
+ */
+TEST_CASE("StaticFFNTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 100);
+  arma::mat labels = arma::floor(3 * arma::randu<arma::mat>(1, 100));
+  labels.elem(arma::find(labels > 2)).fill(2);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > staticModel(Linear<>(10, 8),
+      SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+  staticModel.Predictors() = data;
+  staticModel.Responses() = labels;
+  staticModel.ResetParameters();
+  staticModel.Parameters() = model.Parameters();
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(data, predictions);
+  staticModel.Predict(data, staticPredictions, 32);
+  CheckMatrices(staticPredictions, predictions);
+
+  arma::mat emptyPredictions(3, 5);
+  staticModel.Predict(arma::mat(10, 0), emptyPredictions, 32);
+  REQUIRE(emptyPredictions.n_elem == 0);
+
+  arma::mat gradient, staticGradient;
+  const double loss = model.EvaluateWithGradient(model.Parameters(), 5,
+      gradient, 20);
+  const double staticLoss = staticModel.EvaluateWithGradient(
+      staticModel.Parameters(), 5, staticGradient, 20);
+
+  REQUIRE(staticLoss == Approx(loss).epsilon(1e-7));
+  CheckMatrices(staticGradient, gradient);
+
+  // A copy has to use its own parameters.
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > copy(staticModel);
+  copy.Parameters().zeros();
+  staticModel.Predict(data, predictions);
+  CheckMatrices(predictions, staticPredictions);
+
+  // Training should reduce the objective.
+  ens::StandardSGD opt(0.01, 10, 500, 1e-8, false);
+  const double before = staticModel.Evaluate(staticModel.Parameters());
+  const double after = staticModel.Train(data, labels, opt);
+  REQUIRE(after < before);
+}
+
+/**
+ * Make sure that a trained StaticFFN gives the same predictions after being
+ * saved and loaded.
+ */
+TEST_CASE("StaticFFNSerializationTest", "[FeedForwardNetworkTest]")
+{
+  typedef StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > StaticModelType;
+
+  arma::mat data = arma::randu<arma::mat>(10, 100);
+  arma::mat labels = arma::floor(3 * arma::randu<arma::mat>(1, 100));
+  labels.elem(arma::find(labels > 2)).fill(2);
+
+  StaticModelType model(Linear<>(10, 8), SigmoidLayer<>(), Linear<>(8, 3),
+      LogSoftMax<>());
+  ens::StandardSGD opt(0.01, 10, 500, 1e-8, false);
+  model.Train(data, labels, opt);
+
+  // The loaded models start out with different parameters.
+  StaticModelType xmlModel(Linear<>(10, 8), SigmoidLayer<>(),
+      Linear<>(8, 3), LogSoftMax<>());
+  StaticModelType jsonModel(xmlModel), binaryModel(xmlModel);
+  xmlModel.ResetParameters();
+  jsonModel.ResetParameters();
+  binaryModel.ResetParameters();
+
+  SerializeObjectAll(model, xmlModel, jsonModel, binaryModel);
+
+  arma::mat predictions, xmlPredictions, jsonPredictions, binaryPredictions;
+  model.Predict(data, predictions);
+  xmlModel.Predict(data, xmlPredictions);
+  jsonModel.Predict(data, jsonPredictions);
+  binaryModel.Predict(data, binaryPredictions);
+
+  CheckMatrices(predictions, xmlPredictions, jsonPredictions,
+      binaryPredictions);
+  CheckMatrices(model.Parameters(), xmlModel.Parameters(),
+      jsonModel.Parameters(), binaryModel.Parameters());
+}
+
 /**
  * Test if the custom layers work. The target is to see if the code compiles
  * when the Train and Prediction are called.
@@ -1297,3 +1297,281 @@ TEST_CASE("GaussianBreadthDualKDTreeMonteCarloKDE", "[KDETest]")
 
   REQUIRE(correctResults > 70);
 }
+
+/**
+ * Test parallel single-tree and dual-tree evaluation against brute force
+ * results, for a tree that rearranges the dataset and one that doesn't.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckParallelKDE()
+{
+  arma::mat reference = arma::randu(2, 2000);
+  arma::mat query = arma::randu(2, 1000);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double relError = 0.05;
+
+  // Brute force KDE.
+  GaussianKernel kernel(0.1);
+  BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+  arma::vec bfMonoEstimations(reference.n_cols, arma::fill::zeros);
+  BruteForceKDE<GaussianKernel>(reference, reference, bfMonoEstimations,
+      kernel);
+  // Remove the contribution of each point to itself.
+  bfMonoEstimations -= kernel.Evaluate(0.0) / reference.n_cols;
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  KDE<GaussianKernel, EuclideanDistance, arma::mat, TreeType>
+      kde(relError, 0.0, kernel);
+  kde.Parallel() = true;
+  kde.Train(reference);
+
+  arma::vec dualEstimations, singleEstimations;
+  kde.Evaluate(query, dualEstimations);
+  kde.Mode() = KDEMode::SINGLE_TREE_MODE;
+  kde.Evaluate(query, singleEstimations);
+
+  arma::vec monoEstimations;
+  kde.Mode() = KDEMode::DUAL_TREE_MODE;
+  kde.Evaluate(monoEstimations);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    REQUIRE(dualEstimations[i] ==
+        Approx(bfEstimations[i]).epsilon(relError));
+    REQUIRE(singleEstimations[i] ==
+        Approx(bfEstimations[i]).epsilon(relError));
+  }
+
+  for (size_t i = 0; i < reference.n_cols; ++i)
+  {
+    REQUIRE(monoEstimations[i] ==
+        Approx(bfMonoEstimations[i]).epsilon(relError));
+  }
+}
+
+TEST_CASE("KDTreeParallelKDETest", "[KDETest]")
+{
+  CheckParallelKDE<KDTree>();
+}
+
+TEST_CASE("CoverTreeParallelKDETest", "[KDETest]")
+{
+  CheckParallelKDE<StandardCoverTree>();
+}
+
+/**
+ * Test parallel evaluation with Monte Carlo estimations against brute force
+ * results.
+ */
+TEST_CASE("GaussianParallelMonteCarloKDE", "[KDETest]")
+{
+  arma::mat reference = arma::randu(2, 3000);
+  arma::mat query = arma::randu(2, 200);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double kernelBandwidth = 0.4;
+  const double relError = 0.05;
+
+  // Brute force KDE.
+  GaussianKernel kernel(kernelBandwidth);
+  BruteForceKDE<GaussianKernel>(reference,
+                                query,
+                                bfEstimations,
+                                kernel);
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  metric::EuclideanDistance metric;
+  KDE<GaussianKernel,
+      metric::EuclideanDistance,
+      arma::mat,
+      tree::KDTree>
+    kde(relError,
+        0.0,
+        kernel,
+        KDEMode::DUAL_TREE_MODE,
+        metric,
+        true,
+        0.95,
+        100,
+        3,
+        0.8);
+  kde.Parallel() = true;
+  kde.Train(reference);
+
+  arma::vec dualEstimations, singleEstimations;
+  kde.Evaluate(query, dualEstimations);
+  kde.Mode() = KDEMode::SINGLE_TREE_MODE;
+  kde.Evaluate(query, singleEstimations);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  // The Monte Carlo estimation has a random component so it can fail. Therefore
+  // we require a reasonable amount of results to be right.
+  size_t dualCorrectResults = 0;
+  size_t singleCorrectResults = 0;
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    if (std::abs((bfEstimations[i] - dualEstimations[i]) / bfEstimations[i]) <
+        relError)
+      ++dualCorrectResults;
+    if (std::abs((bfEstimations[i] - singleEstimations[i]) /
+        bfEstimations[i]) < relError)
+      ++singleCorrectResults;
+  }
+
+  REQUIRE(dualCorrectResults > 70);
+  REQUIRE(singleCorrectResults > 70);
+}
+
+/**
+ * Test single-tree, dual-tree and monochromatic evaluation with series
+ * expansions against brute force results, for 3-dimensional data.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckSeriesExpansionKDE(const bool parallel)
+{
+  arma::mat reference = arma::randu(3, 3000);
+  arma::mat query = arma::randu(3, 1000);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double relError = 0.05;
+
+  // Brute force KDE.
+  GaussianKernel kernel(0.5);
+  BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+  arma::vec bfMonoEstimations(reference.n_cols, arma::fill::zeros);
+  BruteForceKDE<GaussianKernel>(reference, reference, bfMonoEstimations,
+      kernel);
+  // Remove the contribution of each point to itself.
+  bfMonoEstimations -= kernel.Evaluate(0.0) / reference.n_cols;
+
+  KDE<GaussianKernel, EuclideanDistance, arma::mat, TreeType>
+      kde(relError, 0.0, kernel);
+  kde.SeriesExpansion() = true;
+  kde.Parallel() = parallel;
+  kde.Train(reference);
+
+  arma::vec dualEstimations, singleEstimations;
+  kde.Evaluate(query, dualEstimations);
+  kde.Mode() = KDEMode::SINGLE_TREE_MODE;
+  kde.Evaluate(query, singleEstimations);
+
+  arma::vec monoEstimations;
+  kde.Mode() = KDEMode::DUAL_TREE_MODE;
+  kde.Evaluate(monoEstimations);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    REQUIRE(dualEstimations[i] ==
+        Approx(bfEstimations[i]).epsilon(relError));
+    REQUIRE(singleEstimations[i] ==
+        Approx(bfEstimations[i]).epsilon(relError));
+  }
+
+  for (size_t i = 0; i < reference.n_cols; ++i)
+  {
+    REQUIRE(monoEstimations[i] ==
+        Approx(bfMonoEstimations[i]).epsilon(relError));
+  }
+}
+
+TEST_CASE("KDTreeSeriesExpansionKDETest", "[KDETest]")
+{
+  CheckSeriesExpansionKDE<KDTree>(false);
+}
+
+TEST_CASE("CoverTreeSeriesExpansionKDETest", "[KDETest]")
+{
+  CheckSeriesExpansionKDE<StandardCoverTree>(false);
+}
+
+TEST_CASE("KDTreeParallelSeriesExpansionKDETest", "[KDETest]")
+{
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  CheckSeriesExpansionKDE<KDTree>(true);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+}
+
+/**
+ * With low-dimensional data, many points and a large bandwidth, the far-field
+ * expansions of large reference nodes are translated into the local
+ * expansions of large query nodes.  Make sure the results are still within
+ * the error tolerance, and that the nodes only hold series expansion state
+ * when series expansions are used.
+ */
+TEST_CASE("HermiteToLocalSeriesExpansionKDETest", "[KDETest]")
+{
+  arma::mat reference = arma::randu(2, 10000);
+  arma::mat query = arma::randu(2, 5000);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double relError = 0.01;
+
+  GaussianKernel kernel(0.8);
+  BruteForceKDE<GaussianKernel>(reference, query, bfEstimations, kernel);
+
+  KDE<GaussianKernel, EuclideanDistance, arma::mat, KDTree>
+      kde(relError, 0.0, kernel);
+  kde.Train(reference);
+
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+  REQUIRE(!kde.ReferenceTree()->Stat().HasSeriesState());
+
+  kde.SeriesExpansion() = true;
+  kde.Evaluate(query, estimations);
+  REQUIRE(kde.ReferenceTree()->Stat().HasSeriesState());
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+    REQUIRE(estimations[i] == Approx(bfEstimations[i]).epsilon(relError));
+}
+
+/**
+ * Make sure that series expansions are ignored for kernels other than the
+ * Gaussian kernel.
+ */
+TEST_CASE("EpanechnikovSeriesExpansionKDETest", "[KDETest]")
+{
+  arma::mat reference = arma::randu(3, 1000);
+  arma::mat query = arma::randu(3, 200);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double relError = 0.05;
+
+  EpanechnikovKernel kernel(0.5);
+  BruteForceKDE<EpanechnikovKernel>(reference, query, bfEstimations, kernel);
+
+  KDE<EpanechnikovKernel, EuclideanDistance, arma::mat, KDTree>
+      kde(relError, 0.0, kernel);
+  kde.SeriesExpansion() = true;
+  kde.Train(reference);
+
+  arma::vec estimations;
+  kde.Evaluate(query, estimations);
+
+  for (size_t i = 0; i < query.n_cols; ++i)
+    REQUIRE(estimations[i] == Approx(bfEstimations[i]).epsilon(relError));
+}
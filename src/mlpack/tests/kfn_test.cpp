@@ -356,6 +356,43 @@ TEST_CASE("KFNDualTreeVsNaive1", "[KFNTest]")
   }
 }
 
+/**
+ * Test the parallel dual-tree furthest-neighbors method with the naive method.
+ *
+ * Errors are produced if the results are not identical.
+ */
+TEST_CASE("KFNParallelDualTreeVsNaive", "[KFNTest]")
+{
+  arma::mat dataset;
+
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    FAIL("Cannot load test dataset test_data_3_1000.csv");
+
+  KFN kfn(dataset, PARALLEL_DUAL_TREE_MODE);
+  KFN naive(dataset, NAIVE_MODE);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive;
+  arma::mat distancesTree, distancesNaive;
+
+  kfn.Search(dataset, 15, neighborsTree, distancesTree);
+  naive.Search(dataset, 15, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    REQUIRE(neighborsTree[i] == neighborsNaive[i]);
+    REQUIRE(distancesTree[i] == Approx(distancesNaive[i]).epsilon(1e-7));
+  }
+
+  kfn.Search(15, neighborsTree, distancesTree);
+  naive.Search(15, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    REQUIRE(neighborsTree[i] == neighborsNaive[i]);
+    REQUIRE(distancesTree[i] == Approx(distancesNaive[i]).epsilon(1e-7));
+  }
+}
+
 /**
  * Test the dual-tree furthest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -718,6 +718,75 @@ TEST_CASE("KNNDualTreeVsNaive2", "[KNNTest]")
   }
 }
 
+/**
+ * Test the parallel dual-tree nearest-neighbors method with the naive method,
+ * both with a separate query set and with only a reference set.
+ *
+ * Errors are produced if the results are not identical.
+ */
+TEST_CASE("KNNParallelDualTreeVsNaive", "[KNNTest]")
+{
+  arma::mat dataset;
+
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  KNN knn(dataset, PARALLEL_DUAL_TREE_MODE);
+  KNN naive(dataset, NAIVE_MODE);
+
+  arma::Mat<size_t> neighborsTree, neighborsNaive;
+  arma::mat distancesTree, distancesNaive;
+
+  knn.Search(dataset, 15, neighborsTree, distancesTree);
+  naive.Search(dataset, 15, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+  {
+    REQUIRE(neighborsTree[i] == neighborsNaive[i]);
+    REQUIRE(distancesTree[i] == Approx(distancesNaive[i]).epsilon(1e-7));
+  }
+
+  // Search twice to make sure the reference tree bounds are reset.
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    knn.Search(15, neighborsTree, distancesTree);
+    naive.Search(15, neighborsNaive, distancesNaive);
+
+    for (size_t i = 0; i < neighborsTree.n_elem; ++i)
+    {
+      REQUIRE(neighborsTree[i] == neighborsNaive[i]);
+      REQUIRE(distancesTree[i] == Approx(distancesNaive[i]).epsilon(1e-7));
+    }
+  }
+}
+
+/**
+ * Make sure the parallel dual-tree search with cover trees gives the same
+ * results as the serial dual-tree search.
+ */
+TEST_CASE("KNNParallelDualCoverTreeTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> CoverTreeKNN;
+  CoverTreeKNN serial(dataset, DUAL_TREE_MODE);
+  CoverTreeKNN parallel(dataset, PARALLEL_DUAL_TREE_MODE);
+
+  arma::Mat<size_t> serialNeighbors, parallelNeighbors;
+  arma::mat serialDistances, parallelDistances;
+
+  serial.Search(dataset, 5, serialNeighbors, serialDistances);
+  parallel.Search(dataset, 5, parallelNeighbors, parallelDistances);
+
+  for (size_t i = 0; i < serialNeighbors.n_elem; ++i)
+  {
+    REQUIRE(parallelNeighbors[i] == serialNeighbors[i]);
+    REQUIRE(parallelDistances[i] ==
+        Approx(serialDistances[i]).epsilon(1e-7));
+  }
+}
+
 /**
  * Test the single-tree nearest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -1101,7 +1170,7 @@ TEST_CASE("KNNModelTest", "[KNNTest]")
   models[26] = KNNModel(KNNModel::TreeTypes::OCTREE, true);
   models[27] = KNNModel(KNNModel::TreeTypes::OCTREE, false);
 
-  for (size_t j = 0; j < 3; ++j)
+  for (size_t j = 0; j < 4; ++j)
   {
     // Get a baseline.
     KNN knn(referenceData);
@@ -1121,6 +1190,9 @@ TEST_CASE("KNNModelTest", "[KNNTest]")
         models[i].BuildModel(std::move(referenceCopy), SINGLE_TREE_MODE);
       if (j == 2)
         models[i].BuildModel(std::move(referenceCopy), NAIVE_MODE);
+      if (j == 3)
+        models[i].BuildModel(std::move(referenceCopy),
+            PARALLEL_DUAL_TREE_MODE);
 
       arma::Mat<size_t> neighbors;
       arma::mat distances;
@@ -1184,7 +1256,7 @@ TEST_CASE("KNNModelMonochromaticTest", "[KNNTest]")
   models[26] = KNNModel(KNNModel::TreeTypes::OCTREE, true);
   models[27] = KNNModel(KNNModel::TreeTypes::OCTREE, false);
 
-  for (size_t j = 0; j < 3; ++j)
+  for (size_t j = 0; j < 4; ++j)
   {
     // Get a baseline.
     KNN knn(referenceData);
@@ -1203,6 +1275,9 @@ TEST_CASE("KNNModelMonochromaticTest", "[KNNTest]")
         models[i].BuildModel(std::move(referenceCopy), SINGLE_TREE_MODE);
       if (j == 2)
         models[i].BuildModel(std::move(referenceCopy), NAIVE_MODE);
+      if (j == 3)
+        models[i].BuildModel(std::move(referenceCopy),
+            PARALLEL_DUAL_TREE_MODE);
 
       arma::Mat<size_t> neighbors;
       arma::mat distances;
@@ -1816,3 +1891,413 @@ TEST_CASE("KNNSpillTreeSearchEnoughResults", "[KNNTest]")
   REQUIRE(arma::accu(distancesGreedy < 0.0 || distancesGreedy > std::sqrt(3.0))
       == 0);
 }
+
+/**
+ * Make sure that searching micro-batches of queries with reusable buffers
+ * gives the same results as a regular search.
+ */
+TEST_CASE("KNNSearchBuffersTest", "[KNNTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 100);
+
+  KNN naive(dataset, NAIVE_MODE);
+  arma::Mat<size_t> neighborsNaive;
+  arma::mat distancesNaive;
+  naive.Search(querySet, 10, neighborsNaive, distancesNaive);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    KNN knn(dataset, (mode == 0) ? NAIVE_MODE :
+        (mode == 1) ? SINGLE_TREE_MODE : DUAL_TREE_MODE);
+    KNN::SearchBuffers buffers(10, 8);
+
+    // Search in batches of different sizes, including single points; the last
+    // batch is larger than the preallocated size.
+    size_t begin = 0;
+    size_t batchSize = 1;
+    while (begin < querySet.n_cols)
+    {
+      const size_t end = std::min(begin + batchSize, (size_t) querySet.n_cols);
+      const arma::mat batch(querySet.colptr(begin), 3, end - begin, false,
+          true);
+      knn.Search(batch, 10, buffers);
+
+      for (size_t i = 0; i < end - begin; ++i)
+      {
+        for (size_t j = 0; j < 10; ++j)
+        {
+          REQUIRE(buffers.Neighbors()(j, i) == neighborsNaive(j, begin + i));
+          REQUIRE(buffers.Distances()(j, i) ==
+              Approx(distancesNaive(j, begin + i)).epsilon(1e-7));
+        }
+      }
+
+      begin = end;
+      batchSize = (batchSize == 1) ? 7 : (batchSize == 7) ? 3 : 20;
+    }
+
+    REQUIRE(buffers.BatchSize() >= 20);
+    REQUIRE(buffers.K() == 10);
+  }
+}
+
+/**
+ * Make sure that searching with a packed reference tree gives the same results
+ * as with an ordinary tree.
+ */
+TEST_CASE("KNNPackedTreeTest", "[KNNTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 200);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const NeighborSearchMode searchMode = (mode == 0) ? SINGLE_TREE_MODE :
+        DUAL_TREE_MODE;
+
+    KNN::Tree tree(dataset, 20);
+    KNN::Tree packedTree(tree);
+    packedTree.Pack();
+
+    KNN knn(std::move(tree), searchMode);
+    KNN packedKnn(std::move(packedTree), searchMode);
+    REQUIRE(packedKnn.ReferenceTree().IsPacked());
+
+    arma::Mat<size_t> neighbors, packedNeighbors;
+    arma::mat distances, packedDistances;
+    knn.Search(querySet, 5, neighbors, distances);
+    packedKnn.Search(querySet, 5, packedNeighbors, packedDistances);
+
+    CheckMatrices(neighbors, packedNeighbors);
+    CheckMatrices(distances, packedDistances);
+
+    knn.Search(5, neighbors, distances);
+    packedKnn.Search(5, packedNeighbors, packedDistances);
+
+    CheckMatrices(neighbors, packedNeighbors);
+    CheckMatrices(distances, packedDistances);
+  }
+}
+
+/**
+ * Make sure that a kNN model saved in the mapped format can be loaded, that
+ * its reference set uses the mapped memory, and that it gives the same results
+ * as the original model.
+ */
+TEST_CASE("KNNModelMappedTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  KNNModel::TreeTypes treeTypes[] = { KNNModel::KD_TREE,
+      KNNModel::COVER_TREE, KNNModel::R_TREE, KNNModel::BALL_TREE };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    for (size_t r = 0; r < 2; ++r)
+    {
+      KNNModel model(treeTypes[t], (r == 1));
+      model.BuildModel(arma::mat(referenceData), DUAL_TREE_MODE);
+      REQUIRE(model.SaveMapped("knn_model_mapped.bin"));
+
+      KNNModel mappedModel;
+      REQUIRE(mappedModel.LoadMapped("knn_model_mapped.bin"));
+      remove("knn_model_mapped.bin");
+
+      REQUIRE(mappedModel.TreeType() == treeTypes[t]);
+      REQUIRE(mappedModel.RandomBasis() == (r == 1));
+      // The reference set was not copied.
+      REQUIRE(mappedModel.Dataset().mem_state == 1);
+      CheckMatrices(model.Dataset(), mappedModel.Dataset());
+
+      arma::Mat<size_t> neighbors, mappedNeighbors;
+      arma::mat distances, mappedDistances;
+      model.Search(arma::mat(queryData), 3, neighbors, distances);
+      mappedModel.Search(arma::mat(queryData), 3, mappedNeighbors,
+          mappedDistances);
+
+      CheckMatrices(neighbors, mappedNeighbors);
+      CheckMatrices(distances, mappedDistances);
+
+      // A copy of the model still works after the mapped model is gone.
+      KNNModel copy(mappedModel);
+      mappedModel = KNNModel();
+      copy.Search(3, neighbors, distances);
+      model.Search(3, mappedNeighbors, mappedDistances);
+
+      CheckMatrices(neighbors, mappedNeighbors);
+      CheckMatrices(distances, mappedDistances);
+    }
+  }
+}
+
+/**
+ * Make sure that loading a file that is not in the mapped format fails.
+ */
+TEST_CASE("KNNModelMappedWrongFormatTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  KNNModel model;
+  model.BuildModel(arma::randu<arma::mat>(3, 50), DUAL_TREE_MODE);
+  data::Save("knn_model.bin", "model", model);
+
+  KNNModel mappedModel;
+  REQUIRE(!mappedModel.LoadMapped("knn_model.bin"));
+  REQUIRE(!mappedModel.LoadMapped("knn_model_nonexistent.bin"));
+  remove("knn_model.bin");
+}
+
+/**
+ * Make sure that a mapped model whose header does not match this system (a
+ * different version, byte order or word size) is rejected.
+ */
+TEST_CASE("KNNModelMappedWrongHeaderTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  KNNModel model;
+  model.BuildModel(arma::randu<arma::mat>(3, 50), DUAL_TREE_MODE);
+
+  // The version, byte order, uword size and size_t size follow the 8 magic
+  // bytes, as 32-bit integers.
+  for (size_t field = 0; field < 4; ++field)
+  {
+    REQUIRE(model.SaveMapped("knn_model_mapped.bin"));
+
+    std::fstream f("knn_model_mapped.bin",
+        std::fstream::in | std::fstream::out | std::fstream::binary);
+    uint32_t value;
+    f.seekg(8 + 4 * field);
+    f.read((char*) &value, sizeof(value));
+    // Swap the bytes (this changes every field, since none is symmetric).
+    value = ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) |
+        ((value >> 8) & 0xFF00) | (value >> 24);
+    f.seekp(8 + 4 * field);
+    f.write((const char*) &value, sizeof(value));
+    f.close();
+
+    KNNModel mappedModel;
+    REQUIRE(!mappedModel.LoadMapped("knn_model_mapped.bin"));
+    remove("knn_model_mapped.bin");
+  }
+}
+
+/**
+ * Make sure that inserting points into and deleting points from the reference
+ * set of a KNN object gives the same results as building a new one, and that
+ * the reference points keep their indices.
+ */
+TEST_CASE("KNNInsertDeleteTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+  arma::mat querySet = arma::randu<arma::mat>(3, 100);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    const NeighborSearchMode searchMode = (mode == 0) ? DUAL_TREE_MODE :
+        (mode == 1) ? SINGLE_TREE_MODE : NAIVE_MODE;
+
+    // The remaining points, and their indices in the results of knn.
+    arma::mat points(dataset);
+    std::vector<size_t> indices(points.n_cols);
+    for (size_t i = 0; i < indices.size(); ++i)
+      indices[i] = i;
+    size_t numIndices = points.n_cols;
+
+    // NSModel packs the trees it builds; modifying a packed tree unpacks it.
+    KNN knn(points, searchMode);
+    if (searchMode != NAIVE_MODE)
+      knn.ReferenceTree().Pack();
+
+    for (size_t i = 0; i < 300; ++i)
+    {
+      if (i % 3 != 2)
+      {
+        arma::vec point = arma::randu<arma::vec>(3) + 0.3;
+        knn.Insert(point);
+        points.insert_cols(points.n_cols, point);
+        indices.push_back(numIndices++);
+      }
+      else
+      {
+        const size_t j = math::RandInt(points.n_cols);
+        knn.Delete(indices[j]);
+        REQUIRE_THROWS_AS(knn.Delete(indices[j]), std::invalid_argument);
+        points.shed_col(j);
+        indices.erase(indices.begin() + j);
+      }
+    }
+
+    REQUIRE_THROWS_AS(knn.Delete(numIndices), std::invalid_argument);
+
+    KNN naive(points, NAIVE_MODE);
+    arma::Mat<size_t> neighbors, naiveNeighbors;
+    arma::mat distances, naiveDistances;
+    knn.Search(querySet, 5, neighbors, distances);
+    naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+    naiveNeighbors.transform([&](size_t n) { return indices[n]; });
+    CheckMatrices(neighbors, naiveNeighbors);
+    CheckMatrices(distances, naiveDistances);
+
+    // The monochromatic search has a column for every index; the columns of
+    // deleted points are empty.
+    knn.Search(5, neighbors, distances);
+    naive.Search(5, naiveNeighbors, naiveDistances);
+
+    REQUIRE(neighbors.n_cols == numIndices);
+    REQUIRE(distances.n_cols == numIndices);
+    for (size_t j = 0; j < points.n_cols; ++j)
+    {
+      for (size_t k = 0; k < 5; ++k)
+      {
+        REQUIRE(neighbors(k, indices[j]) == indices[naiveNeighbors(k, j)]);
+        REQUIRE(distances(k, indices[j]) ==
+            Approx(naiveDistances(k, j)).epsilon(1e-7));
+      }
+    }
+    REQUIRE(arma::accu(neighbors == SIZE_MAX) ==
+        5 * (numIndices - points.n_cols));
+
+    REQUIRE(knn.ReferenceSet().n_cols == points.n_cols);
+  }
+}
+
+/**
+ * Make sure that a kNN model that holds its reference set in single precision
+ * gives the same results as a model that holds it in double precision, and
+ * that with verification the distances are those computed in double precision.
+ */
+TEST_CASE("KNNModelSinglePrecisionTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  // All points can be represented exactly in single precision.
+  arma::mat queryData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 50));
+  arma::mat referenceData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 200));
+
+  KNNModel::TreeTypes treeTypes[] = { KNNModel::KD_TREE, KNNModel::RP_TREE,
+      KNNModel::MAX_RP_TREE };
+  for (size_t t = 0; t < 3; ++t)
+  {
+    KNNModel model(treeTypes[t]);
+    model.BuildModel(arma::mat(referenceData), DUAL_TREE_MODE);
+
+    KNNModel floatModel(treeTypes[t], false, true);
+    floatModel.BuildModel(arma::mat(referenceData), DUAL_TREE_MODE);
+
+    REQUIRE(floatModel.SinglePrecision());
+    REQUIRE(floatModel.Dimensionality() == 10);
+    REQUIRE(floatModel.NumPoints() == 200);
+    REQUIRE(floatModel.FloatDataset().n_cols == 200);
+
+    // The dataset can still be accessed in double precision; it is converted
+    // once.
+    const arma::mat& floatModelDataset = floatModel.Dataset();
+    REQUIRE(&floatModel.Dataset() == &floatModelDataset);
+    REQUIRE(arma::approx_equal(floatModelDataset,
+        arma::conv_to<arma::mat>::from(floatModel.FloatDataset()), "absdiff",
+        0.0));
+    REQUIRE(arma::approx_equal(model.FloatDataset(),
+        arma::conv_to<arma::fmat>::from(model.Dataset()), "absdiff", 0.0));
+
+    arma::Mat<size_t> neighbors, floatNeighbors;
+    arma::mat distances, floatDistances;
+    model.Search(arma::mat(queryData), 3, neighbors, distances);
+    floatModel.Search(arma::mat(queryData), 3, floatNeighbors, floatDistances);
+
+    REQUIRE(floatDistances.n_rows == distances.n_rows);
+    REQUIRE(floatDistances.n_cols == distances.n_cols);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      REQUIRE(floatDistances[i] == Approx(distances[i]).epsilon(1e-5));
+
+    // With verification, the results are the same as in double precision.
+    floatModel.VerifyDistances() = true;
+    floatModel.Search(arma::mat(queryData), 3, floatNeighbors, floatDistances);
+    CheckMatrices(neighbors, floatNeighbors);
+    CheckMatrices(distances, floatDistances, 1e-10);
+
+    model.Search(3, neighbors, distances);
+    floatModel.Search(3, floatNeighbors, floatDistances);
+    CheckMatrices(neighbors, floatNeighbors);
+    CheckMatrices(distances, floatDistances, 1e-10);
+
+    // The model can be saved and loaded, and still holds single-precision data.
+    REQUIRE(floatModel.SaveMapped("knn_model_float.bin"));
+    KNNModel mappedModel;
+    REQUIRE(mappedModel.LoadMapped("knn_model_float.bin"));
+    remove("knn_model_float.bin");
+
+    REQUIRE(mappedModel.SinglePrecision());
+    REQUIRE(mappedModel.FloatDataset().mem_state == 1);
+    mappedModel.VerifyDistances() = true;
+    mappedModel.Search(arma::mat(queryData), 3, floatNeighbors,
+        floatDistances);
+    model.Search(arma::mat(queryData), 3, neighbors, distances);
+    CheckMatrices(neighbors, floatNeighbors);
+    CheckMatrices(distances, floatDistances, 1e-10);
+  }
+
+  // Other tree types cannot hold single-precision data.
+  REQUIRE_THROWS_AS(KNNModel(KNNModel::COVER_TREE, false, true),
+      std::invalid_argument);
+  KNNModel coverModel(KNNModel::COVER_TREE);
+  coverModel.SinglePrecision() = true;
+  REQUIRE_THROWS_AS(coverModel.BuildModel(arma::mat(referenceData),
+      DUAL_TREE_MODE), std::invalid_argument);
+}
+
+/**
+ * Make sure that copies of NeighborSearchRules have their own candidate lists,
+ * and that candidate lists are only shared when that is asked for.
+ */
+TEST_CASE("KNNRulesCopyTest", "[KNNTest]")
+{
+  typedef KNN::RuleType RuleType;
+
+  arma::mat referenceData("1 2 3;"
+                          "0 0 0");
+  arma::mat queryData("0 5;"
+                      "0 0");
+  EuclideanDistance metric;
+
+  RuleType rules(referenceData, queryData, 1, metric);
+  rules.BaseCase(0, 2);
+
+  // The copy starts from the same candidates, but doesn't change the original.
+  RuleType copy(rules);
+  copy.BaseCase(0, 1);
+
+  // A sharing object changes the candidates of the original.
+  RuleType shared(rules, true /* share candidates */);
+  shared.BaseCase(1, 2);
+
+  // A non-sharing object starts from empty candidates.
+  RuleType unshared(rules, false /* don't share candidates */);
+  unshared.BaseCase(1, 0);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  rules.GetResults(neighbors, distances);
+  REQUIRE(neighbors(0, 0) == 2);
+  REQUIRE(neighbors(0, 1) == 2);
+
+  copy.GetResults(neighbors, distances);
+  REQUIRE(neighbors(0, 0) == 1);
+  REQUIRE(neighbors(0, 1) == size_t() - 1);
+
+  unshared.GetResults(neighbors, distances);
+  REQUIRE(neighbors(0, 0) == size_t() - 1);
+  REQUIRE(neighbors(0, 1) == 0);
+}
@@ -991,3 +991,318 @@ TEST_CASE("SparseLSHTest", "[LSHTest]")
     REQUIRE(!std::isnan(sparseDistances[i]));
   }
 }
+
+/**
+ * Make sure that every point is stored in the second hash table once for each
+ * table when the bucket size is not limited, that no bucket holds more than
+ * bucketSize points otherwise, and that the candidates of a query do not hold
+ * duplicates.
+ */
+TEST_CASE("LSHBucketLayoutTest", "[LSHTest]")
+{
+  const size_t numTables = 8;
+  const size_t secondHashSize = 997;
+  arma::mat rdata = arma::randu<arma::mat>(5, 1000);
+
+  LSHSearch<> lsh(rdata, 3, numTables, 0.0, secondHashSize, 0);
+
+  const arma::Col<size_t>& bucketOffsets = lsh.BucketOffsets();
+  const arma::Col<uint32_t>& bucketContents = lsh.BucketContents();
+  REQUIRE(bucketOffsets.n_elem == secondHashSize + 1);
+  REQUIRE(bucketOffsets[0] == 0);
+  REQUIRE(bucketOffsets[secondHashSize] == bucketContents.n_elem);
+  REQUIRE(bucketContents.n_elem == numTables * rdata.n_cols);
+
+  arma::Col<size_t> counts(rdata.n_cols, arma::fill::zeros);
+  for (size_t h = 0; h < secondHashSize; ++h)
+  {
+    REQUIRE(bucketOffsets[h] <= bucketOffsets[h + 1]);
+    for (size_t j = bucketOffsets[h]; j < bucketOffsets[h + 1]; ++j)
+      counts[bucketContents[j]]++;
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    REQUIRE(counts[i] == numTables);
+
+  // Now limit the bucket size.
+  lsh.Train(rdata, 3, numTables, 0.0, secondHashSize, 5);
+  REQUIRE(lsh.BucketOffsets()[secondHashSize] ==
+      lsh.BucketContents().n_elem);
+  for (size_t h = 0; h < secondHashSize; ++h)
+    REQUIRE(lsh.BucketOffsets()[h + 1] - lsh.BucketOffsets()[h] <= 5);
+
+  // Search with many probes, so that most points are found more than once;
+  // each neighbor should still only be returned once.
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Train(rdata, 3, numTables, 0.0, secondHashSize, 0);
+  lsh.Search(arma::randu<arma::mat>(5, 20), 10, neighbors, distances, 0, 5);
+  for (size_t q = 0; q < neighbors.n_cols; ++q)
+  {
+    for (size_t i = 0; i < neighbors.n_rows; ++i)
+    {
+      if (neighbors(i, q) == rdata.n_cols)
+        continue;
+
+      for (size_t j = i + 1; j < neighbors.n_rows; ++j)
+        REQUIRE(neighbors(i, q) != neighbors(j, q));
+    }
+  }
+}
+
+/**
+ * The layout of LSHSearch models saved before the second hash table was
+ * flattened (class version 0).
+ */
+struct LSHSearchVersion0
+{
+  arma::mat referenceSet;
+  size_t numProj;
+  size_t numTables;
+  arma::cube projections;
+  arma::mat offsets;
+  double hashWidth;
+  size_t secondHashSize;
+  arma::vec secondHashWeights;
+  size_t bucketSize;
+  std::vector<arma::Col<size_t>> secondHashTable;
+  arma::Col<size_t> bucketContentSize;
+  arma::Col<size_t> bucketRowInHashTable;
+  size_t distanceEvaluations;
+
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */)
+  {
+    ar(CEREAL_NVP(referenceSet));
+    ar(CEREAL_NVP(numProj));
+    ar(CEREAL_NVP(numTables));
+    ar(CEREAL_NVP(projections));
+    ar(CEREAL_NVP(offsets));
+    ar(CEREAL_NVP(hashWidth));
+    ar(CEREAL_NVP(secondHashSize));
+    ar(CEREAL_NVP(secondHashWeights));
+    ar(CEREAL_NVP(bucketSize));
+    ar(CEREAL_NVP(secondHashTable));
+    ar(CEREAL_NVP(bucketContentSize));
+    ar(CEREAL_NVP(bucketRowInHashTable));
+    ar(CEREAL_NVP(distanceEvaluations));
+  }
+};
+
+/**
+ * Make sure that a model saved in the old format, with one row per occupied
+ * bucket, is converted to the flat layout when it is loaded.
+ */
+TEST_CASE("LSHLoadVersion0Test", "[LSHTest]")
+{
+  const size_t numTables = 6;
+  const size_t secondHashSize = 503;
+  arma::mat rdata = arma::randu<arma::mat>(4, 800);
+
+  LSHSearch<> lsh(rdata, 4, numTables, 1.5, secondHashSize, 0);
+
+  // Rebuild the old table from the new one.  Occupied buckets are given rows
+  // in reverse order, to make sure the conversion follows
+  // bucketRowInHashTable.
+  LSHSearchVersion0 old;
+  old.referenceSet = rdata;
+  old.numProj = 4;
+  old.numTables = numTables;
+  old.projections = lsh.Projections();
+  old.offsets = lsh.Offsets();
+  old.hashWidth = 1.5;
+  old.secondHashSize = secondHashSize;
+  old.secondHashWeights = lsh.SecondHashWeights();
+  old.bucketSize = lsh.BucketSize();
+  old.bucketRowInHashTable.set_size(secondHashSize);
+  old.bucketRowInHashTable.fill(secondHashSize);
+  old.distanceEvaluations = 0;
+
+  const arma::Col<size_t>& bucketOffsets = lsh.BucketOffsets();
+  const arma::Col<uint32_t>& bucketContents = lsh.BucketContents();
+  for (size_t h = secondHashSize; h > 0; --h)
+  {
+    const size_t begin = bucketOffsets[h - 1];
+    const size_t end = bucketOffsets[h];
+    if (begin == end)
+      continue;
+
+    old.bucketRowInHashTable[h - 1] = old.secondHashTable.size();
+    arma::Col<size_t> row(end - begin + 3, arma::fill::zeros);
+    for (size_t j = begin; j < end; ++j)
+      row[j - begin] = bucketContents[j];
+    old.secondHashTable.push_back(row);
+  }
+
+  old.bucketContentSize.set_size(old.secondHashTable.size());
+  for (size_t h = 0; h < secondHashSize; ++h)
+  {
+    if (old.bucketRowInHashTable[h] < secondHashSize)
+    {
+      old.bucketContentSize[old.bucketRowInHashTable[h]] =
+          bucketOffsets[h + 1] - bucketOffsets[h];
+    }
+  }
+
+  std::stringstream stream;
+  {
+    cereal::BinaryOutputArchive ar(stream);
+    ar(cereal::make_nvp("lsh", old));
+  }
+
+  LSHSearch<> loaded;
+  {
+    cereal::BinaryInputArchive ar(stream);
+    ar(cereal::make_nvp("lsh", loaded));
+  }
+
+  REQUIRE(loaded.BucketOffsets().n_elem == bucketOffsets.n_elem);
+  REQUIRE(loaded.BucketContents().n_elem == bucketContents.n_elem);
+  for (size_t i = 0; i < bucketOffsets.n_elem; ++i)
+    REQUIRE(loaded.BucketOffsets()[i] == bucketOffsets[i]);
+  for (size_t i = 0; i < bucketContents.n_elem; ++i)
+    REQUIRE(loaded.BucketContents()[i] == bucketContents[i]);
+
+  // No points could be removed from old models.
+  REQUIRE(loaded.NumRemoved() == 0);
+  for (size_t i = 0; i < rdata.n_cols; ++i)
+    REQUIRE(!loaded.IsRemoved(i));
+  REQUIRE_THROWS_AS(loaded.IsRemoved(rdata.n_cols), std::invalid_argument);
+
+  arma::mat qdata = arma::randu<arma::mat>(4, 50);
+  arma::Mat<size_t> neighbors, loadedNeighbors;
+  arma::mat distances, loadedDistances;
+  lsh.Search(qdata, 5, neighbors, distances);
+  loaded.Search(qdata, 5, loadedNeighbors, loadedDistances);
+
+  CheckMatrices(neighbors, loadedNeighbors);
+  CheckMatrices(distances, loadedDistances);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that the hash table built with many threads is the same as the
+ * hash table built with one thread.
+ */
+TEST_CASE("ParallelBuildTest", "[LSHTest]")
+{
+  arma::mat rdata = arma::randu<arma::mat>(10, 5000);
+
+  math::RandomSeed(42);
+  LSHSearch<> parallelLSH(rdata, 4, 20, 0.0, 99901, 50);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  math::RandomSeed(42);
+  LSHSearch<> sequentialLSH(rdata, 4, 20, 0.0, 99901, 50);
+  omp_set_num_threads(prevNumThreads);
+
+  CheckMatrices(parallelLSH.BucketOffsets(), sequentialLSH.BucketOffsets());
+  REQUIRE(parallelLSH.BucketContents().n_elem ==
+      sequentialLSH.BucketContents().n_elem);
+  REQUIRE(arma::all(parallelLSH.BucketContents() ==
+      sequentialLSH.BucketContents()));
+}
+#endif
+
+/**
+ * Make sure that inserting points into a trained model gives the same hash
+ * table as training on all points at once.
+ */
+TEST_CASE("LSHInsertTest", "[LSHTest]")
+{
+  arma::mat rdata = arma::randu<arma::mat>(5, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(5, 50);
+  arma::cube projections = arma::randn<arma::cube>(5, 3, 10);
+
+  math::RandomSeed(10);
+  LSHSearch<> lsh(rdata, projections, 0.5, 997, 0);
+
+  math::RandomSeed(10);
+  LSHSearch<> insertLSH(rdata.cols(0, 699), projections, 0.5, 997, 0);
+  insertLSH.Insert(rdata.cols(700, 899));
+  insertLSH.Insert(rdata.cols(900, 999));
+
+  REQUIRE(insertLSH.ReferenceSet().n_cols == 1000);
+  CheckMatrices(lsh.BucketOffsets(), insertLSH.BucketOffsets());
+
+  // The order of points in each bucket may be different.
+  for (size_t h = 0; h < 997; ++h)
+  {
+    const size_t begin = lsh.BucketOffsets()[h];
+    const size_t end = lsh.BucketOffsets()[h + 1];
+    if (begin == end)
+      continue;
+
+    arma::Col<uint32_t> bucket = arma::sort(
+        lsh.BucketContents().subvec(begin, end - 1));
+    arma::Col<uint32_t> insertBucket = arma::sort(
+        insertLSH.BucketContents().subvec(begin, end - 1));
+    REQUIRE(arma::all(bucket == insertBucket));
+  }
+
+  arma::Mat<size_t> neighbors, insertNeighbors;
+  arma::mat distances, insertDistances;
+  lsh.Search(qdata, 3, neighbors, distances);
+  insertLSH.Search(qdata, 3, insertNeighbors, insertDistances);
+
+  CheckMatrices(neighbors, insertNeighbors);
+  CheckMatrices(distances, insertDistances);
+
+  // Points can't be inserted into an untrained model, and must have the right
+  // dimensionality.
+  LSHSearch<> emptyLSH;
+  REQUIRE_THROWS_AS(emptyLSH.Insert(rdata), std::invalid_argument);
+  REQUIRE_THROWS_AS(insertLSH.Insert(arma::randu<arma::mat>(4, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that removed points are never returned by a search, and that they
+ * are dropped from the hash table by the next insertion.
+ */
+TEST_CASE("LSHRemoveTest", "[LSHTest]")
+{
+  arma::mat rdata = arma::randu<arma::mat>(5, 1000);
+  arma::mat qdata = arma::randu<arma::mat>(5, 50);
+
+  LSHSearch<> lsh(rdata, 3, 10, 0.0, 997, 0);
+
+  // Remove every other point, some of them twice.
+  for (size_t i = 0; i < rdata.n_cols; i += 2)
+    lsh.Remove(i);
+  for (size_t i = 0; i < rdata.n_cols; i += 4)
+    lsh.Remove(i);
+
+  REQUIRE(lsh.NumRemoved() == 500);
+  REQUIRE(lsh.IsRemoved(0));
+  REQUIRE(!lsh.IsRemoved(1));
+  REQUIRE_THROWS_AS(lsh.Remove(1000), std::invalid_argument);
+  REQUIRE_THROWS_AS(lsh.IsRemoved(1000), std::invalid_argument);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  lsh.Search(qdata, 5, neighbors, distances, 0, 3);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    REQUIRE((neighbors[i] == rdata.n_cols || neighbors[i] % 2 == 1));
+
+  lsh.Search(5, neighbors, distances, 0, 3);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    REQUIRE((neighbors[i] == rdata.n_cols || neighbors[i] % 2 == 1));
+
+  // Inserting points drops the removed points from the hash table, but not
+  // from the reference set.
+  lsh.Insert(arma::randu<arma::mat>(5, 100));
+  REQUIRE(lsh.ReferenceSet().n_cols == 1100);
+  REQUIRE(lsh.BucketContents().n_elem == 10 * 600);
+  for (size_t i = 0; i < lsh.BucketContents().n_elem; ++i)
+  {
+    const size_t index = lsh.BucketContents()[i];
+    REQUIRE((index >= 1000 || index % 2 == 1));
+  }
+
+  // Training again clears the removals.
+  lsh.Train(rdata, 3, 10, 0.0, 997, 0);
+  REQUIRE(lsh.NumRemoved() == 0);
+  REQUIRE(lsh.BucketContents().n_elem == 10 * 1000);
+}
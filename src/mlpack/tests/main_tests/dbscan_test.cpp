@@ -435,6 +435,40 @@ TEST_CASE_METHOD(DBSCANTestFixture, "DBSCANNaiveSearchTest",
   CheckMatrices(output, naiveOutput);
 }
 
+/**
+ * Check that the assignment of cluster is same if
+ * a grid is used instead of range search.
+ */
+TEST_CASE_METHOD(DBSCANTestFixture, "DBSCANGridTest",
+                 "[DBSCANMainTest][BindingTests]")
+{
+  arma::mat inputData(2, 1000, arma::fill::randu);
+
+  SetInputParam("input", inputData);
+  SetInputParam("epsilon", (double) 0.04);
+
+  mlpackMain();
+
+  arma::Row<size_t> output;
+  output = std::move(IO::GetParam<arma::Row<size_t>>("assignments"));
+
+  bindings::tests::CleanMemory();
+
+  IO::GetSingleton().Parameters()["input"].wasPassed = false;
+  IO::GetSingleton().Parameters()["epsilon"].wasPassed = false;
+
+  SetInputParam("input", inputData);
+  SetInputParam("epsilon", (double) 0.04);
+  SetInputParam("grid", true);
+
+  mlpackMain();
+
+  arma::Row<size_t> gridOutput;
+  gridOutput = std::move(IO::GetParam<arma::Row<size_t>>("assignments"));
+
+  CheckMatrices(output, gridOutput);
+}
+
 /**
  * Check that the assignment of cluster is different if
  * point selection policies are different.
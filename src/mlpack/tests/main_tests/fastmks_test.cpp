@@ -349,6 +349,43 @@ TEST_CASE_METHOD(FastMKSTestFixture, "FastMKSTreeTest",
       IO::GetParam<arma::mat>("kernels"));
 }
 
+/*
+ * Ensure that parallel search returns the same result as serial search.
+ */
+TEST_CASE_METHOD(FastMKSTestFixture, "FastMKSParallelTest",
+                 "[FastMKSMainTest][BindingTests]")
+{
+  // 500 points in 3 dimensions.
+  arma::mat referenceData(3, 500, arma::fill::randu);
+
+  // Random input, some k <= number of reference points.
+  SetInputParam("reference", referenceData);
+  SetInputParam("k", (int) 10);
+
+  mlpackMain();
+
+  arma::Mat<size_t> indices;
+  arma::mat kernel;
+  indices = std::move(IO::GetParam<arma::Mat<size_t>>("indices"));
+  kernel = std::move(IO::GetParam<arma::mat>("kernels"));
+
+  bindings::tests::CleanMemory();
+
+  IO::GetSingleton().Parameters()["reference"].wasPassed = false;
+  IO::GetSingleton().Parameters()["k"].wasPassed = false;
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("k", (int) 10);
+  SetInputParam("parallel", true);
+
+  mlpackMain();
+
+  CheckMatrices(indices,
+      IO::GetParam<arma::Mat<size_t>>("indices"));
+  CheckMatrices(kernel,
+      IO::GetParam<arma::mat>("kernels"));
+}
+
 /*
  * Ensure that we get almost same results in cover tree search mode when
  * different basis is specified.
@@ -574,3 +574,81 @@ TEST_CASE_METHOD(KDETestFixture, "KDEMainMonteCarloFlag",
   const double sumDifferences = arma::accu(differences);
   REQUIRE(sumDifferences > 0);
 }
+
+/**
+ * Ensure that the parallel evaluation gives estimations within the error
+ * tolerance of the serial evaluation.
+ */
+TEST_CASE_METHOD(KDETestFixture, "KDEMainParallelFlag",
+                "[KDEMainTest][BindingTests]")
+{
+  // Datasets.
+  arma::mat reference = arma::randu(2, 2000);
+  arma::mat query = arma::randu(2, 500);
+  arma::vec serialEstimations, parallelEstimations;
+  const double relError = 0.05;
+
+  // Compute the serial estimations.
+  SetInputParam("reference", arma::mat(reference));
+  SetInputParam("query", arma::mat(query));
+  SetInputParam("bandwidth", 0.1);
+  SetInputParam("rel_error", relError);
+  mlpackMain();
+  serialEstimations = std::move(IO::GetParam<arma::vec>("predictions"));
+
+  delete IO::GetParam<KDEModel*>("output_model");
+
+  // Compute the parallel estimations.
+  SetInputParam("reference", reference);
+  SetInputParam("query", query);
+  SetInputParam("parallel", true);
+  mlpackMain();
+  parallelEstimations = std::move(IO::GetParam<arma::vec>("predictions"));
+
+  // Both are within relError of the true values.
+  REQUIRE(parallelEstimations.n_elem == query.n_cols);
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    REQUIRE(parallelEstimations[i] ==
+        Approx(serialEstimations[i]).epsilon(2 * relError));
+  }
+}
+
+/**
+ * Ensure that series expansions give estimations within the error tolerance
+ * of the evaluation without them.
+ */
+TEST_CASE_METHOD(KDETestFixture, "KDEMainSeriesExpansionFlag",
+                "[KDEMainTest][BindingTests]")
+{
+  // Datasets.
+  arma::mat reference = arma::randu(3, 2000);
+  arma::mat query = arma::randu(3, 500);
+  arma::vec exactEstimations, seriesEstimations;
+  const double relError = 0.05;
+
+  // Compute the estimations without series expansions.
+  SetInputParam("reference", arma::mat(reference));
+  SetInputParam("query", arma::mat(query));
+  SetInputParam("bandwidth", 0.5);
+  SetInputParam("rel_error", relError);
+  mlpackMain();
+  exactEstimations = std::move(IO::GetParam<arma::vec>("predictions"));
+
+  delete IO::GetParam<KDEModel*>("output_model");
+
+  // Compute the estimations with series expansions.
+  SetInputParam("reference", reference);
+  SetInputParam("query", query);
+  SetInputParam("series_expansion", true);
+  mlpackMain();
+  seriesEstimations = std::move(IO::GetParam<arma::vec>("predictions"));
+
+  // Both are within relError of the true values.
+  REQUIRE(seriesEstimations.n_elem == query.n_cols);
+  for (size_t i = 0; i < query.n_cols; ++i)
+  {
+    REQUIRE(seriesEstimations[i] ==
+        Approx(exactEstimations[i]).epsilon(2 * relError));
+  }
+}
@@ -162,3 +162,66 @@ TEST_CASE("GaussianClustering", "[MeanShiftTest]")
 
   REQUIRE(success == true);
 }
+
+/**
+ * Make sure that shifting the seeds in parallel gives the same clusters as
+ * shifting them serially.
+ */
+TEST_CASE("ParallelMeanShiftTest", "[MeanShiftTest]")
+{
+  const arma::mat data = trans(meanShiftData);
+  MeanShift<> meanShift;
+
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  meanShift.Cluster(data, assignments, centroids);
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  meanShift.Parallel() = true;
+  arma::Row<size_t> parallelAssignments;
+  arma::mat parallelCentroids;
+  meanShift.Cluster(data, parallelAssignments, parallelCentroids);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  REQUIRE(parallelCentroids.n_cols == 3);
+  REQUIRE(parallelCentroids.n_rows == centroids.n_rows);
+  REQUIRE(parallelCentroids.n_cols == centroids.n_cols);
+  CheckMatrices(centroids, parallelCentroids);
+  for (size_t i = 0; i < assignments.n_elem; ++i)
+    REQUIRE(parallelAssignments[i] == assignments[i]);
+}
+
+/**
+ * With more centroids than neighboring grid cells, duplicate centroids are
+ * found with the hash grid; make sure each cluster still gets one centroid.
+ */
+TEST_CASE("MeanShiftManyClustersTest", "[MeanShiftTest]")
+{
+  // 25 small clusters of 20 points each on a 5x5 lattice.
+  arma::mat dataset(2, 500);
+  for (size_t c = 0; c < 25; ++c)
+  {
+    arma::vec center = { 10.0 * (c % 5), 10.0 * (c / 5) };
+    for (size_t i = 0; i < 20; ++i)
+      dataset.col(20 * c + i) = center + 0.2 * arma::randu<arma::vec>(2);
+  }
+
+  MeanShift<> meanShift(1.0);
+  meanShift.Parallel() = true;
+
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  meanShift.Cluster(dataset, assignments, centroids, true, false);
+
+  REQUIRE(centroids.n_cols == 25);
+  for (size_t c = 0; c < 25; ++c)
+    for (size_t i = 1; i < 20; ++i)
+      REQUIRE(assignments[20 * c + i] == assignments[20 * c]);
+}
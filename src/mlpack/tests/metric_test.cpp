@@ -97,6 +97,85 @@ TEST_CASE("LINFMetricTest", "[MetricTest]")
       Approx(lMetric.Evaluate(a2, b2)).epsilon(1e-7));
 }
 
+/**
+ * Make sure the unrolled L-metric kernels used for contiguous vectors give the
+ * same results as Armadillo expressions, for every remainder of the unrolled
+ * loop and for both float and double.
+ */
+template<typename ElemType>
+void CheckDistanceKernels()
+{
+  typedef arma::Mat<ElemType> MatType;
+  typedef arma::Col<ElemType> VecType;
+
+  for (size_t dim = 1; dim < 38; ++dim)
+  {
+    MatType data(dim, 2, arma::fill::randn);
+    const VecType a = data.col(0);
+    const VecType b = data.col(1);
+
+    const double l1 = arma::accu(arma::abs(a - b));
+    const double l2 = arma::accu(arma::square(a - b));
+    const double linf = arma::max(arma::abs(a - b));
+
+    // Both the vector and subview paths use the kernels.
+    REQUIRE(ManhattanDistance::Evaluate(a, b) == Approx(l1).epsilon(1e-5));
+    REQUIRE(ManhattanDistance::Evaluate(data.col(0), data.col(1)) ==
+        Approx(l1).epsilon(1e-5));
+    REQUIRE(SquaredEuclideanDistance::Evaluate(a, b) ==
+        Approx(l2).epsilon(1e-5));
+    REQUIRE(SquaredEuclideanDistance::Evaluate(data.col(0), b) ==
+        Approx(l2).epsilon(1e-5));
+    REQUIRE(EuclideanDistance::Evaluate(a, data.col(1)) ==
+        Approx(std::sqrt(l2)).epsilon(1e-5));
+    REQUIRE(ChebyshevDistance::Evaluate(a, b) == Approx(linf).epsilon(1e-5));
+    REQUIRE(ChebyshevDistance::Evaluate(data.col(0), data.col(1)) ==
+        Approx(linf).epsilon(1e-5));
+
+    // Expressions still use Armadillo.
+    REQUIRE(SquaredEuclideanDistance::Evaluate(a, 2 * b - b) ==
+        Approx(l2).epsilon(1e-5));
+  }
+}
+
+TEST_CASE("LMetricKernelTest", "[MetricTest]")
+{
+  CheckDistanceKernels<double>();
+  CheckDistanceKernels<float>();
+}
+
+/**
+ * Make sure the L-metric kernels reject vectors of different sizes, and that
+ * the L-infinity kernel does not drop NaNs.
+ */
+TEST_CASE("LMetricKernelEdgeCaseTest", "[MetricTest]")
+{
+  arma::vec a(10, arma::fill::randu);
+  arma::vec b(9, arma::fill::randu);
+
+  // Like Armadillo, the sizes are only checked without ARMA_NO_DEBUG.
+  #ifndef ARMA_NO_DEBUG
+  REQUIRE_THROWS_AS(ManhattanDistance::Evaluate(a, b), std::invalid_argument);
+  REQUIRE_THROWS_AS(SquaredEuclideanDistance::Evaluate(a, b),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(EuclideanDistance::Evaluate(a, b), std::invalid_argument);
+  REQUIRE_THROWS_AS(ChebyshevDistance::Evaluate(a, b), std::invalid_argument);
+  #endif
+
+  // Put the NaN at every position of the unrolled loop.
+  b.randu(10);
+  for (size_t i = 0; i < a.n_elem; ++i)
+  {
+    arma::vec c(b);
+    c[i] = arma::datum::nan;
+
+    REQUIRE(std::isnan(ChebyshevDistance::Evaluate(a, c)));
+    REQUIRE(std::isnan(ChebyshevDistance::Evaluate(c, a)));
+    REQUIRE(std::isnan(ManhattanDistance::Evaluate(a, c)));
+    REQUIRE(std::isnan(EuclideanDistance::Evaluate(a, c)));
+  }
+}
+
 /**
  * Simple test for IoU metric.
  */
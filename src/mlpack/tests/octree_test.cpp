@@ -346,3 +346,56 @@ TEST_CASE("OctreeSerializationTest", "[OctreeTest]")
   delete binaryTree;
   delete jsonTree;
 }
+
+/**
+ * Make sure that packing an octree keeps its structure, and stores the nodes
+ * and the ranges of their bounds contiguously in breadth-first order.
+ */
+TEST_CASE("OctreePackTest", "[OctreeTest]")
+{
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  Octree<> t(dataset, 10);
+  Octree<> packed(t);
+
+  REQUIRE(!packed.IsPacked());
+  packed.Pack();
+  REQUIRE(packed.IsPacked());
+  CheckSameNode(t, packed);
+
+  std::vector<const Octree<>*> nodes;
+  for (size_t i = 0; i < packed.NumChildren(); ++i)
+    nodes.push_back(&packed.Child(i));
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (i > 0)
+    {
+      REQUIRE(nodes[i] == nodes[i - 1] + 1);
+      REQUIRE(&nodes[i]->Bound()[0] == &nodes[i - 1]->Bound()[0] + 3);
+    }
+    REQUIRE(nodes[i]->Bound().IsPacked());
+
+    for (size_t j = 0; j < nodes[i]->NumChildren(); ++j)
+    {
+      REQUIRE(nodes[i]->Child(j).Parent() == nodes[i]);
+      nodes.push_back(&nodes[i]->Child(j));
+    }
+  }
+
+  REQUIRE_THROWS_AS(packed.Child(0).Pack(), std::invalid_argument);
+
+  // Copies are ordinary trees; moves keep the packed nodes.
+  Octree<> copied(packed);
+  REQUIRE(!copied.IsPacked());
+  CheckSameNode(t, copied);
+
+  Octree<> moved(std::move(packed));
+  REQUIRE(moved.IsPacked());
+  REQUIRE(!packed.IsPacked());
+  REQUIRE(moved.Child(0).Parent() == &moved);
+  CheckSameNode(t, moved);
+
+  moved.Unpack();
+  REQUIRE(!moved.IsPacked());
+  REQUIRE(!moved.Child(0).Bound().IsPacked());
+  CheckSameNode(t, moved);
+}
@@ -1714,3 +1714,352 @@ TEST_CASE("MoveOperatorNaiveTest", "[RangeSearchTest]")
     }
   }
 }
+
+/**
+ * Make sure that a range search model saved in the mapped format can be
+ * loaded, and that it gives the same results as the original model.
+ */
+TEST_CASE("RSModelMappedTest", "[RangeSearchTest]")
+{
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  RSModel::TreeTypes treeTypes[] = { RSModel::KD_TREE, RSModel::COVER_TREE,
+      RSModel::R_TREE, RSModel::BALL_TREE };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    RSModel model(treeTypes[t], false);
+    model.BuildModel(arma::mat(referenceData), 5, false, false);
+    REQUIRE(model.SaveMapped("rs_model_mapped.bin"));
+
+    RSModel mappedModel;
+    REQUIRE(mappedModel.LoadMapped("rs_model_mapped.bin"));
+    remove("rs_model_mapped.bin");
+
+    REQUIRE(mappedModel.TreeType() == treeTypes[t]);
+    REQUIRE(mappedModel.Dataset().mem_state == 1);
+    CheckMatrices(model.Dataset(), mappedModel.Dataset());
+
+    vector<vector<size_t>> neighbors, mappedNeighbors;
+    vector<vector<double>> distances, mappedDistances;
+    model.Search(arma::mat(queryData), math::Range(0.25, 0.75), neighbors,
+        distances);
+    mappedModel.Search(arma::mat(queryData), math::Range(0.25, 0.75),
+        mappedNeighbors, mappedDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, mappedSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(mappedNeighbors, mappedDistances, mappedSorted);
+
+    REQUIRE(sorted.size() == mappedSorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      REQUIRE(sorted[i].size() == mappedSorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        REQUIRE(sorted[i][j].second == mappedSorted[i][j].second);
+        REQUIRE(sorted[i][j].first ==
+            Approx(mappedSorted[i][j].first).epsilon(1e-7));
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that a range search model that holds its reference set in single
+ * precision finds the same points as a model that holds it in double
+ * precision.
+ */
+TEST_CASE("RSModelSinglePrecisionTest", "[RangeSearchTest]")
+{
+  // All points can be represented exactly in single precision.
+  arma::mat queryData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 50));
+  arma::mat referenceData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 200));
+
+  RSModel::TreeTypes treeTypes[] = { RSModel::KD_TREE, RSModel::RP_TREE,
+      RSModel::MAX_RP_TREE };
+  for (size_t t = 0; t < 3; ++t)
+  {
+    RSModel model(treeTypes[t]);
+    model.BuildModel(arma::mat(referenceData), 5, false, false);
+
+    RSModel floatModel(treeTypes[t], false, true);
+    floatModel.BuildModel(arma::mat(referenceData), 5, false, false);
+    floatModel.VerifyDistances() = true;
+
+    REQUIRE(floatModel.Dimensionality() == 10);
+    REQUIRE(floatModel.NumPoints() == 200);
+
+    // The dataset can still be accessed in double precision; it is converted
+    // once.
+    const arma::mat& floatModelDataset = floatModel.Dataset();
+    REQUIRE(&floatModel.Dataset() == &floatModelDataset);
+    REQUIRE(arma::approx_equal(floatModelDataset,
+        arma::conv_to<arma::mat>::from(floatModel.FloatDataset()), "absdiff",
+        0.0));
+    REQUIRE(arma::approx_equal(model.FloatDataset(),
+        arma::conv_to<arma::fmat>::from(model.Dataset()), "absdiff", 0.0));
+
+    vector<vector<size_t>> neighbors, floatNeighbors;
+    vector<vector<double>> distances, floatDistances;
+    model.Search(arma::mat(queryData), math::Range(0.25, 1.0), neighbors,
+        distances);
+    floatModel.Search(arma::mat(queryData), math::Range(0.25, 1.0),
+        floatNeighbors, floatDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, floatSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(floatNeighbors, floatDistances, floatSorted);
+
+    REQUIRE(sorted.size() == floatSorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      REQUIRE(sorted[i].size() == floatSorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        REQUIRE(sorted[i][j].second == floatSorted[i][j].second);
+        REQUIRE(sorted[i][j].first ==
+            Approx(floatSorted[i][j].first).epsilon(1e-10));
+      }
+    }
+  }
+
+  // Other tree types cannot hold single-precision data.
+  REQUIRE_THROWS_AS(RSModel(RSModel::COVER_TREE, false, true),
+      std::invalid_argument);
+  RSModel coverModel(RSModel::COVER_TREE);
+  coverModel.SinglePrecision() = true;
+  REQUIRE_THROWS_AS(coverModel.BuildModel(arma::mat(referenceData), 5, false,
+      false), std::invalid_argument);
+}
+
+/**
+ * Check that the given sorted range search results are the same.
+ */
+void CheckSameResults(const vector<vector<pair<double, size_t>>>& a,
+                      const vector<vector<pair<double, size_t>>>& b)
+{
+  REQUIRE(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    REQUIRE(a[i].size() == b[i].size());
+    for (size_t j = 0; j < a[i].size(); ++j)
+    {
+      REQUIRE(a[i][j].second == b[i][j].second);
+      REQUIRE(a[i][j].first == Approx(b[i][j].first).epsilon(1e-7));
+    }
+  }
+}
+
+/**
+ * Make sure that a range search model that holds its reference set in single
+ * precision and verifies the distances finds the points that lie exactly on the
+ * bounds of the range, even if their single-precision distance is rounded out
+ * of the range.
+ */
+TEST_CASE("RSModelSinglePrecisionBoundaryTest", "[RangeSearchTest]")
+{
+  // All points can be represented exactly in single precision.
+  arma::mat queryData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 20));
+  arma::mat referenceData = arma::conv_to<arma::mat>::from(
+      arma::randu<arma::fmat>(10, 200));
+
+  RSModel model(RSModel::KD_TREE);
+  model.BuildModel(arma::mat(referenceData), 5, false, false);
+
+  RSModel floatModel(RSModel::KD_TREE, false, true);
+  floatModel.BuildModel(arma::mat(referenceData), 5, false, false);
+  floatModel.VerifyDistances() = true;
+
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+  {
+    // Put a reference point exactly on each bound of the range.
+    const double a = EuclideanDistance::Evaluate(queryData.col(i),
+        referenceData.col(i));
+    const double b = EuclideanDistance::Evaluate(queryData.col(i),
+        referenceData.col(i + 100));
+    const math::Range range(std::min(a, b), std::max(a, b));
+
+    vector<vector<size_t>> neighbors, floatNeighbors;
+    vector<vector<double>> distances, floatDistances;
+    model.Search(arma::mat(queryData.col(i)), range, neighbors, distances);
+    floatModel.Search(arma::mat(queryData.col(i)), range, floatNeighbors,
+        floatDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, floatSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(floatNeighbors, floatDistances, floatSorted);
+
+    REQUIRE(sorted[0].size() >= 2);
+    CheckSameResults(sorted, floatSorted);
+  }
+}
+
+/**
+ * Make sure that parallel search gives the same results as serial search, for
+ * each search mode and both with and without a query set.
+ */
+TEST_CASE("ParallelRangeSearchTest", "[RangeSearchTest]")
+{
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 300);
+  const Range r(0.05, 0.2);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    const bool naive = (mode == 0);
+    const bool singleMode = (mode == 1);
+
+    RangeSearch<> serial(referenceData, naive, singleMode);
+    RangeSearch<> parallel(referenceData, naive, singleMode);
+    parallel.Parallel() = true;
+
+    vector<vector<size_t>> serialNeighbors, parallelNeighbors;
+    vector<vector<double>> serialDistances, parallelDistances;
+    vector<vector<pair<double, size_t>>> serialSorted, parallelSorted;
+
+    serial.Search(queryData, r, serialNeighbors, serialDistances);
+    parallel.Search(queryData, r, parallelNeighbors, parallelDistances);
+    SortResults(serialNeighbors, serialDistances, serialSorted);
+    SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+    CheckSameResults(serialSorted, parallelSorted);
+
+    if (!naive)
+      REQUIRE(serial.BaseCases() > 0);
+
+    // Now the monochromatic search.
+    serial.Search(r, serialNeighbors, serialDistances);
+    parallel.Search(r, parallelNeighbors, parallelDistances);
+    SortResults(serialNeighbors, serialDistances, serialSorted);
+    SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+    CheckSameResults(serialSorted, parallelSorted);
+  }
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+}
+
+/**
+ * Make sure that parallel search with cover trees (which can't search in
+ * parallel in single-tree mode) gives the same results as serial search.
+ */
+TEST_CASE("ParallelCoverTreeRangeSearchTest", "[RangeSearchTest]")
+{
+  typedef RangeSearch<EuclideanDistance, arma::mat, StandardCoverTree>
+      CoverTreeRangeSearch;
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 300);
+  const Range r(0.05, 0.2);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    CoverTreeRangeSearch serial(referenceData, false, (mode == 1));
+    CoverTreeRangeSearch parallel(referenceData, false, (mode == 1));
+    parallel.Parallel() = true;
+
+    vector<vector<size_t>> serialNeighbors, parallelNeighbors;
+    vector<vector<double>> serialDistances, parallelDistances;
+    vector<vector<pair<double, size_t>>> serialSorted, parallelSorted;
+
+    serial.Search(queryData, r, serialNeighbors, serialDistances);
+    parallel.Search(queryData, r, parallelNeighbors, parallelDistances);
+    SortResults(serialNeighbors, serialDistances, serialSorted);
+    SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+    CheckSameResults(serialSorted, parallelSorted);
+  }
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+}
+
+/**
+ * Make sure that the callback version of Search() gives the same results as the
+ * regular version, even when the query set is split into many blocks.
+ */
+TEST_CASE("CallbackRangeSearchTest", "[RangeSearchTest]")
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 205);
+  const Range r(0.05, 0.2);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(referenceData, (mode == 0), (mode == 1));
+
+    vector<vector<size_t>> neighbors, callbackNeighbors;
+    vector<vector<double>> distances, callbackDistances;
+    vector<vector<pair<double, size_t>>> sorted, callbackSorted;
+
+    rs.Search(queryData, r, neighbors, distances);
+
+    callbackNeighbors.resize(queryData.n_cols);
+    callbackDistances.resize(queryData.n_cols);
+    vector<size_t> calls(queryData.n_cols, 0);
+    size_t lastQuery = 0;
+    bool inOrder = true;
+    rs.Search(queryData, r, [&](const size_t query,
+                                const vector<size_t>& queryNeighbors,
+                                const vector<double>& queryDistances)
+        {
+          if (query < lastQuery)
+            inOrder = false;
+          lastQuery = query;
+          ++calls[query];
+          callbackNeighbors[query] = queryNeighbors;
+          callbackDistances[query] = queryDistances;
+        }, 50);
+
+    REQUIRE(inOrder);
+    for (size_t i = 0; i < calls.size(); ++i)
+      REQUIRE(calls[i] == 1);
+
+    SortResults(neighbors, distances, sorted);
+    SortResults(callbackNeighbors, callbackDistances, callbackSorted);
+    CheckSameResults(sorted, callbackSorted);
+
+    // Now the monochromatic search.
+    rs.Search(r, neighbors, distances);
+
+    callbackNeighbors.clear();
+    callbackNeighbors.resize(referenceData.n_cols);
+    callbackDistances.clear();
+    callbackDistances.resize(referenceData.n_cols);
+    calls.assign(referenceData.n_cols, 0);
+    rs.Search(r, [&](const size_t query,
+                     const vector<size_t>& queryNeighbors,
+                     const vector<double>& queryDistances)
+        {
+          ++calls[query];
+          callbackNeighbors[query] = queryNeighbors;
+          callbackDistances[query] = queryDistances;
+        }, 64);
+
+    for (size_t i = 0; i < calls.size(); ++i)
+      REQUIRE(calls[i] == 1);
+
+    SortResults(neighbors, distances, sorted);
+    SortResults(callbackNeighbors, callbackDistances, callbackSorted);
+    CheckSameResults(sorted, callbackSorted);
+  }
+
+  // A block size of 0 is not allowed.
+  RangeSearch<> rs(referenceData);
+  REQUIRE_THROWS_AS(rs.Search(r, [](const size_t, const vector<size_t>&,
+      const vector<double>&) { }, 0), std::invalid_argument);
+}
@@ -1359,3 +1359,142 @@ TEST_CASE("RectangleTreeMoveDatasetTest", "[RectangleTreeTraitsTest]")
   REQUIRE(tree.Dataset().n_rows == 3);
   REQUIRE(tree.Dataset().n_cols == 1000);
 }
+
+/**
+ * Build a tree of the given type by bulk loading, check its structure, and
+ * check that nearest neighbor search with it gives the same results as a naive
+ * search.
+ */
+template<template<typename, typename, typename> class TreeType>
+void CheckBulkLoadedTree(const BulkLoadType bulkLoad)
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  Tree tree(dataset, bulkLoad, 20, 6, 5, 2);
+
+  REQUIRE(tree.NumDescendants() == 1000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+
+  // Every point is held exactly once.
+  std::vector<size_t> counts(dataset.n_cols, 0);
+  for (size_t i = 0; i < tree.NumDescendants(); ++i)
+    counts[tree.Descendant(i)]++;
+  for (size_t i = 0; i < counts.size(); ++i)
+    REQUIRE(counts[i] == 1);
+
+  // The leaves are full: 1000 points make 50 leaves of 20 points, which are
+  // packed into 10 nodes, and then into 2 children of the root.
+  REQUIRE(GetMinLevel(tree) == GetMaxLevel(tree));
+  REQUIRE(tree.TreeDepth() == 4);
+  REQUIRE(tree.NumChildren() == 2);
+
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      TreeType> knn1(std::move(tree), DUAL_TREE_MODE);
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); ++i)
+  {
+    REQUIRE(neighbors1[i] == neighbors2[i]);
+    REQUIRE(distances1[i] == distances2[i]);
+  }
+}
+
+// Make sure that bulk loading gives valid trees of every type that supports it,
+// with both orderings.
+TEST_CASE("RectangleTreeBulkLoadTest", "[RectangleTreeTraitsTest]")
+{
+  CheckBulkLoadedTree<RTree>(STR_BULK_LOAD);
+  CheckBulkLoadedTree<RTree>(HILBERT_BULK_LOAD);
+  CheckBulkLoadedTree<RStarTree>(STR_BULK_LOAD);
+  CheckBulkLoadedTree<RStarTree>(HILBERT_BULK_LOAD);
+  CheckBulkLoadedTree<XTree>(STR_BULK_LOAD);
+  CheckBulkLoadedTree<XTree>(HILBERT_BULK_LOAD);
+  CheckBulkLoadedTree<HilbertRTree>(STR_BULK_LOAD);
+  CheckBulkLoadedTree<HilbertRTree>(HILBERT_BULK_LOAD);
+}
+
+// Make sure that the last nodes of each level are rebalanced so that they
+// satisfy the minimum fill, and that tiny datasets give a single leaf.
+TEST_CASE("RectangleTreeBulkLoadFillTest", "[RectangleTreeTraitsTest]")
+{
+  typedef RStarTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  for (size_t numPoints : { 1, 7, 20, 21, 101, 1003 })
+  {
+    arma::mat dataset = arma::randu<arma::mat>(3, numPoints);
+
+    TreeType strTree(dataset, STR_BULK_LOAD, 20, 8, 5, 2);
+    TreeType hilbertTree(dataset, HILBERT_BULK_LOAD, 20, 8, 5, 2);
+
+    REQUIRE(strTree.NumDescendants() == numPoints);
+    REQUIRE(hilbertTree.NumDescendants() == numPoints);
+    CheckFills(strTree);
+    CheckFills(hilbertTree);
+    CheckNumDescendants(strTree);
+    CheckNumDescendants(hilbertTree);
+    CheckExactContainment(strTree);
+    CheckExactContainment(hilbertTree);
+
+    if (numPoints <= 20)
+    {
+      REQUIRE(strTree.IsLeaf());
+      REQUIRE(hilbertTree.IsLeaf());
+    }
+  }
+
+  // An empty dataset gives an empty leaf.
+  TreeType emptyTree(arma::mat(3, 0), STR_BULK_LOAD);
+  REQUIRE(emptyTree.IsLeaf());
+  REQUIRE(emptyTree.NumDescendants() == 0);
+}
+
+// Make sure that the Hilbert values of a bulk-loaded Hilbert R tree are set up
+// correctly, and that points can be inserted afterwards.
+TEST_CASE("HilbertRTreeBulkLoadTest", "[RectangleTreeTraitsTest]")
+{
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  for (const BulkLoadType bulkLoad : { STR_BULK_LOAD, HILBERT_BULK_LOAD })
+  {
+    TreeType tree(dataset, bulkLoad, 20, 6, 5, 2);
+
+    CheckHilbertOrdering(tree);
+    CheckDiscreteHilbertValueSync(tree);
+    CheckHilbertValue(tree);
+
+    // Insert some more points; the tree should stay valid.
+    const size_t numIter = 50;
+    tree.Dataset().reshape(8, 1000 + numIter);
+    tree.Dataset().cols(1000, 1000 + numIter - 1).randu();
+    for (size_t i = 0; i < numIter; ++i)
+      tree.InsertPoint(1000 + i);
+
+    REQUIRE(tree.NumDescendants() == 1000 + numIter);
+    CheckContainment(tree);
+    CheckExactContainment(tree);
+    CheckNumDescendants(tree);
+    CheckHilbertOrdering(tree);
+    CheckDiscreteHilbertValueSync(tree);
+    CheckHilbertValue(tree);
+  }
+}
@@ -359,6 +359,52 @@ TEST_CASE("BinarySpaceTreeOverwriteTest", "[SerializationTest]")
   CheckTrees(tree, xmlTree, jsonTree, binaryTree);
 }
 
+// Make sure the capacities of two binary space trees are the same.
+template<typename TreeType>
+void CheckCapacities(const TreeType& tree, const TreeType& newTree)
+{
+  REQUIRE(tree.Begin() == newTree.Begin());
+  REQUIRE(tree.Count() == newTree.Count());
+  REQUIRE(tree.Capacity() == newTree.Capacity());
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    CheckCapacities(tree.Child(i), newTree.Child(i));
+}
+
+/**
+ * Make sure that a tree modified with Insert() and Delete(), which has free
+ * columns in its dataset, is serialized properly.
+ */
+TEST_CASE("ModifiedBinarySpaceTreeTest", "[SerializationTest]")
+{
+  arma::mat data;
+  data.randu(3, 100);
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data, 10);
+  for (size_t i = 0; i < 50; ++i)
+  {
+    tree.Insert(arma::vec(arma::randu<arma::vec>(3) + 0.5), 10);
+    tree.Delete(tree.Descendant(0), 10);
+  }
+  REQUIRE(tree.Dataset().n_cols > tree.Count());
+
+  TreeType* xmlTree;
+  TreeType* jsonTree;
+  TreeType* binaryTree;
+
+  SerializePointerObjectAll(&tree, xmlTree, jsonTree, binaryTree);
+
+  CheckTrees(tree, *xmlTree, *jsonTree, *binaryTree);
+  CheckCapacities(tree, *xmlTree);
+  CheckCapacities(tree, *jsonTree);
+  CheckCapacities(tree, *binaryTree);
+  for (size_t i = 0; i < tree.NumDescendants(); ++i)
+    REQUIRE(binaryTree->Descendant(i) == tree.Descendant(i));
+
+  delete xmlTree;
+  delete jsonTree;
+  delete binaryTree;
+}
+
 TEST_CASE("CoverTreeTest", "[SerializationTest]")
 {
   arma::mat data;
@@ -1073,16 +1119,13 @@ TEST_CASE("LSHTest", "[SerializationTest]")
   REQUIRE(lsh.BucketSize() == jsonLsh.BucketSize());
   REQUIRE(lsh.BucketSize() == binaryLsh.BucketSize());
 
-  REQUIRE(lsh.SecondHashTable().size() ==
-      xmlLsh.SecondHashTable().size());
-  REQUIRE(lsh.SecondHashTable().size() ==
-      jsonLsh.SecondHashTable().size());
-  REQUIRE(lsh.SecondHashTable().size() ==
-      binaryLsh.SecondHashTable().size());
-
-  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
-  CheckMatrices(lsh.SecondHashTable()[i], xmlLsh.SecondHashTable()[i],
-      jsonLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
+  CheckMatrices(lsh.BucketOffsets(), xmlLsh.BucketOffsets(),
+      jsonLsh.BucketOffsets(), binaryLsh.BucketOffsets());
+  CheckMatrices(
+      arma::conv_to<arma::Mat<size_t>>::from(lsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(xmlLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(jsonLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(binaryLsh.BucketContents()));
 }
 
 // Make sure serialization works for LARS.
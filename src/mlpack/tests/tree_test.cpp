@@ -15,6 +15,7 @@
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/core/tree/subtree_partition.hpp>
 
 #include <queue>
 #include <stack>
@@ -2287,3 +2288,498 @@ TEST_CASE("CoverTreeDescendantTest", "[TreeTest]")
   // using the recursive function above.
   CheckDescendants(&tree);
 }
+
+// Make sure two cover trees have exactly the same structure.
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  REQUIRE(a.Point() == b.Point());
+  REQUIRE(a.Scale() == b.Scale());
+  REQUIRE(a.NumChildren() == b.NumChildren());
+  REQUIRE(a.NumDescendants() == b.NumDescendants());
+  REQUIRE(a.ParentDistance() == b.ParentDistance());
+  REQUIRE(a.FurthestDescendantDistance() == b.FurthestDescendantDistance());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * The subtrees of large cover tree nodes are built concurrently, and the
+ * distances of large point sets are computed in parallel; make sure that the
+ * tree is exactly the same as when it is built with a single thread, and that
+ * it is still valid.
+ */
+TEST_CASE("CoverTreeParallelBuildTest", "[TreeTest]")
+{
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+  arma::mat dataset;
+  dataset.randu(5, 10000);
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  TreeType serialTree(dataset);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  TreeType parallelTree(dataset);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  CheckSameCoverTree(serialTree, parallelTree);
+
+  arma::vec counts;
+  counts.zeros(dataset.n_cols);
+  RecurseTreeCountLeaves(parallelTree, counts);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    REQUIRE(counts[i] == 1);
+
+  CheckSelfChild<TreeType>(parallelTree);
+  CheckCovering<TreeType, LMetric<2, true> >(parallelTree);
+}
+
+/**
+ * Make sure that packing a cover tree keeps its structure, stores the nodes
+ * contiguously in breadth-first order, and survives copies and moves.
+ */
+TEST_CASE("CoverTreePackTest", "[TreeTest]")
+{
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  TreeType tree(dataset);
+  TreeType packedTree(tree);
+
+  REQUIRE(!packedTree.IsPacked());
+  packedTree.Pack();
+  REQUIRE(packedTree.IsPacked());
+  CheckSameCoverTree(tree, packedTree);
+
+  std::queue<const TreeType*> queue;
+  for (size_t i = 0; i < packedTree.NumChildren(); ++i)
+    queue.push(&packedTree.Child(i));
+  const TreeType* last = NULL;
+  while (!queue.empty())
+  {
+    const TreeType* node = queue.front();
+    queue.pop();
+
+    if (last != NULL)
+      REQUIRE(node == last + 1);
+    last = node;
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+    {
+      REQUIRE(node->Child(i).Parent() == node);
+      queue.push(&node->Child(i));
+    }
+  }
+
+  REQUIRE_THROWS_AS(packedTree.Child(0).Pack(), std::invalid_argument);
+
+  TreeType copiedTree(packedTree);
+  REQUIRE(!copiedTree.IsPacked());
+  CheckSameCoverTree(tree, copiedTree);
+
+  TreeType movedTree(std::move(packedTree));
+  REQUIRE(movedTree.IsPacked());
+  REQUIRE(!packedTree.IsPacked());
+  REQUIRE(movedTree.Child(0).Parent() == &movedTree);
+  CheckSameCoverTree(tree, movedTree);
+
+  movedTree.Unpack();
+  REQUIRE(!movedTree.IsPacked());
+  REQUIRE(movedTree.Child(0).Parent() == &movedTree);
+  CheckSameCoverTree(tree, movedTree);
+  CheckCovering<TreeType, LMetric<2, true> >(movedTree);
+}
+
+/**
+ * Make sure PartitionSubtrees() returns disjoint subtrees that hold every point
+ * of the tree exactly once.
+ */
+TEST_CASE("PartitionSubtreesTest", "[TreeTest]")
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> tree(dataset, 10);
+
+  std::vector<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>*> subtrees;
+  PartitionSubtrees(tree, 16, subtrees);
+
+  REQUIRE(subtrees.size() >= 16);
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < subtrees.size(); ++i)
+  {
+    // The subtrees should be in decreasing order of size.
+    if (i > 0)
+    {
+      REQUIRE(subtrees[i]->NumDescendants() <=
+          subtrees[i - 1]->NumDescendants());
+    }
+
+    for (size_t j = 0; j < subtrees[i]->NumDescendants(); ++j)
+      ++counts[subtrees[i]->Descendant(j)];
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    REQUIRE(counts[i] == 1);
+
+  // Asking for a single subtree should just give the root.
+  PartitionSubtrees(tree, 1, subtrees);
+  REQUIRE(subtrees.size() == 1);
+  REQUIRE(subtrees[0] == &tree);
+}
+
+// Make sure two binary space trees have the same structure and bounds.
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& a, const TreeType& b)
+{
+  REQUIRE(a.Begin() == b.Begin());
+  REQUIRE(a.Count() == b.Count());
+  REQUIRE(a.NumChildren() == b.NumChildren());
+  REQUIRE(a.ParentDistance() == Approx(b.ParentDistance()).epsilon(1e-7));
+
+  for (size_t d = 0; d < a.Bound().Dim(); ++d)
+  {
+    REQUIRE(a.Bound()[d].Lo() == b.Bound()[d].Lo());
+    REQUIRE(a.Bound()[d].Hi() == b.Bound()[d].Hi());
+  }
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameBinarySpaceTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Large trees are built in parallel; make sure that the result is exactly the
+ * same as when the tree is built with a single thread.
+ */
+template<typename TreeType>
+void CheckParallelBuild()
+{
+  arma::mat dataset;
+  dataset.randu(4, 5 * tree::split::ParallelBlockSize);
+
+  #ifdef HAS_OPENMP
+  const int oldThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  std::vector<size_t> serialOldFromNew;
+  TreeType serialTree(dataset, serialOldFromNew, 20);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(oldThreads, 4));
+  #endif
+
+  std::vector<size_t> parallelOldFromNew;
+  TreeType parallelTree(dataset, parallelOldFromNew, 20);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(oldThreads);
+  #endif
+
+  REQUIRE(serialOldFromNew.size() == parallelOldFromNew.size());
+  for (size_t i = 0; i < serialOldFromNew.size(); ++i)
+    REQUIRE(serialOldFromNew[i] == parallelOldFromNew[i]);
+
+  CheckSameBinarySpaceTree(serialTree, parallelTree);
+
+  // The reordered datasets should be identical too.
+  REQUIRE(arma::approx_equal(serialTree.Dataset(), parallelTree.Dataset(),
+      "absdiff", 0.0));
+}
+
+TEST_CASE("KDTreeParallelBuildTest", "[TreeTest]")
+{
+  CheckParallelBuild<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+TEST_CASE("MeanSplitKDTreeParallelBuildTest", "[TreeTest]")
+{
+  CheckParallelBuild<MeanSplitKDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+/**
+ * Make sure that packing a tree keeps its structure, stores the nodes
+ * contiguously in breadth-first order, and survives copies and moves.
+ */
+TEST_CASE("BinarySpaceTreePackTest", "[TreeTest]")
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(5, 2000, arma::fill::randu);
+  TreeType tree(dataset, 10);
+  TreeType packedTree(tree);
+
+  REQUIRE(!packedTree.IsPacked());
+  packedTree.Pack();
+  REQUIRE(packedTree.IsPacked());
+
+  // Packing twice does nothing.
+  packedTree.Pack();
+  REQUIRE(packedTree.IsPacked());
+
+  CheckSameBinarySpaceTree(tree, packedTree);
+
+  // Walk the tree in breadth-first order; every node should directly follow
+  // the previous one in memory.
+  std::queue<const TreeType*> queue;
+  queue.push(&packedTree.Child(0));
+  queue.push(&packedTree.Child(1));
+  const TreeType* last = NULL;
+  const math::Range* lastBound = NULL;
+  while (!queue.empty())
+  {
+    const TreeType* node = queue.front();
+    queue.pop();
+
+    if (last != NULL)
+      REQUIRE(node == last + 1);
+    last = node;
+
+    REQUIRE(&node->Dataset() == &packedTree.Dataset());
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+    {
+      REQUIRE(node->Child(i).Parent() == node);
+      queue.push(&node->Child(i));
+    }
+
+    // The ranges of the bounds are packed too, in the same order.
+    REQUIRE(node->Bound().IsPacked());
+    if (lastBound != NULL)
+      REQUIRE(&node->Bound()[0] == lastBound + 5);
+    lastBound = &node->Bound()[0];
+  }
+  REQUIRE(!packedTree.Bound().IsPacked());
+
+  // Only the root can be packed.
+  REQUIRE_THROWS_AS(packedTree.Child(0).Pack(), std::invalid_argument);
+
+  // A copy is an ordinary tree again.
+  TreeType copiedTree(packedTree);
+  REQUIRE(!copiedTree.IsPacked());
+  CheckSameBinarySpaceTree(tree, copiedTree);
+
+  // Moving keeps the packed nodes.
+  TreeType movedTree(std::move(packedTree));
+  REQUIRE(movedTree.IsPacked());
+  REQUIRE(!packedTree.IsPacked());
+  REQUIRE(movedTree.Child(0).Parent() == &movedTree);
+  CheckSameBinarySpaceTree(tree, movedTree);
+
+  TreeType assignedTree(dataset, 10);
+  assignedTree.Pack();
+  assignedTree = std::move(movedTree);
+  REQUIRE(assignedTree.IsPacked());
+  REQUIRE(assignedTree.Child(1).Parent() == &assignedTree);
+  CheckSameBinarySpaceTree(tree, assignedTree);
+
+  assignedTree = tree;
+  REQUIRE(!assignedTree.IsPacked());
+  CheckSameBinarySpaceTree(tree, assignedTree);
+
+  // Unpacking moves the nodes and their bounds back to the heap.
+  TreeType unpackedTree(tree);
+  unpackedTree.Pack();
+  unpackedTree.Unpack();
+  REQUIRE(!unpackedTree.IsPacked());
+  REQUIRE(!unpackedTree.Child(0).Bound().IsPacked());
+  REQUIRE(unpackedTree.Child(0).Parent() == &unpackedTree);
+  CheckSameBinarySpaceTree(tree, unpackedTree);
+}
+
+// Make sure that the ranges, bounds, and parent distances of a binary space
+// tree that was modified with Insert() and Delete() are consistent.
+template<typename TreeType>
+void CheckModifiedBinarySpaceTree(const TreeType& node)
+{
+  REQUIRE(node.Count() <= node.Capacity());
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+  {
+    const size_t index = node.Descendant(i);
+    REQUIRE(index >= node.Begin());
+    REQUIRE(index < node.Begin() + node.Capacity());
+    REQUIRE(node.Bound().Contains(node.Dataset().col(index)));
+  }
+
+  if (node.IsLeaf())
+    return;
+
+  REQUIRE(node.Left()->Begin() == node.Begin());
+  REQUIRE(node.Right()->Begin() == node.Begin() + node.Left()->Capacity());
+  REQUIRE(node.Left()->Capacity() + node.Right()->Capacity() ==
+      node.Capacity());
+  REQUIRE(node.Left()->Count() + node.Right()->Count() == node.Count());
+
+  arma::vec center, childCenter;
+  node.Center(center);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    REQUIRE(node.Child(i).Parent() == &node);
+    node.Child(i).Center(childCenter);
+    REQUIRE(node.Child(i).ParentDistance() ==
+        Approx(arma::norm(center - childCenter)).epsilon(1e-7));
+    CheckModifiedBinarySpaceTree(node.Child(i));
+  }
+}
+
+// Make sure that the oldFromNew and newFromOld mappings of a modified tree
+// match the given points (indexed by their old index) and each other.
+template<typename TreeType>
+void CheckInsertDeleteMappings(const TreeType& tree,
+                               const arma::mat& points,
+                               const std::vector<size_t>& oldFromNew,
+                               const std::vector<size_t>& newFromOld,
+                               const std::vector<size_t>& remaining)
+{
+  REQUIRE(tree.Capacity() == tree.Dataset().n_cols);
+  REQUIRE(oldFromNew.size() == tree.Dataset().n_cols);
+  REQUIRE(newFromOld.size() == points.n_cols);
+  REQUIRE(tree.Count() == remaining.size());
+
+  size_t numPoints = 0;
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    if (oldFromNew[i] == SIZE_MAX)
+      continue;
+
+    ++numPoints;
+    REQUIRE(newFromOld[oldFromNew[i]] == i);
+    for (size_t d = 0; d < points.n_rows; ++d)
+      REQUIRE(tree.Dataset()(d, i) == points(d, oldFromNew[i]));
+  }
+  REQUIRE(numPoints == remaining.size());
+
+  // The descendants of the root are exactly the columns that hold points.
+  for (size_t i = 0; i < tree.NumDescendants(); ++i)
+    REQUIRE(oldFromNew[tree.Descendant(i)] != SIZE_MAX);
+  for (size_t i = 0; i < remaining.size(); ++i)
+    REQUIRE(newFromOld[remaining[i]] != SIZE_MAX);
+}
+
+/**
+ * Insert points into and delete points from a tree, and make sure that the
+ * tree stays consistent and that the oldFromNew and newFromOld mappings follow
+ * the changes.
+ */
+template<typename TreeType>
+void CheckInsertDelete()
+{
+  // The points are indexed by their old index; deleted points stay in the
+  // matrix, since their old index is not reused.
+  arma::mat points(3, 1000, arma::fill::randu);
+  std::vector<size_t> oldFromNew, newFromOld;
+  TreeType tree(points, oldFromNew, newFromOld, 10);
+
+  std::vector<size_t> remaining(points.n_cols);
+  for (size_t i = 0; i < remaining.size(); ++i)
+    remaining[i] = i;
+
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    // Insert points from a shifted distribution, so that the tree becomes
+    // unbalanced unless it is rebuilt.
+    if (i % 3 != 2)
+    {
+      arma::vec point = arma::randu<arma::vec>(3) + 0.5;
+      tree.Insert(point, oldFromNew, newFromOld, 10);
+      REQUIRE(newFromOld.size() == points.n_cols + 1);
+      remaining.push_back(points.n_cols);
+      points.insert_cols(points.n_cols, point);
+    }
+    else
+    {
+      const size_t j = math::RandInt(remaining.size());
+      const size_t oldIndex = remaining[j];
+      remaining[j] = remaining.back();
+      remaining.pop_back();
+
+      tree.Delete(newFromOld[oldIndex], oldFromNew, newFromOld, 10);
+      REQUIRE(newFromOld[oldIndex] == SIZE_MAX);
+    }
+  }
+
+  CheckInsertDeleteMappings(tree, points, oldFromNew, newFromOld, remaining);
+  CheckModifiedBinarySpaceTree(tree);
+
+  // Deleting a free column or a column past the end of the dataset fails.
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    if (oldFromNew[i] == SIZE_MAX)
+    {
+      REQUIRE_THROWS_AS(tree.Delete(i, oldFromNew, newFromOld, 10),
+          std::invalid_argument);
+      break;
+    }
+  }
+  REQUIRE_THROWS_AS(tree.Delete(oldFromNew.size(), oldFromNew, newFromOld, 10),
+      std::invalid_argument);
+
+  // Removing the free columns keeps the points and the tree.
+  tree.Compact(oldFromNew, newFromOld);
+  REQUIRE(tree.Dataset().n_cols == tree.Count());
+  CheckInsertDeleteMappings(tree, points, oldFromNew, newFromOld, remaining);
+  CheckModifiedBinarySpaceTree(tree);
+
+  // Delete all of the points.
+  while (tree.Count() > 0)
+  {
+    tree.Delete(newFromOld[remaining.back()], oldFromNew, newFromOld, 10);
+    remaining.pop_back();
+  }
+  REQUIRE(tree.IsLeaf());
+  REQUIRE(tree.Dataset().n_cols == 0);
+  REQUIRE(oldFromNew.empty());
+
+  // The tree can grow again from nothing.
+  tree.Insert(arma::vec(points.col(0)), oldFromNew, newFromOld, 10);
+  REQUIRE(tree.Count() == 1);
+  REQUIRE(newFromOld.size() == points.n_cols + 1);
+  REQUIRE(oldFromNew[newFromOld[points.n_cols]] == points.n_cols);
+
+  // Only the root can be modified.
+  TreeType packedTree(arma::mat(3, 100, arma::fill::randu), 10);
+  REQUIRE_THROWS_AS(packedTree.Child(0).Delete(0), std::invalid_argument);
+
+  // Modifying a packed tree unpacks it first.
+  packedTree.Pack();
+  packedTree.Delete(0);
+  REQUIRE(!packedTree.IsPacked());
+  REQUIRE(packedTree.Count() == 99);
+  CheckModifiedBinarySpaceTree(packedTree);
+
+  packedTree.Pack();
+  packedTree.Insert(arma::randu<arma::vec>(3));
+  REQUIRE(!packedTree.IsPacked());
+  REQUIRE(packedTree.Count() == 100);
+  CheckModifiedBinarySpaceTree(packedTree);
+
+  packedTree.Pack();
+  packedTree.Compact();
+  REQUIRE(!packedTree.IsPacked());
+  REQUIRE(packedTree.Dataset().n_cols == 100);
+}
+
+TEST_CASE("KDTreeInsertDeleteTest", "[TreeTest]")
+{
+  CheckInsertDelete<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+TEST_CASE("BallTreeInsertDeleteTest", "[TreeTest]")
+{
+  CheckInsertDelete<BallTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/methods/emst/union_find.hpp>
+#include <mlpack/methods/emst/concurrent_union_find.hpp>
 
 #include <mlpack/core.hpp>
 #include "catch.hpp"
@@ -47,3 +48,66 @@ TEST_CASE("TestUnion", "[UnionFindTest]")
   REQUIRE(testUnionFind.Find(1) == testUnionFind.Find(5));
   REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
 }
+
+TEST_CASE("TestConcurrentUnion", "[UnionFindTest]")
+{
+  static const size_t testSize = 10;
+  ConcurrentUnionFind testUnionFind(testSize);
+
+  REQUIRE(testUnionFind.Union(0, 1));
+  REQUIRE(testUnionFind.Union(2, 3));
+  REQUIRE(testUnionFind.Union(0, 2));
+  REQUIRE(testUnionFind.Union(5, 0));
+  REQUIRE(testUnionFind.Union(0, 6));
+  REQUIRE(!testUnionFind.Union(6, 1));
+
+  REQUIRE(testUnionFind.Find(0) == testUnionFind.Find(1));
+  REQUIRE(testUnionFind.Find(2) == testUnionFind.Find(3));
+  REQUIRE(testUnionFind.Find(1) == testUnionFind.Find(5));
+  REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
+  REQUIRE(testUnionFind.Find(4) == 4);
+  REQUIRE(testUnionFind.Find(4) != testUnionFind.Find(0));
+}
+
+/**
+ * Unite random pairs of elements from many threads at once, and make sure the
+ * components (and their representatives) are the same as when the same unions
+ * are done by a single thread.
+ */
+TEST_CASE("TestParallelConcurrentUnion", "[UnionFindTest]")
+{
+  static const size_t testSize = 10000;
+  arma::Mat<size_t> pairs = arma::randi<arma::Mat<size_t>>(2, 8000,
+      arma::distr_param(0, (int) testSize - 1));
+
+  UnionFind serialUnionFind(testSize);
+  ConcurrentUnionFind concurrentUnionFind(testSize);
+  ConcurrentUnionFind parallelUnionFind(testSize);
+
+  size_t concurrentUnions = 0;
+  for (size_t i = 0; i < pairs.n_cols; ++i)
+  {
+    serialUnionFind.Union(pairs(0, i), pairs(1, i));
+    if (concurrentUnionFind.Union(pairs(0, i), pairs(1, i)))
+      ++concurrentUnions;
+  }
+
+  size_t parallelUnions = 0;
+  #pragma omp parallel for reduction(+:parallelUnions)
+  for (omp_size_t i = 0; i < (omp_size_t) pairs.n_cols; ++i)
+  {
+    if (parallelUnionFind.Union(pairs(0, i), pairs(1, i)))
+      ++parallelUnions;
+  }
+
+  REQUIRE(concurrentUnions == parallelUnions);
+  for (size_t i = 0; i < testSize; ++i)
+  {
+    REQUIRE(concurrentUnionFind.Find(i) == parallelUnionFind.Find(i));
+    for (size_t j = i + 1; j < std::min(i + 20, testSize); ++j)
+    {
+      REQUIRE((serialUnionFind.Find(i) == serialUnionFind.Find(j)) ==
+          (parallelUnionFind.Find(i) == parallelUnionFind.Find(j)));
+    }
+  }
+}